@@ -0,0 +1,484 @@
+#include "renderer.h"
+#include "mesh_import.h"
+#include "mesh_file.h"
+#include "mesh_optimize.h"
+#include "mesh_lod.h"
+#include "meshlet.h"
+#include "scene.h"
+#ifdef MXC_NULL_DRIVER
+#include "null_driver.h"
+#endif // ifdef MXC_NULL_DRIVER
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm> // sort, min
+
+// Headless renderer benchmark. Renders a grid of triangles (or a mesh file, --mesh) offscreen for a fixed number of frames and reports, as JSON:
+// - CPU frame time: duration of Renderer::draw
+// - submit to fence latency: from draw returning to the frame timeline reaching the frame value, observed by a thread blocked on it
+// - GPU time: "render pass" timestamp scope of the GpuProfiler, over its rolling window
+// Warmup frames (pipeline creation, first recordings) are excluded from the CPU and latency statistics.
+// With --scene-nodes, a hierarchy of transforms is animated before each frame and its root places the geometry: the time of the
+// animation and world matrix update is reported too.
+// Runs on whatever ICD the loader picks, --icd forces one (eg. lavapipe's lvp_icd.x86_64.json) through VK_ICD_FILENAMES.
+// Built with MXC_NULL_DRIVER, there is no loader nor GPU: frames cost only the renderer CPU work, GPU times read 0, and the work handed
+// to the driver per measured frame (commands, draws, submits, descriptor writes) is reported too
+namespace
+{
+	struct BenchConfig
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t objectCount;
+		char const* meshPath; // OBJ, glTF or .mxm rendered in place of the grid, if not null
+		mxc::VertexFormat vertexFormat; // of the grid and of imported meshes, .mxm files keep their own
+		bool optimize; // runs optimizeMesh on the grid and on imported meshes, .mxm files are optimized by the converter
+		bool lods; // builds LODs of the grid and of imported meshes, and draws at LOD (the converter builds them for .mxm files)
+		float lodErrorPixels;
+		bool meshlets; // builds meshlets of the grid and of imported meshes, and culls them (the converter builds them for .mxm files)
+		float zoom; // scales the view around its center, above 1 part of the scene is off screen
+		uint32_t sceneNodeCount; // transforms animated each frame, 0 for none
+		uint32_t framesInFlight;
+		uint64_t frameCount;
+		uint64_t warmupFrameCount;
+		bool rerecord; // marks command buffers dirty every frame, so recording is measured too
+		char const* icdPath;
+		char const* outPath; // null means stdout
+	};
+
+	struct Percentiles
+	{
+		double p50;
+		double p95;
+		double p99;
+		double max;
+	};
+
+	auto nowNs() -> uint64_t
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	// nearest rank
+	auto percentiles(std::vector<double> samples) -> Percentiles
+	{
+		if (samples.empty())
+		{
+			return Percentiles{.p50 = 0., .p95 = 0., .p99 = 0., .max = 0.};
+		}
+		std::sort(samples.begin(), samples.end());
+		size_t const n = samples.size();
+		auto const at = [&samples, n](size_t p) -> double { return samples[std::min(n - 1, (n * p) / 100)]; };
+		return Percentiles{.p50 = at(50), .p95 = at(95), .p99 = at(99), .max = samples[n - 1]};
+	}
+
+	auto printPercentiles(FILE* file, char const* name, Percentiles const& p, bool last) -> void
+	{
+		fprintf(file, "\t\"%s\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n", name, p.p50, p.p95, p.p99, p.max, last ? "" : ",");
+	}
+
+#ifdef MXC_NULL_DRIVER
+	auto printNullDriverStats(FILE* file, mxc::nulldrv::Stats const& begin, mxc::nulldrv::Stats const& end, uint64_t frameCount) -> void
+	{
+		auto const perFrame = [frameCount](uint64_t b, uint64_t e) -> double { return static_cast<double>(e - b) / static_cast<double>(frameCount); };
+		fprintf(file, "\t\"nullDriverPerFrame\": {\"commands\": %.2f, \"draws\": %.2f, \"commandBuffers\": %.2f, \"submits\": %.2f, "
+				"\"descriptorWrites\": %.2f, \"mappedRangeFlushes\": %.2f, \"objectsCreated\": %.2f},\n",
+				perFrame(begin.commandsSubmitted, end.commandsSubmitted), perFrame(begin.drawsSubmitted, end.drawsSubmitted),
+				perFrame(begin.commandBuffersSubmitted, end.commandBuffersSubmitted), perFrame(begin.queueSubmits, end.queueSubmits),
+				perFrame(begin.descriptorWrites, end.descriptorWrites), perFrame(begin.mappedRangeFlushes, end.mappedRangeFlushes),
+				perFrame(begin.objectsCreated, end.objectsCreated));
+	}
+#endif // ifdef MXC_NULL_DRIVER
+
+	// objectCount triangles on a square grid covering clip space, one draw item each
+	auto makeScene(uint32_t objectCount, std::vector<mxc::Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<mxc::DrawItem>& drawItems) -> void
+	{
+		uint32_t side = 1;
+		while (side * side < objectCount)
+		{
+			++side;
+		}
+		float const cell = 2.f / static_cast<float>(side);
+		vertices.reserve(3 * objectCount);
+		indices.reserve(3 * objectCount);
+		drawItems.reserve(objectCount);
+		for (uint32_t i = 0; i < objectCount; ++i)
+		{
+			float const x = -1.f + cell * static_cast<float>(i % side);
+			float const y = -1.f + cell * static_cast<float>(i / side);
+			float const shade = static_cast<float>(i) / static_cast<float>(objectCount);
+			uint32_t const first = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(mxc::Vertex{.pos = {x + .5f * cell, y + .1f * cell, 0.f}, .col = {1.f, shade, 0.f}});
+			vertices.push_back(mxc::Vertex{.pos = {x + .1f * cell, y + .9f * cell, 0.f}, .col = {0.f, 1.f, shade}});
+			vertices.push_back(mxc::Vertex{.pos = {x + .9f * cell, y + .9f * cell, 0.f}, .col = {shade, 0.f, 1.f}});
+			drawItems.push_back(mxc::DrawItem{.indexCount = 3, .firstIndex = static_cast<uint32_t>(indices.size()), .vertexOffset = 0});
+			indices.insert(indices.end(), {first, first + 1, first + 2});
+		}
+	}
+
+	auto forceIcd(char const* icdPath) -> void
+	{
+#ifdef _WIN32
+		_putenv_s("VK_ICD_FILENAMES", icdPath);
+		_putenv_s("VK_DRIVER_FILES", icdPath);
+#else
+		setenv("VK_ICD_FILENAMES", icdPath, /*overwrite*/1);
+		setenv("VK_DRIVER_FILES", icdPath, /*overwrite*/1); // loader 1.3.207+ name
+#endif
+	}
+
+	auto runBench(BenchConfig const& config) -> mxc::status_t
+	{
+		if (config.icdPath)
+		{
+			forceIcd(config.icdPath);
+		}
+
+		mxc::JobSystem jobSystem; // declared before the renderer, so that it outlives it
+		if (jobSystem.init() != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to start the job system!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// geometry, either generated, imported or mapped, the renderer takes it from the view
+		mxc::MeshData sceneData;
+		mxc::MeshFile sceneFile;
+		mxc::MeshView scene;
+		auto transform {Eigen::Transform<float,3,Eigen::Affine>::Identity()};
+		if (config.meshPath)
+		{
+			if (mxc::isMeshFilePath(config.meshPath))
+			{
+				if (sceneFile.open(config.meshPath) != APP_SUCCESS)
+				{
+					return APP_GENERIC_ERR;
+				}
+				scene = sceneFile.view();
+			}
+			else
+			{
+				if (mxc::importMesh(config.meshPath, &jobSystem, &sceneData) != APP_SUCCESS)
+				{
+					fprintf(stderr, "failed to import %s!\n", config.meshPath);
+					return APP_GENERIC_ERR;
+				}
+				scene = sceneData.view();
+			}
+			if (scene.indices.count == 0)
+			{
+				fprintf(stderr, "%s has no triangles!\n", config.meshPath);
+				return APP_GENERIC_ERR;
+			}
+			transform = mxc::fitToView(scene);
+		}
+		else
+		{
+			makeScene(config.objectCount, sceneData.vertices, sceneData.indices, sceneData.drawItems);
+			sceneData.boundsMin = Eigen::Vector3f(-1.f, -1.f, 0.f);
+			sceneData.boundsMax = Eigen::Vector3f(1.f, 1.f, 0.f);
+		}
+		transform = Eigen::Scaling(config.zoom, config.zoom, 1.f) * transform;
+		if (!sceneData.vertices.empty()) // generated or imported
+		{
+			if ((config.optimize && mxc::optimizeMesh(&sceneData, &jobSystem) != APP_SUCCESS) || (config.lods && mxc::buildLods(&sceneData, &jobSystem) != APP_SUCCESS)
+				|| (config.meshlets && mxc::buildMeshlets(&sceneData, &jobSystem) != APP_SUCCESS) || mxc::encodeVertices(&sceneData, config.vertexFormat, &jobSystem) != APP_SUCCESS)
+			{
+				return APP_GENERIC_ERR;
+			}
+			scene = sceneData.view();
+		}
+		mxc::VertexStream const& vertices = scene.vertices;
+		mxc::IndexStream const& indices = scene.indices;
+		std::span<mxc::DrawItem const> const drawItems = scene.drawItems;
+		mxc::Renderer<> renderer;
+		std::vector<char const*> instanceExtensions;
+#ifndef NDEBUG
+		instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+#endif
+		std::vector<char const*> deviceExtensions;
+		if (renderer.setFramesInFlight(config.framesInFlight) != APP_SUCCESS
+			|| renderer.init(instanceExtensions, deviceExtensions, /*window*/nullptr, config.width, config.height, vertices, indices, transform, &jobSystem) != APP_SUCCESS
+			|| renderer.progress_incomplete())
+		{
+			fprintf(stderr, "failed to initialize the renderer!\n");
+			return APP_INIT_FAILURE;
+		}
+		renderer.setDrawItems(drawItems);
+		if ((config.lods && renderer.setLods(scene.lodChains, scene.lods, config.lodErrorPixels) != APP_SUCCESS)
+			|| (config.meshlets && renderer.setMeshlets(scene.meshletRanges, scene.meshlets, scene.meshletBounds) != APP_SUCCESS))
+		{
+			return APP_INIT_FAILURE;
+		}
+
+		// a tree of SCENE_BENCH_FANOUT children per node, added breadth first, so that the first update restores the depth first order
+		constexpr uint32_t SCENE_BENCH_FANOUT = 8;
+		mxc::Scene sceneGraph;
+		if (config.sceneNodeCount > 0)
+		{
+			sceneGraph.reserve(config.sceneNodeCount);
+			sceneGraph.addNode(mxc::SCENE_NO_PARENT, transform);
+			for (uint32_t node = 1; node < config.sceneNodeCount; ++node)
+			{
+				sceneGraph.addNode((node - 1) / SCENE_BENCH_FANOUT, Eigen::Transform<float,3,Eigen::Affine>::Identity());
+			}
+			sceneGraph.updateWorld(&jobSystem);
+			renderer.setTransform(sceneGraph.world(0));
+		}
+
+		// frame n completes when the timeline reaches n. The watcher blocks on each submitted value in turn, and never on a value not
+		// submitted yet, so that it can't hang if a draw fails
+		uint64_t const totalFrames = config.warmupFrameCount + config.frameCount;
+		std::vector<uint64_t> submitNs(totalFrames + 1, 0);
+		std::vector<uint64_t> completeNs(totalFrames + 1, 0);
+		std::vector<double> cpuFrameMs;
+		cpuFrameMs.reserve(config.frameCount);
+		std::vector<double> sceneUpdateMs;
+		sceneUpdateMs.reserve(config.sceneNodeCount > 0 ? config.frameCount : 0);
+		constexpr uint64_t NO_MORE_FRAMES = UINT64_MAX;
+		std::atomic<uint64_t> submitted{0};
+		std::thread watcher([&renderer, &submitted, &completeNs, totalFrames]() {
+			for (uint64_t frame = 1; frame <= totalFrames; ++frame)
+			{
+				uint64_t lastSubmitted;
+				while ((lastSubmitted = submitted.load(std::memory_order_acquire)) < frame)
+				{
+					submitted.wait(lastSubmitted, std::memory_order_acquire);
+				}
+				if (lastSubmitted == NO_MORE_FRAMES || renderer.waitFrameTimeline(frame) != APP_SUCCESS)
+				{
+					return;
+				}
+				completeNs[frame] = nowNs();
+			}
+		});
+
+		mxc::status_t status = APP_SUCCESS;
+#ifdef MXC_NULL_DRIVER
+		mxc::nulldrv::Stats driverStatsBegin = mxc::nulldrv::stats();
+#endif // ifdef MXC_NULL_DRIVER
+		for (uint64_t i = 0; i < totalFrames; ++i)
+		{
+#ifdef MXC_NULL_DRIVER
+			if (i == config.warmupFrameCount)
+			{
+				driverStatsBegin = mxc::nulldrv::stats();
+			}
+#endif // ifdef MXC_NULL_DRIVER
+			if (config.rerecord)
+			{
+				renderer.markCommandBuffersDirty();
+			}
+			if (config.sceneNodeCount > 0)
+			{
+				// every node but the root spins, at a few different speeds
+				uint64_t const sceneBeginNs = nowNs();
+				float const angle = .01f * static_cast<float>(i);
+				for (uint32_t node = 1; node < config.sceneNodeCount; ++node)
+				{
+					sceneGraph.setLocal(node, Eigen::Translation3f(.01f, 0.f, 0.f) * Eigen::AngleAxisf(angle * static_cast<float>(node % 7 + 1), Eigen::Vector3f::UnitZ()));
+				}
+				sceneGraph.updateWorld(&jobSystem);
+				if (i >= config.warmupFrameCount)
+				{
+					sceneUpdateMs.push_back(static_cast<double>(nowNs() - sceneBeginNs) * 1e-6);
+				}
+			}
+			uint64_t const beginNs = nowNs();
+			status = renderer.draw();
+			uint64_t const endNs = nowNs();
+			if (status != APP_SUCCESS)
+			{
+				fprintf(stderr, "draw failed at frame %lu!\n", static_cast<unsigned long>(i));
+				break;
+			}
+			uint64_t const frame = renderer.submittedFrameCount();
+			submitNs[frame] = endNs;
+			submitted.store(frame, std::memory_order_release);
+			submitted.notify_one();
+			if (i >= config.warmupFrameCount)
+			{
+				cpuFrameMs.push_back(static_cast<double>(endNs - beginNs) * 1e-6);
+			}
+		}
+		if (status != APP_SUCCESS)
+		{
+			submitted.store(NO_MORE_FRAMES, std::memory_order_release); // wakes the watcher, which would otherwise wait forever
+			submitted.notify_one();
+			watcher.join();
+			return status;
+		}
+		watcher.join();
+#ifdef MXC_NULL_DRIVER
+		mxc::nulldrv::Stats const driverStatsEnd = mxc::nulldrv::stats();
+#endif // ifdef MXC_NULL_DRIVER
+
+		std::vector<double> latencyMs;
+		latencyMs.reserve(config.frameCount);
+		for (uint64_t frame = config.warmupFrameCount + 1; frame <= totalFrames; ++frame)
+		{
+			latencyMs.push_back(static_cast<double>(completeNs[frame] - std::min(completeNs[frame], submitNs[frame])) * 1e-6);
+		}
+
+		// -- report -------------------------------------------------------------------------------------------------------------------------
+		FILE* file = config.outPath ? fopen(config.outPath, "w") : stdout;
+		if (!file)
+		{
+			fprintf(stderr, "failed to open %s!\n", config.outPath);
+			return APP_GENERIC_ERR;
+		}
+		mxc::GpuProfiler::ScopeStats gpuStats{};
+		bool const hasGpuStats = renderer.gpuProfiler().scopeStats("render pass", &gpuStats);
+		uint64_t triangleCount = 0; // at full detail, the index buffer holds the LODs too
+		for (mxc::DrawItem const& drawItem : drawItems)
+		{
+			triangleCount += drawItem.indexCount / 3;
+		}
+		fprintf(file, "{\n");
+		fprintf(file, "\t\"config\": {\"width\": %u, \"height\": %u, \"objects\": %lu, \"triangles\": %lu, \"drawnTriangles\": %lu, \"vertexFormat\": \"%s\", "
+				"\"vertexBytes\": %lu, \"indexSize\": %u, \"optimize\": %s, \"lods\": %s, \"lodErrorPixels\": %.2f, \"meshlets\": %lu, \"zoom\": %.2f, \"sceneNodes\": %u, \"framesInFlight\": %u, \"frames\": %lu, "
+				"\"warmupFrames\": %lu, \"rerecord\": %s},\n",
+				config.width, config.height, static_cast<unsigned long>(drawItems.size()), static_cast<unsigned long>(triangleCount),
+				static_cast<unsigned long>(renderer.recordedIndexCount() / 3), mxc::vertexFormatName(vertices.format),
+				static_cast<unsigned long>(vertices.data.size()), indices.indexSize, config.optimize ? "true" : "false", config.lods ? "true" : "false",
+				static_cast<double>(config.lodErrorPixels), static_cast<unsigned long>(config.meshlets ? scene.meshlets.size() : 0), static_cast<double>(config.zoom),
+				config.sceneNodeCount, config.framesInFlight,
+				static_cast<unsigned long>(config.frameCount), static_cast<unsigned long>(config.warmupFrameCount), config.rerecord ? "true" : "false");
+#ifdef MXC_NULL_DRIVER
+		printNullDriverStats(file, driverStatsBegin, driverStatsEnd, config.frameCount);
+#endif // ifdef MXC_NULL_DRIVER
+		printPercentiles(file, "cpuFrameMs", percentiles(cpuFrameMs), /*last*/false);
+		if (config.sceneNodeCount > 0)
+		{
+			printPercentiles(file, "sceneUpdateMs", percentiles(sceneUpdateMs), /*last*/false);
+		}
+		printPercentiles(file, "submitToFenceMs", percentiles(latencyMs), /*last*/!hasGpuStats);
+		if (hasGpuStats) // timestamps not supported otherwise
+		{
+			fprintf(file, "\t\"gpuRenderPassMs\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"samples\": %u}\n",
+					static_cast<double>(gpuStats.p50Ms), static_cast<double>(gpuStats.p95Ms), static_cast<double>(gpuStats.p99Ms),
+					static_cast<double>(gpuStats.maxMs), gpuStats.sampleCount);
+		}
+		fprintf(file, "}\n");
+		if (config.outPath)
+		{
+			fclose(file);
+			printf("benchmark results written to %s\n", config.outPath);
+		}
+		return APP_SUCCESS;
+	}
+}
+
+auto main(int32_t argc, char* argv[]) -> int32_t
+{
+	BenchConfig config {
+		.width = 1280,
+		.height = 720,
+		.objectCount = 1024,
+		.meshPath = nullptr,
+		.vertexFormat = mxc::VERTEX_FORMAT_FLOAT32,
+		.optimize = false,
+		.lods = false,
+		.lodErrorPixels = 1.f,
+		.meshlets = false,
+		.zoom = 1.f,
+		.sceneNodeCount = 0,
+		.framesInFlight = MXC_RENDERER_DEFAULT_FRAMES_IN_FLIGHT,
+		.frameCount = 500,
+		.warmupFrameCount = 20,
+		.rerecord = false,
+		.icdPath = nullptr,
+		.outPath = nullptr
+	};
+	for (int32_t i = 1; i < argc; ++i)
+	{
+		bool const hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--width") == 0 && hasValue)
+		{
+			config.width = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--height") == 0 && hasValue)
+		{
+			config.height = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--objects") == 0 && hasValue)
+		{
+			config.objectCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--vertex-format") == 0 && hasValue && mxc::parseVertexFormat(argv[i + 1], &config.vertexFormat) == APP_SUCCESS)
+		{
+			++i;
+		}
+		else if (strcmp(argv[i], "--optimize") == 0)
+		{
+			config.optimize = true;
+		}
+		else if (strcmp(argv[i], "--lods") == 0)
+		{
+			config.lods = true;
+		}
+		else if (strcmp(argv[i], "--lod-error") == 0 && hasValue)
+		{
+			config.lodErrorPixels = strtof(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--meshlets") == 0)
+		{
+			config.meshlets = true;
+		}
+		else if (strcmp(argv[i], "--zoom") == 0 && hasValue)
+		{
+			config.zoom = strtof(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--scene-nodes") == 0 && hasValue)
+		{
+			config.sceneNodeCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--mesh") == 0 && hasValue)
+		{
+			config.meshPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && hasValue)
+		{
+			config.framesInFlight = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			config.frameCount = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+		{
+			config.warmupFrameCount = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--rerecord") == 0)
+		{
+			config.rerecord = true;
+		}
+		else if (strcmp(argv[i], "--icd") == 0 && hasValue)
+		{
+			config.icdPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--out") == 0 && hasValue)
+		{
+			config.outPath = argv[++i];
+		}
+		else
+		{
+			fprintf(stderr, "unknown argument %s\nusage: %s [--width W] [--height H] [--objects N] [--mesh PATH] [--vertex-format float32|half|snorm16] [--optimize] [--lods] [--lod-error PIXELS] [--meshlets] [--zoom F] [--scene-nodes N] [--frames-in-flight N] [--frames N] [--warmup N] "
+					"[--rerecord] [--icd ICD_JSON] [--out PATH]\n", argv[i], argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (config.width == 0 || config.height == 0 || config.objectCount == 0 || config.framesInFlight == 0 || config.frameCount == 0 || !(config.zoom > 0.f))
+	{
+		fprintf(stderr, "width, height, objects, frames in flight, frames and zoom must be positive!\n");
+		return EXIT_FAILURE;
+	}
+
+	return runBench(config) == APP_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,797 @@
+#pragma once
+
+#include "status.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+#include <vector>
+#include <algorithm> // min, max
+#include <memory> // allocator
+#include <bit> // countl_zero, countr_zero
+
+// Device memory sub-allocator. Instead of calling vkAllocateMemory once per resource (which quickly runs into
+// VkPhysicalDeviceLimits::maxMemoryAllocationCount and is slow on every driver), we allocate large VkDeviceMemory
+// blocks per memory type and place resources inside them with a TLSF (two level segregated fit) allocator, which
+// gives O(1) allocation and deallocation with bounded fragmentation.
+// - alignment: every placement honours VkMemoryRequirements::alignment
+// - bufferImageGranularity: when the device reports a granularity > 1, linear resources (buffers, linear images) and
+//   optimal tiling images never share a block, so two neighbouring resources of different kind can never alias a "page"
+// - host visible blocks are persistently mapped once at creation, and allocations carry their mapped pointer
+// NOTE: not thread safe, all calls are expected from the thread owning the renderer
+namespace mxc
+{
+	enum class ResourceKind : uint8_t
+	{
+		LINEAR = 0, // buffers and VK_IMAGE_TILING_LINEAR images
+		OPTIMAL = 1 // VK_IMAGE_TILING_OPTIMAL images
+	};
+
+	struct DeviceAllocation
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		void* mappedPtr = nullptr; // already offset by "offset". nullptr if memory is not host visible
+		uint32_t memoryTypeIndex = UINT32_MAX;
+		uint32_t blockIdx = UINT32_MAX;
+		uint32_t nodeIdx = UINT32_MAX;
+	};
+
+	struct DeviceAllocatorStats
+	{
+		uint64_t blockCount; // live VkDeviceMemory objects
+		uint64_t bytesReserved; // sum of the sizes of all live VkDeviceMemory objects
+		uint64_t bytesInUse; // sum of the sizes of all live sub-allocations
+		uint64_t peakBytesInUse;
+		uint64_t allocationCount; // live sub-allocations
+		uint64_t totalAllocations; // sub-allocations made since init
+		uint64_t totalFrees; // sub-allocations freed since init
+		uint64_t totalBlockAllocations; // vkAllocateMemory calls since init
+		uint64_t failedAllocations;
+		uint64_t bytesReservedPerType[VK_MAX_MEMORY_TYPES];
+		uint64_t bytesInUsePerType[VK_MAX_MEMORY_TYPES];
+	};
+
+	template <template<class> class AllocTemplate = std::allocator>
+	class DeviceAllocator
+	{
+	public: // type shortcuts
+		template <typename T>
+		using VectorCustom = std::vector<T, AllocTemplate<T>>;
+
+		static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull << 20; // 64 MiB
+
+	public: // constructors
+		DeviceAllocator() = default;
+		DeviceAllocator(DeviceAllocator const&) = delete;
+		auto operator=(DeviceAllocator const&) -> DeviceAllocator& = delete;
+		~DeviceAllocator() { assert(m_device == VK_NULL_HANDLE && "destroy() must be called before the VkDevice is destroyed"); }
+
+	public: // public functions
+		// allocationCallbacks, if not null, must outlive the allocator. The modules built on top of it use them too
+		auto init(VkPhysicalDevice phyDevice, VkDevice device, VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE,
+				  VkAllocationCallbacks const* allocationCallbacks = nullptr) & -> status_t;
+		auto destroy() & -> void;
+		auto allocationCallbacks() const & -> VkAllocationCallbacks const* { return m_allocationCallbacks; }
+
+		// picks a memory type from memoryRequirements.memoryTypeBits having all requiredProperties, favouring those having also preferredProperties
+		auto allocate(VkMemoryRequirements const& memoryRequirements, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties,
+					  ResourceKind kind, DeviceAllocation* outAllocation) & -> status_t;
+		// query requirements, allocate and bind in one go
+		auto allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, DeviceAllocation* outAllocation) & -> status_t;
+		auto allocateForImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, DeviceAllocation* outAllocation) & -> status_t;
+		auto free(DeviceAllocation& allocation) & -> void; // accepts empty allocations, resets the allocation
+
+		// needed only for memory types without VK_MEMORY_PROPERTY_HOST_COHERENT_BIT. offset is relative to the allocation
+		auto flush(DeviceAllocation const& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const & -> status_t;
+		auto invalidate(DeviceAllocation const& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const & -> status_t;
+		auto isHostCoherent(DeviceAllocation const& allocation) const & -> bool;
+
+		auto stats() const & -> DeviceAllocatorStats const& { return m_stats; }
+		auto printStats() const & -> void;
+		auto memoryProperties() const & -> VkPhysicalDeviceMemoryProperties const& { return m_memoryProperties; }
+		auto findMemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties) const & -> uint32_t;
+
+	private: // TLSF parameters
+		// first level: power of two ranges. second level: each power of two range is split linearly in SL_COUNT lists
+		static constexpr uint32_t SL_LOG2 = 4;
+		static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+		static constexpr uint32_t FL_COUNT = 64;
+		static constexpr VkDeviceSize SMALL_SIZE = SL_COUNT; // sizes below this are mapped linearly to the first level 0
+		static constexpr VkDeviceSize MIN_SPLIT_SIZE = 256; // don't leave free fragments smaller than this behind
+		static constexpr uint32_t INVALID_IDX = UINT32_MAX;
+
+		struct Node
+		{
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			uint32_t prevPhys; // neighbours in address order within the block
+			uint32_t nextPhys;
+			uint32_t prevFree; // neighbours in the segregated free list
+			uint32_t nextFree;
+			bool free;
+		};
+
+		struct Block
+		{
+			VkDeviceMemory memory;
+			VkDeviceSize size;
+			void* mappedPtr;
+			uint32_t memoryTypeIndex;
+			ResourceKind kind;
+			uint32_t allocationCount;
+			uint64_t flBitmap;
+			uint32_t slBitmaps[FL_COUNT];
+			uint32_t freeHeads[FL_COUNT][SL_COUNT];
+		};
+
+	private: // functions, TLSF
+		static auto mapping(VkDeviceSize size, uint32_t* fl, uint32_t* sl) -> void;
+		static auto mappingSearch(VkDeviceSize size, uint32_t* fl, uint32_t* sl) -> void;
+		auto insertFree(Block& block, uint32_t nodeIdx) & -> void;
+		auto removeFree(Block& block, uint32_t nodeIdx) & -> void;
+		auto findFree(Block& block, VkDeviceSize size) & -> uint32_t;
+		auto newNode() & -> uint32_t;
+		auto releaseNode(uint32_t nodeIdx) & -> void;
+		auto allocateFromBlock(uint32_t blockIdx, VkDeviceSize size, VkDeviceSize alignment, DeviceAllocation* outAllocation) & -> bool;
+		auto createBlock(uint32_t memoryTypeIndex, ResourceKind kind, VkDeviceSize minSize) & -> uint32_t;
+		auto destroyBlock(uint32_t blockIdx) & -> void;
+		auto preferredBlockSize(uint32_t memoryTypeIndex) const & -> VkDeviceSize;
+
+	private: // data
+		VkPhysicalDevice m_phyDevice = VK_NULL_HANDLE;
+		VkDevice m_device = VK_NULL_HANDLE;
+		VkAllocationCallbacks const* m_allocationCallbacks = nullptr;
+		VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+		VkDeviceSize m_bufferImageGranularity = 1;
+		VkDeviceSize m_nonCoherentAtomSize = 1;
+		uint32_t m_maxMemoryAllocationCount = UINT32_MAX;
+		VkDeviceSize m_preferredBlockSize = DEFAULT_BLOCK_SIZE;
+
+		VectorCustom<Block> m_blocks; // destroyed blocks leave a hole with memory == VK_NULL_HANDLE, to keep indices stable
+		VectorCustom<uint32_t> m_freeBlockSlots;
+		VectorCustom<Node> m_nodes;
+		uint32_t m_freeNodeHead = INVALID_IDX; // nodes not in use are chained through nextFree
+		DeviceAllocatorStats m_stats{};
+	};
+
+	// -- TLSF mapping functions -------------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::mapping(VkDeviceSize size, uint32_t* fl, uint32_t* sl) -> void
+	{
+		if (size < SMALL_SIZE)
+		{
+			*fl = 0;
+			*sl = static_cast<uint32_t>(size);
+			return;
+		}
+		uint32_t const msb = 63u - static_cast<uint32_t>(std::countl_zero(size));
+		*fl = msb;
+		*sl = static_cast<uint32_t>(size >> (msb - SL_LOG2)) ^ SL_COUNT; // remove the leading one
+	}
+
+	// rounds size up to the next list boundary, so that any block in the list found is big enough
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::mappingSearch(VkDeviceSize size, uint32_t* fl, uint32_t* sl) -> void
+	{
+		if (size >= SMALL_SIZE)
+		{
+			uint32_t const msb = 63u - static_cast<uint32_t>(std::countl_zero(size));
+			size += (VkDeviceSize{1} << (msb - SL_LOG2)) - 1;
+		}
+		mapping(size, fl, sl);
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::insertFree(Block& block, uint32_t nodeIdx) & -> void
+	{
+		Node& node = m_nodes[nodeIdx];
+		uint32_t fl, sl;
+		mapping(node.size, &fl, &sl);
+		node.free = true;
+		node.prevFree = INVALID_IDX;
+		node.nextFree = block.freeHeads[fl][sl];
+		if (node.nextFree != INVALID_IDX)
+		{
+			m_nodes[node.nextFree].prevFree = nodeIdx;
+		}
+		block.freeHeads[fl][sl] = nodeIdx;
+		block.flBitmap |= uint64_t{1} << fl;
+		block.slBitmaps[fl] |= 1u << sl;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::removeFree(Block& block, uint32_t nodeIdx) & -> void
+	{
+		Node& node = m_nodes[nodeIdx];
+		uint32_t fl, sl;
+		mapping(node.size, &fl, &sl);
+		if (node.prevFree != INVALID_IDX)
+		{
+			m_nodes[node.prevFree].nextFree = node.nextFree;
+		}
+		else
+		{
+			block.freeHeads[fl][sl] = node.nextFree;
+		}
+		if (node.nextFree != INVALID_IDX)
+		{
+			m_nodes[node.nextFree].prevFree = node.prevFree;
+		}
+		if (block.freeHeads[fl][sl] == INVALID_IDX)
+		{
+			block.slBitmaps[fl] &= ~(1u << sl);
+			if (block.slBitmaps[fl] == 0)
+			{
+				block.flBitmap &= ~(uint64_t{1} << fl);
+			}
+		}
+		node.free = false;
+		node.prevFree = node.nextFree = INVALID_IDX;
+	}
+
+	// returns a free node with size >= size, or INVALID_IDX
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::findFree(Block& block, VkDeviceSize size) & -> uint32_t
+	{
+		uint32_t fl, sl;
+		mappingSearch(size, &fl, &sl);
+		if (fl >= FL_COUNT)
+		{
+			return INVALID_IDX;
+		}
+
+		// first look in the same first level range, for second level lists at least as big
+		uint32_t slMap = block.slBitmaps[fl] & (~0u << sl);
+		if (slMap == 0)
+		{
+			// then take the smallest non empty first level range bigger than the requested one
+			uint64_t const flMap = fl + 1 < FL_COUNT ? block.flBitmap & (~uint64_t{0} << (fl + 1)) : 0;
+			if (flMap == 0)
+			{
+				// good fit failed. Last resort, walk the list the size itself maps to, as it may still hold a big enough node
+				// (eg. the single node of a dedicated block, which is exactly as big as the request)
+				mapping(size, &fl, &sl);
+				for (uint32_t nodeIdx = block.freeHeads[fl][sl]; nodeIdx != INVALID_IDX; nodeIdx = m_nodes[nodeIdx].nextFree)
+				{
+					if (m_nodes[nodeIdx].size >= size)
+					{
+						return nodeIdx;
+					}
+				}
+				return INVALID_IDX;
+			}
+			fl = static_cast<uint32_t>(std::countr_zero(flMap));
+			slMap = block.slBitmaps[fl];
+		}
+		sl = static_cast<uint32_t>(std::countr_zero(slMap));
+		return block.freeHeads[fl][sl];
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::newNode() & -> uint32_t
+	{
+		if (m_freeNodeHead != INVALID_IDX)
+		{
+			uint32_t const nodeIdx = m_freeNodeHead;
+			m_freeNodeHead = m_nodes[nodeIdx].nextFree;
+			return nodeIdx;
+		}
+		m_nodes.push_back(Node{});
+		return static_cast<uint32_t>(m_nodes.size() - 1);
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::releaseNode(uint32_t nodeIdx) & -> void
+	{
+		m_nodes[nodeIdx] = Node{.offset = 0, .size = 0, .prevPhys = INVALID_IDX, .nextPhys = INVALID_IDX, .prevFree = INVALID_IDX, .nextFree = m_freeNodeHead, .free = false};
+		m_freeNodeHead = nodeIdx;
+	}
+
+	// -- initialization and destruction --------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::init(VkPhysicalDevice phyDevice, VkDevice device, VkDeviceSize preferredBlockSize,
+											  VkAllocationCallbacks const* allocationCallbacks) & -> status_t
+	{
+		assert(m_device == VK_NULL_HANDLE && "device allocator initialized twice");
+		m_phyDevice = phyDevice;
+		m_device = device;
+		m_allocationCallbacks = allocationCallbacks;
+		m_preferredBlockSize = preferredBlockSize;
+
+		// done once here, instead of at each allocation
+		vkGetPhysicalDeviceMemoryProperties(m_phyDevice, &m_memoryProperties);
+		VkPhysicalDeviceProperties phyDeviceProperties;
+		vkGetPhysicalDeviceProperties(m_phyDevice, &phyDeviceProperties);
+		m_bufferImageGranularity = phyDeviceProperties.limits.bufferImageGranularity;
+		m_nonCoherentAtomSize = phyDeviceProperties.limits.nonCoherentAtomSize;
+		m_maxMemoryAllocationCount = phyDeviceProperties.limits.maxMemoryAllocationCount;
+
+		m_stats = DeviceAllocatorStats{};
+		printf("device allocator initialized, bufferImageGranularity = %lu, maxMemoryAllocationCount = %u\n",
+			   static_cast<unsigned long>(m_bufferImageGranularity), m_maxMemoryAllocationCount);
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::destroy() & -> void
+	{
+		if (m_device == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		for (uint32_t i = 0; i < m_blocks.size(); ++i)
+		{
+			if (m_blocks[i].memory != VK_NULL_HANDLE)
+			{
+				if (m_blocks[i].allocationCount != 0)
+				{
+					fprintf(stderr, "device allocator: block %u still has %u live allocations at destruction!\n", i, m_blocks[i].allocationCount);
+				}
+				destroyBlock(i);
+			}
+		}
+		m_blocks.clear();
+		m_freeBlockSlots.clear();
+		m_nodes.clear();
+		m_freeNodeHead = INVALID_IDX;
+		m_device = VK_NULL_HANDLE;
+		m_phyDevice = VK_NULL_HANDLE;
+	}
+
+	// -- memory types and blocks ----------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::findMemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties) const & -> uint32_t
+	{
+		// VkMemoryRequirements::memoryTypeBits is a bitfield whose bits are set to one if the corresponding memory type index can be used by the resource.
+		// among the usable types having all the required properties pick the one matching the most preferred properties
+		uint32_t bestIdx = UINT32_MAX;
+		int32_t bestScore = -1;
+		for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+		{
+			VkMemoryPropertyFlags const flags = m_memoryProperties.memoryTypes[i].propertyFlags;
+			if ((memoryTypeBits & (1u << i)) && (flags & requiredProperties) == requiredProperties)
+			{
+				int32_t const score = std::popcount(flags & preferredProperties);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestIdx = i;
+				}
+			}
+		}
+		return bestIdx;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::preferredBlockSize(uint32_t memoryTypeIndex) const & -> VkDeviceSize
+	{
+		// small heaps (eg. the 256 MiB host visible device local heap) get smaller blocks, so that we don't take all of it in one go
+		VkDeviceSize const heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+		return heapSize <= (VkDeviceSize{1} << 30) ? std::min(m_preferredBlockSize, heapSize / 8) : m_preferredBlockSize;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::createBlock(uint32_t memoryTypeIndex, ResourceKind kind, VkDeviceSize minSize) & -> uint32_t
+	{
+		if (m_stats.blockCount >= m_maxMemoryAllocationCount)
+		{
+			fprintf(stderr, "device allocator: reached maxMemoryAllocationCount (%u)!\n", m_maxMemoryAllocationCount);
+			return INVALID_IDX;
+		}
+
+		// big resources get a block of their own (its TLSF will hold exactly one node), the others share a standard block.
+		// if the driver refuses the standard size, halve it until it is not worth it anymore
+		VkDeviceSize blockSize = preferredBlockSize(memoryTypeIndex);
+		if (minSize > blockSize / 2)
+		{
+			blockSize = minSize;
+		}
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkResult res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		for (;;)
+		{
+			VkMemoryAllocateInfo const allocateInfo {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+				.pNext = nullptr,
+				.allocationSize = blockSize,
+				.memoryTypeIndex = memoryTypeIndex
+			};
+			res = vkAllocateMemory(m_device, &allocateInfo, m_allocationCallbacks, &memory);
+			if (res == VK_SUCCESS || blockSize == minSize)
+			{
+				break;
+			}
+			blockSize = std::max(blockSize / 2, minSize); // the last try is exactly minSize
+		}
+		if (res != VK_SUCCESS)
+		{
+			return INVALID_IDX;
+		}
+
+		// host visible memory is mapped once for the whole lifetime of the block
+		void* mappedPtr = nullptr;
+		if (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			res = vkMapMemory(m_device, memory, /*offset*/0, VK_WHOLE_SIZE, /*flags*/0, &mappedPtr);
+			if (res != VK_SUCCESS)
+			{
+				fprintf(stderr, "device allocator: failed to map block memory!\n");
+				vkFreeMemory(m_device, memory, m_allocationCallbacks);
+				return INVALID_IDX;
+			}
+		}
+
+		uint32_t blockIdx;
+		if (!m_freeBlockSlots.empty())
+		{
+			blockIdx = m_freeBlockSlots.back();
+			m_freeBlockSlots.pop_back();
+		}
+		else
+		{
+			m_blocks.emplace_back();
+			blockIdx = static_cast<uint32_t>(m_blocks.size() - 1);
+		}
+
+		Block& block = m_blocks[blockIdx];
+		block.memory = memory;
+		block.size = blockSize;
+		block.mappedPtr = mappedPtr;
+		block.memoryTypeIndex = memoryTypeIndex;
+		block.kind = kind;
+		block.allocationCount = 0;
+		block.flBitmap = 0;
+		for (uint32_t fl = 0; fl < FL_COUNT; ++fl)
+		{
+			block.slBitmaps[fl] = 0;
+			for (uint32_t sl = 0; sl < SL_COUNT; ++sl)
+			{
+				block.freeHeads[fl][sl] = INVALID_IDX;
+			}
+		}
+
+		// the whole block starts as a single free node
+		uint32_t const nodeIdx = newNode();
+		m_nodes[nodeIdx] = Node{.offset = 0, .size = blockSize, .prevPhys = INVALID_IDX, .nextPhys = INVALID_IDX, .prevFree = INVALID_IDX, .nextFree = INVALID_IDX, .free = true};
+		insertFree(m_blocks[blockIdx], nodeIdx);
+
+		++m_stats.blockCount;
+		++m_stats.totalBlockAllocations;
+		m_stats.bytesReserved += blockSize;
+		m_stats.bytesReservedPerType[memoryTypeIndex] += blockSize;
+		return blockIdx;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::destroyBlock(uint32_t blockIdx) & -> void
+	{
+		Block& block = m_blocks[blockIdx];
+
+		// give back all the nodes of the block, walking the physical list from the first node
+		uint32_t nodeIdx = INVALID_IDX;
+		for (uint32_t fl = 0; fl < FL_COUNT && nodeIdx == INVALID_IDX; ++fl)
+		{
+			for (uint32_t sl = 0; sl < SL_COUNT && nodeIdx == INVALID_IDX; ++sl)
+			{
+				nodeIdx = block.freeHeads[fl][sl];
+			}
+		}
+		if (nodeIdx != INVALID_IDX) // a block being destroyed with live allocations can be fully used, so it's not an error not to find one
+		{
+			while (m_nodes[nodeIdx].prevPhys != INVALID_IDX)
+			{
+				nodeIdx = m_nodes[nodeIdx].prevPhys;
+			}
+			while (nodeIdx != INVALID_IDX)
+			{
+				uint32_t const next = m_nodes[nodeIdx].nextPhys;
+				releaseNode(nodeIdx);
+				nodeIdx = next;
+			}
+		}
+
+		if (block.mappedPtr)
+		{
+			vkUnmapMemory(m_device, block.memory);
+		}
+		vkFreeMemory(m_device, block.memory, m_allocationCallbacks);
+
+		--m_stats.blockCount;
+		m_stats.bytesReserved -= block.size;
+		m_stats.bytesReservedPerType[block.memoryTypeIndex] -= block.size;
+		block.memory = VK_NULL_HANDLE;
+		block.mappedPtr = nullptr;
+		block.size = 0;
+		m_freeBlockSlots.push_back(blockIdx);
+	}
+
+	// -- allocation -------------------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::allocateFromBlock(uint32_t blockIdx, VkDeviceSize size, VkDeviceSize alignment, DeviceAllocation* outAllocation) & -> bool
+	{
+		Block& block = m_blocks[blockIdx];
+
+		// ask for enough space to align the start of the free node found. Alignments are powers of 2
+		uint32_t const nodeIdx = findFree(block, size + alignment - 1);
+		if (nodeIdx == INVALID_IDX)
+		{
+			return false;
+		}
+		removeFree(block, nodeIdx);
+
+		// split away the leading padding needed for alignment. Its previous physical neighbour is not free, otherwise they would have been merged
+		VkDeviceSize const alignedOffset = (m_nodes[nodeIdx].offset + alignment - 1) & ~(alignment - 1);
+		VkDeviceSize const padding = alignedOffset - m_nodes[nodeIdx].offset;
+		if (padding != 0)
+		{
+			uint32_t const padIdx = newNode(); // can reallocate m_nodes, no references held across this
+			m_nodes[padIdx] = Node{.offset = m_nodes[nodeIdx].offset, .size = padding, .prevPhys = m_nodes[nodeIdx].prevPhys, .nextPhys = nodeIdx, .prevFree = INVALID_IDX, .nextFree = INVALID_IDX, .free = true};
+			if (m_nodes[padIdx].prevPhys != INVALID_IDX)
+			{
+				m_nodes[m_nodes[padIdx].prevPhys].nextPhys = padIdx;
+			}
+			m_nodes[nodeIdx].prevPhys = padIdx;
+			m_nodes[nodeIdx].offset = alignedOffset;
+			m_nodes[nodeIdx].size -= padding;
+			insertFree(block, padIdx);
+		}
+
+		// split away the trailing space, if it is worth it
+		if (m_nodes[nodeIdx].size - size >= MIN_SPLIT_SIZE)
+		{
+			uint32_t const tailIdx = newNode();
+			m_nodes[tailIdx] = Node{.offset = alignedOffset + size, .size = m_nodes[nodeIdx].size - size, .prevPhys = nodeIdx, .nextPhys = m_nodes[nodeIdx].nextPhys, .prevFree = INVALID_IDX, .nextFree = INVALID_IDX, .free = true};
+			if (m_nodes[tailIdx].nextPhys != INVALID_IDX)
+			{
+				m_nodes[m_nodes[tailIdx].nextPhys].prevPhys = tailIdx;
+			}
+			m_nodes[nodeIdx].nextPhys = tailIdx;
+			m_nodes[nodeIdx].size = size;
+			insertFree(block, tailIdx);
+		}
+
+		++block.allocationCount;
+		*outAllocation = DeviceAllocation{
+			.memory = block.memory,
+			.offset = alignedOffset,
+			.size = m_nodes[nodeIdx].size,
+			.mappedPtr = block.mappedPtr ? static_cast<unsigned char*>(block.mappedPtr) + alignedOffset : nullptr,
+			.memoryTypeIndex = block.memoryTypeIndex,
+			.blockIdx = blockIdx,
+			.nodeIdx = nodeIdx
+		};
+		return true;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::allocate(VkMemoryRequirements const& memoryRequirements, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties,
+												  ResourceKind kind, DeviceAllocation* outAllocation) & -> status_t
+	{
+		assert(m_device != VK_NULL_HANDLE && "device allocator not initialized");
+		assert(outAllocation);
+
+		// with a granularity of 1 linear and optimal resources can freely be neighbours, otherwise they live in different blocks
+		bool const separateKinds = m_bufferImageGranularity > 1;
+		VkDeviceSize const alignment = std::max<VkDeviceSize>(memoryRequirements.alignment, 1);
+
+		// try every compatible memory type, best match first
+		uint32_t memoryTypeBits = memoryRequirements.memoryTypeBits;
+		for (uint32_t memoryTypeIndex = findMemoryTypeIndex(memoryTypeBits, requiredProperties, preferredProperties);
+			 memoryTypeIndex != UINT32_MAX;
+			 memoryTypeIndex = findMemoryTypeIndex(memoryTypeBits, requiredProperties, preferredProperties))
+		{
+			// first fit among the existing blocks
+			bool found = false;
+			for (uint32_t i = 0; i < m_blocks.size() && !found; ++i)
+			{
+				if (m_blocks[i].memory != VK_NULL_HANDLE && m_blocks[i].memoryTypeIndex == memoryTypeIndex && (!separateKinds || m_blocks[i].kind == kind))
+				{
+					found = allocateFromBlock(i, memoryRequirements.size, alignment, outAllocation);
+				}
+			}
+
+			// then grow
+			if (!found)
+			{
+				uint32_t const blockIdx = createBlock(memoryTypeIndex, kind, memoryRequirements.size + alignment - 1);
+				found = blockIdx != INVALID_IDX && allocateFromBlock(blockIdx, memoryRequirements.size, alignment, outAllocation);
+			}
+
+			if (found)
+			{
+				++m_stats.allocationCount;
+				++m_stats.totalAllocations;
+				m_stats.bytesInUse += outAllocation->size;
+				m_stats.bytesInUsePerType[memoryTypeIndex] += outAllocation->size;
+				m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+				return APP_SUCCESS;
+			}
+			memoryTypeBits &= ~(1u << memoryTypeIndex);
+		}
+
+		++m_stats.failedAllocations;
+		fprintf(stderr, "device allocator: couldn't allocate %lu bytes with alignment %lu!\n",
+				static_cast<unsigned long>(memoryRequirements.size), static_cast<unsigned long>(alignment));
+		return APP_VK_ALLOCATION_ERR;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, DeviceAllocation* outAllocation) & -> status_t
+	{
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(m_device, buffer, &memoryRequirements);
+		if (allocate(memoryRequirements, requiredProperties, preferredProperties, ResourceKind::LINEAR, outAllocation) != APP_SUCCESS)
+		{
+			return APP_VK_ALLOCATION_ERR;
+		}
+		if (vkBindBufferMemory(m_device, buffer, outAllocation->memory, outAllocation->offset) != VK_SUCCESS)
+		{
+			free(*outAllocation);
+			return APP_GENERIC_ERR;
+		}
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::allocateForImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, DeviceAllocation* outAllocation) & -> status_t
+	{
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(m_device, image, &memoryRequirements);
+		ResourceKind const kind = tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::OPTIMAL : ResourceKind::LINEAR;
+		if (allocate(memoryRequirements, requiredProperties, preferredProperties, kind, outAllocation) != APP_SUCCESS)
+		{
+			return APP_VK_ALLOCATION_ERR;
+		}
+		if (vkBindImageMemory(m_device, image, outAllocation->memory, outAllocation->offset) != VK_SUCCESS)
+		{
+			free(*outAllocation);
+			return APP_GENERIC_ERR;
+		}
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::free(DeviceAllocation& allocation) & -> void
+	{
+		if (allocation.memory == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		uint32_t const blockIdx = allocation.blockIdx;
+		uint32_t nodeIdx = allocation.nodeIdx;
+		assert(blockIdx < m_blocks.size() && m_blocks[blockIdx].memory == allocation.memory && !m_nodes[nodeIdx].free && "invalid or double free");
+
+		m_stats.bytesInUse -= allocation.size;
+		m_stats.bytesInUsePerType[allocation.memoryTypeIndex] -= allocation.size;
+		--m_stats.allocationCount;
+		++m_stats.totalFrees;
+		allocation = DeviceAllocation{};
+
+		// coalesce with free physical neighbours
+		Block& block = m_blocks[blockIdx];
+		uint32_t const prevIdx = m_nodes[nodeIdx].prevPhys;
+		if (prevIdx != INVALID_IDX && m_nodes[prevIdx].free)
+		{
+			removeFree(block, prevIdx);
+			m_nodes[prevIdx].size += m_nodes[nodeIdx].size;
+			m_nodes[prevIdx].nextPhys = m_nodes[nodeIdx].nextPhys;
+			if (m_nodes[prevIdx].nextPhys != INVALID_IDX)
+			{
+				m_nodes[m_nodes[prevIdx].nextPhys].prevPhys = prevIdx;
+			}
+			releaseNode(nodeIdx);
+			nodeIdx = prevIdx;
+		}
+		uint32_t const nextIdx = m_nodes[nodeIdx].nextPhys;
+		if (nextIdx != INVALID_IDX && m_nodes[nextIdx].free)
+		{
+			removeFree(block, nextIdx);
+			m_nodes[nodeIdx].size += m_nodes[nextIdx].size;
+			m_nodes[nodeIdx].nextPhys = m_nodes[nextIdx].nextPhys;
+			if (m_nodes[nodeIdx].nextPhys != INVALID_IDX)
+			{
+				m_nodes[m_nodes[nodeIdx].nextPhys].prevPhys = nodeIdx;
+			}
+			releaseNode(nextIdx);
+		}
+		insertFree(block, nodeIdx);
+
+		// keep at most one empty block per memory type around, to avoid vkAllocateMemory/vkFreeMemory ping-pong. Dedicated blocks go right away
+		if (--block.allocationCount == 0)
+		{
+			if (block.size > preferredBlockSize(block.memoryTypeIndex))
+			{
+				destroyBlock(blockIdx);
+				return;
+			}
+			for (uint32_t i = 0; i < m_blocks.size(); ++i)
+			{
+				if (i != blockIdx && m_blocks[i].memory != VK_NULL_HANDLE && m_blocks[i].allocationCount == 0
+					&& m_blocks[i].memoryTypeIndex == m_blocks[blockIdx].memoryTypeIndex)
+				{
+					destroyBlock(blockIdx);
+					break;
+				}
+			}
+		}
+	}
+
+	// -- host access --------------------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::isHostCoherent(DeviceAllocation const& allocation) const & -> bool
+	{
+		return m_memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::flush(DeviceAllocation const& allocation, VkDeviceSize offset, VkDeviceSize size) const & -> status_t
+	{
+		if (allocation.memory == VK_NULL_HANDLE || isHostCoherent(allocation))
+		{
+			return APP_SUCCESS;
+		}
+
+		// ranges must be multiples of nonCoherentAtomSize, or reach the end of the memory object. Since blocks are sized in powers of two, or
+		// are dedicated to one allocation, rounding up within the block is always safe
+		VkDeviceSize const blockSize = m_blocks[allocation.blockIdx].size;
+		VkDeviceSize const begin = (allocation.offset + offset) & ~(m_nonCoherentAtomSize - 1);
+		VkDeviceSize const end = size == VK_WHOLE_SIZE ? allocation.offset + allocation.size : allocation.offset + offset + size;
+		VkDeviceSize const alignedEnd = std::min((end + m_nonCoherentAtomSize - 1) & ~(m_nonCoherentAtomSize - 1), blockSize);
+		VkMappedMemoryRange const memoryRange {
+			.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+			.pNext = nullptr,
+			.memory = allocation.memory,
+			.offset = begin,
+			.size = alignedEnd == blockSize ? VK_WHOLE_SIZE : alignedEnd - begin
+		};
+		return vkFlushMappedMemoryRanges(m_device, /*memoryRangeCount*/1, &memoryRange) == VK_SUCCESS ? APP_SUCCESS : APP_GENERIC_ERR;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::invalidate(DeviceAllocation const& allocation, VkDeviceSize offset, VkDeviceSize size) const & -> status_t
+	{
+		if (allocation.memory == VK_NULL_HANDLE || isHostCoherent(allocation))
+		{
+			return APP_SUCCESS;
+		}
+
+		VkDeviceSize const blockSize = m_blocks[allocation.blockIdx].size;
+		VkDeviceSize const begin = (allocation.offset + offset) & ~(m_nonCoherentAtomSize - 1);
+		VkDeviceSize const end = size == VK_WHOLE_SIZE ? allocation.offset + allocation.size : allocation.offset + offset + size;
+		VkDeviceSize const alignedEnd = std::min((end + m_nonCoherentAtomSize - 1) & ~(m_nonCoherentAtomSize - 1), blockSize);
+		VkMappedMemoryRange const memoryRange {
+			.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+			.pNext = nullptr,
+			.memory = allocation.memory,
+			.offset = begin,
+			.size = alignedEnd == blockSize ? VK_WHOLE_SIZE : alignedEnd - begin
+		};
+		return vkInvalidateMappedMemoryRanges(m_device, /*memoryRangeCount*/1, &memoryRange) == VK_SUCCESS ? APP_SUCCESS : APP_GENERIC_ERR;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto DeviceAllocator<AllocTemplate>::printStats() const & -> void
+	{
+		printf("device allocator stats:\n"
+			   "\tblocks: %lu (%lu vkAllocateMemory calls), reserved %lu bytes\n"
+			   "\tallocations: %lu live, %lu total, %lu frees, %lu failed\n"
+			   "\tin use: %lu bytes, peak %lu bytes\n",
+			   static_cast<unsigned long>(m_stats.blockCount), static_cast<unsigned long>(m_stats.totalBlockAllocations), static_cast<unsigned long>(m_stats.bytesReserved),
+			   static_cast<unsigned long>(m_stats.allocationCount), static_cast<unsigned long>(m_stats.totalAllocations), static_cast<unsigned long>(m_stats.totalFrees), static_cast<unsigned long>(m_stats.failedAllocations),
+			   static_cast<unsigned long>(m_stats.bytesInUse), static_cast<unsigned long>(m_stats.peakBytesInUse));
+		for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+		{
+			if (m_stats.bytesReservedPerType[i] != 0)
+			{
+				printf("\tmemory type %u: %lu/%lu bytes in use\n", i, static_cast<unsigned long>(m_stats.bytesInUsePerType[i]), static_cast<unsigned long>(m_stats.bytesReservedPerType[i]));
+			}
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#include "frame_readback.h"
+
+#include <cstdio>
+
+namespace mxc
+{
+	// -- sinks --------------------------------------------------------------------------------------------------------------------------------------
+	auto readbackPpmSink(ReadbackFrame const& frame, void* userData) -> void
+	{
+		char path[512];
+		snprintf(path, sizeof(path), "%s%06lu.ppm", static_cast<char const*>(userData), static_cast<unsigned long>(frame.frameNumber));
+		FILE* file = fopen(path, "wb");
+		if (!file)
+		{
+			fprintf(stderr, "failed to open %s for writing!\n", path);
+			return;
+		}
+
+		// P6 wants RGB triplets, so each row is converted in a small buffer, dropping alpha and swapping channels for BGRA formats
+		bool const bgra = frame.format == VK_FORMAT_B8G8R8A8_UNORM || frame.format == VK_FORMAT_B8G8R8A8_SRGB;
+		uint32_t const r = bgra ? 2 : 0;
+		uint32_t const b = bgra ? 0 : 2;
+		fprintf(file, "P6\n%u %u\n255\n", frame.width, frame.height);
+		uint8_t row[3 * 4096];
+		for (uint32_t y = 0; y < frame.height; ++y)
+		{
+			uint8_t const* src = frame.pixels.data() + size_t{y} * frame.rowPitch;
+			for (uint32_t x0 = 0; x0 < frame.width; x0 += 4096)
+			{
+				uint32_t const count = std::min(frame.width - x0, 4096u);
+				for (uint32_t x = 0; x < count; ++x)
+				{
+					uint8_t const* pixel = src + size_t{x0 + x} * 4;
+					row[3 * x + 0] = pixel[r];
+					row[3 * x + 1] = pixel[1];
+					row[3 * x + 2] = pixel[b];
+				}
+				fwrite(row, 3, count, file);
+			}
+		}
+		fclose(file);
+	}
+
+	auto readbackRawSink(ReadbackFrame const& frame, void* userData) -> void
+	{
+		char path[512];
+		snprintf(path, sizeof(path), "%s%06lu.raw", static_cast<char const*>(userData), static_cast<unsigned long>(frame.frameNumber));
+		FILE* file = fopen(path, "wb");
+		if (!file)
+		{
+			fprintf(stderr, "failed to open %s for writing!\n", path);
+			return;
+		}
+		fwrite(frame.pixels.data(), 1, size_t{frame.rowPitch} * frame.height, file); // zero copy, straight from the mapped buffer
+		fclose(file);
+	}
+}
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "status.h"
+#include "device_allocator.h"
+#include "job_system.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+#include <atomic>
+#include <algorithm> // min
+#include <span>
+
+// Pipelined readback of rendered frames. Each frame which wants to be captured gets a slot of a ring of host visible buffers, and a
+// command buffer copying the color attachment into it, submitted together with the frame command buffer. Slots are retired some frames
+// later, when the frame timeline says the GPU is done with them (checked without blocking), and handed to the consumer on a job system
+// worker, as a span pointing straight into the mapped buffer. A slot is reused only once the consumer returned.
+// The render loop never waits: when every slot is either in flight or being consumed the frame is simply not captured (and counted as dropped).
+// Consumers run concurrently, so frames may be delivered out of order, ReadbackFrame::frameNumber tells which one it is.
+// NOTE: not thread safe, apart from the consumer callbacks
+namespace mxc
+{
+	struct ReadbackFrame
+	{
+		uint64_t frameNumber; // value of the frame timeline signaled by the frame
+		uint32_t width;
+		uint32_t height;
+		VkFormat format; // 4 bytes per pixel, R8G8B8A8 or B8G8R8A8
+		uint32_t rowPitch; // in bytes
+		std::span<uint8_t const> pixels; // valid only during the callback
+	};
+	using ReadbackCallback = void (*)(ReadbackFrame const& frame, void* userData);
+
+	// ready made consumers, userData is a char const* path prefix, files are named <prefix><frameNumber>.ppm/.raw
+	auto readbackPpmSink(ReadbackFrame const& frame, void* userData) -> void; // binary P6, alpha dropped
+	auto readbackRawSink(ReadbackFrame const& frame, void* userData) -> void; // pixels as they are, rowPitch * height bytes
+
+	template <template<class> class AllocTemplate>
+	class FrameReadback
+	{
+	public: // constants
+		static constexpr uint32_t MAX_SLOTS = 8;
+
+	public: // constructors
+		FrameReadback() = default;
+		FrameReadback(FrameReadback const&) = delete;
+		auto operator=(FrameReadback const&) -> FrameReadback& = delete;
+		~FrameReadback() { assert(m_cmdPool == VK_NULL_HANDLE && "destroy() must be called before the VkDevice is destroyed"); }
+
+	public: // public functions
+		// jobSystem can be null, in which case consumers run on the thread calling poll
+		auto init(VkDevice device, DeviceAllocator<AllocTemplate>* deviceAllocator, uint32_t queueFamilyIdx, JobSystem* jobSystem,
+				  uint32_t slotCount, ReadbackCallback callback, void* userData) & -> status_t;
+		// the device must be idle. Waits for running consumers
+		auto destroy() & -> void;
+		auto isInitialized() const & -> bool { return m_cmdPool != VK_NULL_HANDLE; }
+
+		// records the copy of image (in layout currentLayout, left by a render pass whose color output is complete) into a free slot.
+		// Returns the command buffer to submit right after the one rendering the frame, or VK_NULL_HANDLE if no slot is free
+		auto record(VkImage image, VkImageLayout currentLayout, VkExtent2D extent, VkFormat format, uint64_t frameNumber) & -> VkCommandBuffer;
+		// hands every slot whose frame is <= completedFrameNumber to the consumer. Never blocks
+		auto poll(uint64_t completedFrameNumber) & -> void;
+
+		auto capturedCount() const & -> uint64_t { return m_capturedCount; }
+		auto droppedCount() const & -> uint64_t { return m_droppedCount; }
+
+	private: // types
+		enum class SlotState : uint32_t { FREE, IN_FLIGHT, CONSUMING };
+		struct Slot
+		{
+			VkBuffer buffer;
+			DeviceAllocation memory;
+			VkDeviceSize capacity;
+			VkCommandBuffer cmdBuf;
+			ReadbackFrame frame;
+			std::atomic<SlotState> state;
+		};
+
+	private: // functions
+		auto ensureCapacity(Slot& slot, VkDeviceSize size) & -> status_t;
+		auto consume(uint32_t slotIdx) & -> void;
+
+	private: // data
+		VkDevice m_device = VK_NULL_HANDLE;
+		DeviceAllocator<AllocTemplate>* m_deviceAllocator = nullptr;
+		JobSystem* m_jobSystem = nullptr;
+		VkCommandPool m_cmdPool = VK_NULL_HANDLE;
+		ReadbackCallback m_callback = nullptr;
+		void* m_userData = nullptr;
+
+		Slot m_slots[MAX_SLOTS]{};
+		uint32_t m_slotCount = 0;
+		uint32_t m_nextSlot = 0; // slots are used in ring order, so captures are handed over in order
+		JobCounter m_consumersRunning{0};
+
+		uint64_t m_capturedCount = 0;
+		uint64_t m_droppedCount = 0;
+	};
+
+	template <template<class> class AllocTemplate>
+	auto FrameReadback<AllocTemplate>::init(VkDevice device, DeviceAllocator<AllocTemplate>* deviceAllocator, uint32_t queueFamilyIdx, JobSystem* jobSystem,
+											uint32_t slotCount, ReadbackCallback callback, void* userData) & -> status_t
+	{
+		assert(m_cmdPool == VK_NULL_HANDLE && "frame readback initialized twice");
+		assert(slotCount != 0 && callback);
+		m_device = device;
+		m_deviceAllocator = deviceAllocator;
+		m_jobSystem = jobSystem;
+		m_callback = callback;
+		m_userData = userData;
+		m_slotCount = std::min(slotCount, MAX_SLOTS);
+		m_nextSlot = 0;
+
+		VkCommandPoolCreateInfo const cmdPoolCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, // re-recorded at each capture
+			.queueFamilyIndex = queueFamilyIdx
+		};
+		if (vkCreateCommandPool(m_device, &cmdPoolCreateInfo, m_deviceAllocator->allocationCallbacks(), &m_cmdPool) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create readback command pool!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		for (uint32_t i = 0; i < m_slotCount; ++i)
+		{
+			VkCommandBufferAllocateInfo const cmdBufAllocInfo {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.pNext = nullptr,
+				.commandPool = m_cmdPool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1
+			};
+			if (vkAllocateCommandBuffers(m_device, &cmdBufAllocInfo, &m_slots[i].cmdBuf) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to allocate readback command buffer!\n");
+				return APP_VK_ALLOCATION_ERR;
+			}
+			m_slots[i].buffer = VK_NULL_HANDLE;
+			m_slots[i].capacity = 0;
+			m_slots[i].state.store(SlotState::FREE, std::memory_order_relaxed);
+		}
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto FrameReadback<AllocTemplate>::destroy() & -> void
+	{
+		if (m_cmdPool == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		// frames still in flight are done, as the device is idle, deliver them before tearing down
+		poll(UINT64_MAX);
+		if (m_jobSystem)
+		{
+			m_jobSystem->wait(&m_consumersRunning);
+		}
+
+		for (uint32_t i = 0; i < m_slotCount; ++i)
+		{
+			vkDestroyBuffer(m_device, m_slots[i].buffer, m_deviceAllocator->allocationCallbacks());
+			m_deviceAllocator->free(m_slots[i].memory);
+			m_slots[i].buffer = VK_NULL_HANDLE;
+		}
+		vkDestroyCommandPool(m_device, m_cmdPool, m_deviceAllocator->allocationCallbacks()); // frees its command buffers
+		m_cmdPool = VK_NULL_HANDLE;
+		printf("frame readback: %lu frames captured, %lu dropped\n", static_cast<unsigned long>(m_capturedCount), static_cast<unsigned long>(m_droppedCount));
+	}
+
+	template <template<class> class AllocTemplate>
+	auto FrameReadback<AllocTemplate>::ensureCapacity(Slot& slot, VkDeviceSize size) & -> status_t
+	{
+		if (slot.capacity >= size)
+		{
+			return APP_SUCCESS;
+		}
+
+		// grown on demand (eg. after a resize). The slot is free, so neither the GPU nor a consumer touch the old buffer
+		vkDestroyBuffer(m_device, slot.buffer, m_deviceAllocator->allocationCallbacks());
+		m_deviceAllocator->free(slot.memory);
+		slot.buffer = VK_NULL_HANDLE;
+		slot.capacity = 0;
+
+		VkBufferCreateInfo const bufferCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.size = size,
+			.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices = nullptr
+		};
+		if (vkCreateBuffer(m_device, &bufferCreateInfo, m_deviceAllocator->allocationCallbacks(), &slot.buffer) != VK_SUCCESS)
+		{
+			slot.buffer = VK_NULL_HANDLE;
+			fprintf(stderr, "failed to create readback buffer!\n");
+			return APP_GENERIC_ERR;
+		}
+		// host cached makes CPU reads fast, at the price of an invalidate when not coherent
+		if (m_deviceAllocator->allocateForBuffer(slot.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, &slot.memory) != APP_SUCCESS)
+		{
+			// the slot stays empty, so the next frame tries again and destroy doesn't find a buffer without memory
+			vkDestroyBuffer(m_device, slot.buffer, m_deviceAllocator->allocationCallbacks());
+			slot.buffer = VK_NULL_HANDLE;
+			fprintf(stderr, "failed to allocate memory for readback buffer!\n");
+			return APP_VK_ALLOCATION_ERR;
+		}
+		slot.capacity = size;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto FrameReadback<AllocTemplate>::record(VkImage image, VkImageLayout currentLayout, VkExtent2D extent, VkFormat format, uint64_t frameNumber) & -> VkCommandBuffer
+	{
+		Slot& slot = m_slots[m_nextSlot];
+		if (slot.state.load(std::memory_order_acquire) != SlotState::FREE)
+		{
+			++m_droppedCount; // the consumer or the GPU are lagging behind, don't wait for them
+			return VK_NULL_HANDLE;
+		}
+
+		uint32_t const rowPitch = extent.width * 4;
+		VkDeviceSize const size = VkDeviceSize{rowPitch} * extent.height;
+		if (ensureCapacity(slot, size) != APP_SUCCESS)
+		{
+			++m_droppedCount;
+			return VK_NULL_HANDLE;
+		}
+
+		VkCommandBufferBeginInfo const cmdBufBeginInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			.pInheritanceInfo = nullptr
+		};
+		vkResetCommandBuffer(slot.cmdBuf, /*flags*/0);
+		vkBeginCommandBuffer(slot.cmdBuf, &cmdBufBeginInfo);
+
+		// color output of the frame -> transfer read. The layout transition is a no op when the render pass already left it in TRANSFER_SRC_OPTIMAL
+		VkImageMemoryBarrier imageBarrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+			.oldLayout = currentLayout,
+			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = image,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			}
+		};
+		vkCmdPipelineBarrier(slot.cmdBuf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, /*dependencyFlags*/0,
+							 /*memoryBarrierCount*/0, nullptr, /*bufferMemoryBarrierCount*/0, nullptr, /*imageMemoryBarrierCount*/1, &imageBarrier);
+
+		VkBufferImageCopy const region {
+			.bufferOffset = 0,
+			.bufferRowLength = 0, // tightly packed
+			.bufferImageHeight = 0,
+			.imageSubresource = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = 0,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			},
+			.imageOffset = VkOffset3D{0, 0, 0},
+			.imageExtent = VkExtent3D{extent.width, extent.height, 1}
+		};
+		vkCmdCopyImageToBuffer(slot.cmdBuf, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, /*regionCount*/1, &region);
+
+		// transfer write -> host read, so that once the frame timeline is signaled the data can be read after an invalidate
+		VkBufferMemoryBarrier const bufferBarrier {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.buffer = slot.buffer,
+			.offset = 0,
+			.size = size
+		};
+		// and give the image back in the layout it was, eg. PRESENT_SRC_KHR for swapchain images
+		imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imageBarrier.dstAccessMask = 0;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.newLayout = currentLayout;
+		vkCmdPipelineBarrier(slot.cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, /*dependencyFlags*/0,
+							 /*memoryBarrierCount*/0, nullptr, /*bufferMemoryBarrierCount*/1, &bufferBarrier, /*imageMemoryBarrierCount*/1, &imageBarrier);
+
+		if (vkEndCommandBuffer(slot.cmdBuf) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to record readback command buffer!\n");
+			++m_droppedCount;
+			return VK_NULL_HANDLE;
+		}
+
+		slot.frame = ReadbackFrame{
+			.frameNumber = frameNumber,
+			.width = extent.width,
+			.height = extent.height,
+			.format = format,
+			.rowPitch = rowPitch,
+			.pixels = std::span<uint8_t const>(static_cast<uint8_t const*>(slot.memory.mappedPtr), static_cast<size_t>(size))
+		};
+		slot.state.store(SlotState::IN_FLIGHT, std::memory_order_relaxed);
+		m_nextSlot = (m_nextSlot + 1) % m_slotCount;
+		return slot.cmdBuf;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto FrameReadback<AllocTemplate>::poll(uint64_t completedFrameNumber) & -> void
+	{
+		for (uint32_t i = 0; i < m_slotCount; ++i)
+		{
+			Slot& slot = m_slots[i];
+			if (slot.state.load(std::memory_order_relaxed) != SlotState::IN_FLIGHT || slot.frame.frameNumber > completedFrameNumber)
+			{
+				continue;
+			}
+
+			m_deviceAllocator->invalidate(slot.memory, 0, slot.frame.pixels.size());
+			slot.state.store(SlotState::CONSUMING, std::memory_order_relaxed);
+			++m_capturedCount;
+			if (m_jobSystem)
+			{
+				m_jobSystem->submit([this, i]() { consume(i); }, &m_consumersRunning);
+			}
+			else
+			{
+				consume(i);
+			}
+		}
+	}
+
+	template <template<class> class AllocTemplate>
+	auto FrameReadback<AllocTemplate>::consume(uint32_t slotIdx) & -> void
+	{
+		Slot& slot = m_slots[slotIdx];
+		m_callback(slot.frame, m_userData);
+		slot.state.store(SlotState::FREE, std::memory_order_release); // the render loop may reuse it from now on
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "vertex_format.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm> // max
+#include <cstddef> // byte, offsetof
+#include <cstdint>
+#include <span>
+#include <type_traits> // is_standard_layout
+
+// vertex layout of the renderer's vertex buffer, and ranges of its index buffer (with their LODs and meshlets), shared by whatever produces geometry (eg. mesh import)
+namespace mxc
+{
+	struct Vertex
+	{
+		Eigen::Vector3f pos;
+		Eigen::Vector3f col;
+	};
+	static_assert(std::is_standard_layout_v<Vertex>);
+	static_assert(sizeof(Vertex) == VertexLayoutFloat32::stride && offsetof(Vertex, col) == VertexLayoutFloat32::offset<1>());
+
+	// one vkCmdDrawIndexed on a range of the index buffer
+	struct DrawItem
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset; // added to each index before fetching the vertex
+	};
+
+	// a coarser version of a DrawItem: the same vertices, fewer triangles, in another range of the same index buffer
+	struct MeshLod
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		float error; // object space, about how far the surface moved from the full detail one
+	};
+
+	// LODs of one DrawItem, lods[firstLod, firstLod + lodCount) from finest to coarsest, the DrawItem itself being the level with no error
+	struct LodChain
+	{
+		uint32_t firstLod;
+		uint32_t lodCount;
+		Eigen::Vector3f center; // bounding sphere of the DrawItem, object space
+		float radius;
+	};
+	static_assert(std::is_standard_layout_v<LodChain> && sizeof(LodChain) == 24 && sizeof(MeshLod) == 12); // stored in .mxm files
+
+	// what selectLod needs of the object to clip transform and of the viewport, computed once per frame
+	struct LodProjection
+	{
+		Eigen::Vector4f wRow; // clip w of an object space point
+		float wSlope; // how much w can change per unit of object space distance
+		float pixelsPerUnit; // at w = 1, the most pixels one unit of object space distance can cover
+	};
+
+	inline auto lodProjection(Eigen::Matrix4f const& objectToClip, float viewportWidth, float viewportHeight) -> LodProjection
+	{
+		// clip space [-1,1] covers the viewport, so x and y move by viewport / 2 pixels per unit
+		return LodProjection{
+			.wRow = objectToClip.row(3).transpose(),
+			.wSlope = objectToClip.block<1,3>(3, 0).norm(),
+			.pixelsPerUnit = std::max(objectToClip.block<1,3>(0, 0).norm() * .5f * viewportWidth, objectToClip.block<1,3>(1, 0).norm() * .5f * viewportHeight)
+		};
+	}
+
+	// the coarsest level of chain whose error covers at most maxErrorPixels once projected. Errors are scaled by 1/w at the point of the
+	// bounding sphere nearest to the eye (w is 1 everywhere with an affine transform). A sphere crossing w = 0 gets full detail
+	inline auto selectLod(DrawItem const& drawItem, LodChain const& chain, std::span<MeshLod const> lods, LodProjection const& projection, float maxErrorPixels) -> DrawItem
+	{
+		float const w = projection.wRow.dot(chain.center.homogeneous()) - chain.radius * projection.wSlope;
+		if (w <= 0.f)
+		{
+			return drawItem;
+		}
+		float const maxError = maxErrorPixels * w / projection.pixelsPerUnit;
+		DrawItem selected = drawItem;
+		for (uint32_t i = 0; i < chain.lodCount && lods[chain.firstLod + i].error <= maxError; ++i)
+		{
+			selected = DrawItem{.indexCount = lods[chain.firstLod + i].indexCount, .firstIndex = lods[chain.firstLod + i].firstIndex, .vertexOffset = drawItem.vertexOffset};
+		}
+		return selected;
+	}
+
+	inline constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+	inline constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+	// a range of a DrawItem's indices, using at most MESHLET_MAX_VERTICES vertices for at most MESHLET_MAX_TRIANGLES triangles
+	struct Meshlet
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+	};
+
+	// meshlets of one DrawItem, meshlets[firstMeshlet, firstMeshlet + meshletCount), in index order and covering all of its indices
+	struct MeshletRange
+	{
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+	};
+
+	// culling data of meshlets [4 i, 4 i + 4), one per lane, so that the culler loads a field of 4 meshlets at once. Object space
+	struct MeshletBounds4
+	{
+		float centerX[4]; // bounding sphere
+		float centerY[4];
+		float centerZ[4];
+		float radius[4];
+		float axisX[4]; // normal cone: every triangle normal is within its half angle from axis
+		float axisY[4];
+		float axisZ[4];
+		float coneCos[4]; // of the half angle, 0 (and sine 1) when the cone is as wide as a half space or wider, which never culls
+		float coneSin[4];
+	};
+	static_assert(std::is_standard_layout_v<Meshlet> && sizeof(Meshlet) == 8 && sizeof(MeshletBounds4) == 144); // stored in .mxm files
+
+	// contents of a vertex buffer in one of the VertexFormats. Quantized formats store positions mapped to [-1,1], the stored position
+	// p stands for positionOffset + positionScale * p
+	struct VertexStream
+	{
+		std::span<std::byte const> data;
+		uint32_t count;
+		VertexFormat format;
+		Eigen::Vector3f positionOffset = Eigen::Vector3f::Zero();
+		Eigen::Vector3f positionScale = Eigen::Vector3f::Ones();
+
+		auto dequantization() const -> Eigen::Transform<float,3,Eigen::Affine>
+		{
+			return Eigen::Translation3f(positionOffset) * Eigen::Scaling(positionScale);
+		}
+	};
+
+	inline auto vertexStreamOf(std::span<Vertex const> vertices) -> VertexStream
+	{
+		return VertexStream{
+			.data = std::as_bytes(vertices),
+			.count = static_cast<uint32_t>(vertices.size()),
+			.format = VERTEX_FORMAT_FLOAT32,
+			.positionOffset = Eigen::Vector3f::Zero(),
+			.positionScale = Eigen::Vector3f::Ones()
+		};
+	}
+
+	// contents of an index buffer, 16 bit when every DrawItem spans at most 65536 vertices (see optimizeMesh), 32 bit otherwise
+	struct IndexStream
+	{
+		std::span<std::byte const> data;
+		uint32_t count;
+		uint32_t indexSize; // 2 or 4 bytes
+
+		auto indexType() const -> VkIndexType { return indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; }
+	};
+
+	template <typename Index> auto indexStreamOf(std::span<Index const> indices) -> IndexStream
+	{
+		static_assert(std::is_same_v<Index, uint16_t> || std::is_same_v<Index, uint32_t>);
+		return IndexStream{.data = std::as_bytes(indices), .count = static_cast<uint32_t>(indices.size()), .indexSize = sizeof(Index)};
+	}
+
+	// geometry ready to be handed to the renderer, whoever owns it (eg. MeshData, or a memory mapped MeshFile)
+	struct MeshView
+	{
+		VertexStream vertices;
+		IndexStream indices;
+		std::span<DrawItem const> drawItems;
+		std::span<LodChain const> lodChains; // one for each DrawItem, or none if the mesh has no LODs (see buildLods)
+		std::span<MeshLod const> lods;
+		std::span<MeshletRange const> meshletRanges; // one for each DrawItem, or none if the mesh has no meshlets (see buildMeshlets)
+		std::span<Meshlet const> meshlets;
+		std::span<MeshletBounds4 const> meshletBounds; // (meshlets + 3) / 4
+		Eigen::Vector3f boundsMin = Eigen::Vector3f::Zero();
+		Eigen::Vector3f boundsMax = Eigen::Vector3f::Zero();
+	};
+}
@@ -0,0 +1,243 @@
+#include "gpu_profiler.h"
+
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <algorithm> // min, copy, sort
+
+namespace mxc
+{
+	auto GpuProfiler::init(VkPhysicalDevice phyDevice, VkDevice device, uint32_t queueFamilyIdx, uint32_t slotCount,
+						   VkAllocationCallbacks const* allocationCallbacks) & -> status_t
+	{
+		assert(m_slots == nullptr && "gpu profiler initialized twice");
+		m_device = device;
+		m_allocationCallbacks = allocationCallbacks;
+
+		// -- timestamp support and resolution ------------------------------------------------------------------------------------------------------
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(phyDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(phyDevice, &queueFamilyCount, queueFamilyProperties.data());
+		uint32_t const validBits = queueFamilyIdx < queueFamilyCount ? queueFamilyProperties[queueFamilyIdx].timestampValidBits : 0;
+		if (validBits == 0)
+		{
+			printf("queue family %u doesn't support timestamps, gpu profiler disabled\n", queueFamilyIdx);
+			return APP_SUCCESS;
+		}
+		m_validMask = validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+
+		VkPhysicalDeviceProperties phyDeviceProperties;
+		vkGetPhysicalDeviceProperties(phyDevice, &phyDeviceProperties);
+		m_msPerTick = static_cast<double>(phyDeviceProperties.limits.timestampPeriod) * 1e-6; // timestampPeriod is in ns
+
+		// -- one query pool for each slot, two timestamps for each scope --------------------------------------------------------------------------
+		m_slots = new (std::nothrow) Slot[slotCount];
+		m_histories = new (std::nothrow) History[MAX_SCOPE_NAMES];
+		if (!m_slots || !m_histories)
+		{
+			// destroy() bails out without slots, so whichever array was allocated is freed here
+			delete[] m_slots;
+			delete[] m_histories;
+			m_slots = nullptr;
+			m_histories = nullptr;
+			fprintf(stderr, "failed to allocate gpu profiler slots!\n");
+			return APP_MEMORY_ERR;
+		}
+		m_slotCount = slotCount;
+		m_historyCount = 0;
+
+		VkQueryPoolCreateInfo const queryPoolCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = 2 * MAX_SCOPES_PER_SLOT,
+			.pipelineStatistics = 0
+		};
+		for (uint32_t i = 0; i < m_slotCount; ++i)
+		{
+			m_slots[i].scopeCount = 0;
+			m_slots[i].pending = false;
+			if (vkCreateQueryPool(m_device, &queryPoolCreateInfo, m_allocationCallbacks, &m_slots[i].queryPool) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create timestamp query pool!\n");
+				m_slotCount = i;
+				destroy();
+				return APP_GENERIC_ERR;
+			}
+		}
+
+		printf("gpu profiler: %u slots, %f ns per tick\n", m_slotCount, static_cast<double>(phyDeviceProperties.limits.timestampPeriod));
+		return APP_SUCCESS;
+	}
+
+	auto GpuProfiler::destroy() & -> void
+	{
+		if (!m_slots)
+		{
+			return;
+		}
+		for (uint32_t i = 0; i < m_slotCount; ++i)
+		{
+			vkDestroyQueryPool(m_device, m_slots[i].queryPool, m_allocationCallbacks);
+		}
+		delete[] m_slots;
+		delete[] m_histories;
+		m_slots = nullptr;
+		m_histories = nullptr;
+		m_slotCount = 0;
+	}
+
+	// -- recording ----------------------------------------------------------------------------------------------------------------------------------
+	auto GpuProfiler::beginFrame(VkCommandBuffer cmdBuf, uint32_t slot) & -> void
+	{
+		if (!m_slots || slot >= m_slotCount)
+		{
+			return;
+		}
+		// queries have to be reset before being written again. Recorded, so cached command buffers reset them at each execution
+		vkCmdResetQueryPool(cmdBuf, m_slots[slot].queryPool, /*firstQuery*/0, 2 * MAX_SCOPES_PER_SLOT);
+		m_slots[slot].scopeCount = 0;
+		m_slots[slot].pending = false;
+	}
+
+	auto GpuProfiler::beginScope(VkCommandBuffer cmdBuf, uint32_t slot, char const* name) & -> uint32_t
+	{
+		if (!m_slots || slot >= m_slotCount || m_slots[slot].scopeCount == MAX_SCOPES_PER_SLOT)
+		{
+			return INVALID_SCOPE;
+		}
+		uint32_t const scopeIdx = m_slots[slot].scopeCount++;
+		m_slots[slot].names[scopeIdx] = name;
+		// top of pipe: the timestamp is written as soon as all the previous commands started
+		vkCmdWriteTimestamp(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_slots[slot].queryPool, 2 * scopeIdx);
+		return scopeIdx;
+	}
+
+	auto GpuProfiler::endScope(VkCommandBuffer cmdBuf, uint32_t slot, uint32_t scopeIdx) & -> void
+	{
+		if (scopeIdx == INVALID_SCOPE)
+		{
+			return;
+		}
+		// bottom of pipe: written once all the previous commands completed
+		vkCmdWriteTimestamp(cmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_slots[slot].queryPool, 2 * scopeIdx + 1);
+	}
+
+	// -- collection ---------------------------------------------------------------------------------------------------------------------------------
+	auto GpuProfiler::markSubmitted(uint32_t slot) & -> void
+	{
+		if (m_slots && slot < m_slotCount)
+		{
+			m_slots[slot].pending = m_slots[slot].scopeCount != 0;
+		}
+	}
+
+	auto GpuProfiler::collect(uint32_t slot) & -> void
+	{
+		if (!m_slots || slot >= m_slotCount || !m_slots[slot].pending)
+		{
+			return;
+		}
+
+		Slot& s = m_slots[slot];
+		uint64_t timestamps[2 * MAX_SCOPES_PER_SLOT];
+		// no WAIT_BIT: if the results are not there yet, VK_NOT_READY is returned and they are kept for the next call
+		VkResult const res = vkGetQueryPoolResults(m_device, s.queryPool, /*firstQuery*/0, 2 * s.scopeCount, sizeof(timestamps), timestamps,
+												   /*stride*/sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (res != VK_SUCCESS)
+		{
+			return;
+		}
+
+		for (uint32_t i = 0; i < s.scopeCount; ++i)
+		{
+			uint64_t const ticks = ((timestamps[2 * i + 1] & m_validMask) - (timestamps[2 * i] & m_validMask)) & m_validMask; // wraps around
+			addSample(s.names[i], static_cast<float>(static_cast<double>(ticks) * m_msPerTick));
+		}
+		s.pending = false;
+	}
+
+	auto GpuProfiler::addSample(char const* name, float ms) & -> void
+	{
+		History* history = nullptr;
+		for (uint32_t i = 0; i < m_historyCount && !history; ++i)
+		{
+			// names are usually literals, so the pointer comparison almost always decides
+			if (m_histories[i].name == name || strcmp(m_histories[i].name, name) == 0)
+			{
+				history = &m_histories[i];
+			}
+		}
+		if (!history)
+		{
+			if (m_historyCount == MAX_SCOPE_NAMES)
+			{
+				return;
+			}
+			history = &m_histories[m_historyCount++];
+			history->name = name;
+			history->count = 0;
+		}
+		history->samplesMs[history->count % HISTORY_SIZE] = ms;
+		++history->count;
+	}
+
+	// -- statistics ---------------------------------------------------------------------------------------------------------------------------------
+	auto GpuProfiler::scopeStats(char const* name, ScopeStats* outStats) const & -> bool
+	{
+		for (uint32_t i = 0; i < m_historyCount; ++i)
+		{
+			History const& history = m_histories[i];
+			if (history.name != name && strcmp(history.name, name) != 0)
+			{
+				continue;
+			}
+
+			// a window is at most HISTORY_SIZE samples, so sorting a copy is cheap enough
+			uint32_t const sampleCount = std::min(history.count, HISTORY_SIZE);
+			float sorted[HISTORY_SIZE] {};
+			std::copy(history.samplesMs, history.samplesMs + sampleCount, sorted);
+			std::sort(sorted, sorted + sampleCount);
+			float sum = 0.f;
+			for (uint32_t j = 0; j < sampleCount; ++j)
+			{
+				sum += sorted[j];
+			}
+			auto const percentile = [&sorted, sampleCount](uint32_t p) -> float { return sorted[std::min(sampleCount - 1, (sampleCount * p) / 100)]; };
+
+			*outStats = ScopeStats{
+				.name = history.name,
+				.minMs = sorted[0],
+				.avgMs = sum / static_cast<float>(sampleCount),
+				.p50Ms = percentile(50),
+				.p95Ms = percentile(95),
+				.p99Ms = percentile(99),
+				.maxMs = sorted[sampleCount - 1],
+				.sampleCount = sampleCount
+			};
+			return true;
+		}
+		return false;
+	}
+
+	auto GpuProfiler::printStats() const & -> void
+	{
+		if (m_historyCount == 0)
+		{
+			return;
+		}
+		printf("gpu profile, last %u samples at most:\n", HISTORY_SIZE);
+		for (uint32_t i = 0; i < m_historyCount; ++i)
+		{
+			ScopeStats stats;
+			if (scopeStats(m_histories[i].name, &stats))
+			{
+				printf("\t%-16s min %8.3f ms  avg %8.3f ms  p99 %8.3f ms  (%u samples)\n", stats.name, static_cast<double>(stats.minMs),
+					   static_cast<double>(stats.avgMs), static_cast<double>(stats.p99Ms), stats.sampleCount);
+			}
+		}
+	}
+}
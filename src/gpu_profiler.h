@@ -0,0 +1,109 @@
+#pragma once
+
+#include "status.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cassert>
+
+// GPU timings from vkCmdWriteTimestamp. Work is profiled in slots, each with its own VkQueryPool: a slot is a command buffer which is
+// submitted and then retired (eg. one for each swapchain image, one for each upload batch), so while a slot is in flight the others can
+// be recorded and collected. Named scopes write a timestamp at their beginning and at their end, and collect reads the results back,
+// without waiting, once the owner knows the slot is done with (eg. after its fence or timeline value). Durations are scaled by
+// VkPhysicalDeviceLimits::timestampPeriod and accumulated per scope name in a rolling window, reporting min, average, percentiles and max.
+// Cached command buffers are fine: the reset of the queries is recorded by beginFrame, so it is executed at each submission.
+// If the queue doesn't support timestamps every function silently does nothing.
+// NOTE: not thread safe
+namespace mxc
+{
+	class GpuProfiler
+	{
+	public: // constants
+		static constexpr uint32_t MAX_SCOPES_PER_SLOT = 16;
+		static constexpr uint32_t MAX_SCOPE_NAMES = 32;
+		static constexpr uint32_t HISTORY_SIZE = 256; // samples kept for each scope name
+		static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+	public: // types
+		struct ScopeStats
+		{
+			char const* name;
+			float minMs;
+			float avgMs;
+			float p50Ms;
+			float p95Ms;
+			float p99Ms;
+			float maxMs;
+			uint32_t sampleCount; // at most HISTORY_SIZE, stats are over the most recent samples
+		};
+
+		// RAII scope. Must end before the command buffer ends, and can't straddle a render pass boundary
+		class Scope
+		{
+		public:
+			Scope(GpuProfiler* profiler, VkCommandBuffer cmdBuf, uint32_t slot, char const* name)
+				: m_profiler(profiler), m_cmdBuf(cmdBuf), m_slot(slot), m_scopeIdx(profiler->beginScope(cmdBuf, slot, name)) {}
+			Scope(Scope const&) = delete;
+			auto operator=(Scope const&) -> Scope& = delete;
+			~Scope() { m_profiler->endScope(m_cmdBuf, m_slot, m_scopeIdx); }
+
+		private:
+			GpuProfiler* m_profiler;
+			VkCommandBuffer m_cmdBuf;
+			uint32_t m_slot;
+			uint32_t m_scopeIdx;
+		};
+
+	public: // constructors
+		GpuProfiler() = default;
+		GpuProfiler(GpuProfiler const&) = delete;
+		auto operator=(GpuProfiler const&) -> GpuProfiler& = delete;
+		~GpuProfiler() { assert(m_slots == nullptr && "destroy() must be called before the VkDevice is destroyed"); }
+
+	public: // public functions
+		auto init(VkPhysicalDevice phyDevice, VkDevice device, uint32_t queueFamilyIdx, uint32_t slotCount,
+				  VkAllocationCallbacks const* allocationCallbacks = nullptr) & -> status_t;
+		auto destroy() & -> void;
+		auto isEnabled() const & -> bool { return m_slots != nullptr; }
+
+		// to be recorded at the beginning of the command buffer of the slot, outside a render pass. Forgets the scopes of its previous recording
+		auto beginFrame(VkCommandBuffer cmdBuf, uint32_t slot) & -> void;
+		auto beginScope(VkCommandBuffer cmdBuf, uint32_t slot, char const* name) & -> uint32_t; // name must be a string literal, or anyway outlive the profiler
+		auto endScope(VkCommandBuffer cmdBuf, uint32_t slot, uint32_t scopeIdx) & -> void;
+
+		auto markSubmitted(uint32_t slot) & -> void; // results of slot will be collected by the next collect(slot)
+		auto collect(uint32_t slot) & -> void; // never blocks, results not yet available are kept for the next call
+
+		auto scopeStats(char const* name, ScopeStats* outStats) const & -> bool;
+		auto printStats() const & -> void;
+
+	private: // types
+		struct Slot
+		{
+			VkQueryPool queryPool;
+			char const* names[MAX_SCOPES_PER_SLOT];
+			uint32_t scopeCount;
+			bool pending; // submitted and not collected yet
+		};
+		struct History
+		{
+			char const* name;
+			float samplesMs[HISTORY_SIZE];
+			uint32_t count; // total, the window holds the last min(count, HISTORY_SIZE)
+		};
+
+	private: // functions
+		auto addSample(char const* name, float ms) & -> void;
+
+	private: // data
+		VkDevice m_device = VK_NULL_HANDLE;
+		VkAllocationCallbacks const* m_allocationCallbacks = nullptr;
+		Slot* m_slots = nullptr;
+		uint32_t m_slotCount = 0;
+		double m_msPerTick = 0.0;
+		uint64_t m_validMask = 0;
+		History* m_histories = nullptr; // MAX_SCOPE_NAMES of them
+		uint32_t m_historyCount = 0;
+	};
+}
@@ -0,0 +1,380 @@
+#include "host_allocator.h"
+
+#include "trace.h" // now
+
+#include <algorithm> // min
+#include <atomic>
+#include <bit> // bit_width
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace mxc::hostalloc
+{
+	namespace
+	{
+		inline constexpr uint32_t LARGE_CLASS = SIZE_CLASS_COUNT;
+		inline constexpr uint32_t MAX_TRACE_THREADS = 64;
+
+		struct Counters
+		{
+			std::atomic<uint64_t> bytesLive{0};
+			std::atomic<uint64_t> bytesPeak{0};
+			std::atomic<uint64_t> allocationCount{0};
+			std::atomic<uint64_t> freeCount{0};
+			std::atomic<uint64_t> cacheHitCount{0};
+			std::atomic<uint64_t> sizeClassAllocations[SIZE_CLASS_COUNT + 1]{};
+			std::atomic<uint64_t> tagAllocations[MAX_TAGS]{};
+			std::atomic<uint64_t> tagBytes[MAX_TAGS]{};
+		};
+
+		// trivially destructible, so that it stays usable until the thread is gone. CacheReaper empties it at thread exit
+		struct ThreadCache
+		{
+			void* blocks[SIZE_CLASS_COUNT][CACHE_CAPACITY];
+			uint32_t counts[SIZE_CLASS_COUNT];
+		};
+
+		enum class CacheState : uint8_t
+		{
+			UNINITIALIZED,
+			ALIVE,
+			DEAD // thread exiting: later frees go straight to free
+		};
+
+		struct TraceEvent
+		{
+			uint64_t ns;
+			void const* ptr;
+			uint64_t bytes;
+			uint32_t tag;
+			bool isAllocation;
+		};
+
+		struct TraceBuffer
+		{
+			TraceEvent events[TRACE_EVENTS_PER_THREAD];
+			std::atomic<uint32_t> count; // events [0, count) are complete and never written again
+			std::atomic<uint32_t> dropped;
+		};
+
+		// constant initialized, usable by allocations made during static initialization
+		Counters g_counters;
+		std::atomic<char const*> g_tagNames[MAX_TAGS]{};
+		std::atomic<bool> g_tracing{false};
+		std::atomic<TraceBuffer*> g_traceBuffers[MAX_TRACE_THREADS]{};
+		std::atomic<uint32_t> g_traceBufferCount{0};
+
+		thread_local ThreadCache t_cache;
+		thread_local CacheState t_cacheState = CacheState::UNINITIALIZED;
+		thread_local uint32_t t_tag = 0;
+		thread_local TraceBuffer* t_traceBuffer = nullptr;
+		thread_local bool t_traceRegistrationFailed = false;
+
+		struct CacheReaper
+		{
+			~CacheReaper()
+			{
+				for (uint32_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+				{
+					for (uint32_t i = 0; i < t_cache.counts[sizeClass]; ++i)
+					{
+						std::free(t_cache.blocks[sizeClass][i]);
+					}
+					t_cache.counts[sizeClass] = 0;
+				}
+				t_cacheState = CacheState::DEAD;
+			}
+		};
+
+		auto threadCache() -> ThreadCache*
+		{
+			if (t_cacheState == CacheState::UNINITIALIZED)
+			{
+				thread_local CacheReaper reaper; // constructed once per thread, registers the cleanup at thread exit
+				static_cast<void>(reaper);
+				t_cacheState = CacheState::ALIVE;
+			}
+			return t_cacheState == CacheState::ALIVE ? &t_cache : nullptr;
+		}
+
+		auto count(std::atomic<uint64_t>& counter, uint64_t amount = 1) -> void
+		{
+			counter.fetch_add(amount, std::memory_order_relaxed);
+		}
+
+		auto isCached(size_t bytes, size_t alignment) -> bool
+		{
+			return bytes <= MAX_CACHED_SIZE && alignment <= alignof(std::max_align_t);
+		}
+
+		// 16 -> 0, 17..32 -> 1, ..., 2049..4096 -> 8
+		auto sizeClassOf(size_t bytes) -> uint32_t
+		{
+			return bytes <= MIN_CLASS_SIZE ? 0u : static_cast<uint32_t>(std::bit_width(bytes - 1)) - static_cast<uint32_t>(std::bit_width(MIN_CLASS_SIZE - 1));
+		}
+
+		auto alignedAllocate(size_t bytes, size_t alignment) -> void*
+		{
+			size_t const rounded = (bytes + alignment - 1) & ~(alignment - 1); // aligned_alloc wants a multiple of the alignment
+#ifdef _WIN32
+			return _aligned_malloc(rounded, alignment);
+#else
+			return std::aligned_alloc(alignment, rounded);
+#endif
+		}
+
+		auto alignedFree(void* ptr) -> void
+		{
+#ifdef _WIN32
+			_aligned_free(ptr);
+#else
+			std::free(ptr);
+#endif
+		}
+
+		auto traceBuffer() -> TraceBuffer*
+		{
+			if (t_traceBuffer || t_traceRegistrationFailed)
+			{
+				return t_traceBuffer;
+			}
+			uint32_t const idx = g_traceBufferCount.fetch_add(1, std::memory_order_relaxed);
+			TraceBuffer* buffer = idx < MAX_TRACE_THREADS ? new (std::nothrow) TraceBuffer : nullptr; // global new, not this allocator
+			if (!buffer)
+			{
+				t_traceRegistrationFailed = true;
+				return nullptr;
+			}
+			buffer->count.store(0, std::memory_order_relaxed);
+			buffer->dropped.store(0, std::memory_order_relaxed);
+			g_traceBuffers[idx].store(buffer, std::memory_order_release);
+			t_traceBuffer = buffer;
+			return t_traceBuffer;
+		}
+
+		auto traceEvent(void const* ptr, size_t bytes, bool isAllocation) -> void
+		{
+			TraceBuffer* buffer = traceBuffer();
+			if (!buffer)
+			{
+				return;
+			}
+			uint32_t const count = buffer->count.load(std::memory_order_relaxed);
+			if (count == TRACE_EVENTS_PER_THREAD)
+			{
+				buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return;
+			}
+			buffer->events[count] = TraceEvent{.ns = trace::now(), .ptr = ptr, .bytes = bytes, .tag = t_tag, .isAllocation = isAllocation};
+			buffer->count.store(count + 1, std::memory_order_release);
+		}
+
+		auto tagName(uint32_t tag) -> char const*
+		{
+			char const* name = tag == 0 ? nullptr : g_tagNames[tag].load(std::memory_order_acquire);
+			return name ? name : "untagged";
+		}
+
+		auto tagId(char const* name) -> uint32_t
+		{
+			for (uint32_t i = 1; i < MAX_TAGS; ++i)
+			{
+				char const* current = g_tagNames[i].load(std::memory_order_acquire);
+				// a failed exchange loads the name which won the slot
+				if ((!current && g_tagNames[i].compare_exchange_strong(current, name, std::memory_order_acq_rel)) || current == name || strcmp(current, name) == 0)
+				{
+					return i;
+				}
+			}
+			return 0;
+		}
+	}
+
+	auto allocate(size_t bytes, size_t alignment) -> void*
+	{
+		bool const cached = isCached(bytes, alignment);
+		uint32_t const sizeClass = cached ? sizeClassOf(bytes) : LARGE_CLASS;
+		void* ptr = nullptr;
+		if (cached)
+		{
+			ThreadCache* cache = threadCache();
+			if (cache && cache->counts[sizeClass] > 0)
+			{
+				ptr = cache->blocks[sizeClass][--cache->counts[sizeClass]];
+				count(g_counters.cacheHitCount);
+			}
+			else
+			{
+				ptr = std::malloc(MIN_CLASS_SIZE << sizeClass);
+			}
+		}
+		else
+		{
+			ptr = alignment <= alignof(std::max_align_t) ? std::malloc(bytes) : alignedAllocate(bytes, alignment);
+		}
+		if (!ptr)
+		{
+			return nullptr;
+		}
+
+		uint64_t const live = g_counters.bytesLive.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		uint64_t peak = g_counters.bytesPeak.load(std::memory_order_relaxed);
+		while (live > peak && !g_counters.bytesPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+		count(g_counters.allocationCount);
+		count(g_counters.sizeClassAllocations[sizeClass]);
+		count(g_counters.tagAllocations[t_tag]);
+		count(g_counters.tagBytes[t_tag], bytes);
+		if (g_tracing.load(std::memory_order_relaxed))
+		{
+			traceEvent(ptr, bytes, /*isAllocation*/true);
+		}
+		return ptr;
+	}
+
+	auto deallocate(void* ptr, size_t bytes, size_t alignment) -> void
+	{
+		if (!ptr)
+		{
+			return;
+		}
+		g_counters.bytesLive.fetch_sub(bytes, std::memory_order_relaxed);
+		count(g_counters.freeCount);
+		if (g_tracing.load(std::memory_order_relaxed))
+		{
+			traceEvent(ptr, bytes, /*isAllocation*/false);
+		}
+
+		if (!isCached(bytes, alignment))
+		{
+			if (alignment <= alignof(std::max_align_t))
+			{
+				std::free(ptr);
+			}
+			else
+			{
+				alignedFree(ptr);
+			}
+			return;
+		}
+		// blocks are plain malloc blocks of their class size, so they can go to any thread cache, including one of another thread
+		uint32_t const sizeClass = sizeClassOf(bytes);
+		ThreadCache* cache = threadCache();
+		if (cache && cache->counts[sizeClass] < CACHE_CAPACITY)
+		{
+			cache->blocks[sizeClass][cache->counts[sizeClass]++] = ptr;
+			return;
+		}
+		std::free(ptr);
+	}
+
+	auto stats() -> Stats
+	{
+		Stats stats {
+			.bytesLive = g_counters.bytesLive.load(std::memory_order_relaxed),
+			.bytesPeak = g_counters.bytesPeak.load(std::memory_order_relaxed),
+			.allocationCount = g_counters.allocationCount.load(std::memory_order_relaxed),
+			.freeCount = g_counters.freeCount.load(std::memory_order_relaxed),
+			.cacheHitCount = g_counters.cacheHitCount.load(std::memory_order_relaxed),
+			.sizeClassAllocations = {},
+			.tags = {},
+			.tagCount = 0
+		};
+		for (uint32_t i = 0; i <= SIZE_CLASS_COUNT; ++i)
+		{
+			stats.sizeClassAllocations[i] = g_counters.sizeClassAllocations[i].load(std::memory_order_relaxed);
+		}
+		for (uint32_t i = 0; i < MAX_TAGS && (i == 0 || g_tagNames[i].load(std::memory_order_acquire)); ++i)
+		{
+			stats.tags[i] = TagStats{
+				.name = tagName(i),
+				.allocationCount = g_counters.tagAllocations[i].load(std::memory_order_relaxed),
+				.bytes = g_counters.tagBytes[i].load(std::memory_order_relaxed)
+			};
+			stats.tagCount = i + 1;
+		}
+		return stats;
+	}
+
+	auto printStats() -> void
+	{
+		Stats const s = stats();
+		printf("host allocator stats:\n"
+			   "\tallocations: %lu total, %lu frees, %lu from thread caches\n"
+			   "\tlive: %lu bytes, peak %lu bytes\n",
+			   static_cast<unsigned long>(s.allocationCount), static_cast<unsigned long>(s.freeCount), static_cast<unsigned long>(s.cacheHitCount),
+			   static_cast<unsigned long>(s.bytesLive), static_cast<unsigned long>(s.bytesPeak));
+		for (uint32_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+		{
+			if (s.sizeClassAllocations[i] != 0)
+			{
+				printf("\tsize class %5lu: %lu allocations\n", static_cast<unsigned long>(MIN_CLASS_SIZE << i), static_cast<unsigned long>(s.sizeClassAllocations[i]));
+			}
+		}
+		printf("\tlarger, over aligned: %lu allocations\n", static_cast<unsigned long>(s.sizeClassAllocations[LARGE_CLASS]));
+		for (uint32_t i = 0; i < s.tagCount; ++i)
+		{
+			printf("\ttag %-16s %lu allocations, %lu bytes\n", s.tags[i].name, static_cast<unsigned long>(s.tags[i].allocationCount), static_cast<unsigned long>(s.tags[i].bytes));
+		}
+	}
+
+	TagScope::TagScope(char const* name) : m_previousTag(t_tag)
+	{
+		t_tag = tagId(name);
+	}
+
+	TagScope::~TagScope()
+	{
+		t_tag = m_previousTag;
+	}
+
+	auto setTracing(bool enabled) -> void
+	{
+		g_tracing.store(enabled, std::memory_order_relaxed);
+	}
+
+	auto dumpTrace(char const* path) -> bool
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+		{
+			fprintf(stderr, "failed to open allocation trace file %s!\n", path);
+			return false;
+		}
+
+		uint64_t eventCount = 0;
+		uint64_t droppedCount = 0;
+		fputs("# ns thread op bytes address tag\n", file);
+		uint32_t const bufferCount = std::min(g_traceBufferCount.load(std::memory_order_relaxed), MAX_TRACE_THREADS);
+		for (uint32_t tid = 0; tid < bufferCount; ++tid)
+		{
+			TraceBuffer const* buffer = g_traceBuffers[tid].load(std::memory_order_acquire);
+			if (!buffer)
+			{
+				continue;
+			}
+			uint32_t const count = buffer->count.load(std::memory_order_acquire);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				TraceEvent const& event = buffer->events[i];
+				fprintf(file, "%lu %u %s %lu %p %s\n", static_cast<unsigned long>(event.ns), tid, event.isAllocation ? "alloc" : "free",
+						static_cast<unsigned long>(event.bytes), event.ptr, tagName(event.tag));
+			}
+			eventCount += count;
+			droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+		}
+
+		bool const ok = ferror(file) == 0;
+		fclose(file);
+		if (!ok)
+		{
+			fprintf(stderr, "failed to write allocation trace file %s!\n", path);
+			return false;
+		}
+		printf("allocation trace with %lu events written to %s, %lu events dropped\n", static_cast<unsigned long>(eventCount), path,
+			   static_cast<unsigned long>(droppedCount));
+		return true;
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "linear_arena.h" // heapAllowed
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+// Host memory for the renderer containers (AllocTemplate). Blocks up to MAX_CACHED_SIZE bytes are rounded to a power of two size class
+// and recycled through per-thread caches, so that steady state allocations are a thread local pop, without locks. Larger or over aligned
+// blocks go straight to malloc. Shared atomic counters track live and peak bytes, allocations per size class and per tag: a tag names
+// whatever the calling thread is doing (TagScope), eg. "app::init". Allocation tracing is off by default; when enabled each thread appends
+// its events to a fixed buffer, written out only by dumpTrace
+namespace mxc::hostalloc
+{
+	inline constexpr size_t MIN_CLASS_SIZE = 16;
+	inline constexpr uint32_t SIZE_CLASS_COUNT = 9; // 16 .. 4096 bytes
+	inline constexpr size_t MAX_CACHED_SIZE = MIN_CLASS_SIZE << (SIZE_CLASS_COUNT - 1);
+	inline constexpr uint32_t CACHE_CAPACITY = 32; // blocks per size class per thread, the rest is freed
+	inline constexpr uint32_t MAX_TAGS = 32; // tag 0 is "untagged"
+	inline constexpr uint32_t TRACE_EVENTS_PER_THREAD = 1u << 16;
+
+	struct TagStats
+	{
+		char const* name;
+		uint64_t allocationCount;
+		uint64_t bytes; // allocated, frees can't be attributed
+	};
+
+	struct Stats
+	{
+		uint64_t bytesLive; // as requested, not rounded to the size class
+		uint64_t bytesPeak;
+		uint64_t allocationCount;
+		uint64_t freeCount;
+		uint64_t cacheHitCount; // allocations served by a thread cache
+		uint64_t sizeClassAllocations[SIZE_CLASS_COUNT + 1]; // last entry: larger or over aligned
+		TagStats tags[MAX_TAGS];
+		uint32_t tagCount;
+	};
+
+	// null on failure
+	auto allocate(size_t bytes, size_t alignment) -> void*;
+	// bytes and alignment must be the ones passed to allocate
+	auto deallocate(void* ptr, size_t bytes, size_t alignment) -> void;
+
+	auto stats() -> Stats;
+	auto printStats() -> void;
+
+	// name must be a string literal, or anyway outlive the process. Past MAX_TAGS names, allocations are counted as untagged
+	class TagScope
+	{
+	public:
+		explicit TagScope(char const* name);
+		TagScope(TagScope const&) = delete;
+		auto operator=(TagScope const&) -> TagScope& = delete;
+		~TagScope();
+
+	private:
+		uint32_t m_previousTag;
+	};
+
+	auto setTracing(bool enabled) -> void;
+	// one line per event: ns since startup, thread, alloc/free, bytes, address, tag
+	auto dumpTrace(char const* path) -> bool;
+}
+
+namespace mxc
+{
+	// stateless, every instance can free what another allocated
+	template <typename T> struct HostAllocator
+	{
+		using value_type = T;
+		constexpr HostAllocator() = default;
+		template <class U> constexpr HostAllocator(HostAllocator<U> const&) noexcept {}
+
+		[[nodiscard]] auto allocate(size_t n) -> T*
+		{
+			if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+			{
+				throw std::bad_array_new_length();
+			}
+			assert(heapAllowed() && "container allocation inside a NoHeapScope");
+			if (void* ptr = hostalloc::allocate(n * sizeof(T), alignof(T)))
+			{
+				return static_cast<T*>(ptr);
+			}
+			throw std::bad_alloc();
+		}
+
+		auto deallocate(T* ptr, size_t n) noexcept -> void
+		{
+			hostalloc::deallocate(ptr, n * sizeof(T), alignof(T));
+		}
+	};
+
+	template <class T, class U> constexpr auto operator==(HostAllocator<T> const&, HostAllocator<U> const&) -> bool { return true; }
+	template <class T, class U> constexpr auto operator!=(HostAllocator<T> const&, HostAllocator<U> const&) -> bool { return false; }
+}
@@ -0,0 +1,246 @@
+#include "job_system.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+namespace mxc
+{
+	static thread_local uint32_t t_threadIdx = UINT32_MAX;
+
+	auto JobSystem::threadIndex() -> uint32_t
+	{
+		return t_threadIdx;
+	}
+
+	auto JobSystem::init(uint32_t threadCount) & -> status_t
+	{
+		assert(!m_running.load() && "job system initialized twice");
+		if (threadCount == 0)
+		{
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		m_threadCount = std::min(threadCount, MAX_THREADS);
+
+		m_deques = new (std::nothrow) Deque[m_threadCount];
+		if (!m_deques)
+		{
+			fprintf(stderr, "failed to allocate job system deques!\n");
+			return APP_MEMORY_ERR;
+		}
+		for (uint32_t i = 0; i < m_threadCount; ++i)
+		{
+			m_deques[i].top.store(0, std::memory_order_relaxed);
+			m_deques[i].bottom.store(0, std::memory_order_relaxed);
+			m_deques[i].poolHead = 0;
+			for (uint32_t j = 0; j < DEQUE_CAPACITY; ++j)
+			{
+				m_deques[i].slots[j].store(nullptr, std::memory_order_relaxed);
+				m_deques[i].pool[j].busy.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		// the calling thread takes part as thread 0
+		t_threadIdx = 0;
+		m_running.store(true);
+		m_workers = new std::thread[m_threadCount - 1];
+		for (uint32_t i = 1; i < m_threadCount; ++i)
+		{
+			m_workers[i - 1] = std::thread([this, i]() { workerLoop(i); });
+		}
+
+		printf("job system started with %u threads\n", m_threadCount);
+		return APP_SUCCESS;
+	}
+
+	auto JobSystem::shutdown() & -> void
+	{
+		if (!m_running.exchange(false))
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_sleepCondition.notify_all();
+		}
+		for (uint32_t i = 0; i + 1 < m_threadCount; ++i)
+		{
+			m_workers[i].join();
+		}
+		delete[] m_workers;
+		delete[] m_deques;
+		m_workers = nullptr;
+		m_deques = nullptr;
+		t_threadIdx = UINT32_MAX;
+	}
+
+	// -- Chase-Lev deque ------------------------------------------------------------------------------------------------------------------------------
+	auto JobSystem::push(Job const& job) & -> bool
+	{
+		uint32_t const threadIdx = t_threadIdx;
+		if (threadIdx >= m_threadCount || !m_deques)
+		{
+			return false;
+		}
+		Deque& deque = m_deques[threadIdx];
+
+		int64_t const bottom = deque.bottom.load(std::memory_order_relaxed);
+		int64_t const top = deque.top.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64_t>(DEQUE_CAPACITY))
+		{
+			return false;
+		}
+
+		// find a free slot in the pool. There are as many slots as deque entries, but a slot stays busy while its job runs after being
+		// taken from the deque, so we may have to skip some
+		JobSlot* slot = nullptr;
+		for (uint32_t i = 0; i < DEQUE_CAPACITY && !slot; ++i)
+		{
+			JobSlot& candidate = deque.pool[deque.poolHead];
+			deque.poolHead = (deque.poolHead + 1) & (DEQUE_CAPACITY - 1);
+			if (!candidate.busy.load(std::memory_order_acquire))
+			{
+				slot = &candidate;
+			}
+		}
+		if (!slot)
+		{
+			return false;
+		}
+		slot->job = job;
+		slot->busy.store(true, std::memory_order_relaxed);
+
+		deque.slots[bottom & (DEQUE_CAPACITY - 1)].store(slot, std::memory_order_relaxed);
+		deque.bottom.store(bottom + 1, std::memory_order_release);
+		m_queuedCount.fetch_add(1, std::memory_order_release);
+
+		if (m_sleepingCount.load(std::memory_order_acquire) != 0)
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_sleepCondition.notify_one();
+		}
+		return true;
+	}
+
+	auto JobSystem::pop(uint32_t threadIdx) & -> JobSlot*
+	{
+		Deque& deque = m_deques[threadIdx];
+		int64_t const bottom = deque.bottom.load(std::memory_order_relaxed) - 1;
+		deque.bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = deque.top.load(std::memory_order_relaxed);
+
+		if (top > bottom) // empty
+		{
+			deque.bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		JobSlot* slot = deque.slots[bottom & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// last job, race against thieves
+			if (!deque.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				slot = nullptr;
+			}
+			deque.bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return slot;
+	}
+
+	auto JobSystem::steal(uint32_t victimIdx) & -> JobSlot*
+	{
+		Deque& deque = m_deques[victimIdx];
+		int64_t top = deque.top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t const bottom = deque.bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+
+		JobSlot* slot = deque.slots[top & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!deque.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr; // lost against the owner or another thief
+		}
+		return slot;
+	}
+
+	// -- execution --------------------------------------------------------------------------------------------------------------------------------------
+	auto JobSystem::execute(JobSlot* slot) & -> void
+	{
+		m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+		slot->job.invoke(slot->job.storage);
+		JobCounter* const counter = slot->job.counter;
+		slot->busy.store(false, std::memory_order_release); // from here on the owner can reuse the slot
+		if (counter)
+		{
+			counter->fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	auto JobSystem::tryRunOne(uint32_t threadIdx) & -> bool
+	{
+		JobSlot* slot = pop(threadIdx);
+		if (!slot)
+		{
+			// steal, starting from the next thread so that thieves spread out
+			for (uint32_t i = 1; i < m_threadCount && !slot; ++i)
+			{
+				slot = steal((threadIdx + i) % m_threadCount);
+			}
+		}
+		if (!slot)
+		{
+			return false;
+		}
+		execute(slot);
+		return true;
+	}
+
+	auto JobSystem::wait(JobCounter const* counter) & -> void
+	{
+		uint32_t const threadIdx = t_threadIdx;
+		while (counter->load(std::memory_order_acquire) != 0)
+		{
+			if (threadIdx >= m_threadCount || !tryRunOne(threadIdx))
+			{
+				std::this_thread::yield(); // someone else is running the last jobs
+			}
+		}
+	}
+
+	auto JobSystem::workerLoop(uint32_t threadIdx) & -> void
+	{
+		t_threadIdx = threadIdx;
+		uint32_t idleRounds = 0;
+		while (m_running.load(std::memory_order_acquire))
+		{
+			if (tryRunOne(threadIdx))
+			{
+				idleRounds = 0;
+				continue;
+			}
+
+			// spin a little before going to sleep, as new work typically comes in bursts
+			if (++idleRounds < 64)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			m_sleepingCount.fetch_add(1, std::memory_order_acq_rel);
+			m_sleepCondition.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+				return !m_running.load(std::memory_order_acquire) || m_queuedCount.load(std::memory_order_acquire) != 0;
+			});
+			m_sleepingCount.fetch_sub(1, std::memory_order_acq_rel);
+			idleRounds = 0;
+		}
+		t_threadIdx = UINT32_MAX;
+	}
+}
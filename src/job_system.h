@@ -0,0 +1,152 @@
+#pragma once
+
+#include "status.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+// Work stealing job system. Every thread taking part (the thread calling init, index 0, and the workers) owns a Chase-Lev deque:
+// the owner pushes and pops at the bottom (LIFO, cache friendly), idle threads steal from the top (FIFO, oldest and usually biggest work).
+// Dependencies are expressed with counters: submitting a job with a counter increments it, completing the job decrements it, and
+// wait(counter) runs other jobs until the counter reaches zero, so no thread ever blocks while there is work to do.
+// Jobs are small trivially copyable callables (typically lambdas capturing pointers or references), stored inline, no allocations.
+// NOTE: only the thread which called init and the workers can submit jobs
+namespace mxc
+{
+	using JobCounter = std::atomic<uint32_t>;
+
+	class JobSystem
+	{
+	public: // constants
+		static constexpr uint32_t MAX_THREADS = 64;
+		static constexpr uint32_t DEQUE_CAPACITY = 4096; // power of 2, jobs queued at the same time by one thread
+		static constexpr uint32_t JOB_STORAGE_SIZE = 48;
+
+	public: // constructors
+		JobSystem() = default;
+		JobSystem(JobSystem const&) = delete;
+		auto operator=(JobSystem const&) -> JobSystem& = delete;
+		~JobSystem() { shutdown(); }
+
+	public: // public functions
+		// threadCount includes the calling thread. 0 = one for each hardware thread
+		auto init(uint32_t threadCount = 0) & -> status_t;
+		auto shutdown() & -> void;
+
+		template <typename F>
+		auto submit(F const& function, JobCounter* counter = nullptr) & -> void;
+		// runs jobs until the counter reaches zero
+		auto wait(JobCounter const* counter) & -> void;
+
+		// calls function(begin, end) on [0, count) split in ranges of at most grainSize elements, and returns when all of them are done
+		template <typename F>
+		auto parallel_for(uint32_t count, uint32_t grainSize, F const& function) & -> void;
+
+		auto threadCount() const & -> uint32_t { return m_threadCount; }
+		static auto threadIndex() -> uint32_t; // index of the calling thread, UINT32_MAX if it doesn't belong to a job system
+
+	private: // types
+		struct Job
+		{
+			void (*invoke)(void const* storage);
+			JobCounter* counter;
+			alignas(16) unsigned char storage[JOB_STORAGE_SIZE];
+		};
+
+		// jobs live in the pool of the submitting thread, slots are recycled once their job has run
+		struct JobSlot
+		{
+			Job job;
+			std::atomic<bool> busy;
+		};
+
+		struct alignas(64) Deque
+		{
+			std::atomic<int64_t> top;
+			std::atomic<int64_t> bottom;
+			std::atomic<JobSlot*> slots[DEQUE_CAPACITY];
+			JobSlot pool[DEQUE_CAPACITY];
+			uint32_t poolHead; // touched only by the owner
+		};
+
+	private: // functions
+		auto push(Job const& job) & -> bool;
+		auto pop(uint32_t threadIdx) & -> JobSlot*;
+		auto steal(uint32_t victimIdx) & -> JobSlot*;
+		auto tryRunOne(uint32_t threadIdx) & -> bool;
+		auto execute(JobSlot* slot) & -> void;
+		auto workerLoop(uint32_t threadIdx) & -> void;
+
+	private: // data
+		uint32_t m_threadCount = 0;
+		Deque* m_deques = nullptr; // one for each thread
+		std::thread* m_workers = nullptr; // m_threadCount - 1 of them
+		std::atomic<bool> m_running{false};
+
+		// idle workers sleep here, instead of spinning
+		std::mutex m_sleepMutex;
+		std::condition_variable m_sleepCondition;
+		std::atomic<uint32_t> m_sleepingCount{0};
+		std::atomic<uint64_t> m_queuedCount{0};
+	};
+
+	template <typename F>
+	auto JobSystem::submit(F const& function, JobCounter* counter) & -> void
+	{
+		static_assert(sizeof(F) <= JOB_STORAGE_SIZE, "job callable too big, capture by reference or pointer");
+		static_assert(alignof(F) <= 16, "job callable over aligned");
+		static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>, "job callable must be trivially copyable");
+
+		Job job;
+		job.invoke = [](void const* storage) { (*static_cast<F const*>(storage))(); };
+		job.counter = counter;
+		memcpy(job.storage, &function, sizeof(F));
+
+		if (counter)
+		{
+			counter->fetch_add(1, std::memory_order_relaxed);
+		}
+		if (!push(job))
+		{
+			// queue full (or caller is not part of the job system): run it right away
+			job.invoke(job.storage);
+			if (counter)
+			{
+				counter->fetch_sub(1, std::memory_order_release);
+			}
+		}
+	}
+
+	template <typename F>
+	auto JobSystem::parallel_for(uint32_t count, uint32_t grainSize, F const& function) & -> void
+	{
+		assert(grainSize != 0);
+		if (count == 0)
+		{
+			return;
+		}
+		if (count <= grainSize || m_threadCount <= 1)
+		{
+			function(0u, count);
+			return;
+		}
+
+		JobCounter counter{0};
+		F const* functionPtr = &function;
+		// the last range is run by this thread, the others are queued, then this thread helps until all are done
+		uint32_t begin = 0;
+		for (; begin + grainSize < count; begin += grainSize)
+		{
+			uint32_t const end = begin + grainSize;
+			submit([functionPtr, begin, end]() { (*functionPtr)(begin, end); }, &counter);
+		}
+		function(begin, count);
+		wait(&counter);
+	}
+}
@@ -0,0 +1,139 @@
+#include "linear_arena.h"
+
+#include <algorithm> // max
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+namespace mxc
+{
+	namespace
+	{
+		thread_local LinearArena* t_currentArena = nullptr;
+		thread_local uint32_t t_noHeapDepth = 0;
+	}
+
+	// -- LinearArena -------------------------------------------------------------------------------------------------------------------
+	LinearArena::~LinearArena()
+	{
+		destroy();
+	}
+
+	auto LinearArena::init(size_t capacity) & -> status_t
+	{
+		assert(!m_buffer && "arena already initialized");
+		m_buffer = static_cast<unsigned char*>(::operator new(capacity, std::align_val_t{alignof(std::max_align_t)}, std::nothrow));
+		if (!m_buffer)
+		{
+			fprintf(stderr, "linear arena: couldn't reserve %lu bytes!\n", static_cast<unsigned long>(capacity));
+			return APP_GENERIC_ERR;
+		}
+		m_capacity = capacity;
+		return APP_SUCCESS;
+	}
+
+	auto LinearArena::destroy() & -> void
+	{
+		assert(m_top == 0 && "arena destroyed inside one of its scopes");
+		::operator delete(m_buffer, std::align_val_t{alignof(std::max_align_t)});
+		m_buffer = nullptr;
+		m_capacity = 0;
+	}
+
+	auto LinearArena::allocate(size_t bytes, size_t alignment) & -> void*
+	{
+		// the buffer is max_align_t aligned, so aligning the offset aligns the address, unless the alignment is bigger
+		uintptr_t const address = reinterpret_cast<uintptr_t>(m_buffer) + m_top;
+		size_t const begin = m_top + ((alignment - address % alignment) % alignment);
+		if (begin > m_capacity || bytes > m_capacity - begin)
+		{
+			return nullptr;
+		}
+		m_top = begin + bytes;
+		m_peak = std::max(m_peak, m_top);
+		++m_allocationCount;
+		return m_buffer + begin;
+	}
+
+	auto LinearArena::deallocate(void* ptr, size_t bytes) & -> void
+	{
+		unsigned char* const block = static_cast<unsigned char*>(ptr);
+		if (block + bytes == m_buffer + m_top)
+		{
+			m_top = static_cast<size_t>(block - m_buffer);
+		}
+	}
+
+	auto LinearArena::stats() const & -> Stats
+	{
+		return Stats{
+			.capacity = m_capacity,
+			.used = m_top,
+			.peak = m_peak,
+			.allocationCount = m_allocationCount,
+			.heapFallbackCount = m_heapFallbackCount
+		};
+	}
+
+	auto LinearArena::printStats() const & -> void
+	{
+		printf("linear arena stats:\n"
+			   "\tallocations: %lu, plus %lu which didn't fit and went to the heap\n"
+			   "\tin use: %lu bytes, peak %lu/%lu bytes\n",
+			   static_cast<unsigned long>(m_allocationCount), static_cast<unsigned long>(m_heapFallbackCount),
+			   static_cast<unsigned long>(m_top), static_cast<unsigned long>(m_peak), static_cast<unsigned long>(m_capacity));
+	}
+
+	auto LinearArena::current() -> LinearArena*
+	{
+		return t_currentArena;
+	}
+
+	auto LinearArena::heapAllocate(LinearArena* arena, size_t bytes, size_t alignment) -> void*
+	{
+		assert(heapAllowed() && "heap allocation inside a NoHeapScope");
+		if (arena)
+		{
+			++arena->m_heapFallbackCount;
+		}
+		return ::operator new(bytes, std::align_val_t{std::max(alignment, alignof(std::max_align_t))}, std::nothrow);
+	}
+
+	auto LinearArena::heapDeallocate(void* ptr, size_t alignment) -> void
+	{
+		::operator delete(ptr, std::align_val_t{std::max(alignment, alignof(std::max_align_t))});
+	}
+
+	// -- LinearArena::Scope ------------------------------------------------------------------------------------------------------------
+	LinearArena::Scope::Scope(LinearArena* arena)
+		: m_arena(arena), m_previous(t_currentArena), m_top(arena ? arena->m_top : 0)
+	{
+		t_currentArena = arena;
+	}
+
+	LinearArena::Scope::~Scope()
+	{
+		assert(t_currentArena == m_arena && "arena scopes must be closed in reverse order");
+		if (m_arena)
+		{
+			m_arena->m_top = m_top;
+		}
+		t_currentArena = m_previous;
+	}
+
+	// -- NoHeapScope -------------------------------------------------------------------------------------------------------------------
+	NoHeapScope::NoHeapScope()
+	{
+		++t_noHeapDepth;
+	}
+
+	NoHeapScope::~NoHeapScope()
+	{
+		--t_noHeapDepth;
+	}
+
+	auto heapAllowed() -> bool
+	{
+		return t_noHeapDepth == 0;
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "status.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+// Bump pointer arena for transient host memory, eg. the temporary arrays of the setup functions and of frame recording. Allocation is an
+// aligned increment of the top, frees are ignored except for the last block (so that a growing vector reuses its own tail), and a Scope
+// gives back everything allocated within it in O(1), by restoring the top it found. The buffer is reserved once by init and never grows:
+// when it is full allocations fall back to the heap, and are counted so that the capacity can be tuned.
+// An arena belongs to one thread at a time. ArenaAllocator takes the arena of the innermost Scope open on the calling thread, so it can be
+// used as AllocTemplate for temporaries. In debug builds, inside a NoHeapScope heap allocations of the calling thread made through
+// ArenaAllocator and HostAllocator assert
+namespace mxc
+{
+	class LinearArena
+	{
+	public:
+		struct Stats
+		{
+			size_t capacity;
+			size_t used;
+			size_t peak;
+			uint64_t allocationCount;
+			uint64_t heapFallbackCount; // allocations which didn't fit
+		};
+
+		// makes arena the current one of this thread until destruction, which frees what was allocated from it in the meantime
+		class Scope
+		{
+		public:
+			explicit Scope(LinearArena* arena);
+			Scope(Scope const&) = delete;
+			auto operator=(Scope const&) -> Scope& = delete;
+			~Scope();
+
+		private:
+			LinearArena* m_arena;
+			LinearArena* m_previous;
+			size_t m_top;
+		};
+
+	public:
+		LinearArena() = default;
+		LinearArena(LinearArena const&) = delete;
+		auto operator=(LinearArena const&) -> LinearArena& = delete;
+		~LinearArena();
+
+		auto init(size_t capacity) & -> status_t;
+		auto destroy() & -> void;
+
+		auto allocate(size_t bytes, size_t alignment) & -> void*; // null if it doesn't fit
+		auto deallocate(void* ptr, size_t bytes) & -> void; // only the last block is given back
+		auto owns(void const* ptr) const & -> bool { return ptr >= m_buffer && ptr < m_buffer + m_capacity; }
+
+		auto stats() const & -> Stats;
+		auto printStats() const & -> void;
+
+		static auto current() -> LinearArena*; // of the innermost Scope open on this thread, null if none
+		// fallback when arena, possibly null, is full. Asserts in debug builds inside a NoHeapScope
+		static auto heapAllocate(LinearArena* arena, size_t bytes, size_t alignment) -> void*;
+		static auto heapDeallocate(void* ptr, size_t alignment) -> void;
+
+	private:
+		unsigned char* m_buffer = nullptr;
+		size_t m_capacity = 0;
+		size_t m_top = 0;
+		size_t m_peak = 0;
+		uint64_t m_allocationCount = 0;
+		uint64_t m_heapFallbackCount = 0;
+	};
+
+	// marks a path which must not touch the heap, eg. frame recording in steady state. Nests, and is per thread
+	class NoHeapScope
+	{
+	public:
+		NoHeapScope();
+		NoHeapScope(NoHeapScope const&) = delete;
+		auto operator=(NoHeapScope const&) -> NoHeapScope& = delete;
+		~NoHeapScope();
+	};
+	auto heapAllowed() -> bool; // false inside a NoHeapScope
+
+	// stateful: remembers the arena current at its construction, so frees go to the right one even from an inner Scope
+	template <typename T> struct ArenaAllocator
+	{
+		using value_type = T;
+		ArenaAllocator() noexcept : arena(LinearArena::current()) {}
+		template <class U> ArenaAllocator(ArenaAllocator<U> const& other) noexcept : arena(other.arena) {}
+
+		[[nodiscard]] auto allocate(size_t n) -> T*
+		{
+			if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+			{
+				throw std::bad_array_new_length();
+			}
+			void* ptr = arena ? arena->allocate(n * sizeof(T), alignof(T)) : nullptr;
+			if (!ptr && !(ptr = LinearArena::heapAllocate(arena, n * sizeof(T), alignof(T))))
+			{
+				throw std::bad_alloc();
+			}
+			return static_cast<T*>(ptr);
+		}
+
+		auto deallocate(T* ptr, size_t n) noexcept -> void
+		{
+			if (arena && arena->owns(ptr))
+			{
+				arena->deallocate(ptr, n * sizeof(T));
+			}
+			else
+			{
+				LinearArena::heapDeallocate(ptr, alignof(T));
+			}
+		}
+
+		LinearArena* arena;
+	};
+
+	template <class T, class U> constexpr auto operator==(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b) -> bool { return a.arena == b.arena; }
+	template <class T, class U> constexpr auto operator!=(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b) -> bool { return a.arena != b.arena; }
+}
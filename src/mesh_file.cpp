@@ -0,0 +1,359 @@
+#include "mesh_file.h"
+
+#include "trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mxc
+{
+	namespace
+	{
+		auto alignUp(uint64_t offset) -> uint64_t
+		{
+			return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+		}
+
+		// whether [offset, offset + count * elementSize) is an aligned range inside a file of fileSize bytes
+		auto isInFile(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) -> bool
+		{
+			return offset % MESH_FILE_ALIGNMENT == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+		}
+
+		// maps the whole file read only, with a hint that it is going to be read once front to back
+		auto mapFile(char const* path, void const** outData, size_t* outSize) -> status_t
+		{
+#ifdef _WIN32
+			HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return APP_GENERIC_ERR;
+			}
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+			{
+				CloseHandle(file);
+				return APP_GENERIC_ERR;
+			}
+			// the view keeps the mapping, and the file, alive after the handles are closed
+			HANDLE const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			void const* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+			if (mapping)
+			{
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			if (!data)
+			{
+				return APP_GENERIC_ERR;
+			}
+			*outData = data;
+			*outSize = static_cast<size_t>(size.QuadPart);
+			return APP_SUCCESS;
+#else
+			int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+			{
+				return APP_GENERIC_ERR;
+			}
+			struct stat info;
+			if (fstat(fd, &info) != 0 || info.st_size <= 0)
+			{
+				::close(fd);
+				return APP_GENERIC_ERR;
+			}
+			size_t const size = static_cast<size_t>(info.st_size);
+			void* const data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd); // the mapping holds its own reference
+			if (data == MAP_FAILED)
+			{
+				return APP_GENERIC_ERR;
+			}
+			madvise(data, size, MADV_SEQUENTIAL);
+			madvise(data, size, MADV_WILLNEED); // starts reading ahead while the caller sets up the rest
+			*outData = data;
+			*outSize = size;
+			return APP_SUCCESS;
+#endif
+		}
+
+		auto unmapFile(void const* data, size_t size) -> void
+		{
+#ifdef _WIN32
+			(void)size;
+			UnmapViewOfFile(data);
+#else
+			munmap(const_cast<void*>(data), size);
+#endif
+		}
+	}
+
+	// -- MeshFile ----------------------------------------------------------------------------------------------------------------------
+	auto MeshFile::open(char const* path) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		close();
+		if (mapFile(path, &m_data, &m_size) != APP_SUCCESS)
+		{
+			fprintf(stderr, "mesh file: couldn't map %s\n", path);
+			return APP_GENERIC_ERR;
+		}
+		if (validate(path) != APP_SUCCESS)
+		{
+			close();
+			return APP_GENERIC_ERR;
+		}
+		printf("mapped %s: %lu meshes, %lu LODs, %lu meshlets, %lu %s vertices, %lu triangles (LODs included), %lu bytes\n", path,
+			   static_cast<unsigned long>(m_view.drawItems.size()), static_cast<unsigned long>(m_view.lods.size()),
+			   static_cast<unsigned long>(m_view.meshlets.size()), static_cast<unsigned long>(m_view.vertices.count), vertexFormatName(m_view.vertices.format),
+			   static_cast<unsigned long>(m_view.indices.count / 3), static_cast<unsigned long>(m_size));
+		return APP_SUCCESS;
+	}
+
+	auto MeshFile::close() & -> void
+	{
+		if (m_data)
+		{
+			unmapFile(m_data, m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_view = MeshView{};
+	}
+
+	auto MeshFile::validate(char const* path) & -> status_t
+	{
+		MeshFileHeader header;
+		if (m_size < sizeof(header))
+		{
+			fprintf(stderr, "mesh file: %s is too small\n", path);
+			return APP_GENERIC_ERR;
+		}
+		memcpy(&header, m_data, sizeof(header));
+		if (header.magic != MESH_FILE_MAGIC)
+		{
+			fprintf(stderr, "mesh file: %s is not an .mxm file\n", path);
+			return APP_GENERIC_ERR;
+		}
+		if (header.version != MESH_FILE_VERSION || header.vertexFormat >= VERTEX_FORMAT_COUNT
+			|| header.vertexStride != vertexStride(static_cast<VertexFormat>(header.vertexFormat))
+			|| (header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t)))
+		{
+			fprintf(stderr, "mesh file: %s has version %u (or an unknown vertex format), this build reads version %u, convert it again\n",
+					path, header.version, MESH_FILE_VERSION);
+			return APP_GENERIC_ERR;
+		}
+		if (header.fileSize != m_size
+			|| !isInFile(header.vertexOffset, header.vertexCount, header.vertexStride, m_size)
+			|| !isInFile(header.indexOffset, header.indexCount, header.indexSize, m_size)
+			|| !isInFile(header.drawItemOffset, header.drawItemCount, sizeof(DrawItem), m_size)
+			|| !isInFile(header.lodChainOffset, header.lodChainCount, sizeof(LodChain), m_size)
+			|| !isInFile(header.lodOffset, header.lodCount, sizeof(MeshLod), m_size)
+			|| (header.lodChainCount != 0 && header.lodChainCount != header.drawItemCount)
+			|| !isInFile(header.meshletRangeOffset, header.meshletRangeCount, sizeof(MeshletRange), m_size)
+			|| !isInFile(header.meshletOffset, header.meshletCount, sizeof(Meshlet), m_size)
+			|| !isInFile(header.meshletBoundsOffset, (uint64_t{header.meshletCount} + 3) / 4, sizeof(MeshletBounds4), m_size)
+			|| (header.meshletRangeCount != 0 && header.meshletRangeCount != header.drawItemCount)
+			|| header.vertexCount > static_cast<uint32_t>(INT32_MAX))
+		{
+			fprintf(stderr, "mesh file: %s is truncated or corrupted\n", path);
+			return APP_GENERIC_ERR;
+		}
+
+		unsigned char const* const bytes = static_cast<unsigned char const*>(m_data);
+		MeshView const view {
+			.vertices = VertexStream{
+				.data = std::span<std::byte const>(reinterpret_cast<std::byte const*>(bytes + header.vertexOffset), size_t{header.vertexCount} * header.vertexStride),
+				.count = header.vertexCount,
+				.format = static_cast<VertexFormat>(header.vertexFormat),
+				.positionOffset = Eigen::Vector3f(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]),
+				.positionScale = Eigen::Vector3f(header.positionScale[0], header.positionScale[1], header.positionScale[2])
+			},
+			.indices = IndexStream{
+				.data = std::span<std::byte const>(reinterpret_cast<std::byte const*>(bytes + header.indexOffset), size_t{header.indexCount} * header.indexSize),
+				.count = header.indexCount,
+				.indexSize = header.indexSize
+			},
+			.drawItems = std::span<DrawItem const>(reinterpret_cast<DrawItem const*>(bytes + header.drawItemOffset), header.drawItemCount),
+			.lodChains = std::span<LodChain const>(reinterpret_cast<LodChain const*>(bytes + header.lodChainOffset), header.lodChainCount),
+			.lods = std::span<MeshLod const>(reinterpret_cast<MeshLod const*>(bytes + header.lodOffset), header.lodCount),
+			.meshletRanges = std::span<MeshletRange const>(reinterpret_cast<MeshletRange const*>(bytes + header.meshletRangeOffset), header.meshletRangeCount),
+			.meshlets = std::span<Meshlet const>(reinterpret_cast<Meshlet const*>(bytes + header.meshletOffset), header.meshletCount),
+			.meshletBounds = std::span<MeshletBounds4 const>(reinterpret_cast<MeshletBounds4 const*>(bytes + header.meshletBoundsOffset), (uint64_t{header.meshletCount} + 3) / 4),
+			.boundsMin = Eigen::Vector3f(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+			.boundsMax = Eigen::Vector3f(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2])
+		};
+		// a draw outside of the index buffer would read out of bounds on the GPU. There are few of them, so this costs nothing
+		for (DrawItem const& drawItem : view.drawItems)
+		{
+			if (drawItem.firstIndex > view.indices.count || drawItem.indexCount > view.indices.count - drawItem.firstIndex
+				|| drawItem.vertexOffset < 0 || static_cast<uint32_t>(drawItem.vertexOffset) > header.vertexCount)
+			{
+				fprintf(stderr, "mesh file: %s has a mesh outside of its index or vertex data\n", path);
+				return APP_GENERIC_ERR;
+			}
+		}
+		for (LodChain const& chain : view.lodChains)
+		{
+			if (chain.firstLod > view.lods.size() || chain.lodCount > view.lods.size() - chain.firstLod)
+			{
+				fprintf(stderr, "mesh file: %s has a LOD chain outside of its LODs\n", path);
+				return APP_GENERIC_ERR;
+			}
+		}
+		for (MeshLod const& lod : view.lods)
+		{
+			if (lod.firstIndex > view.indices.count || lod.indexCount > view.indices.count - lod.firstIndex)
+			{
+				fprintf(stderr, "mesh file: %s has a LOD outside of its index data\n", path);
+				return APP_GENERIC_ERR;
+			}
+		}
+		for (MeshletRange const& range : view.meshletRanges)
+		{
+			if (range.firstMeshlet > view.meshlets.size() || range.meshletCount > view.meshlets.size() - range.firstMeshlet)
+			{
+				fprintf(stderr, "mesh file: %s has a meshlet range outside of its meshlets\n", path);
+				return APP_GENERIC_ERR;
+			}
+		}
+		for (Meshlet const& meshlet : view.meshlets)
+		{
+			if (meshlet.firstIndex > view.indices.count || meshlet.indexCount > view.indices.count - meshlet.firstIndex)
+			{
+				fprintf(stderr, "mesh file: %s has a meshlet outside of its index data\n", path);
+				return APP_GENERIC_ERR;
+			}
+		}
+		m_view = view;
+		return APP_SUCCESS;
+	}
+
+	auto isMeshFilePath(char const* path) -> bool
+	{
+		size_t const length = strlen(path);
+		char const extension[] = ".mxm";
+		if (length < sizeof(extension) - 1)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < sizeof(extension) - 1; ++i)
+		{
+			char const c = path[length - (sizeof(extension) - 1) + i];
+			if ((c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c) != extension[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// -- writing -----------------------------------------------------------------------------------------------------------------------
+	auto writeMeshFile(char const* path, MeshView const& mesh) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		if (mesh.vertices.count > static_cast<uint32_t>(INT32_MAX) || mesh.drawItems.size() > UINT32_MAX || mesh.lods.size() > UINT32_MAX
+			|| (!mesh.lodChains.empty() && mesh.lodChains.size() != mesh.drawItems.size()) || mesh.meshlets.size() > UINT32_MAX
+			|| (!mesh.meshletRanges.empty() && mesh.meshletRanges.size() != mesh.drawItems.size())
+			|| mesh.meshletBounds.size() != (mesh.meshlets.size() + 3) / 4)
+		{
+			fprintf(stderr, "mesh file: too much geometry for %s\n", path);
+			return APP_GENERIC_ERR;
+		}
+
+		MeshFileHeader header {
+			.magic = MESH_FILE_MAGIC,
+			.version = MESH_FILE_VERSION,
+			.vertexStride = vertexStride(mesh.vertices.format),
+			.indexSize = mesh.indices.indexSize,
+			.vertexCount = mesh.vertices.count,
+			.indexCount = mesh.indices.count,
+			.drawItemCount = static_cast<uint32_t>(mesh.drawItems.size()),
+			.vertexFormat = mesh.vertices.format,
+			.lodChainCount = static_cast<uint32_t>(mesh.lodChains.size()),
+			.lodCount = static_cast<uint32_t>(mesh.lods.size()),
+			.meshletRangeCount = static_cast<uint32_t>(mesh.meshletRanges.size()),
+			.meshletCount = static_cast<uint32_t>(mesh.meshlets.size()),
+			.boundsMin = {mesh.boundsMin.x(), mesh.boundsMin.y(), mesh.boundsMin.z()},
+			.boundsMax = {mesh.boundsMax.x(), mesh.boundsMax.y(), mesh.boundsMax.z()},
+			.positionOffset = {mesh.vertices.positionOffset.x(), mesh.vertices.positionOffset.y(), mesh.vertices.positionOffset.z()},
+			.positionScale = {mesh.vertices.positionScale.x(), mesh.vertices.positionScale.y(), mesh.vertices.positionScale.z()},
+			.vertexOffset = alignUp(sizeof(MeshFileHeader)),
+			.indexOffset = 0,
+			.drawItemOffset = 0,
+			.lodChainOffset = 0,
+			.lodOffset = 0,
+			.meshletRangeOffset = 0,
+			.meshletOffset = 0,
+			.meshletBoundsOffset = 0,
+			.fileSize = 0
+		};
+		header.indexOffset = alignUp(header.vertexOffset + mesh.vertices.data.size());
+		header.drawItemOffset = alignUp(header.indexOffset + mesh.indices.data.size());
+		header.lodChainOffset = alignUp(header.drawItemOffset + mesh.drawItems.size_bytes());
+		header.lodOffset = alignUp(header.lodChainOffset + mesh.lodChains.size_bytes());
+		header.meshletRangeOffset = alignUp(header.lodOffset + mesh.lods.size_bytes());
+		header.meshletOffset = alignUp(header.meshletRangeOffset + mesh.meshletRanges.size_bytes());
+		header.meshletBoundsOffset = alignUp(header.meshletOffset + mesh.meshlets.size_bytes());
+		header.fileSize = header.meshletBoundsOffset + mesh.meshletBounds.size_bytes();
+
+		std::filesystem::path const finalPath(path);
+		std::filesystem::path tmpPath = finalPath;
+		tmpPath += ".tmp";
+		bool written;
+		{
+			std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+			char const padding[MESH_FILE_ALIGNMENT] {};
+			// each array is preceded by the padding up to its offset
+			auto const writeAt = [&file, &padding](uint64_t offset, void const* data, size_t size) -> bool {
+				uint64_t const position = static_cast<uint64_t>(file.tellp());
+				return file.write(padding, static_cast<std::streamsize>(offset - position))
+					&& file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+			};
+			written = file
+				&& writeAt(0, &header, sizeof(header))
+				&& writeAt(header.vertexOffset, mesh.vertices.data.data(), mesh.vertices.data.size())
+				&& writeAt(header.indexOffset, mesh.indices.data.data(), mesh.indices.data.size())
+				&& writeAt(header.drawItemOffset, mesh.drawItems.data(), mesh.drawItems.size_bytes())
+				&& writeAt(header.lodChainOffset, mesh.lodChains.data(), mesh.lodChains.size_bytes())
+				&& writeAt(header.lodOffset, mesh.lods.data(), mesh.lods.size_bytes())
+				&& writeAt(header.meshletRangeOffset, mesh.meshletRanges.data(), mesh.meshletRanges.size_bytes())
+				&& writeAt(header.meshletOffset, mesh.meshlets.data(), mesh.meshlets.size_bytes())
+				&& writeAt(header.meshletBoundsOffset, mesh.meshletBounds.data(), mesh.meshletBounds.size_bytes())
+				&& file.flush();
+		} // closed before it is removed or renamed, which some platforms don't allow on open files
+		std::error_code errorCode;
+		if (!written)
+		{
+			fprintf(stderr, "mesh file: failed to write %s\n", tmpPath.string().c_str());
+			std::filesystem::remove(tmpPath, errorCode); // a partial file, if it was created at all
+			return APP_GENERIC_ERR;
+		}
+		std::filesystem::rename(tmpPath, finalPath, errorCode);
+		if (errorCode)
+		{
+			fprintf(stderr, "mesh file: failed to replace %s: %s\n", path, errorCode.message().c_str());
+			std::filesystem::remove(tmpPath, errorCode);
+			return APP_GENERIC_ERR;
+		}
+		return APP_SUCCESS;
+	}
+}
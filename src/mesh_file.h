@@ -0,0 +1,79 @@
+#pragma once
+
+#include "status.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// .mxm, the engine's own mesh container, produced offline (VulkanLearningMeshConvert) from any format importMesh reads. It is a header
+// followed by the vertex, index, DrawItem, LOD (LodChain, MeshLod) and meshlet (MeshletRange, Meshlet, MeshletBounds4) arrays exactly as the renderer uploads them, vertices in any VertexFormat, each array
+// starting at a MESH_FILE_ALIGNMENT offset: loading is a memory mapping and a validation of the header, and the renderer memcpys the
+// mapped arrays straight into staging memory, so load time is bound by the disk rather than by parsing.
+// Little endian, like every platform the renderer runs on. The version changes whenever the header or a vertex layout does, and old
+// files must be converted again. Index values are not checked against the vertex count, that would mean reading the whole file up
+// front: files are trusted to come from the converter
+namespace mxc
+{
+	inline constexpr uint32_t MESH_FILE_MAGIC = 0x464d584d; // "MXMF" in file order
+	inline constexpr uint32_t MESH_FILE_VERSION = 4;
+	inline constexpr uint64_t MESH_FILE_ALIGNMENT = 64;
+
+	struct MeshFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vertexStride; // of vertexFormat when written
+		uint32_t indexSize; // 2 or 4
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t drawItemCount;
+		uint32_t vertexFormat; // VertexFormat
+		uint32_t lodChainCount; // drawItemCount, or 0 without LODs
+		uint32_t lodCount;
+		uint32_t meshletRangeCount; // drawItemCount, or 0 without meshlets
+		uint32_t meshletCount; // MeshletBounds4 are (meshletCount + 3) / 4
+		float boundsMin[3];
+		float boundsMax[3];
+		float positionOffset[3]; // VertexStream dequantization
+		float positionScale[3];
+		uint64_t vertexOffset; // from the start of the file, for each array
+		uint64_t indexOffset;
+		uint64_t drawItemOffset;
+		uint64_t lodChainOffset;
+		uint64_t lodOffset;
+		uint64_t meshletRangeOffset;
+		uint64_t meshletOffset;
+		uint64_t meshletBoundsOffset;
+		uint64_t fileSize;
+	};
+	static_assert(sizeof(MeshFileHeader) == 168);
+
+	// a read only mapping of an .mxm file. The view stays valid until close or destruction
+	class MeshFile
+	{
+	public:
+		MeshFile() = default;
+		MeshFile(MeshFile const&) = delete;
+		auto operator=(MeshFile const&) -> MeshFile& = delete;
+		~MeshFile() { close(); }
+
+		auto open(char const* path) & -> status_t;
+		auto close() & -> void;
+
+		auto view() const & -> MeshView { return m_view; }
+		auto size() const & -> size_t { return m_size; }
+
+	private:
+		auto validate(char const* path) & -> status_t; // fills m_view
+
+	private:
+		void const* m_data = nullptr;
+		size_t m_size = 0;
+		MeshView m_view {};
+	};
+
+	auto isMeshFilePath(char const* path) -> bool; // by extension, case insensitive
+	// writes mesh as .mxm, through a temporary file renamed at the end, so a failed conversion never leaves a truncated file behind
+	auto writeMeshFile(char const* path, MeshView const& mesh) -> status_t;
+}
@@ -0,0 +1,1326 @@
+#include "mesh_import.h"
+
+#include "job_system.h"
+#include "trace.h"
+
+#include <algorithm> // min, max, sort, unique
+#include <bit> // bit_ceil
+#include <cassert>
+#include <charconv> // from_chars
+#include <cmath> // floor
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace mxc
+{
+	namespace
+	{
+		inline constexpr size_t OBJ_CHUNK_SIZE = 1u << 20; // bytes of OBJ text parsed by one job
+		inline constexpr uint32_t NO_INDEX = UINT32_MAX;
+		inline constexpr uint32_t JSON_MAX_DEPTH = 64;
+		inline constexpr uint64_t JSON_MAX_INTEGER = uint64_t{1} << 53; // larger ones aren't exact in a double
+		inline constexpr uint32_t GLTF_MAX_NODE_DEPTH = 64;
+		inline constexpr size_t VERTEX_ENCODE_CHUNK = 1u << 16; // vertices encoded by one job
+
+		// -- shared --------------------------------------------------------------------------------------------------------------------
+		// one DrawItem, decoded by one job independently of the others
+		struct MeshPart
+		{
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+			Eigen::Vector3f boundsMin = Eigen::Vector3f::Zero(); // set by computeBounds
+			Eigen::Vector3f boundsMax = Eigen::Vector3f::Zero();
+			status_t status;
+		};
+
+		// function(i) for i in [0, count), on the job system if any
+		template <typename F> auto forEach(JobSystem* jobSystem, uint32_t count, F const& function) -> void
+		{
+			if (!jobSystem)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					function(i);
+				}
+				return;
+			}
+			jobSystem->parallel_for(count, /*grainSize*/1, [&function](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					function(i);
+				}
+			});
+		}
+
+		auto readFile(std::filesystem::path const& path, std::vector<char>* outData) -> bool
+		{
+			std::ifstream file{path, std::ios::binary | std::ios::ate};
+			if (!file)
+			{
+				return false;
+			}
+			std::streamsize const size = file.tellg();
+			if (size < 0)
+			{
+				return false;
+			}
+			outData->resize(static_cast<size_t>(size));
+			file.seekg(0);
+			return static_cast<bool>(file.read(outData->data(), size));
+		}
+
+		auto colorFromNormal(Eigen::Vector3f const& normal) -> Eigen::Vector3f
+		{
+			float const length = normal.norm();
+			if (length == 0.f)
+			{
+				return Eigen::Vector3f(.8f, .8f, .8f);
+			}
+			return (normal / length) * .5f + Eigen::Vector3f::Constant(.5f);
+		}
+
+		auto computeBounds(MeshPart* part) -> void
+		{
+			part->boundsMin = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+			part->boundsMax = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+			for (Vertex const& vertex : part->vertices)
+			{
+				part->boundsMin = part->boundsMin.cwiseMin(vertex.pos);
+				part->boundsMax = part->boundsMax.cwiseMax(vertex.pos);
+			}
+		}
+
+		// open addressing, linear probing. Sized for at most 2/3 load even if every key is unique
+		struct DedupeTable
+		{
+			explicit DedupeTable(size_t maxKeys)
+				: mask(std::bit_ceil(std::max<size_t>(16, maxKeys + maxKeys / 2)) - 1), slots(mask + 1, NO_INDEX)
+			{
+			}
+			size_t mask;
+			std::vector<uint32_t> slots; // index of the unique vertex, NO_INDEX if empty
+		};
+
+		auto hashBytes(void const* data, size_t size) -> uint64_t
+		{
+			// FNV-1a, then mixed so that the low bits, which pick the slot, depend on all of them
+			uint64_t hash = 14695981039346656037ull;
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash = (hash ^ static_cast<unsigned char const*>(data)[i]) * 1099511628211ull;
+			}
+			return hash ^ (hash >> 29);
+		}
+
+		// concatenates the parts, in order, skipping empty ones
+		auto assemble(std::vector<MeshPart>& parts, JobSystem* jobSystem, MeshData* outMesh) -> void
+		{
+			MXC_TRACE_SCOPE("mesh import assemble");
+			std::vector<size_t> vertexBases(parts.size());
+			std::vector<size_t> indexBases(parts.size());
+			size_t vertexCount = 0;
+			size_t indexCount = 0;
+			outMesh->drawItems.clear();
+			outMesh->boundsMin = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+			outMesh->boundsMax = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+			for (size_t i = 0; i < parts.size(); ++i)
+			{
+				vertexBases[i] = vertexCount;
+				indexBases[i] = indexCount;
+				if (parts[i].indices.empty())
+				{
+					continue;
+				}
+				outMesh->drawItems.push_back(DrawItem{
+					.indexCount = static_cast<uint32_t>(parts[i].indices.size()),
+					.firstIndex = static_cast<uint32_t>(indexCount),
+					.vertexOffset = static_cast<int32_t>(vertexCount)
+				});
+				outMesh->boundsMin = outMesh->boundsMin.cwiseMin(parts[i].boundsMin);
+				outMesh->boundsMax = outMesh->boundsMax.cwiseMax(parts[i].boundsMax);
+				vertexCount += parts[i].vertices.size();
+				indexCount += parts[i].indices.size();
+			}
+			if (outMesh->drawItems.empty())
+			{
+				outMesh->boundsMin = outMesh->boundsMax = Eigen::Vector3f::Zero();
+			}
+
+			outMesh->vertices.resize(vertexCount);
+			outMesh->indices.resize(indexCount);
+			forEach(jobSystem, static_cast<uint32_t>(parts.size()), [&parts, &vertexBases, &indexBases, outMesh](uint32_t i) {
+				std::copy(parts[i].vertices.begin(), parts[i].vertices.end(), outMesh->vertices.begin() + vertexBases[i]);
+				std::copy(parts[i].indices.begin(), parts[i].indices.end(), outMesh->indices.begin() + indexBases[i]);
+				parts[i] = MeshPart{}; // give the memory back early, the peak is already 2x the mesh
+			});
+		}
+
+		// -- OBJ -----------------------------------------------------------------------------------------------------------------------
+		inline constexpr uint8_t OBJ_POSITION_RELATIVE = 1; // the index is relative to the first position of the chunk
+		inline constexpr uint8_t OBJ_NORMAL_RELATIVE = 2;
+
+		struct ObjCorner
+		{
+			int64_t position; // 0 based
+			int64_t normal; // 0 based, -1 if none
+			uint8_t flags;
+		};
+
+		struct ObjChunk
+		{
+			char const* begin;
+			char const* end;
+			std::vector<float> positions; // xyz
+			std::vector<float> colors; // rgb for each position, r < 0 if it has none
+			std::vector<float> normals; // xyz
+			std::vector<ObjCorner> corners; // 3 for each triangle
+			std::vector<uint32_t> meshStarts; // chunk triangle indices where an o, g or usemtl line starts a new mesh
+			size_t positionBase; // counts in the previous chunks
+			size_t normalBase;
+			size_t triangleBase;
+			char const* errorLine; // first malformed line, if any
+		};
+
+		auto isBlank(char c) -> bool
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		auto skipBlanks(char const* p, char const* end) -> char const*
+		{
+			while (p < end && isBlank(*p))
+			{
+				++p;
+			}
+			return p;
+		}
+
+		// keyword followed by a blank (or the end of the line)
+		auto isKeyword(char const* p, char const* end, std::string_view keyword) -> bool
+		{
+			size_t const size = keyword.size();
+			return static_cast<size_t>(end - p) >= size && memcmp(p, keyword.data(), size) == 0 && (p + size == end || isBlank(p[size]));
+		}
+
+		auto parseFloats(char const* p, char const* end, float* out, uint32_t maxCount) -> uint32_t
+		{
+			uint32_t count = 0;
+			for (; count < maxCount; ++count)
+			{
+				p = skipBlanks(p, end);
+				auto const [next, error] = std::from_chars(p, end, out[count]);
+				if (error != std::errc())
+				{
+					break;
+				}
+				p = next;
+			}
+			return count;
+		}
+
+		auto parseObjChunk(ObjChunk* chunk) -> void
+		{
+			MXC_TRACE_SCOPE("obj parse chunk");
+			std::vector<ObjCorner> polygon;
+			char const* line = chunk->begin;
+			while (line < chunk->end && !chunk->errorLine)
+			{
+				char const* lineEnd = static_cast<char const*>(memchr(line, '\n', static_cast<size_t>(chunk->end - line)));
+				lineEnd = lineEnd ? lineEnd : chunk->end;
+				char const* p = skipBlanks(line, lineEnd);
+
+				if (isKeyword(p, lineEnd, "v"))
+				{
+					float values[6];
+					uint32_t const count = parseFloats(p + 1, lineEnd, values, 6);
+					if (count < 3)
+					{
+						chunk->errorLine = line;
+						break;
+					}
+					chunk->positions.insert(chunk->positions.end(), values, values + 3);
+					// w, if present, is ignored. Colors are an extension: "v x y z r g b"
+					float const noColor[3] {-1.f, -1.f, -1.f};
+					chunk->colors.insert(chunk->colors.end(), count == 6 ? values + 3 : noColor, count == 6 ? values + 6 : noColor + 3);
+				}
+				else if (isKeyword(p, lineEnd, "vn"))
+				{
+					float values[3];
+					if (parseFloats(p + 2, lineEnd, values, 3) != 3)
+					{
+						chunk->errorLine = line;
+						break;
+					}
+					chunk->normals.insert(chunk->normals.end(), values, values + 3);
+				}
+				else if (isKeyword(p, lineEnd, "f"))
+				{
+					// corners are v, v/vt, v//vn or v/vt/vn. Negative indices count back from the last element defined so far
+					polygon.clear();
+					p = skipBlanks(p + 1, lineEnd);
+					while (p < lineEnd)
+					{
+						int64_t indices[3] {0, 0, 0};
+						for (uint32_t i = 0; i < 3 && p < lineEnd && !isBlank(*p); ++i)
+						{
+							auto const [next, error] = std::from_chars(p, lineEnd, indices[i]);
+							p = error == std::errc() ? next : p;
+							if (p < lineEnd && *p == '/')
+							{
+								++p;
+							}
+						}
+						if (indices[0] == 0)
+						{
+							chunk->errorLine = line;
+							break;
+						}
+						int64_t const positionCount = static_cast<int64_t>(chunk->positions.size() / 3);
+						int64_t const normalCount = static_cast<int64_t>(chunk->normals.size() / 3);
+						polygon.push_back(ObjCorner{
+							.position = indices[0] > 0 ? indices[0] - 1 : positionCount + indices[0],
+							.normal = indices[2] > 0 ? indices[2] - 1 : (indices[2] < 0 ? normalCount + indices[2] : -1),
+							.flags = static_cast<uint8_t>((indices[0] < 0 ? OBJ_POSITION_RELATIVE : 0) | (indices[2] < 0 ? OBJ_NORMAL_RELATIVE : 0))
+						});
+						p = skipBlanks(p, lineEnd);
+					}
+					for (size_t i = 2; i < polygon.size(); ++i)
+					{
+						chunk->corners.insert(chunk->corners.end(), {polygon[0], polygon[i - 1], polygon[i]});
+					}
+				}
+				else if (isKeyword(p, lineEnd, "o") || isKeyword(p, lineEnd, "g") || isKeyword(p, lineEnd, "usemtl"))
+				{
+					uint32_t const triangle = static_cast<uint32_t>(chunk->corners.size() / 3);
+					if (chunk->meshStarts.empty() || chunk->meshStarts.back() != triangle)
+					{
+						chunk->meshStarts.push_back(triangle);
+					}
+				}
+				// anything else (vt, comments, s, mtllib, lines, points) is ignored
+				line = lineEnd + 1;
+			}
+		}
+
+		// makes chunk indices global, checking them
+		auto resolveObjChunk(ObjChunk* chunk, size_t positionCount, size_t normalCount) -> bool
+		{
+			for (ObjCorner& corner : chunk->corners)
+			{
+				corner.position += (corner.flags & OBJ_POSITION_RELATIVE) ? static_cast<int64_t>(chunk->positionBase) : 0;
+				corner.normal += (corner.flags & OBJ_NORMAL_RELATIVE) ? static_cast<int64_t>(chunk->normalBase) : 0;
+				if (corner.position < 0 || corner.position >= static_cast<int64_t>(positionCount) || corner.normal >= static_cast<int64_t>(normalCount)
+					|| corner.normal < -1)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		struct ObjAttributes
+		{
+			std::vector<float> positions;
+			std::vector<float> colors;
+			std::vector<float> normals;
+		};
+
+		// corners of triangles [firstTriangle, lastTriangle), which can span several chunks
+		auto decodeObjMesh(std::vector<ObjChunk> const& chunks, ObjAttributes const& attributes, size_t firstTriangle, size_t lastTriangle, MeshPart* outPart) -> void
+		{
+			MXC_TRACE_SCOPE("obj decode mesh");
+			size_t const cornerCount = 3 * (lastTriangle - firstTriangle);
+			DedupeTable table(cornerCount);
+			std::vector<uint64_t> keys; // of the unique vertices: position << 32 | (normal + 1)
+			outPart->indices.reserve(cornerCount);
+
+			size_t chunkIdx = 0;
+			while (chunks[chunkIdx].triangleBase + chunks[chunkIdx].corners.size() / 3 <= firstTriangle)
+			{
+				++chunkIdx;
+			}
+			for (size_t triangle = firstTriangle; triangle < lastTriangle; ++triangle)
+			{
+				while (triangle >= chunks[chunkIdx].triangleBase + chunks[chunkIdx].corners.size() / 3)
+				{
+					++chunkIdx;
+				}
+				ObjCorner const* corners = &chunks[chunkIdx].corners[3 * (triangle - chunks[chunkIdx].triangleBase)];
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					uint64_t const key = (static_cast<uint64_t>(corners[c].position) << 32) | static_cast<uint64_t>(corners[c].normal + 1);
+					size_t slot = hashBytes(&key, sizeof(key)) & table.mask;
+					while (table.slots[slot] != NO_INDEX && keys[table.slots[slot]] != key)
+					{
+						slot = (slot + 1) & table.mask;
+					}
+					if (table.slots[slot] == NO_INDEX)
+					{
+						table.slots[slot] = static_cast<uint32_t>(keys.size());
+						keys.push_back(key);
+					}
+					outPart->indices.push_back(table.slots[slot]);
+				}
+			}
+
+			outPart->vertices.resize(keys.size());
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				size_t const position = static_cast<size_t>(keys[i] >> 32);
+				int64_t const normal = static_cast<int64_t>(keys[i] & 0xffffffffu) - 1;
+				Vertex& vertex = outPart->vertices[i];
+				vertex.pos = Eigen::Vector3f(attributes.positions[3 * position], attributes.positions[3 * position + 1], attributes.positions[3 * position + 2]);
+				if (attributes.colors[3 * position] >= 0.f)
+				{
+					vertex.col = Eigen::Vector3f(attributes.colors[3 * position], attributes.colors[3 * position + 1], attributes.colors[3 * position + 2]);
+				}
+				else
+				{
+					vertex.col = normal < 0 ? Eigen::Vector3f(.8f, .8f, .8f)
+						: colorFromNormal(Eigen::Vector3f(attributes.normals[3 * normal], attributes.normals[3 * normal + 1], attributes.normals[3 * normal + 2]));
+				}
+			}
+			computeBounds(outPart);
+			outPart->status = APP_SUCCESS;
+		}
+
+		auto importObj(std::vector<char> const& text, JobSystem* jobSystem, std::vector<MeshPart>* outParts) -> status_t
+		{
+			// -- split at line boundaries, parse in parallel -----------------------------------------------------------------------------
+			char const* const end = text.data() + text.size();
+			std::vector<ObjChunk> chunks;
+			for (char const* begin = text.data(); begin < end;)
+			{
+				char const* chunkEnd = begin + std::min(OBJ_CHUNK_SIZE, static_cast<size_t>(end - begin));
+				char const* const newline = static_cast<char const*>(memchr(chunkEnd - 1, '\n', static_cast<size_t>(end - chunkEnd + 1)));
+				chunkEnd = newline ? newline + 1 : end;
+				chunks.push_back(ObjChunk{.begin = begin, .end = chunkEnd, .positions = {}, .colors = {}, .normals = {}, .corners = {}, .meshStarts = {},
+										  .positionBase = 0, .normalBase = 0, .triangleBase = 0, .errorLine = nullptr});
+				begin = chunkEnd;
+			}
+			forEach(jobSystem, static_cast<uint32_t>(chunks.size()), [&chunks](uint32_t i) { parseObjChunk(&chunks[i]); });
+
+			// -- global indices: chunk bases are the counts of the chunks before --------------------------------------------------------
+			size_t positionCount = 0;
+			size_t normalCount = 0;
+			size_t triangleCount = 0;
+			std::vector<size_t> meshStarts {0};
+			for (ObjChunk& chunk : chunks)
+			{
+				if (chunk.errorLine)
+				{
+					char const* const lineEnd = static_cast<char const*>(memchr(chunk.errorLine, '\n', static_cast<size_t>(end - chunk.errorLine)));
+					fprintf(stderr, "obj import: malformed line \"%.*s\"\n", static_cast<int>(std::min<ptrdiff_t>((lineEnd ? lineEnd : end) - chunk.errorLine, 80)), chunk.errorLine);
+					return APP_GENERIC_ERR;
+				}
+				chunk.positionBase = positionCount;
+				chunk.normalBase = normalCount;
+				chunk.triangleBase = triangleCount;
+				for (uint32_t start : chunk.meshStarts)
+				{
+					meshStarts.push_back(triangleCount + start);
+				}
+				positionCount += chunk.positions.size() / 3;
+				normalCount += chunk.normals.size() / 3;
+				triangleCount += chunk.corners.size() / 3;
+			}
+			if (positionCount >= NO_INDEX || normalCount >= NO_INDEX)
+			{
+				fprintf(stderr, "obj import: more than 2^32 positions or normals\n");
+				return APP_GENERIC_ERR;
+			}
+			meshStarts.push_back(triangleCount);
+			meshStarts.erase(std::unique(meshStarts.begin(), meshStarts.end()), meshStarts.end()); // already sorted
+
+			ObjAttributes attributes;
+			attributes.positions.resize(3 * positionCount);
+			attributes.colors.resize(3 * positionCount);
+			attributes.normals.resize(3 * normalCount);
+			std::vector<uint8_t> resolved(chunks.size());
+			forEach(jobSystem, static_cast<uint32_t>(chunks.size()), [&chunks, &attributes, &resolved, positionCount, normalCount](uint32_t i) {
+				ObjChunk& chunk = chunks[i];
+				std::copy(chunk.positions.begin(), chunk.positions.end(), attributes.positions.begin() + 3 * chunk.positionBase);
+				std::copy(chunk.colors.begin(), chunk.colors.end(), attributes.colors.begin() + 3 * chunk.positionBase);
+				std::copy(chunk.normals.begin(), chunk.normals.end(), attributes.normals.begin() + 3 * chunk.normalBase);
+				resolved[i] = resolveObjChunk(&chunk, positionCount, normalCount);
+			});
+			if (std::find(resolved.begin(), resolved.end(), uint8_t{0}) != resolved.end())
+			{
+				fprintf(stderr, "obj import: face index out of range\n");
+				return APP_GENERIC_ERR;
+			}
+
+			// -- one mesh for each range between o, g, usemtl lines, deduplicated in parallel ------------------------------------------
+			outParts->resize(meshStarts.size() - 1);
+			forEach(jobSystem, static_cast<uint32_t>(outParts->size()), [&chunks, &attributes, &meshStarts, outParts](uint32_t i) {
+				decodeObjMesh(chunks, attributes, meshStarts[i], meshStarts[i + 1], &(*outParts)[i]);
+			});
+			return APP_SUCCESS;
+		}
+
+		// -- JSON, just what glTF needs ------------------------------------------------------------------------------------------------
+		// a DOM in one array. Strings are views on the text, escapes left as they are (glTF names and URIs seldom have any)
+		class JsonDocument
+		{
+		public:
+			enum class Type : uint8_t { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+			static inline constexpr uint32_t NONE = UINT32_MAX;
+			static inline constexpr uint64_t NO_INTEGER = UINT64_MAX;
+
+			auto parse(std::string_view text) & -> bool
+			{
+				m_nodes.clear();
+				m_cursor = text.data();
+				m_end = text.data() + text.size();
+				return parseValue(0) != NONE && (skipSpaces(), m_cursor == m_end);
+			}
+
+			auto type(uint32_t node) const & -> Type { return m_nodes[node].type; }
+			// NONE if node is NONE, not an object or doesn't have key
+			auto member(uint32_t node, std::string_view key) const & -> uint32_t
+			{
+				if (node == NONE || m_nodes[node].type != Type::OBJECT)
+				{
+					return NONE;
+				}
+				for (uint32_t child = m_nodes[node].firstChild; child != NONE; child = m_nodes[child].nextSibling)
+				{
+					if (m_nodes[child].key == key)
+					{
+						return child;
+					}
+				}
+				return NONE;
+			}
+			// children of an array or object, for indexed access
+			auto elements(uint32_t node) const & -> std::vector<uint32_t>
+			{
+				std::vector<uint32_t> children;
+				for (uint32_t child = node == NONE ? NONE : m_nodes[node].firstChild; child != NONE; child = m_nodes[child].nextSibling)
+				{
+					children.push_back(child);
+				}
+				return children;
+			}
+			auto number(uint32_t node, double fallback) const & -> double
+			{
+				return node != NONE && m_nodes[node].type == Type::NUMBER ? m_nodes[node].number : fallback;
+			}
+			// glTF indices, counts and sizes. fallback if node is NONE, NO_INTEGER if it isn't a number in [0, max] without a fraction, as
+			// casting a negative or too large double to an unsigned integer is undefined
+			auto integer(uint32_t node, uint64_t fallback, uint64_t max) const & -> uint64_t
+			{
+				assert(max <= JSON_MAX_INTEGER);
+				if (node == NONE)
+				{
+					return fallback;
+				}
+				double const value = m_nodes[node].type == Type::NUMBER ? m_nodes[node].number : -1.;
+				return value >= 0. && value <= static_cast<double>(max) && value == std::floor(value) ? static_cast<uint64_t>(value) : NO_INTEGER;
+			}
+			// NO_INDEX if node is NONE or not a valid index
+			auto index(uint32_t node) const & -> uint32_t
+			{
+				uint64_t const value = integer(node, NO_INDEX, NO_INDEX - 1);
+				return value == NO_INTEGER ? NO_INDEX : static_cast<uint32_t>(value);
+			}
+			auto string(uint32_t node) const & -> std::string_view
+			{
+				return node != NONE && m_nodes[node].type == Type::STRING ? m_nodes[node].string : std::string_view();
+			}
+			// fills at most count numbers of an array, returns how many
+			auto numbers(uint32_t node, float* out, uint32_t count) const & -> uint32_t
+			{
+				uint32_t i = 0;
+				for (uint32_t child = node == NONE ? NONE : m_nodes[node].firstChild; child != NONE && i < count; child = m_nodes[child].nextSibling)
+				{
+					out[i++] = static_cast<float>(number(child, 0.));
+				}
+				return i;
+			}
+
+		private:
+			struct Node
+			{
+				Type type;
+				double number; // numbers and booleans
+				std::string_view string;
+				std::string_view key; // if member of an object
+				uint32_t firstChild;
+				uint32_t nextSibling;
+			};
+
+			auto skipSpaces() & -> void
+			{
+				while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\n' || *m_cursor == '\r'))
+				{
+					++m_cursor;
+				}
+			}
+
+			auto parseString(std::string_view* out) & -> bool
+			{
+				if (m_cursor == m_end || *m_cursor != '"')
+				{
+					return false;
+				}
+				char const* const begin = ++m_cursor;
+				while (m_cursor < m_end && *m_cursor != '"')
+				{
+					m_cursor += *m_cursor == '\\' ? 2 : 1;
+				}
+				if (m_cursor >= m_end)
+				{
+					return false;
+				}
+				*out = std::string_view(begin, static_cast<size_t>(m_cursor - begin));
+				++m_cursor;
+				return true;
+			}
+
+			auto literal(std::string_view word) & -> bool
+			{
+				if (static_cast<size_t>(m_end - m_cursor) < word.size() || memcmp(m_cursor, word.data(), word.size()) != 0)
+				{
+					return false;
+				}
+				m_cursor += word.size();
+				return true;
+			}
+
+			auto parseValue(uint32_t depth) & -> uint32_t
+			{
+				skipSpaces();
+				if (m_cursor == m_end || depth > JSON_MAX_DEPTH)
+				{
+					return NONE;
+				}
+				uint32_t const node = static_cast<uint32_t>(m_nodes.size());
+				m_nodes.push_back(Node{.type = Type::NUL, .number = 0., .string = {}, .key = {}, .firstChild = NONE, .nextSibling = NONE});
+				char const c = *m_cursor;
+				if (c == '{' || c == '[')
+				{
+					bool const isObject = c == '{';
+					m_nodes[node].type = isObject ? Type::OBJECT : Type::ARRAY;
+					++m_cursor;
+					skipSpaces();
+					uint32_t lastChild = NONE;
+					if (m_cursor < m_end && *m_cursor == (isObject ? '}' : ']'))
+					{
+						++m_cursor;
+						return node;
+					}
+					while (true)
+					{
+						std::string_view key;
+						if (isObject)
+						{
+							skipSpaces();
+							if (!parseString(&key) || (skipSpaces(), m_cursor == m_end || *m_cursor != ':'))
+							{
+								return NONE;
+							}
+							++m_cursor;
+						}
+						uint32_t const child = parseValue(depth + 1);
+						if (child == NONE)
+						{
+							return NONE;
+						}
+						m_nodes[child].key = key;
+						(lastChild == NONE ? m_nodes[node].firstChild : m_nodes[lastChild].nextSibling) = child;
+						lastChild = child;
+						skipSpaces();
+						if (m_cursor < m_end && *m_cursor == ',')
+						{
+							++m_cursor;
+							continue;
+						}
+						if (m_cursor < m_end && *m_cursor == (isObject ? '}' : ']'))
+						{
+							++m_cursor;
+							return node;
+						}
+						return NONE;
+					}
+				}
+				if (c == '"')
+				{
+					m_nodes[node].type = Type::STRING;
+					std::string_view string;
+					if (!parseString(&string))
+					{
+						return NONE;
+					}
+					m_nodes[node].string = string;
+					return node;
+				}
+				if (literal("true") || literal("false"))
+				{
+					m_nodes[node].type = Type::BOOLEAN;
+					m_nodes[node].number = c == 't' ? 1. : 0.;
+					return node;
+				}
+				if (literal("null"))
+				{
+					return node;
+				}
+				double number = 0.;
+				auto const [next, error] = std::from_chars(m_cursor, m_end, number);
+				if (error != std::errc())
+				{
+					return NONE;
+				}
+				m_cursor = next;
+				m_nodes[node].type = Type::NUMBER;
+				m_nodes[node].number = number;
+				return node;
+			}
+
+			std::vector<Node> m_nodes;
+			char const* m_cursor = nullptr;
+			char const* m_end = nullptr;
+		};
+
+		// -- glTF ----------------------------------------------------------------------------------------------------------------------
+		inline constexpr uint32_t GLTF_BYTE = 5120;
+		inline constexpr uint32_t GLTF_UNSIGNED_BYTE = 5121;
+		inline constexpr uint32_t GLTF_SHORT = 5122;
+		inline constexpr uint32_t GLTF_UNSIGNED_SHORT = 5123;
+		inline constexpr uint32_t GLTF_UNSIGNED_INT = 5125;
+		inline constexpr uint32_t GLTF_FLOAT = 5126;
+		inline constexpr uint32_t GLTF_TRIANGLES = 4;
+		inline constexpr uint32_t GLTF_TRIANGLE_STRIP = 5;
+		inline constexpr uint32_t GLTF_TRIANGLE_FAN = 6;
+		inline constexpr uint32_t GLB_MAGIC = 0x46546c67; // "glTF"
+		inline constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+		inline constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+		struct GltfBuffer
+		{
+			std::vector<char> data; // empty for the .glb BIN chunk, which stays in the file data
+			char const* bytes;
+			size_t size;
+		};
+
+		struct GltfAccessor
+		{
+			char const* data; // first element
+			size_t stride;
+			uint32_t count;
+			uint32_t componentType;
+			uint32_t componentCount;
+			bool normalized;
+		};
+
+		// a primitive, and the world transform of the node instancing it
+		struct GltfDraw
+		{
+			uint32_t primitive;
+			Eigen::Matrix4f world;
+		};
+
+		struct GltfScene
+		{
+			JsonDocument json;
+			std::vector<GltfBuffer> buffers;
+			std::vector<uint32_t> bufferViews;
+			std::vector<uint32_t> accessors;
+			std::vector<GltfDraw> draws;
+		};
+
+		auto componentSize(uint32_t componentType) -> size_t
+		{
+			switch (componentType)
+			{
+				case GLTF_BYTE: case GLTF_UNSIGNED_BYTE: return 1;
+				case GLTF_SHORT: case GLTF_UNSIGNED_SHORT: return 2;
+				case GLTF_UNSIGNED_INT: case GLTF_FLOAT: return 4;
+				default: return 0;
+			}
+		}
+
+		auto componentCount(std::string_view type) -> uint32_t
+		{
+			return type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+		}
+
+		auto readComponent(GltfAccessor const& accessor, uint32_t element, uint32_t component) -> float
+		{
+			char const* const p = accessor.data + element * accessor.stride + component * componentSize(accessor.componentType);
+			switch (accessor.componentType)
+			{
+				case GLTF_FLOAT: { float v; memcpy(&v, p, 4); return v; }
+				case GLTF_UNSIGNED_BYTE: { uint8_t v; memcpy(&v, p, 1); return accessor.normalized ? v / 255.f : v; }
+				case GLTF_UNSIGNED_SHORT: { uint16_t v; memcpy(&v, p, 2); return accessor.normalized ? v / 65535.f : v; }
+				case GLTF_BYTE: { int8_t v; memcpy(&v, p, 1); return accessor.normalized ? std::max(v / 127.f, -1.f) : v; }
+				case GLTF_SHORT: { int16_t v; memcpy(&v, p, 2); return accessor.normalized ? std::max(v / 32767.f, -1.f) : v; }
+				case GLTF_UNSIGNED_INT: { uint32_t v; memcpy(&v, p, 4); return static_cast<float>(v); }
+				default: return 0.f;
+			}
+		}
+
+		auto readIndex(GltfAccessor const& accessor, uint32_t element) -> uint32_t
+		{
+			char const* const p = accessor.data + element * accessor.stride;
+			switch (accessor.componentType)
+			{
+				case GLTF_UNSIGNED_BYTE: { uint8_t v; memcpy(&v, p, 1); return v; }
+				case GLTF_UNSIGNED_SHORT: { uint16_t v; memcpy(&v, p, 2); return v; }
+				case GLTF_UNSIGNED_INT: { uint32_t v; memcpy(&v, p, 4); return v; }
+				default: return NO_INDEX;
+			}
+		}
+
+		// checks that every element lies within its buffer view
+		auto resolveAccessor(GltfScene const& scene, uint32_t accessorIdx, GltfAccessor* outAccessor) -> bool
+		{
+			JsonDocument const& json = scene.json;
+			if (accessorIdx >= scene.accessors.size())
+			{
+				return false;
+			}
+			uint32_t const accessor = scene.accessors[accessorIdx];
+			if (json.member(accessor, "sparse") != JsonDocument::NONE)
+			{
+				fprintf(stderr, "gltf import: sparse accessors are not supported\n");
+				return false;
+			}
+			uint32_t const viewIdx = json.index(json.member(accessor, "bufferView"));
+			if (viewIdx >= scene.bufferViews.size())
+			{
+				return false; // without a view it's all zeros, useless for geometry
+			}
+			uint32_t const view = scene.bufferViews[viewIdx];
+			uint32_t const bufferIdx = json.index(json.member(view, "buffer"));
+			if (bufferIdx >= scene.buffers.size())
+			{
+				return false;
+			}
+			GltfBuffer const& buffer = scene.buffers[bufferIdx];
+
+			// every offset and size within the buffer, so that none of the arithmetic below can overflow
+			uint64_t const viewOffset = json.integer(json.member(view, "byteOffset"), 0, buffer.size);
+			uint64_t const viewLength = json.integer(json.member(view, "byteLength"), 0, buffer.size);
+			uint64_t const offset = json.integer(json.member(accessor, "byteOffset"), 0, buffer.size);
+			uint64_t const componentType = json.integer(json.member(accessor, "componentType"), 0, UINT32_MAX);
+			uint64_t const count = json.integer(json.member(accessor, "count"), 0, UINT32_MAX);
+			if (viewOffset == JsonDocument::NO_INTEGER || viewLength == JsonDocument::NO_INTEGER || offset == JsonDocument::NO_INTEGER
+				|| componentType == JsonDocument::NO_INTEGER || count == JsonDocument::NO_INTEGER)
+			{
+				return false;
+			}
+			outAccessor->componentType = static_cast<uint32_t>(componentType);
+			outAccessor->componentCount = componentCount(json.string(json.member(accessor, "type")));
+			outAccessor->count = static_cast<uint32_t>(count);
+			outAccessor->normalized = json.number(json.member(accessor, "normalized"), 0.) != 0.;
+			size_t const elementSize = componentSize(outAccessor->componentType) * outAccessor->componentCount;
+			uint64_t const stride = json.integer(json.member(view, "byteStride"), elementSize, buffer.size);
+			// the last element starts (count - 1) strides after the first, and has to end within the view
+			if (elementSize == 0 || stride == JsonDocument::NO_INTEGER || stride < elementSize || viewLength > buffer.size - viewOffset || offset > viewLength
+				|| (count > 0 && (elementSize > viewLength - offset || (viewLength - offset - elementSize) / stride < count - 1)))
+			{
+				return false;
+			}
+			outAccessor->stride = static_cast<size_t>(stride);
+			outAccessor->data = buffer.bytes + viewOffset + offset;
+			return true;
+		}
+
+		auto decodeBase64(std::string_view text, std::vector<char>* out) -> bool
+		{
+			out->clear();
+			out->reserve(text.size() / 4 * 3);
+			uint32_t bits = 0;
+			uint32_t bitCount = 0;
+			for (char c : text)
+			{
+				uint32_t value;
+				if (c >= 'A' && c <= 'Z') value = static_cast<uint32_t>(c - 'A');
+				else if (c >= 'a' && c <= 'z') value = static_cast<uint32_t>(c - 'a' + 26);
+				else if (c >= '0' && c <= '9') value = static_cast<uint32_t>(c - '0' + 52);
+				else if (c == '+') value = 62;
+				else if (c == '/') value = 63;
+				else if (c == '=') break;
+				else return false;
+				bits = (bits << 6) | value;
+				bitCount += 6;
+				if (bitCount >= 8)
+				{
+					bitCount -= 8;
+					out->push_back(static_cast<char>((bits >> bitCount) & 0xff));
+				}
+			}
+			return true;
+		}
+
+		// relative URIs are percent encoded
+		auto decodeUri(std::string_view uri) -> std::string
+		{
+			std::string path;
+			for (size_t i = 0; i < uri.size(); ++i)
+			{
+				unsigned value = 0;
+				if (uri[i] == '%' && i + 2 < uri.size() && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ptr == uri.data() + i + 3)
+				{
+					path.push_back(static_cast<char>(value));
+					i += 2;
+				}
+				else
+				{
+					path.push_back(uri[i]);
+				}
+			}
+			return path;
+		}
+
+		auto loadGltfBuffers(std::filesystem::path const& directory, std::string_view binChunk, GltfScene* scene) -> bool
+		{
+			JsonDocument const& json = scene->json;
+			std::vector<uint32_t> const buffers = json.elements(json.member(0, "buffers"));
+			scene->buffers.resize(buffers.size());
+			for (size_t i = 0; i < buffers.size(); ++i)
+			{
+				GltfBuffer& buffer = scene->buffers[i];
+				std::string_view const uri = json.string(json.member(buffers[i], "uri"));
+				uint64_t const byteLength = json.integer(json.member(buffers[i], "byteLength"), 0, JSON_MAX_INTEGER);
+				if (byteLength == JsonDocument::NO_INTEGER)
+				{
+					fprintf(stderr, "gltf import: buffer %lu has an invalid byteLength\n", static_cast<unsigned long>(i));
+					return false;
+				}
+				if (uri.empty())
+				{
+					// the .glb BIN chunk, which can be padded
+					buffer.bytes = binChunk.data();
+					buffer.size = binChunk.size();
+				}
+				else if (uri.starts_with("data:"))
+				{
+					size_t const comma = uri.find(";base64,");
+					if (comma == std::string_view::npos || !decodeBase64(uri.substr(comma + 8), &buffer.data))
+					{
+						fprintf(stderr, "gltf import: buffer %lu has an unsupported data URI\n", static_cast<unsigned long>(i));
+						return false;
+					}
+				}
+				else if (!readFile(directory / decodeUri(uri), &buffer.data))
+				{
+					fprintf(stderr, "gltf import: couldn't read buffer %.*s\n", static_cast<int>(uri.size()), uri.data());
+					return false;
+				}
+				if (!uri.empty())
+				{
+					buffer.bytes = buffer.data.data();
+					buffer.size = buffer.data.size();
+				}
+				if (buffer.size < byteLength)
+				{
+					fprintf(stderr, "gltf import: buffer %lu is shorter than its byteLength\n", static_cast<unsigned long>(i));
+					return false;
+				}
+				buffer.size = static_cast<size_t>(byteLength); // anything past it is padding
+			}
+			return true;
+		}
+
+		auto nodeTransform(JsonDocument const& json, uint32_t node) -> Eigen::Matrix4f
+		{
+			float values[16];
+			if (json.numbers(json.member(node, "matrix"), values, 16) == 16)
+			{
+				return Eigen::Map<Eigen::Matrix4f const>(values); // column major, like Eigen
+			}
+			float t[3] {0.f, 0.f, 0.f};
+			float r[4] {0.f, 0.f, 0.f, 1.f}; // xyzw
+			float s[3] {1.f, 1.f, 1.f};
+			json.numbers(json.member(node, "translation"), t, 3);
+			json.numbers(json.member(node, "rotation"), r, 4);
+			json.numbers(json.member(node, "scale"), s, 3);
+			Eigen::Affine3f const transform = Eigen::Translation3f(t[0], t[1], t[2]) * Eigen::Quaternionf(r[3], r[0], r[1], r[2]).normalized() * Eigen::Scaling(s[0], s[1], s[2]);
+			return transform.matrix();
+		}
+
+		// every primitive of every mesh instanced by the nodes of the default scene (or of every root node, if there are no scenes)
+		auto collectGltfDraws(GltfScene* scene) -> void
+		{
+			JsonDocument const& json = scene->json;
+			std::vector<uint32_t> const nodes = json.elements(json.member(0, "nodes"));
+			std::vector<uint32_t> const meshes = json.elements(json.member(0, "meshes"));
+			std::vector<uint32_t> const scenes = json.elements(json.member(0, "scenes"));
+
+			std::vector<uint32_t> roots;
+			if (!scenes.empty())
+			{
+				uint32_t const sceneIdx = json.index(json.member(0, "scene"));
+				for (uint32_t root : json.elements(json.member(scenes[sceneIdx < scenes.size() ? sceneIdx : 0], "nodes")))
+				{
+					roots.push_back(json.index(root)); // invalid ones are skipped by the traversal
+				}
+			}
+			else
+			{
+				std::vector<uint8_t> isChild(nodes.size(), 0);
+				for (uint32_t node : nodes)
+				{
+					for (uint32_t child : json.elements(json.member(node, "children")))
+					{
+						uint32_t const childIdx = json.index(child);
+						if (childIdx < nodes.size())
+						{
+							isChild[childIdx] = 1;
+						}
+					}
+				}
+				for (uint32_t i = 0; i < nodes.size(); ++i)
+				{
+					if (!isChild[i])
+					{
+						roots.push_back(i);
+					}
+				}
+			}
+
+			struct Visit { uint32_t node; uint32_t depth; Eigen::Matrix4f parent; };
+			std::vector<Visit> stack;
+			for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+			{
+				stack.push_back(Visit{.node = *it, .depth = 0, .parent = Eigen::Matrix4f::Identity()});
+			}
+			while (!stack.empty())
+			{
+				Visit const visit = stack.back();
+				stack.pop_back();
+				if (visit.node >= nodes.size() || visit.depth > GLTF_MAX_NODE_DEPTH) // also stops cycles, which are invalid anyway
+				{
+					continue;
+				}
+				uint32_t const node = nodes[visit.node];
+				Eigen::Matrix4f const world = visit.parent * nodeTransform(json, node);
+				uint32_t const meshIdx = json.index(json.member(node, "mesh"));
+				if (meshIdx < meshes.size())
+				{
+					for (uint32_t primitive : json.elements(json.member(meshes[meshIdx], "primitives")))
+					{
+						scene->draws.push_back(GltfDraw{.primitive = primitive, .world = world});
+					}
+				}
+				std::vector<uint32_t> const children = json.elements(json.member(node, "children"));
+				for (auto it = children.rbegin(); it != children.rend(); ++it)
+				{
+					stack.push_back(Visit{.node = json.index(*it), .depth = visit.depth + 1, .parent = world});
+				}
+			}
+		}
+
+		auto decodeGltfDraw(GltfScene const& scene, GltfDraw const& draw, MeshPart* outPart) -> void
+		{
+			MXC_TRACE_SCOPE("gltf decode primitive");
+			JsonDocument const& json = scene.json;
+			outPart->status = APP_GENERIC_ERR;
+			uint64_t const mode = json.integer(json.member(draw.primitive, "mode"), GLTF_TRIANGLES, UINT32_MAX);
+			if (mode != GLTF_TRIANGLES && mode != GLTF_TRIANGLE_STRIP && mode != GLTF_TRIANGLE_FAN)
+			{
+				outPart->status = APP_SUCCESS; // points and lines are skipped
+				return;
+			}
+
+			uint32_t const attributes = json.member(draw.primitive, "attributes");
+			GltfAccessor positions;
+			GltfAccessor normals;
+			GltfAccessor colors;
+			if (!resolveAccessor(scene, json.index(json.member(attributes, "POSITION")), &positions) || positions.componentCount != 3)
+			{
+				fprintf(stderr, "gltf import: primitive without a valid POSITION\n");
+				return;
+			}
+			uint32_t const normalAttribute = json.member(attributes, "NORMAL");
+			uint32_t const colorAttribute = json.member(attributes, "COLOR_0");
+			bool const hasNormals = normalAttribute != JsonDocument::NONE;
+			bool const hasColors = colorAttribute != JsonDocument::NONE;
+			if ((hasNormals && (!resolveAccessor(scene, json.index(normalAttribute), &normals) || normals.componentCount != 3 || normals.count < positions.count))
+				|| (hasColors && (!resolveAccessor(scene, json.index(colorAttribute), &colors) || colors.componentCount < 3 || colors.count < positions.count)))
+			{
+				fprintf(stderr, "gltf import: invalid NORMAL or COLOR_0\n");
+				return;
+			}
+
+			// -- triangle list of the source vertices ----------------------------------------------------------------------------------
+			uint32_t const indicesMember = json.member(draw.primitive, "indices");
+			GltfAccessor indices;
+			if (indicesMember != JsonDocument::NONE && (!resolveAccessor(scene, json.index(indicesMember), &indices) || indices.componentCount != 1))
+			{
+				fprintf(stderr, "gltf import: invalid indices\n");
+				return;
+			}
+			uint32_t const count = indicesMember != JsonDocument::NONE ? indices.count : positions.count;
+			auto const sourceIndex = [&indices, indicesMember](uint32_t i) -> uint32_t { return indicesMember != JsonDocument::NONE ? readIndex(indices, i) : i; };
+			std::vector<uint32_t> triangles;
+			if (mode == GLTF_TRIANGLES)
+			{
+				triangles.resize(count - count % 3);
+				for (uint32_t i = 0; i < triangles.size(); ++i)
+				{
+					triangles[i] = sourceIndex(i);
+				}
+			}
+			else
+			{
+				for (uint32_t i = 2; i < count; ++i)
+				{
+					// strips alternate winding, fans pivot on the first vertex
+					uint32_t const a = mode == GLTF_TRIANGLE_FAN ? sourceIndex(0) : sourceIndex(i - 2 + (i & 1));
+					uint32_t const b = mode == GLTF_TRIANGLE_FAN ? sourceIndex(i - 1) : sourceIndex(i - 1 - (i & 1));
+					triangles.insert(triangles.end(), {a, b, sourceIndex(i)});
+				}
+			}
+			if (draw.world.topLeftCorner<3, 3>().determinant() < 0.f) // mirroring flips the winding
+			{
+				for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+				{
+					std::swap(triangles[i + 1], triangles[i + 2]);
+				}
+			}
+
+			// -- transform and dedupe the vertices actually referenced ------------------------------------------------------------------
+			Eigen::Matrix3f const normalMatrix = draw.world.topLeftCorner<3, 3>().inverse().transpose();
+			std::vector<uint32_t> remap(positions.count, NO_INDEX);
+			DedupeTable table(std::min<size_t>(positions.count, triangles.size()));
+			outPart->indices.resize(triangles.size());
+			for (size_t i = 0; i < triangles.size(); ++i)
+			{
+				uint32_t const source = triangles[i];
+				if (source >= positions.count)
+				{
+					fprintf(stderr, "gltf import: index out of range\n");
+					outPart->indices.clear();
+					outPart->vertices.clear();
+					return;
+				}
+				if (remap[source] == NO_INDEX)
+				{
+					Vertex vertex;
+					vertex.pos = (draw.world * Eigen::Vector4f(readComponent(positions, source, 0), readComponent(positions, source, 1), readComponent(positions, source, 2), 1.f)).head<3>();
+					if (hasColors)
+					{
+						vertex.col = Eigen::Vector3f(readComponent(colors, source, 0), readComponent(colors, source, 1), readComponent(colors, source, 2));
+					}
+					else if (hasNormals)
+					{
+						vertex.col = colorFromNormal(normalMatrix * Eigen::Vector3f(readComponent(normals, source, 0), readComponent(normals, source, 1), readComponent(normals, source, 2)));
+					}
+					else
+					{
+						vertex.col = Eigen::Vector3f(.8f, .8f, .8f);
+					}
+
+					size_t slot = hashBytes(&vertex, sizeof(Vertex)) & table.mask;
+					while (table.slots[slot] != NO_INDEX && memcmp(&outPart->vertices[table.slots[slot]], &vertex, sizeof(Vertex)) != 0)
+					{
+						slot = (slot + 1) & table.mask;
+					}
+					if (table.slots[slot] == NO_INDEX)
+					{
+						table.slots[slot] = static_cast<uint32_t>(outPart->vertices.size());
+						outPart->vertices.push_back(vertex);
+					}
+					remap[source] = table.slots[slot];
+				}
+				outPart->indices[i] = remap[source];
+			}
+			computeBounds(outPart);
+			outPart->status = APP_SUCCESS;
+		}
+
+		auto importGltf(std::filesystem::path const& path, std::vector<char> const& file, JobSystem* jobSystem, std::vector<MeshPart>* outParts) -> status_t
+		{
+			// -- .glb: 12 bytes header, JSON chunk, optional BIN chunk ---------------------------------------------------------------------
+			std::string_view jsonText(file.data(), file.size());
+			std::string_view binChunk;
+			uint32_t header[3] {0, 0, 0};
+			if (file.size() >= sizeof(header))
+			{
+				memcpy(header, file.data(), sizeof(header));
+			}
+			if (header[0] == GLB_MAGIC)
+			{
+				jsonText = {};
+				for (size_t offset = sizeof(header); offset + 8 <= file.size();)
+				{
+					uint32_t chunkHeader[2]; // length, type
+					memcpy(chunkHeader, file.data() + offset, sizeof(chunkHeader));
+					if (chunkHeader[0] > file.size() - offset - 8)
+					{
+						break;
+					}
+					std::string_view const chunk(file.data() + offset + 8, chunkHeader[0]);
+					jsonText = chunkHeader[1] == GLB_CHUNK_JSON && jsonText.empty() ? chunk : jsonText;
+					binChunk = chunkHeader[1] == GLB_CHUNK_BIN && binChunk.empty() ? chunk : binChunk;
+					offset += 8 + chunkHeader[0];
+				}
+			}
+
+			GltfScene scene;
+			if (!scene.json.parse(jsonText) || scene.json.type(0) != JsonDocument::Type::OBJECT)
+			{
+				fprintf(stderr, "gltf import: invalid JSON\n");
+				return APP_GENERIC_ERR;
+			}
+			scene.bufferViews = scene.json.elements(scene.json.member(0, "bufferViews"));
+			scene.accessors = scene.json.elements(scene.json.member(0, "accessors"));
+			if (!loadGltfBuffers(path.parent_path(), binChunk, &scene))
+			{
+				return APP_GENERIC_ERR;
+			}
+			collectGltfDraws(&scene);
+
+			outParts->resize(scene.draws.size());
+			forEach(jobSystem, static_cast<uint32_t>(scene.draws.size()), [&scene, outParts](uint32_t i) {
+				decodeGltfDraw(scene, scene.draws[i], &(*outParts)[i]);
+			});
+			for (MeshPart const& part : *outParts)
+			{
+				if (part.status != APP_SUCCESS)
+				{
+					return APP_GENERIC_ERR;
+				}
+			}
+			return APP_SUCCESS;
+		}
+	}
+
+	auto MeshData::view() const & -> MeshView
+	{
+		VertexStream stream = vertexStreamOf(vertices);
+		if (vertexFormat != VERTEX_FORMAT_FLOAT32)
+		{
+			stream = VertexStream{
+				.data = encodedVertices,
+				.count = static_cast<uint32_t>(encodedVertices.size() / vertexStride(vertexFormat)),
+				.format = vertexFormat,
+				.positionOffset = positionOffset,
+				.positionScale = positionScale
+			};
+		}
+		IndexStream const indexStream = indices16.empty() ? indexStreamOf<uint32_t>(indices) : indexStreamOf<uint16_t>(indices16);
+		return MeshView{
+			.vertices = stream,
+			.indices = indexStream,
+			.drawItems = drawItems,
+			.lodChains = lodChains,
+			.lods = lods,
+			.meshletRanges = meshletRanges,
+			.meshlets = meshlets,
+			.meshletBounds = meshletBounds,
+			.boundsMin = boundsMin,
+			.boundsMax = boundsMax
+		};
+	}
+
+	auto encodeVertices(MeshData* mesh, VertexFormat format, JobSystem* jobSystem) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		if (format >= VERTEX_FORMAT_COUNT || mesh->vertexFormat != VERTEX_FORMAT_FLOAT32)
+		{
+			fprintf(stderr, "mesh import: can't encode to %s from %s\n", vertexFormatName(format), vertexFormatName(mesh->vertexFormat));
+			return APP_GENERIC_ERR;
+		}
+		if (format == VERTEX_FORMAT_FLOAT32)
+		{
+			return APP_SUCCESS;
+		}
+
+		// bounds to [-1,1]. A flat axis keeps scale 1, so that it doesn't divide by 0
+		Eigen::Vector3f const center = .5f * (mesh->boundsMin + mesh->boundsMax);
+		Eigen::Vector3f halfExtent = .5f * (mesh->boundsMax - mesh->boundsMin);
+		halfExtent = (halfExtent.array() > 0.f).select(halfExtent, Eigen::Vector3f::Ones());
+		Eigen::Vector3f const invHalfExtent = halfExtent.cwiseInverse();
+
+		uint32_t const stride = vertexStride(format);
+		size_t const vertexCount = mesh->vertices.size();
+		mesh->encodedVertices.resize(vertexCount * stride);
+		uint32_t const chunkCount = static_cast<uint32_t>((vertexCount + VERTEX_ENCODE_CHUNK - 1) / VERTEX_ENCODE_CHUNK);
+		forEach(jobSystem, chunkCount, [&](uint32_t chunk) {
+			size_t const first = size_t{chunk} * VERTEX_ENCODE_CHUNK;
+			size_t const count = std::min(VERTEX_ENCODE_CHUNK, vertexCount - first);
+			Vertex const* in = mesh->vertices.data() + first;
+			std::byte* out = mesh->encodedVertices.data() + first * stride;
+			// both quantized layouts are an 8 byte position followed by RGBA8
+			if (format == VERTEX_FORMAT_HALF)
+			{
+				encodePositionsHalf(in->pos.data(), sizeof(Vertex), count, center.data(), invHalfExtent.data(), out, stride);
+			}
+			else
+			{
+				encodePositionsSnorm16(in->pos.data(), sizeof(Vertex), count, center.data(), invHalfExtent.data(), out, stride);
+			}
+			encodeColorsUnorm8(in->col.data(), sizeof(Vertex), count, out + PositionHalf4::size, stride);
+		});
+		static_assert(VertexLayoutHalf::offset<1>() == PositionHalf4::size && VertexLayoutSnorm16::offset<1>() == PositionSnorm16x4::size
+					  && PositionHalf4::size == PositionSnorm16x4::size);
+
+		mesh->vertices = {};
+		mesh->vertexFormat = format;
+		mesh->positionOffset = center;
+		mesh->positionScale = halfExtent;
+		return APP_SUCCESS;
+	}
+
+	auto fitToView(MeshView const& mesh) -> Eigen::Transform<float,3,Eigen::Affine>
+	{
+		Eigen::Vector3f const center = .5f * (mesh.boundsMin + mesh.boundsMax);
+		float const extent = (mesh.boundsMax - mesh.boundsMin).maxCoeff();
+		float const scale = extent > 0.f ? 1.8f / extent : 1.f;
+		Eigen::Transform<float,3,Eigen::Affine> transform = Eigen::Transform<float,3,Eigen::Affine>::Identity();
+		transform.translate(Eigen::Vector3f(0.f, 0.f, .5f));
+		transform.scale(Eigen::Vector3f(scale, -scale, .25f * scale)); // clip space y points down
+		transform.translate(-center);
+		return transform;
+	}
+
+	auto importMesh(char const* path, JobSystem* jobSystem, MeshData* outMesh) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		uint64_t const beginNs = trace::now();
+		std::filesystem::path const filePath(path);
+		std::string extension = filePath.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c); });
+		if (extension != ".obj" && extension != ".gltf" && extension != ".glb")
+		{
+			fprintf(stderr, "mesh import: unsupported format %s, expected .obj, .gltf or .glb\n", path);
+			return APP_GENERIC_ERR;
+		}
+
+		std::vector<char> file;
+		if (!readFile(filePath, &file))
+		{
+			fprintf(stderr, "mesh import: couldn't read %s\n", path);
+			return APP_GENERIC_ERR;
+		}
+
+		std::vector<MeshPart> parts;
+		status_t const status = extension == ".obj" ? importObj(file, jobSystem, &parts) : importGltf(filePath, file, jobSystem, &parts);
+		if (status != APP_SUCCESS)
+		{
+			return status;
+		}
+		file = {};
+		assemble(parts, jobSystem, outMesh);
+		if (outMesh->vertices.size() > static_cast<size_t>(INT32_MAX))
+		{
+			fprintf(stderr, "mesh import: %s has too many vertices\n", path);
+			return APP_GENERIC_ERR;
+		}
+
+		printf("imported %s: %lu meshes, %lu vertices, %lu triangles in %.1f ms\n", path, static_cast<unsigned long>(outMesh->drawItems.size()),
+			   static_cast<unsigned long>(outMesh->vertices.size()), static_cast<unsigned long>(outMesh->indices.size() / 3),
+			   static_cast<double>(trace::now() - beginNs) * 1e-6);
+		return APP_SUCCESS;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "status.h"
+#include "geometry.h"
+
+#include <cstdint>
+#include <vector>
+
+// Mesh import from local files into the renderer's vertex layout: Wavefront OBJ, and glTF 2.0, either .gltf with its buffers in .bin
+// files (or data URIs) or binary .glb. Vertices are deduplicated, and each mesh becomes one DrawItem whose indices are relative to its
+// vertexOffset, so meshes are decoded independently and their results just concatenated.
+// - OBJ: the file is split in chunks at line boundaries, parsed in parallel, and the chunks' relative (negative) indices resolved once
+//   all counts are known. Objects, groups and material changes (o, g, usemtl) start a new mesh. Polygons are triangulated as fans.
+// - glTF: each primitive of each node of the default scene is one mesh, decoded in parallel, with the node's world transform baked in.
+//   Triangle lists, strips and fans are supported, sparse accessors are not.
+// Vertex colors come from the file if any (OBJ "v x y z r g b", glTF COLOR_0), otherwise the normal mapped to [0,1], otherwise gray.
+// Texture coordinates are dropped, as Vertex has none, which lets dedupe merge vertices split only by UV seams
+namespace mxc
+{
+	class JobSystem;
+
+	struct MeshData
+	{
+		std::vector<Vertex> vertices; // empty once encoded
+		std::vector<uint32_t> indices; // empty if indices16 isn't
+		std::vector<uint16_t> indices16; // filled by optimizeMesh in place of indices when they fit
+		std::vector<DrawItem> drawItems; // one for each mesh
+		std::vector<LodChain> lodChains; // filled by buildLods, one for each DrawItem
+		std::vector<MeshLod> lods;
+		std::vector<MeshletRange> meshletRanges; // filled by buildMeshlets, one for each DrawItem
+		std::vector<Meshlet> meshlets;
+		std::vector<MeshletBounds4> meshletBounds;
+		Eigen::Vector3f boundsMin;
+		Eigen::Vector3f boundsMax;
+		// filled by encodeVertices
+		VertexFormat vertexFormat = VERTEX_FORMAT_FLOAT32;
+		std::vector<std::byte> encodedVertices;
+		Eigen::Vector3f positionOffset = Eigen::Vector3f::Zero();
+		Eigen::Vector3f positionScale = Eigen::Vector3f::Ones();
+
+		auto view() const & -> MeshView; // of the encoded vertices and 16 bit indices, if any
+	};
+
+	// format deduced from the extension. jobSystem can be null, then everything runs on the calling thread, which otherwise must be
+	// allowed to submit jobs to it
+	auto importMesh(char const* path, JobSystem* jobSystem, MeshData* outMesh) -> status_t;
+	// converts the float vertices to format, in parallel, and drops them. Quantized positions are mapped from the mesh bounds to [-1,1],
+	// so the precision follows the mesh size. Last step of import: processing which needs the float vertices goes before
+	auto encodeVertices(MeshData* mesh, VertexFormat format, JobSystem* jobSystem) -> status_t;
+	// until there is a camera: centers the bounds and scales them to fill most of clip space, y up, depth in [0.25, 0.75]
+	auto fitToView(MeshView const& mesh) -> Eigen::Transform<float,3,Eigen::Affine>;
+}
@@ -0,0 +1,513 @@
+#include "mesh_lod.h"
+
+#include "job_system.h"
+#include "trace.h"
+
+#include <algorithm> // minmax_element, find, sort, unique
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <queue>
+#include <utility> // pair
+#include <vector>
+
+namespace mxc
+{
+	namespace
+	{
+		inline constexpr double LOD_TRIANGLE_RATIO = .5; // of each level to the previous one
+		inline constexpr double LOD_STUCK_RATIO = .85; // a level keeping more than this of the previous one isn't worth its indices
+		inline constexpr double NO_COLLAPSE = std::numeric_limits<double>::infinity();
+
+		// sum of weight * squared distance to a set of planes (n, d), as the symmetric 4x4 matrix of (n, d)(n, d)^T, plus the sum of the
+		// weights, so that the error can be turned back into a distance
+		struct Quadric
+		{
+			std::array<double, 10> q; // upper triangle, row major
+			double weight;
+
+			static auto plane(Eigen::Vector3d const& n, double d, double weight) -> Quadric
+			{
+				std::array<double, 4> const p {n.x(), n.y(), n.z(), d};
+				Quadric result {.q = {}, .weight = weight};
+				for (uint32_t row = 0, i = 0; row < 4; ++row)
+				{
+					for (uint32_t col = row; col < 4; ++col)
+					{
+						result.q[i++] = weight * p[row] * p[col];
+					}
+				}
+				return result;
+			}
+
+			auto operator+=(Quadric const& other) -> Quadric&
+			{
+				for (uint32_t i = 0; i < q.size(); ++i)
+				{
+					q[i] += other.q[i];
+				}
+				weight += other.weight;
+				return *this;
+			}
+
+			auto evaluate(Eigen::Vector3f const& p) const -> double
+			{
+				double const x = p.x();
+				double const y = p.y();
+				double const z = p.z();
+				return q[0] * x * x + 2. * q[1] * x * y + 2. * q[2] * x * z + 2. * q[3] * x
+					+ q[4] * y * y + 2. * q[5] * y * z + 2. * q[6] * y
+					+ q[7] * z * z + 2. * q[8] * z
+					+ q[9];
+			}
+		};
+
+		struct Candidate
+		{
+			double cost;
+			uint32_t vertex;
+			uint32_t version; // of vertex when pushed, older ones are stale
+		};
+
+		struct CheaperFirst
+		{
+			auto operator()(Candidate const& a, Candidate const& b) const -> bool { return a.cost > b.cost; }
+		};
+
+		// -- simplifier ----------------------------------------------------------------------------------------------------------------
+		// one DrawItem, on indices local to its vertex range
+		class Simplifier
+		{
+		public:
+			Simplifier(std::span<uint32_t const> indices, std::span<Vertex const> vertices);
+
+			auto simplify(uint32_t targetTriangleCount) -> void; // collapses until the target, or until nothing can collapse
+			auto triangleCount() const -> uint32_t { return m_liveTriangleCount; }
+			auto error() const -> float { return static_cast<float>(m_error); }
+			auto appendTriangles(uint32_t indexBase, std::vector<uint32_t>* outIndices) const -> void; // the live ones, in the original order
+
+		private:
+			auto neighbours(uint32_t v, std::vector<uint32_t>* outNeighbours) const -> void; // sorted
+			auto evaluate(uint32_t u, uint32_t* outTarget) -> double; // cheapest valid collapse of u, NO_COLLAPSE if none
+			auto canCollapse(uint32_t u, uint32_t v) -> bool; // expects m_neighboursU filled
+			auto push(uint32_t u) -> void;
+			auto collapse(uint32_t u, uint32_t v) -> void;
+
+		private:
+			std::span<Vertex const> m_vertices;
+			std::vector<std::array<uint32_t, 3>> m_triangles;
+			std::vector<uint8_t> m_triangleAlive;
+			std::vector<std::vector<uint32_t>> m_vertexTriangles; // live triangles using each vertex
+			std::vector<Quadric> m_quadrics;
+			std::vector<uint8_t> m_locked; // on a border, or dead
+			std::vector<uint32_t> m_versions;
+			std::priority_queue<Candidate, std::vector<Candidate>, CheaperFirst> m_heap;
+			uint32_t m_liveTriangleCount;
+			double m_error = 0.;
+			std::vector<uint32_t> m_neighboursU; // scratch
+			std::vector<uint32_t> m_neighboursV;
+			std::vector<uint32_t> m_affected;
+			std::vector<std::pair<double, uint32_t>> m_costs;
+		};
+
+		Simplifier::Simplifier(std::span<uint32_t const> indices, std::span<Vertex const> vertices)
+			: m_vertices(vertices), m_triangles(indices.size() / 3), m_triangleAlive(indices.size() / 3, 1), m_vertexTriangles(vertices.size())
+			, m_quadrics(vertices.size(), Quadric{.q = {}, .weight = 0.}), m_locked(vertices.size(), 0), m_versions(vertices.size(), 0)
+			, m_liveTriangleCount(static_cast<uint32_t>(indices.size() / 3))
+		{
+			std::vector<uint64_t> edges; // smaller vertex in the high half, so that equal edges sort together
+			edges.reserve(indices.size());
+			for (uint32_t t = 0; t < m_triangles.size(); ++t)
+			{
+				std::array<uint32_t, 3> const triangle {indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]};
+				m_triangles[t] = triangle;
+				Eigen::Vector3d const a = vertices[triangle[0]].pos.cast<double>();
+				Eigen::Vector3d const cross = (vertices[triangle[1]].pos.cast<double>() - a).cross(vertices[triangle[2]].pos.cast<double>() - a);
+				double const doubleArea = cross.norm();
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					uint32_t const v0 = triangle[c];
+					uint32_t const v1 = triangle[(c + 1) % 3];
+					m_vertexTriangles[v0].push_back(t);
+					edges.push_back(uint64_t{std::min(v0, v1)} << 32 | std::max(v0, v1));
+					if (doubleArea > 0.)
+					{
+						Eigen::Vector3d const n = cross / doubleArea;
+						m_quadrics[v0] += Quadric::plane(n, -n.dot(a), .5 * doubleArea);
+					}
+				}
+			}
+
+			// an edge with other than 2 triangles is a border, a seam or non manifold: its vertices stay where they are
+			std::sort(edges.begin(), edges.end());
+			for (size_t begin = 0, end = 0; begin < edges.size(); begin = end)
+			{
+				for (end = begin + 1; end < edges.size() && edges[end] == edges[begin]; ++end) {}
+				if (end - begin != 2)
+				{
+					m_locked[edges[begin] >> 32] = 1;
+					m_locked[edges[begin] & UINT32_MAX] = 1;
+				}
+			}
+
+			for (uint32_t v = 0; v < vertices.size(); ++v)
+			{
+				push(v);
+			}
+		}
+
+		auto Simplifier::neighbours(uint32_t v, std::vector<uint32_t>* outNeighbours) const -> void
+		{
+			outNeighbours->clear();
+			for (uint32_t t : m_vertexTriangles[v])
+			{
+				for (uint32_t w : m_triangles[t])
+				{
+					if (w != v)
+					{
+						outNeighbours->push_back(w);
+					}
+				}
+			}
+			std::sort(outNeighbours->begin(), outNeighbours->end());
+			outNeighbours->erase(std::unique(outNeighbours->begin(), outNeighbours->end()), outNeighbours->end());
+		}
+
+		auto Simplifier::canCollapse(uint32_t u, uint32_t v) -> bool
+		{
+			// link condition: the only vertices adjacent to both are the opposite corners of the 2 triangles on the edge, otherwise the
+			// collapse would pinch the surface into a non manifold one
+			uint32_t edgeTriangleCount = 0;
+			for (uint32_t t : m_vertexTriangles[u])
+			{
+				edgeTriangleCount += std::find(m_triangles[t].begin(), m_triangles[t].end(), v) != m_triangles[t].end();
+			}
+			neighbours(v, &m_neighboursV);
+			uint32_t sharedCount = 0;
+			for (auto a = m_neighboursU.begin(), b = m_neighboursV.begin(); a != m_neighboursU.end() && b != m_neighboursV.end();)
+			{
+				if (*a < *b)
+				{
+					++a;
+				}
+				else if (*b < *a)
+				{
+					++b;
+				}
+				else
+				{
+					++sharedCount;
+					++a;
+					++b;
+				}
+			}
+			if (edgeTriangleCount != 2 || sharedCount != 2)
+			{
+				return false;
+			}
+
+			// triangles which stay must keep facing the same way
+			Eigen::Vector3f const& target = m_vertices[v].pos;
+			for (uint32_t t : m_vertexTriangles[u])
+			{
+				std::array<uint32_t, 3> const& triangle = m_triangles[t];
+				if (std::find(triangle.begin(), triangle.end(), v) != triangle.end())
+				{
+					continue;
+				}
+				std::array<Eigen::Vector3f, 3> corners {m_vertices[triangle[0]].pos, m_vertices[triangle[1]].pos, m_vertices[triangle[2]].pos};
+				Eigen::Vector3f const before = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+				corners[std::find(triangle.begin(), triangle.end(), u) - triangle.begin()] = target;
+				Eigen::Vector3f const after = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+				if (before.dot(after) <= 0.f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		auto Simplifier::evaluate(uint32_t u, uint32_t* outTarget) -> double
+		{
+			if (m_locked[u])
+			{
+				return NO_COLLAPSE;
+			}
+			// cheapest first, validity costs more than the quadrics and the first one is usually valid
+			neighbours(u, &m_neighboursU);
+			m_costs.clear();
+			for (uint32_t v : m_neighboursU)
+			{
+				Quadric merged = m_quadrics[u];
+				merged += m_quadrics[v];
+				m_costs.emplace_back(std::max(merged.evaluate(m_vertices[v].pos), 0.), v); // can be slightly negative from rounding
+			}
+			std::sort(m_costs.begin(), m_costs.end());
+			for (auto const& [cost, v] : m_costs)
+			{
+				if (canCollapse(u, v))
+				{
+					*outTarget = v;
+					return cost;
+				}
+			}
+			return NO_COLLAPSE;
+		}
+
+		auto Simplifier::push(uint32_t u) -> void
+		{
+			uint32_t target;
+			double const cost = evaluate(u, &target);
+			++m_versions[u];
+			if (cost != NO_COLLAPSE)
+			{
+				m_heap.push(Candidate{.cost = cost, .vertex = u, .version = m_versions[u]});
+			}
+		}
+
+		auto Simplifier::collapse(uint32_t u, uint32_t v) -> void
+		{
+			for (uint32_t t : m_vertexTriangles[u])
+			{
+				std::array<uint32_t, 3>& triangle = m_triangles[t];
+				if (std::find(triangle.begin(), triangle.end(), v) != triangle.end())
+				{
+					m_triangleAlive[t] = 0;
+					--m_liveTriangleCount;
+					for (uint32_t w : triangle)
+					{
+						if (w != u)
+						{
+							std::vector<uint32_t>& triangles = m_vertexTriangles[w];
+							triangles.erase(std::find(triangles.begin(), triangles.end(), t));
+						}
+					}
+				}
+				else
+				{
+					*std::find(triangle.begin(), triangle.end(), u) = v;
+					m_vertexTriangles[v].push_back(t);
+				}
+			}
+			m_vertexTriangles[u] = {};
+			m_quadrics[v] += m_quadrics[u];
+			m_locked[u] = 1;
+		}
+
+		auto Simplifier::simplify(uint32_t targetTriangleCount) -> void
+		{
+			while (m_liveTriangleCount > targetTriangleCount && !m_heap.empty())
+			{
+				Candidate const candidate = m_heap.top();
+				m_heap.pop();
+				uint32_t const u = candidate.vertex;
+				if (m_locked[u] || candidate.version != m_versions[u])
+				{
+					continue;
+				}
+				// collapses elsewhere may have changed the neighbourhood since the push, without touching the triangles of u
+				uint32_t v;
+				double const cost = evaluate(u, &v);
+				if (cost == NO_COLLAPSE)
+				{
+					continue;
+				}
+				if (cost > candidate.cost)
+				{
+					m_heap.push(Candidate{.cost = cost, .vertex = u, .version = ++m_versions[u]});
+					continue;
+				}
+
+				double const weight = m_quadrics[u].weight + m_quadrics[v].weight;
+				m_error = std::max(m_error, weight > 0. ? std::sqrt(cost / weight) : 0.);
+				collapse(u, v);
+				neighbours(v, &m_affected);
+				m_affected.push_back(v);
+				for (uint32_t w : m_affected)
+				{
+					push(w);
+				}
+			}
+		}
+
+		auto Simplifier::appendTriangles(uint32_t indexBase, std::vector<uint32_t>* outIndices) const -> void
+		{
+			for (uint32_t t = 0; t < m_triangles.size(); ++t)
+			{
+				if (m_triangleAlive[t])
+				{
+					for (uint32_t v : m_triangles[t])
+					{
+						outIndices->push_back(indexBase + v);
+					}
+				}
+			}
+		}
+
+		// -- one DrawItem --------------------------------------------------------------------------------------------------------------
+		struct ItemLods
+		{
+			LodChain chain;
+			std::vector<MeshLod> lods; // firstIndex relative to indices
+			std::vector<uint32_t> indices; // relative to the DrawItem's vertexOffset, as the DrawItem's own
+		};
+
+		// indices of the DrawItem, vertices the range [vertexOffset + minIndex, vertexOffset + maxIndex]
+		auto buildItemLods(std::span<uint32_t const> indices, std::span<Vertex const> vertices, uint32_t minIndex) -> ItemLods
+		{
+			std::vector<uint32_t> local(indices.begin(), indices.end());
+			Eigen::Vector3f boundsMin = vertices[local[0] - minIndex].pos;
+			Eigen::Vector3f boundsMax = boundsMin;
+			for (uint32_t& v : local)
+			{
+				v -= minIndex;
+				boundsMin = boundsMin.cwiseMin(vertices[v].pos);
+				boundsMax = boundsMax.cwiseMax(vertices[v].pos);
+			}
+			ItemLods result {.chain = LodChain{.firstLod = 0, .lodCount = 0, .center = .5f * (boundsMin + boundsMax), .radius = 0.f}, .lods = {}, .indices = {}};
+			for (uint32_t v : local)
+			{
+				result.chain.radius = std::max(result.chain.radius, (vertices[v].pos - result.chain.center).norm());
+			}
+
+			uint32_t previousCount = static_cast<uint32_t>(local.size() / 3);
+			if (previousCount < 2 * MESH_LOD_MIN_TRIANGLES)
+			{
+				return result;
+			}
+			Simplifier simplifier(local, vertices);
+			while (result.lods.size() < MESH_LOD_MAX_LEVELS)
+			{
+				uint32_t const target = static_cast<uint32_t>(previousCount * LOD_TRIANGLE_RATIO);
+				if (target < MESH_LOD_MIN_TRIANGLES)
+				{
+					break;
+				}
+				simplifier.simplify(target);
+				if (simplifier.triangleCount() > previousCount * LOD_STUCK_RATIO)
+				{
+					break;
+				}
+				uint32_t const firstIndex = static_cast<uint32_t>(result.indices.size());
+				simplifier.appendTriangles(minIndex, &result.indices);
+				result.lods.push_back(MeshLod{.indexCount = static_cast<uint32_t>(result.indices.size()) - firstIndex, .firstIndex = firstIndex, .error = simplifier.error()});
+				previousCount = simplifier.triangleCount();
+			}
+			result.chain.lodCount = static_cast<uint32_t>(result.lods.size());
+			return result;
+		}
+	}
+
+	auto buildLods(MeshData* mesh, JobSystem* jobSystem, MeshLodStats* outStats) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		uint64_t const beginNs = trace::now();
+		if (mesh->vertexFormat != VERTEX_FORMAT_FLOAT32 || !mesh->lodChains.empty())
+		{
+			fprintf(stderr, "mesh lod: LODs must be built once, before the vertices are encoded\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// 32 bit while building, LOD indices never exceed those of their DrawItem, so they fit back in 16 bits if those did
+		bool const indices16 = !mesh->indices16.empty();
+		std::vector<uint32_t> indices = indices16 ? std::vector<uint32_t>(mesh->indices16.begin(), mesh->indices16.end()) : std::move(mesh->indices);
+		auto const storeIndices = [mesh, &indices, indices16]() {
+			if (indices16)
+			{
+				mesh->indices16.assign(indices.begin(), indices.end());
+			}
+			else
+			{
+				mesh->indices = std::move(indices);
+			}
+		};
+
+		uint32_t const itemCount = static_cast<uint32_t>(mesh->drawItems.size());
+		std::vector<std::pair<uint32_t, uint32_t>> ranges(itemCount, {0, 0}); // min and max index of each DrawItem
+		std::vector<uint8_t> simplifiable(itemCount, 0);
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			DrawItem const& item = mesh->drawItems[i];
+			if (size_t{item.firstIndex} + item.indexCount > indices.size())
+			{
+				fprintf(stderr, "mesh lod: mesh %u is outside of the index buffer\n", i);
+				storeIndices();
+				return APP_GENERIC_ERR;
+			}
+			if (item.indexCount < 3 || item.indexCount % 3 != 0)
+			{
+				continue;
+			}
+			auto const [minIt, maxIt] = std::minmax_element(indices.begin() + item.firstIndex, indices.begin() + item.firstIndex + item.indexCount);
+			ranges[i] = {*minIt, *maxIt};
+			if (int64_t{item.vertexOffset} + *minIt < 0 || int64_t{item.vertexOffset} + *maxIt >= static_cast<int64_t>(mesh->vertices.size()))
+			{
+				fprintf(stderr, "mesh lod: mesh %u is outside of the vertex buffer\n", i);
+				storeIndices();
+				return APP_GENERIC_ERR;
+			}
+			simplifiable[i] = 1;
+		}
+
+		std::vector<ItemLods> itemLods(itemCount);
+		auto const buildRange = [mesh, &indices, &ranges, &simplifiable, &itemLods](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				if (simplifiable[i])
+				{
+					DrawItem const& item = mesh->drawItems[i];
+					std::span<Vertex const> const vertices(mesh->vertices.data() + (int64_t{item.vertexOffset} + ranges[i].first), ranges[i].second - ranges[i].first + 1);
+					itemLods[i] = buildItemLods(std::span<uint32_t const>(indices.data() + item.firstIndex, item.indexCount), vertices, ranges[i].first);
+				}
+			}
+		};
+		if (jobSystem)
+		{
+			jobSystem->parallel_for(itemCount, /*grainSize*/1, buildRange);
+		}
+		else
+		{
+			buildRange(0, itemCount);
+		}
+
+		// -- append to the shared index buffer ------------------------------------------------------------------------------------
+		MeshLodStats stats {.lodCount = 0, .meshCount = 0, .baseIndexCount = indices.size(), .lodIndexCount = 0};
+		for (ItemLods const& item : itemLods)
+		{
+			stats.lodIndexCount += item.indices.size();
+		}
+		if (indices.size() + stats.lodIndexCount > UINT32_MAX)
+		{
+			fprintf(stderr, "mesh lod: too many indices with LODs\n");
+			storeIndices();
+			return APP_GENERIC_ERR;
+		}
+		indices.reserve(indices.size() + stats.lodIndexCount);
+		mesh->lodChains.resize(itemCount);
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			ItemLods& item = itemLods[i];
+			item.chain.firstLod = static_cast<uint32_t>(mesh->lods.size());
+			mesh->lodChains[i] = item.chain;
+			for (MeshLod lod : item.lods)
+			{
+				lod.firstIndex += static_cast<uint32_t>(indices.size());
+				mesh->lods.push_back(lod);
+			}
+			indices.insert(indices.end(), item.indices.begin(), item.indices.end());
+			stats.lodCount += item.chain.lodCount;
+			stats.meshCount += item.chain.lodCount > 0;
+		}
+		storeIndices();
+
+		printf("built %u LODs for %u of %u meshes, %.1f%% more indices, in %.1f ms\n", stats.lodCount, stats.meshCount, itemCount,
+			   stats.baseIndexCount > 0 ? 100. * static_cast<double>(stats.lodIndexCount) / static_cast<double>(stats.baseIndexCount) : 0.,
+			   static_cast<double>(trace::now() - beginNs) * 1e-6);
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+		return APP_SUCCESS;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "status.h"
+#include "mesh_import.h"
+
+#include <cstdint>
+
+// Discrete LODs, built after optimizeMesh and before encodeVertices, as they need the float positions. Each DrawItem is simplified on
+// its own, in parallel, by edge collapses ordered by quadric error (Garland, Heckbert 1997): every vertex accumulates the planes of its
+// triangles, weighted by area, and the collapse moving the fewest distance from them goes first. Collapses are half edge ones, a vertex
+// merging into a neighbour, so every level indexes the vertices of the full detail mesh and only adds indices, appended to the same
+// index buffer. Collapses which would flip a triangle or make the mesh non manifold are skipped, and vertices on borders (or seams, where
+// the importer split vertices) never move, so that LODs of neighbouring meshes don't crack apart.
+// Each level halves the triangles of the previous one, until MESH_LOD_MIN_TRIANGLES or until the simplification gets stuck. Its error
+// is the largest distance, in object space, of the collapses so far: selectLod projects it on screen to pick the level per DrawItem
+namespace mxc
+{
+	class JobSystem;
+
+	inline constexpr uint32_t MESH_LOD_MAX_LEVELS = 8;
+	inline constexpr uint32_t MESH_LOD_MIN_TRIANGLES = 32;
+
+	struct MeshLodStats
+	{
+		uint32_t lodCount;
+		uint32_t meshCount; // DrawItems with at least one LOD
+		uint64_t baseIndexCount;
+		uint64_t lodIndexCount; // added to the index buffer
+	};
+
+	// fills mesh->lodChains and mesh->lods, and appends the LOD indices to the 16 or 32 bit index buffer. jobSystem can be null
+	auto buildLods(MeshData* mesh, JobSystem* jobSystem, MeshLodStats* outStats = nullptr) -> status_t;
+}
@@ -0,0 +1,458 @@
+#include "mesh_optimize.h"
+
+#include "job_system.h"
+#include "trace.h"
+
+#include <algorithm> // min, max, sort, stable_sort, fill
+#include <cstdio>
+#include <numeric> // iota
+#include <vector>
+
+namespace mxc
+{
+	namespace
+	{
+		inline constexpr uint32_t NO_VERTEX = UINT32_MAX;
+		inline constexpr double OVERDRAW_ACMR_THRESHOLD = 1.05; // how much worse than Tipsify's ACMR a cluster can be, and the final order
+
+		// what happens to one DrawItem
+		struct ItemPlan
+		{
+			uint32_t minIndex;
+			uint32_t maxIndex;
+			bool reorder; // its index range is its own
+			bool renumber; // its vertex range is its own too
+		};
+
+		struct ItemResult
+		{
+			uint64_t missesBefore;
+			uint64_t missesAfter;
+		};
+
+		// -- cache simulation ----------------------------------------------------------------------------------------------------------
+		// FIFO with timestamps: a vertex is cached if it missed less than cacheSize misses ago, and after the last flush
+		class FifoCache
+		{
+		public:
+			explicit FifoCache(uint32_t vertexCount) : m_stamps(vertexCount, 0), m_misses(MESH_OPTIMIZE_CACHE_SIZE), m_flushedAt(m_misses) {}
+
+			auto access(uint32_t v) -> bool // true if it missed
+			{
+				if (m_stamps[v] < m_flushedAt || m_misses - m_stamps[v] >= MESH_OPTIMIZE_CACHE_SIZE)
+				{
+					m_stamps[v] = m_misses++;
+					return true;
+				}
+				return false;
+			}
+			auto flush() -> void { m_flushedAt = m_misses; }
+			auto misses() const -> uint64_t { return m_misses - MESH_OPTIMIZE_CACHE_SIZE; }
+
+		private:
+			std::vector<uint64_t> m_stamps;
+			uint64_t m_misses;
+			uint64_t m_flushedAt;
+		};
+
+		auto countMisses(std::span<uint32_t const> indices, uint32_t vertexCount) -> uint64_t
+		{
+			FifoCache cache(vertexCount);
+			for (uint32_t v : indices)
+			{
+				cache.access(v);
+			}
+			return cache.misses();
+		}
+
+		// -- Tipsify -------------------------------------------------------------------------------------------------------------------
+		// fans around the vertex which is going to stay in the cache longest, falling back on recently seen vertices (the dead end stack)
+		// and then on the next one in order. outHardBoundaries gets the triangles where a fan started from a dead end
+		auto tipsify(std::span<uint32_t const> indices, uint32_t vertexCount, std::vector<uint32_t>* outOrder, std::vector<uint32_t>* outHardBoundaries) -> void
+		{
+			uint32_t const triangleCount = static_cast<uint32_t>(indices.size() / 3);
+			std::vector<uint32_t> liveCount(vertexCount, 0);
+			for (uint32_t v : indices)
+			{
+				++liveCount[v];
+			}
+			std::vector<uint32_t> adjacencyBegin(vertexCount + 1, 0);
+			for (uint32_t v = 0; v < vertexCount; ++v)
+			{
+				adjacencyBegin[v + 1] = adjacencyBegin[v] + liveCount[v];
+			}
+			std::vector<uint32_t> adjacency(indices.size());
+			std::vector<uint32_t> fill(adjacencyBegin.begin(), adjacencyBegin.end() - 1);
+			for (uint32_t i = 0; i < indices.size(); ++i)
+			{
+				adjacency[fill[indices[i]]++] = i / 3;
+			}
+
+			std::vector<uint32_t> cacheTime(vertexCount, 0);
+			std::vector<uint8_t> emitted(triangleCount, 0);
+			std::vector<uint32_t> deadEnds;
+			std::vector<uint32_t> candidates;
+			uint32_t time = MESH_OPTIMIZE_CACHE_SIZE + 1;
+			uint32_t cursor = 0;
+			auto const skipDeadEnd = [&]() -> uint32_t {
+				while (!deadEnds.empty())
+				{
+					uint32_t const v = deadEnds.back();
+					deadEnds.pop_back();
+					if (liveCount[v] > 0)
+					{
+						return v;
+					}
+				}
+				for (; cursor < vertexCount; ++cursor)
+				{
+					if (liveCount[cursor] > 0)
+					{
+						return cursor;
+					}
+				}
+				return NO_VERTEX;
+			};
+
+			outOrder->clear();
+			outHardBoundaries->assign(1, 0);
+			for (uint32_t fan = skipDeadEnd(); fan != NO_VERTEX;)
+			{
+				candidates.clear();
+				for (uint32_t a = adjacencyBegin[fan]; a < adjacencyBegin[fan + 1]; ++a)
+				{
+					uint32_t const t = adjacency[a];
+					if (emitted[t])
+					{
+						continue;
+					}
+					emitted[t] = 1;
+					outOrder->push_back(t);
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						uint32_t const v = indices[3 * t + c];
+						deadEnds.push_back(v);
+						candidates.push_back(v);
+						--liveCount[v];
+						if (time - cacheTime[v] > MESH_OPTIMIZE_CACHE_SIZE)
+						{
+							cacheTime[v] = time++;
+						}
+					}
+				}
+
+				// the candidate still in the cache after its remaining triangles are emitted, which entered it first
+				uint32_t next = NO_VERTEX;
+				int64_t bestPriority = -1;
+				for (uint32_t v : candidates)
+				{
+					if (liveCount[v] == 0)
+					{
+						continue;
+					}
+					int64_t const age = int64_t{time} - cacheTime[v];
+					int64_t const priority = age + 2 * int64_t{liveCount[v]} <= MESH_OPTIMIZE_CACHE_SIZE ? age : 0;
+					if (priority > bestPriority)
+					{
+						bestPriority = priority;
+						next = v;
+					}
+				}
+				if (next == NO_VERTEX)
+				{
+					next = skipDeadEnd();
+					if (outOrder->size() < triangleCount)
+					{
+						outHardBoundaries->push_back(static_cast<uint32_t>(outOrder->size()));
+					}
+				}
+				fan = next;
+			}
+		}
+
+		// -- overdraw ------------------------------------------------------------------------------------------------------------------
+		// splits the Tipsify order in clusters, each ending as soon as its ACMR, counted from a cold cache, is within the threshold of the
+		// whole mesh's, then sorts them by how much they face away from the mesh center, outwards first
+		auto sortClustersForOverdraw(std::span<uint32_t const> indices, std::span<Vertex const> vertices, std::span<uint32_t const> order,
+									 std::span<uint32_t const> hardBoundaries, uint32_t vertexCount, std::vector<uint32_t>* outOrder) -> void
+		{
+			uint32_t const triangleCount = static_cast<uint32_t>(order.size());
+			std::vector<uint32_t> orderedIndices(indices.size());
+			for (uint32_t i = 0; i < triangleCount; ++i)
+			{
+				std::copy_n(indices.begin() + 3 * order[i], 3, orderedIndices.begin() + 3 * i);
+			}
+			double const threshold = OVERDRAW_ACMR_THRESHOLD * static_cast<double>(countMisses(orderedIndices, vertexCount)) / triangleCount;
+
+			std::vector<uint32_t> clusterBegins;
+			FifoCache cache(vertexCount);
+			uint64_t clusterMissesBegin = 0;
+			uint32_t clusterBegin = 0;
+			size_t nextHardBoundary = 0;
+			for (uint32_t i = 0; i < triangleCount; ++i)
+			{
+				bool const hard = nextHardBoundary < hardBoundaries.size() && hardBoundaries[nextHardBoundary] == i;
+				nextHardBoundary += hard;
+				if (hard || i == clusterBegin)
+				{
+					clusterBegin = i;
+					clusterBegins.push_back(i);
+					cache.flush();
+					clusterMissesBegin = cache.misses();
+				}
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					cache.access(orderedIndices[3 * i + c]);
+				}
+				double const clusterAcmr = static_cast<double>(cache.misses() - clusterMissesBegin) / (i + 1 - clusterBegin);
+				if (clusterAcmr <= threshold)
+				{
+					clusterBegin = i + 1; // the next triangle opens a new cluster
+				}
+			}
+			clusterBegins.push_back(triangleCount);
+
+			// centroid and normal of each cluster, area weighted. Cross products are twice the area times the normal
+			uint32_t const clusterCount = static_cast<uint32_t>(clusterBegins.size() - 1);
+			std::vector<Eigen::Vector3f> centroids(clusterCount);
+			std::vector<Eigen::Vector3f> normals(clusterCount);
+			Eigen::Vector3f meshCentroid = Eigen::Vector3f::Zero();
+			float meshArea = 0.f;
+			for (uint32_t k = 0; k < clusterCount; ++k)
+			{
+				Eigen::Vector3f weightedCentroid = Eigen::Vector3f::Zero();
+				Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+				float area = 0.f;
+				for (uint32_t i = clusterBegins[k]; i < clusterBegins[k + 1]; ++i)
+				{
+					Eigen::Vector3f const& a = vertices[orderedIndices[3 * i]].pos;
+					Eigen::Vector3f const& b = vertices[orderedIndices[3 * i + 1]].pos;
+					Eigen::Vector3f const& c = vertices[orderedIndices[3 * i + 2]].pos;
+					Eigen::Vector3f const cross = (b - a).cross(c - a);
+					float const triangleArea = cross.norm();
+					normal += cross;
+					weightedCentroid += triangleArea * (a + b + c) / 3.f;
+					area += triangleArea;
+				}
+				meshCentroid += weightedCentroid;
+				meshArea += area;
+				centroids[k] = area > 0.f ? Eigen::Vector3f(weightedCentroid / area) : vertices[orderedIndices[3 * clusterBegins[k]]].pos;
+				normals[k] = normal.normalized();
+			}
+			if (meshArea > 0.f)
+			{
+				meshCentroid /= meshArea;
+			}
+
+			std::vector<float> occlusion(clusterCount);
+			for (uint32_t k = 0; k < clusterCount; ++k)
+			{
+				occlusion[k] = (centroids[k] - meshCentroid).dot(normals[k]);
+			}
+			std::vector<uint32_t> clusterOrder(clusterCount);
+			std::iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+			std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&occlusion](uint32_t a, uint32_t b) { return occlusion[a] > occlusion[b]; });
+
+			outOrder->clear();
+			for (uint32_t k : clusterOrder)
+			{
+				outOrder->insert(outOrder->end(), order.begin() + clusterBegins[k], order.begin() + clusterBegins[k + 1]);
+			}
+		}
+
+		// -- one DrawItem --------------------------------------------------------------------------------------------------------------
+		// indices are already rebased on minIndex, vertices is the range they refer to
+		auto optimizeItem(std::span<uint32_t> indices, std::span<Vertex> vertices, bool renumber) -> ItemResult
+		{
+			uint32_t const vertexCount = static_cast<uint32_t>(vertices.size());
+			uint64_t const missesBefore = countMisses(indices, vertexCount);
+
+			std::vector<uint32_t> cacheOrder;
+			std::vector<uint32_t> hardBoundaries;
+			tipsify(indices, vertexCount, &cacheOrder, &hardBoundaries);
+			std::vector<uint32_t> order;
+			sortClustersForOverdraw(indices, vertices, cacheOrder, hardBoundaries, vertexCount, &order);
+
+			std::vector<uint32_t> reordered(indices.size());
+			for (uint32_t i = 0; i < order.size(); ++i)
+			{
+				std::copy_n(indices.begin() + 3 * order[i], 3, reordered.begin() + 3 * i); // corners keep their order, and so the winding
+			}
+			uint64_t missesAfter = countMisses(reordered, vertexCount);
+			if (static_cast<double>(missesAfter) > OVERDRAW_ACMR_THRESHOLD * static_cast<double>(missesBefore))
+			{
+				reordered.assign(indices.begin(), indices.end()); // already well ordered, or too small to gain anything
+				missesAfter = missesBefore;
+			}
+
+			if (renumber)
+			{
+				std::vector<uint32_t> newIndex(vertexCount, NO_VERTEX);
+				uint32_t next = 0;
+				for (uint32_t& v : reordered)
+				{
+					if (newIndex[v] == NO_VERTEX)
+					{
+						newIndex[v] = next++;
+					}
+					v = newIndex[v];
+				}
+				for (uint32_t& v : newIndex) // unused ones go at the end
+				{
+					v = v == NO_VERTEX ? next++ : v;
+				}
+				std::vector<Vertex> renumbered(vertexCount);
+				for (uint32_t v = 0; v < vertexCount; ++v)
+				{
+					renumbered[newIndex[v]] = vertices[v];
+				}
+				std::copy(renumbered.begin(), renumbered.end(), vertices.begin());
+			}
+			std::copy(reordered.begin(), reordered.end(), indices.begin());
+			return ItemResult{.missesBefore = missesBefore, .missesAfter = missesAfter};
+		}
+
+		// flags DrawItems whose [begin, end) range, given by rangeOf, overlaps another's
+		template <typename F> auto findOverlaps(std::span<DrawItem const> drawItems, F const& rangeOf, std::vector<uint8_t>* outOverlaps) -> void
+		{
+			std::vector<uint32_t> sorted(drawItems.size());
+			std::iota(sorted.begin(), sorted.end(), 0u);
+			std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return rangeOf(a).first < rangeOf(b).first; });
+			outOverlaps->assign(drawItems.size(), 0);
+			int64_t furthestEnd = INT64_MIN;
+			uint32_t furthestItem = 0;
+			for (uint32_t i : sorted)
+			{
+				auto const [begin, end] = rangeOf(i);
+				if (begin < furthestEnd)
+				{
+					(*outOverlaps)[i] = 1;
+					(*outOverlaps)[furthestItem] = 1;
+				}
+				if (end > furthestEnd)
+				{
+					furthestEnd = end;
+					furthestItem = i;
+				}
+			}
+		}
+	}
+
+	auto optimizeMesh(MeshData* mesh, JobSystem* jobSystem, MeshOptimizeStats* outStats) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		uint64_t const beginNs = trace::now();
+		if (mesh->vertexFormat != VERTEX_FORMAT_FLOAT32 || !mesh->indices16.empty())
+		{
+			fprintf(stderr, "mesh optimize: the mesh must be optimized before being encoded\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// -- plan: what each DrawItem can safely do, in parallel with the others ---------------------------------------------------
+		uint32_t const itemCount = static_cast<uint32_t>(mesh->drawItems.size());
+		std::vector<ItemPlan> plans(itemCount);
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			DrawItem const& item = mesh->drawItems[i];
+			if (size_t{item.firstIndex} + item.indexCount > mesh->indices.size())
+			{
+				fprintf(stderr, "mesh optimize: mesh %u is outside of the index buffer\n", i);
+				return APP_GENERIC_ERR;
+			}
+			auto const [minIt, maxIt] = std::minmax_element(mesh->indices.begin() + item.firstIndex, mesh->indices.begin() + item.firstIndex + item.indexCount);
+			plans[i] = ItemPlan{
+				.minIndex = item.indexCount > 0 ? *minIt : 0,
+				.maxIndex = item.indexCount > 0 ? *maxIt : 0,
+				.reorder = item.indexCount >= 3 && item.indexCount % 3 == 0,
+				.renumber = false
+			};
+			if (plans[i].reorder && int64_t{item.vertexOffset} + plans[i].maxIndex >= static_cast<int64_t>(mesh->vertices.size()))
+			{
+				fprintf(stderr, "mesh optimize: mesh %u is outside of the vertex buffer\n", i);
+				return APP_GENERIC_ERR;
+			}
+		}
+		std::vector<uint8_t> indexOverlaps;
+		std::vector<uint8_t> vertexOverlaps;
+		findOverlaps(mesh->drawItems, [mesh](uint32_t i) {
+			return std::pair<int64_t, int64_t>(mesh->drawItems[i].firstIndex, int64_t{mesh->drawItems[i].firstIndex} + mesh->drawItems[i].indexCount);
+		}, &indexOverlaps);
+		findOverlaps(mesh->drawItems, [mesh, &plans](uint32_t i) {
+			int64_t const base = mesh->drawItems[i].vertexOffset;
+			return std::pair<int64_t, int64_t>(base + plans[i].minIndex, base + plans[i].maxIndex + 1);
+		}, &vertexOverlaps);
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			plans[i].reorder = plans[i].reorder && !indexOverlaps[i];
+			plans[i].renumber = plans[i].reorder && !vertexOverlaps[i];
+		}
+
+		// -- optimize -------------------------------------------------------------------------------------------------------------
+		std::vector<ItemResult> results(itemCount, ItemResult{.missesBefore = 0, .missesAfter = 0});
+		auto const optimizeRange = [mesh, &plans, &results](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				if (!plans[i].reorder)
+				{
+					continue;
+				}
+				DrawItem& item = mesh->drawItems[i];
+				std::span<uint32_t> const indices(mesh->indices.data() + item.firstIndex, item.indexCount);
+				uint32_t const base = plans[i].minIndex;
+				for (uint32_t& v : indices)
+				{
+					v -= base;
+				}
+				item.vertexOffset += static_cast<int32_t>(base);
+				std::span<Vertex> const vertices(mesh->vertices.data() + item.vertexOffset, plans[i].maxIndex - base + 1);
+				results[i] = optimizeItem(indices, vertices, plans[i].renumber);
+			}
+		};
+		if (jobSystem)
+		{
+			jobSystem->parallel_for(itemCount, /*grainSize*/1, optimizeRange);
+		}
+		else
+		{
+			optimizeRange(0, itemCount);
+		}
+
+		// -- stats, index size ----------------------------------------------------------------------------------------------------
+		MeshOptimizeStats stats {.acmrBefore = 0., .acmrAfter = 0., .meshCount = 0, .renumberedMeshCount = 0, .indices16 = false};
+		uint64_t missesBefore = 0;
+		uint64_t missesAfter = 0;
+		uint64_t triangleCount = 0;
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			if (plans[i].reorder)
+			{
+				missesBefore += results[i].missesBefore;
+				missesAfter += results[i].missesAfter;
+				triangleCount += mesh->drawItems[i].indexCount / 3;
+				++stats.meshCount;
+				stats.renumberedMeshCount += plans[i].renumber;
+			}
+		}
+		if (triangleCount > 0)
+		{
+			stats.acmrBefore = static_cast<double>(missesBefore) / static_cast<double>(triangleCount);
+			stats.acmrAfter = static_cast<double>(missesAfter) / static_cast<double>(triangleCount);
+		}
+
+		stats.indices16 = !mesh->indices.empty() && *std::max_element(mesh->indices.begin(), mesh->indices.end()) <= UINT16_MAX;
+		if (stats.indices16)
+		{
+			mesh->indices16.assign(mesh->indices.begin(), mesh->indices.end());
+			mesh->indices = {};
+		}
+
+		printf("optimized %u meshes (%u renumbered): ACMR %.3f -> %.3f with a %u entries FIFO, %u bit indices, in %.1f ms\n", stats.meshCount,
+			   stats.renumberedMeshCount, stats.acmrBefore, stats.acmrAfter, MESH_OPTIMIZE_CACHE_SIZE, stats.indices16 ? 16u : 32u,
+			   static_cast<double>(trace::now() - beginNs) * 1e-6);
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+		return APP_SUCCESS;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "status.h"
+#include "mesh_import.h"
+
+#include <cstdint>
+
+// Mesh optimization, after import and before encodeVertices, as it needs the float positions. Each DrawItem is processed on its own,
+// in parallel:
+// - triangles are reordered for the post transform vertex cache with Tipsify (Sander, Nehab, Barczak 2007), then the clusters it produces,
+//   split where their ACMR is close enough to the whole mesh's, are sorted so that outward facing ones, which are likely to occlude
+//   the others, come first, to reduce overdraw. The new order is dropped if it makes the cache misses more than 5% worse
+// - vertices are renumbered in order of first use, so vertex fetch walks the buffer forward, and the DrawItem rebased on its first vertex
+// Finally indices become 16 bit if every DrawItem spans at most 65536 vertices.
+// ACMR (average cache miss ratio) is the vertices transformed per triangle with a FIFO cache of MESH_OPTIMIZE_CACHE_SIZE entries: 3 is
+// the worst, 0.5 the ideal on a large regular grid.
+// DrawItems sharing index ranges are left as they are, ones sharing vertex ranges (eg. all using vertexOffset 0) keep their vertex order
+namespace mxc
+{
+	class JobSystem;
+
+	inline constexpr uint32_t MESH_OPTIMIZE_CACHE_SIZE = 16;
+
+	struct MeshOptimizeStats
+	{
+		double acmrBefore;
+		double acmrAfter;
+		uint32_t meshCount; // DrawItems whose triangles could be reordered
+		uint32_t renumberedMeshCount; // DrawItems whose vertices could be renumbered too
+		bool indices16;
+	};
+
+	// jobSystem can be null, like for importMesh
+	auto optimizeMesh(MeshData* mesh, JobSystem* jobSystem, MeshOptimizeStats* outStats = nullptr) -> status_t;
+}
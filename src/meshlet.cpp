@@ -0,0 +1,520 @@
+#include "meshlet.h"
+
+#include "mesh_import.h"
+#include "job_system.h"
+#include "trace.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MXC_MESHLET_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm> // minmax_element, sort, min, max
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric> // iota
+#include <utility> // pair
+#include <vector>
+
+namespace mxc
+{
+	namespace
+	{
+		inline constexpr uint32_t NO_TRIANGLE = UINT32_MAX;
+
+		struct Bounds
+		{
+			Eigen::Vector3f center;
+			float radius;
+			Eigen::Vector3f axis;
+			float coneCos;
+			float coneSin;
+		};
+
+		// -- one DrawItem --------------------------------------------------------------------------------------------------------------
+		struct ItemMeshlets
+		{
+			std::vector<Meshlet> meshlets; // firstIndex relative to the DrawItem's
+			std::vector<Bounds> bounds;
+			uint64_t vertexCount = 0; // summed over the meshlets
+		};
+
+		// sphere around the AABB center, cone around the average normal. A cone which can't be narrower than a half space never culls
+		auto meshletBounds(std::span<uint32_t const> indices, std::span<Vertex const> vertices) -> Bounds
+		{
+			Eigen::Vector3f boundsMin = vertices[indices[0]].pos;
+			Eigen::Vector3f boundsMax = boundsMin;
+			Eigen::Vector3f normalSum = Eigen::Vector3f::Zero();
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				Eigen::Vector3f const& a = vertices[indices[i]].pos;
+				Eigen::Vector3f const& b = vertices[indices[i + 1]].pos;
+				Eigen::Vector3f const& c = vertices[indices[i + 2]].pos;
+				boundsMin = boundsMin.cwiseMin(a).cwiseMin(b).cwiseMin(c);
+				boundsMax = boundsMax.cwiseMax(a).cwiseMax(b).cwiseMax(c);
+				Eigen::Vector3f const n = (b - a).cross(c - a);
+				float const length = n.norm();
+				if (length > 0.f)
+				{
+					normalSum += n / length;
+				}
+			}
+
+			Bounds result {.center = .5f * (boundsMin + boundsMax), .radius = 0.f, .axis = Eigen::Vector3f::Zero(), .coneCos = 0.f, .coneSin = 1.f};
+			for (uint32_t v : indices)
+			{
+				result.radius = std::max(result.radius, (vertices[v].pos - result.center).norm());
+			}
+
+			float const sumLength = normalSum.norm();
+			if (sumLength <= 0.f)
+			{
+				return result;
+			}
+			Eigen::Vector3f const axis = normalSum / sumLength;
+			float minDot = 1.f;
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				Eigen::Vector3f const& a = vertices[indices[i]].pos;
+				Eigen::Vector3f const n = (vertices[indices[i + 1]].pos - a).cross(vertices[indices[i + 2]].pos - a);
+				float const length = n.norm();
+				if (length > 0.f)
+				{
+					minDot = std::min(minDot, axis.dot(n) / length);
+				}
+			}
+			if (minDot > 0.f)
+			{
+				result.axis = axis;
+				result.coneCos = minDot;
+				result.coneSin = std::sqrt(std::max(1.f - minDot * minDot, 0.f));
+			}
+			return result;
+		}
+
+		// reorders indices in place, meshlet after meshlet. vertices the range [vertexOffset + minIndex, vertexOffset + maxIndex]
+		auto buildItemMeshlets(std::span<uint32_t> indices, std::span<Vertex const> vertices, uint32_t minIndex) -> ItemMeshlets
+		{
+			uint32_t const triangleCount = static_cast<uint32_t>(indices.size() / 3);
+			uint32_t const vertexCount = static_cast<uint32_t>(vertices.size());
+
+			// triangles of each vertex, CSR
+			std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+			for (uint32_t v : indices)
+			{
+				++triangleOffsets[v - minIndex + 1];
+			}
+			std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+			std::vector<uint32_t> vertexTriangles(indices.size());
+			std::vector<uint32_t> written(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			std::vector<Eigen::Vector3f> centroids(triangleCount);
+			for (uint32_t t = 0; t < triangleCount; ++t)
+			{
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					vertexTriangles[written[indices[3 * t + c] - minIndex]++] = t;
+				}
+				centroids[t] = (vertices[indices[3 * t] - minIndex].pos + vertices[indices[3 * t + 1] - minIndex].pos + vertices[indices[3 * t + 2] - minIndex].pos) / 3.f;
+			}
+
+			ItemMeshlets result;
+			std::vector<uint32_t> order; // triangles, meshlet after meshlet
+			order.reserve(triangleCount);
+			std::vector<uint8_t> assigned(triangleCount, 0);
+			std::vector<uint32_t> vertexStamp(vertexCount, UINT32_MAX); // meshlet which last took each vertex
+			std::vector<uint32_t> candidateStamp(triangleCount, UINT32_MAX);
+			std::vector<uint32_t> candidates;
+			uint32_t cursor = 0; // every triangle before it is assigned
+			while (order.size() < triangleCount)
+			{
+				uint32_t const id = static_cast<uint32_t>(result.meshlets.size());
+				uint32_t const firstTriangle = static_cast<uint32_t>(order.size());
+				uint32_t meshletVertexCount = 0;
+				Eigen::Vector3f centroidSum = Eigen::Vector3f::Zero();
+				candidates.clear();
+
+				auto const newVertices = [&](uint32_t t) {
+					uint32_t count = 0;
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						count += vertexStamp[indices[3 * t + c] - minIndex] != id;
+					}
+					return count;
+				};
+				auto const take = [&](uint32_t t) {
+					assigned[t] = 1;
+					order.push_back(t);
+					centroidSum += centroids[t];
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						uint32_t const v = indices[3 * t + c] - minIndex;
+						if (vertexStamp[v] == id)
+						{
+							continue;
+						}
+						vertexStamp[v] = id;
+						++meshletVertexCount;
+						for (uint32_t i = triangleOffsets[v]; i < triangleOffsets[v + 1]; ++i)
+						{
+							uint32_t const neighbour = vertexTriangles[i];
+							if (!assigned[neighbour] && candidateStamp[neighbour] != id)
+							{
+								candidateStamp[neighbour] = id;
+								candidates.push_back(neighbour);
+							}
+						}
+					}
+				};
+
+				for (; assigned[cursor]; ++cursor) {}
+				take(cursor);
+				while (order.size() - firstTriangle < MESHLET_MAX_TRIANGLES)
+				{
+					// the neighbour adding the fewest vertices, then the closest to the meshlet
+					Eigen::Vector3f const centroid = centroidSum / static_cast<float>(order.size() - firstTriangle);
+					uint32_t best = NO_TRIANGLE;
+					uint32_t bestNew = 4;
+					float bestDistance = std::numeric_limits<float>::infinity();
+					for (size_t i = 0; i < candidates.size();)
+					{
+						uint32_t const t = candidates[i];
+						if (assigned[t])
+						{
+							candidates[i] = candidates.back();
+							candidates.pop_back();
+							continue;
+						}
+						++i;
+						uint32_t const count = newVertices(t);
+						if (meshletVertexCount + count > MESHLET_MAX_VERTICES || count > bestNew)
+						{
+							continue;
+						}
+						float const distance = (centroids[t] - centroid).squaredNorm();
+						if (count < bestNew || distance < bestDistance)
+						{
+							best = t;
+							bestNew = count;
+							bestDistance = distance;
+						}
+					}
+					// no neighbour left or fitting: continue with the next triangle in cache order, which is usually close anyway
+					if (best == NO_TRIANGLE)
+					{
+						for (; cursor < triangleCount && assigned[cursor]; ++cursor) {}
+						if (cursor == triangleCount || meshletVertexCount + newVertices(cursor) > MESHLET_MAX_VERTICES)
+						{
+							break;
+						}
+						best = cursor;
+					}
+					take(best);
+				}
+
+				uint32_t const meshletTriangleCount = static_cast<uint32_t>(order.size()) - firstTriangle;
+				result.meshlets.push_back(Meshlet{.indexCount = 3 * meshletTriangleCount, .firstIndex = 3 * firstTriangle});
+				result.vertexCount += meshletVertexCount;
+			}
+
+			std::vector<uint32_t> reordered(indices.size());
+			for (uint32_t i = 0; i < triangleCount; ++i)
+			{
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					reordered[3 * i + c] = indices[3 * order[i] + c] - minIndex;
+				}
+			}
+			result.bounds.reserve(result.meshlets.size());
+			for (Meshlet const& meshlet : result.meshlets)
+			{
+				result.bounds.push_back(meshletBounds(std::span<uint32_t const>(reordered.data() + meshlet.firstIndex, meshlet.indexCount), vertices));
+			}
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				indices[i] = reordered[i] + minIndex;
+			}
+			return result;
+		}
+	}
+
+	auto buildMeshlets(MeshData* mesh, JobSystem* jobSystem, MeshletStats* outStats) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		uint64_t const beginNs = trace::now();
+		if (mesh->vertexFormat != VERTEX_FORMAT_FLOAT32 || !mesh->meshletRanges.empty())
+		{
+			fprintf(stderr, "meshlet: meshlets must be built once, before the vertices are encoded\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// 32 bit while building, reordering doesn't change which indices there are
+		bool const indices16 = !mesh->indices16.empty();
+		std::vector<uint32_t> indices = indices16 ? std::vector<uint32_t>(mesh->indices16.begin(), mesh->indices16.end()) : std::move(mesh->indices);
+		auto const storeIndices = [mesh, &indices, indices16]() {
+			if (indices16)
+			{
+				mesh->indices16.assign(indices.begin(), indices.end());
+			}
+			else
+			{
+				mesh->indices = std::move(indices);
+			}
+		};
+
+		uint32_t const itemCount = static_cast<uint32_t>(mesh->drawItems.size());
+		std::vector<std::pair<uint32_t, uint32_t>> ranges(itemCount, {0, 0}); // min and max index of each DrawItem
+		std::vector<uint8_t> clusterable(itemCount, 0);
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			DrawItem const& item = mesh->drawItems[i];
+			if (size_t{item.firstIndex} + item.indexCount > indices.size())
+			{
+				fprintf(stderr, "meshlet: mesh %u is outside of the index buffer\n", i);
+				storeIndices();
+				return APP_GENERIC_ERR;
+			}
+			if (item.indexCount < 3 || item.indexCount % 3 != 0)
+			{
+				continue;
+			}
+			auto const [minIt, maxIt] = std::minmax_element(indices.begin() + item.firstIndex, indices.begin() + item.firstIndex + item.indexCount);
+			ranges[i] = {*minIt, *maxIt};
+			if (int64_t{item.vertexOffset} + *minIt < 0 || int64_t{item.vertexOffset} + *maxIt >= static_cast<int64_t>(mesh->vertices.size()))
+			{
+				fprintf(stderr, "meshlet: mesh %u is outside of the vertex buffer\n", i);
+				storeIndices();
+				return APP_GENERIC_ERR;
+			}
+			clusterable[i] = 1;
+		}
+
+		// reordering the triangles of a DrawItem sharing indices with another would reorder those of the other too
+		std::vector<uint32_t> sorted(itemCount);
+		std::iota(sorted.begin(), sorted.end(), 0u);
+		std::sort(sorted.begin(), sorted.end(), [mesh](uint32_t a, uint32_t b) { return mesh->drawItems[a].firstIndex < mesh->drawItems[b].firstIndex; });
+		uint64_t furthestEnd = 0;
+		uint32_t furthestItem = 0;
+		for (uint32_t i : sorted)
+		{
+			DrawItem const& item = mesh->drawItems[i];
+			if (item.indexCount == 0)
+			{
+				continue;
+			}
+			if (item.firstIndex < furthestEnd)
+			{
+				clusterable[i] = 0;
+				clusterable[furthestItem] = 0;
+			}
+			if (uint64_t{item.firstIndex} + item.indexCount > furthestEnd)
+			{
+				furthestEnd = uint64_t{item.firstIndex} + item.indexCount;
+				furthestItem = i;
+			}
+		}
+
+		std::vector<ItemMeshlets> itemMeshlets(itemCount);
+		auto const buildRange = [mesh, &indices, &ranges, &clusterable, &itemMeshlets](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				if (clusterable[i])
+				{
+					DrawItem const& item = mesh->drawItems[i];
+					std::span<Vertex const> const vertices(mesh->vertices.data() + (int64_t{item.vertexOffset} + ranges[i].first), ranges[i].second - ranges[i].first + 1);
+					itemMeshlets[i] = buildItemMeshlets(std::span<uint32_t>(indices.data() + item.firstIndex, item.indexCount), vertices, ranges[i].first);
+				}
+			}
+		};
+		if (jobSystem)
+		{
+			jobSystem->parallel_for(itemCount, /*grainSize*/1, buildRange);
+		}
+		else
+		{
+			buildRange(0, itemCount);
+		}
+		storeIndices();
+
+		// -- gather, bounds in groups of 4 --------------------------------------------------------------------------------------------
+		MeshletStats stats {.meshletCount = 0, .meshCount = 0, .averageTriangles = 0., .averageVertices = 0.};
+		uint64_t vertexCount = 0;
+		mesh->meshletRanges.resize(itemCount);
+		for (uint32_t i = 0; i < itemCount; ++i)
+		{
+			ItemMeshlets const& item = itemMeshlets[i];
+			mesh->meshletRanges[i] = MeshletRange{.firstMeshlet = static_cast<uint32_t>(mesh->meshlets.size()), .meshletCount = static_cast<uint32_t>(item.meshlets.size())};
+			for (Meshlet meshlet : item.meshlets)
+			{
+				meshlet.firstIndex += mesh->drawItems[i].firstIndex;
+				mesh->meshlets.push_back(meshlet);
+				stats.averageTriangles += meshlet.indexCount / 3;
+			}
+			stats.meshCount += !item.meshlets.empty();
+			vertexCount += item.vertexCount;
+		}
+		stats.meshletCount = static_cast<uint32_t>(mesh->meshlets.size());
+		mesh->meshletBounds.assign((mesh->meshlets.size() + 3) / 4, MeshletBounds4{});
+		for (uint32_t i = 0, meshlet = 0; i < itemCount; ++i)
+		{
+			for (Bounds const& bounds : itemMeshlets[i].bounds)
+			{
+				MeshletBounds4& group = mesh->meshletBounds[meshlet / 4];
+				uint32_t const lane = meshlet++ % 4;
+				group.centerX[lane] = bounds.center.x();
+				group.centerY[lane] = bounds.center.y();
+				group.centerZ[lane] = bounds.center.z();
+				group.radius[lane] = bounds.radius;
+				group.axisX[lane] = bounds.axis.x();
+				group.axisY[lane] = bounds.axis.y();
+				group.axisZ[lane] = bounds.axis.z();
+				group.coneCos[lane] = bounds.coneCos;
+				group.coneSin[lane] = bounds.coneSin;
+			}
+		}
+		if (stats.meshletCount > 0)
+		{
+			stats.averageTriangles /= stats.meshletCount;
+			stats.averageVertices = static_cast<double>(vertexCount) / stats.meshletCount;
+		}
+
+		printf("built %u meshlets for %u of %u meshes, %.1f triangles and %.1f vertices each, in %.1f ms\n", stats.meshletCount, stats.meshCount,
+			   itemCount, stats.averageTriangles, stats.averageVertices, static_cast<double>(trace::now() - beginNs) * 1e-6);
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+		return APP_SUCCESS;
+	}
+
+	// -- culling -------------------------------------------------------------------------------------------------------------------------
+	namespace
+	{
+		auto det3(Eigen::Vector3f const& a, Eigen::Vector3f const& b, Eigen::Vector3f const& c) -> float { return a.dot(b.cross(c)); }
+	}
+
+	auto meshletCuller(Eigen::Matrix4f const& objectToClip) -> MeshletCuller
+	{
+		Eigen::Matrix4f const& m = objectToClip;
+		// Vulkan clip volume: -w <= x <= w, -w <= y <= w, 0 <= z <= w
+		MeshletCuller result {
+			.planes = {
+				Eigen::Vector4f(m.row(3) + m.row(0)), Eigen::Vector4f(m.row(3) - m.row(0)),
+				Eigen::Vector4f(m.row(3) + m.row(1)), Eigen::Vector4f(m.row(3) - m.row(1)),
+				Eigen::Vector4f(m.row(2)), Eigen::Vector4f(m.row(3) - m.row(2)),
+			},
+			.eye = Eigen::Vector4f::Zero(),
+		};
+		for (Eigen::Vector4f& plane : result.planes)
+		{
+			float const length = plane.head<3>().norm();
+			plane /= length > 0.f ? length : 1.f;
+		}
+
+		// the eye is what projects to nowhere on screen: the null vector of the x, y, w rows, whose components are the cofactors of the 4x4
+		// matrix made of those rows and any other one
+		Eigen::Matrix<float, 3, 4> p;
+		p << m.row(0), m.row(1), m.row(3);
+		Eigen::Vector4f eye;
+		for (int32_t column = 0; column < 4; ++column)
+		{
+			Eigen::Matrix3f minor;
+			for (int32_t c = 0, j = 0; c < 4; ++c)
+			{
+				if (c != column)
+				{
+					minor.col(j++) = p.col(c);
+				}
+			}
+			eye[column] = (column % 2 == 0 ? 1.f : -1.f) * minor.determinant();
+		}
+
+		// its sign: a triangle (a, b, c) is front facing, with counter clockwise front faces and y pointing down, when the determinant of its
+		// projected (x, y, w) corners is negative, and that determinant is proportional to dot(n, eye.xyz - a * eye.w), with the constant
+		// found on whichever reference triangle gives the largest value
+		std::array<std::array<Eigen::Vector3f, 3>, 4> const references {{
+			{Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitX(), Eigen::Vector3f::UnitY()},
+			{Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitY(), Eigen::Vector3f::UnitZ()},
+			{Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitZ(), Eigen::Vector3f::UnitX()},
+			{Eigen::Vector3f::Ones(), Eigen::Vector3f(2.f, 1.f, 1.f), Eigen::Vector3f(1.f, 2.f, 1.f)},
+		}};
+		float bestPlane = 0.f;
+		float bestDeterminant = 0.f;
+		for (auto const& [a, b, c] : references)
+		{
+			float const plane = (b - a).cross(c - a).dot(eye.head<3>() - a * eye.w());
+			if (std::abs(plane) > std::abs(bestPlane))
+			{
+				bestPlane = plane;
+				bestDeterminant = det3(p * a.homogeneous(), p * b.homogeneous(), p * c.homogeneous());
+			}
+		}
+		if (bestPlane != 0.f && bestDeterminant != 0.f)
+		{
+			// front facing, determinant < 0, must give dot < 0
+			result.eye = (bestDeterminant > 0.f) == (bestPlane > 0.f) ? eye : Eigen::Vector4f(-eye);
+		}
+		return result;
+	}
+
+	auto cullMeshlets(std::span<MeshletBounds4 const> bounds, uint32_t first, uint32_t last, MeshletCuller const& culler, uint8_t* outVisible) -> void
+	{
+		for (uint32_t g = first / 4; g < (last + 3) / 4; ++g)
+		{
+			MeshletBounds4 const& group = bounds[g];
+			uint32_t mask;
+#ifdef MXC_MESHLET_SSE2
+			__m128 const cx = _mm_loadu_ps(group.centerX);
+			__m128 const cy = _mm_loadu_ps(group.centerY);
+			__m128 const cz = _mm_loadu_ps(group.centerZ);
+			__m128 const r = _mm_loadu_ps(group.radius);
+			__m128 const negR = _mm_sub_ps(_mm_setzero_ps(), r);
+			__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (Eigen::Vector4f const& plane : culler.planes)
+			{
+				__m128 const d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x()), cx), _mm_mul_ps(_mm_set1_ps(plane.y()), cy)),
+											_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z()), cz), _mm_set1_ps(plane.w())));
+				visible = _mm_and_ps(visible, _mm_cmpge_ps(d, negR));
+			}
+			// the cone faces away from every point of the sphere: the angle between the axis and the direction to the eye, minus the
+			// angle subtended by the sphere, is more than 90 degrees plus the cone's half angle
+			__m128 const ew = _mm_set1_ps(culler.eye.w());
+			__m128 const bx = _mm_sub_ps(_mm_set1_ps(culler.eye.x()), _mm_mul_ps(cx, ew));
+			__m128 const by = _mm_sub_ps(_mm_set1_ps(culler.eye.y()), _mm_mul_ps(cy, ew));
+			__m128 const bz = _mm_sub_ps(_mm_set1_ps(culler.eye.z()), _mm_mul_ps(cz, ew));
+			__m128 const t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(group.axisX), bx), _mm_mul_ps(_mm_loadu_ps(group.axisY), by)),
+										_mm_mul_ps(_mm_loadu_ps(group.axisZ), bz));
+			__m128 const bb = _mm_add_ps(_mm_add_ps(_mm_mul_ps(bx, bx), _mm_mul_ps(by, by)), _mm_mul_ps(bz, bz));
+			__m128 const s = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(bb, _mm_mul_ps(t, t)), _mm_setzero_ps()));
+			__m128 const lhs = _mm_sub_ps(_mm_mul_ps(t, _mm_loadu_ps(group.coneCos)), _mm_mul_ps(s, _mm_loadu_ps(group.coneSin)));
+			visible = _mm_andnot_ps(_mm_cmpgt_ps(lhs, _mm_mul_ps(r, _mm_set1_ps(std::abs(culler.eye.w())))), visible);
+			mask = static_cast<uint32_t>(_mm_movemask_ps(visible));
+#else
+			mask = 0;
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				Eigen::Vector3f const center(group.centerX[lane], group.centerY[lane], group.centerZ[lane]);
+				float const r = group.radius[lane];
+				bool visible = true;
+				for (Eigen::Vector4f const& plane : culler.planes)
+				{
+					visible = visible && plane.head<3>().dot(center) + plane.w() >= -r;
+				}
+				Eigen::Vector3f const b = culler.eye.head<3>() - center * culler.eye.w();
+				float const t = Eigen::Vector3f(group.axisX[lane], group.axisY[lane], group.axisZ[lane]).dot(b);
+				float const s = std::sqrt(std::max(b.squaredNorm() - t * t, 0.f));
+				visible = visible && !(t * group.coneCos[lane] - s * group.coneSin[lane] > r * std::abs(culler.eye.w()));
+				mask |= uint32_t{visible} << lane;
+			}
+#endif
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				uint32_t const i = 4 * g + lane;
+				if (i >= first && i < last)
+				{
+					outVisible[i] = (mask >> lane) & 1;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "status.h"
+#include "geometry.h"
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// Meshlets: each DrawItem partitioned in clusters of at most MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles, each a
+// contiguous range of its indices. Built after optimizeMesh and before encodeVertices, as they need the float positions: a cluster
+// grows from the first free triangle in cache order, taking the neighbouring triangle which adds the fewest vertices (then the closest),
+// so clusters come out compact, with similar normals, and with a good vertex cache order of their own.
+// Each meshlet gets a bounding sphere and a cone containing its normals. When command buffers are recorded, the CPU culler tests them,
+// 4 at a time with SSE2, against the frustum and against the eye (all triangles of the meshlet facing away): consecutive visible
+// meshlets become one draw, so a large mesh is drawn only as much as it is visible. There are no mesh shaders involved, meshlets are
+// ranges of the ordinary index buffer
+namespace mxc
+{
+	class JobSystem;
+	struct MeshData;
+
+	struct MeshletStats
+	{
+		uint32_t meshletCount;
+		uint32_t meshCount; // DrawItems with meshlets
+		double averageTriangles;
+		double averageVertices;
+	};
+
+	// fills mesh->meshletRanges, mesh->meshlets and mesh->meshletBounds, reordering the triangles of each DrawItem (LODs are left as they
+	// are). DrawItems sharing index ranges get no meshlets. jobSystem can be null
+	auto buildMeshlets(MeshData* mesh, JobSystem* jobSystem, MeshletStats* outStats = nullptr) -> status_t;
+
+	// -- culling -----------------------------------------------------------------------------------------------------------------------
+	// what cullMeshlets needs of the object to clip transform, computed once per recording
+	struct MeshletCuller
+	{
+		std::array<Eigen::Vector4f, 6> planes; // frustum, object space, inside when dot(plane, (p, 1)) >= 0, normalized
+		// the eye, homogeneous, object space (w is 0 for a parallel projection), signed so that a triangle with normal n through p
+		// faces away, and is culled by the rasterizer, when dot(n, eye.xyz - p * eye.w) > 0
+		Eigen::Vector4f eye;
+	};
+
+	auto meshletCuller(Eigen::Matrix4f const& objectToClip) -> MeshletCuller;
+	// outVisible[i] for i in [first, last) tells whether meshlet i may be visible
+	auto cullMeshlets(std::span<MeshletBounds4 const> bounds, uint32_t first, uint32_t last, MeshletCuller const& culler, uint8_t* outVisible) -> void;
+}
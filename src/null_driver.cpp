@@ -0,0 +1,1070 @@
+#include "null_driver.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm> // min, copy_n, find
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace mxc::nulldrv
+{
+	namespace
+	{
+		inline constexpr VkDeviceSize BUFFER_ALIGNMENT = 256; // covers every offset alignment limit reported
+		inline constexpr VkDeviceSize IMAGE_ALIGNMENT = 4096;
+		inline constexpr VkDeviceSize MAX_TEXEL_SIZE = 8; // images are never backed, only their size is made up
+		inline constexpr VkDeviceSize HEAP_SIZE = 8ull << 30;
+		inline constexpr uint32_t MEMORY_TYPE_BITS = 0b111;
+
+		// dispatchable handles are pointers to objects, where the loader would put its dispatch table
+		struct Instance { uint32_t unused; };
+		struct PhysicalDevice { uint32_t unused; };
+		struct Device { uint32_t unused; };
+		struct Queue { uint32_t unused; };
+
+		// command buffers are externally synchronized, so their counts need no atomics
+		struct CommandBuffer
+		{
+			uint64_t commandCount;
+			uint64_t drawCount;
+		};
+
+		struct CommandPool
+		{
+			std::vector<CommandBuffer*> commandBuffers;
+		};
+
+		struct Buffer { VkDeviceSize size; };
+		struct Image { VkDeviceSize size; };
+		struct DeviceMemory
+		{
+			void* data; // only for host visible memory types
+			VkDeviceSize size;
+		};
+
+		// signaled by vkQueueSubmit, waited from any thread. Guarded by g_syncMutex
+		struct Semaphore
+		{
+			bool timeline;
+			uint64_t value;
+		};
+
+		struct Fence { bool signaled; };
+
+		struct Counters
+		{
+			std::atomic<uint64_t> objectsCreated{0};
+			std::atomic<uint64_t> objectsDestroyed{0};
+			std::atomic<uint64_t> memoryAllocations{0};
+			std::atomic<uint64_t> bytesAllocated{0};
+			std::atomic<uint64_t> queueSubmits{0};
+			std::atomic<uint64_t> commandBuffersSubmitted{0};
+			std::atomic<uint64_t> commandsSubmitted{0};
+			std::atomic<uint64_t> drawsSubmitted{0};
+			std::atomic<uint64_t> descriptorWrites{0};
+			std::atomic<uint64_t> mappedRangeFlushes{0};
+		};
+
+		Instance g_instance{};
+		PhysicalDevice g_physicalDevice{};
+		Device g_device{};
+		Queue g_queue{};
+		Counters g_counters;
+		std::atomic<uint64_t> g_nextHandle{1};
+		std::mutex g_syncMutex;
+		std::condition_variable g_syncCondition;
+
+		VkExtensionProperties const g_instanceExtensions[] {
+			{.extensionName = VK_EXT_DEBUG_UTILS_EXTENSION_NAME, .specVersion = 1}
+		};
+		VkExtensionProperties const g_deviceExtensions[] {
+			{.extensionName = VK_KHR_SWAPCHAIN_EXTENSION_NAME, .specVersion = 1}
+		};
+
+		auto count(std::atomic<uint64_t>& counter, uint64_t amount = 1) -> void
+		{
+			counter.fetch_add(amount, std::memory_order_relaxed);
+		}
+
+		template <class H> auto toHandle(void* object) -> H
+		{
+			if constexpr (std::is_pointer_v<H>)
+			{
+				return static_cast<H>(object);
+			}
+			else
+			{
+				return static_cast<H>(reinterpret_cast<uintptr_t>(object));
+			}
+		}
+
+		template <class T, class H> auto fromHandle(H handle) -> T*
+		{
+			if constexpr (std::is_pointer_v<H>)
+			{
+				return reinterpret_cast<T*>(handle);
+			}
+			else
+			{
+				return reinterpret_cast<T*>(static_cast<uintptr_t>(handle));
+			}
+		}
+
+		// objects without state are just unique ids
+		template <class H> auto createHandle(H* handle) -> VkResult
+		{
+			count(g_counters.objectsCreated);
+			uintptr_t const id = static_cast<uintptr_t>(g_nextHandle.fetch_add(1, std::memory_order_relaxed));
+			if constexpr (std::is_pointer_v<H>)
+			{
+				*handle = reinterpret_cast<H>(id);
+			}
+			else
+			{
+				*handle = static_cast<H>(id);
+			}
+			return VK_SUCCESS;
+		}
+
+		template <class H> auto destroyHandle(H handle) -> void
+		{
+			if (handle)
+			{
+				count(g_counters.objectsDestroyed);
+			}
+		}
+
+		template <class T, class H> auto createObject(T const& init, H* handle) -> VkResult
+		{
+			T* const object = new (std::nothrow) T(init);
+			if (!object)
+			{
+				return VK_ERROR_OUT_OF_HOST_MEMORY;
+			}
+			count(g_counters.objectsCreated);
+			*handle = toHandle<H>(object);
+			return VK_SUCCESS;
+		}
+
+		template <class T, class H> auto destroyObject(H handle) -> void
+		{
+			if (handle)
+			{
+				count(g_counters.objectsDestroyed);
+				delete fromHandle<T>(handle);
+			}
+		}
+
+		// two calls idiom: a null output returns the count, a short output is VK_INCOMPLETE
+		template <class T> auto enumerate(T const* items, uint32_t itemCount, uint32_t* pCount, T* pItems) -> VkResult
+		{
+			if (!pItems)
+			{
+				*pCount = itemCount;
+				return VK_SUCCESS;
+			}
+			uint32_t const written = std::min(*pCount, itemCount);
+			std::copy_n(items, written, pItems);
+			*pCount = written;
+			return written < itemCount ? VK_INCOMPLETE : VK_SUCCESS;
+		}
+
+		template <class T> auto findInChain(void const* pNext, VkStructureType sType) -> T const*
+		{
+			for (auto const* base = static_cast<VkBaseInStructure const*>(pNext); base; base = base->pNext)
+			{
+				if (base->sType == sType)
+				{
+					return reinterpret_cast<T const*>(base);
+				}
+			}
+			return nullptr;
+		}
+
+		auto recordCommand(VkCommandBuffer commandBuffer) -> void
+		{
+			++fromHandle<CommandBuffer>(commandBuffer)->commandCount;
+		}
+
+		auto recordDraw(VkCommandBuffer commandBuffer) -> void
+		{
+			CommandBuffer* const cmd = fromHandle<CommandBuffer>(commandBuffer);
+			++cmd->commandCount;
+			++cmd->drawCount;
+		}
+
+		// waits on g_syncCondition until ready() or the timeout (ns) expires. UINT64_MAX waits forever
+		template <class F> auto waitUntil(std::unique_lock<std::mutex>& lock, uint64_t timeout, F&& ready) -> VkResult
+		{
+			if (timeout == UINT64_MAX)
+			{
+				g_syncCondition.wait(lock, ready);
+				return VK_SUCCESS;
+			}
+			return g_syncCondition.wait_for(lock, std::chrono::nanoseconds(timeout), ready) ? VK_SUCCESS : VK_TIMEOUT;
+		}
+
+		auto surfaceLost() -> VkResult
+		{
+			return VK_ERROR_SURFACE_LOST_KHR;
+		}
+
+		VKAPI_ATTR auto VKAPI_CALL createDebugUtilsMessenger(VkInstance, VkDebugUtilsMessengerCreateInfoEXT const*, VkAllocationCallbacks const*,
+															  VkDebugUtilsMessengerEXT* pMessenger) -> VkResult
+		{
+			return createHandle(pMessenger);
+		}
+
+		VKAPI_ATTR auto VKAPI_CALL destroyDebugUtilsMessenger(VkInstance, VkDebugUtilsMessengerEXT messenger, VkAllocationCallbacks const*) -> void
+		{
+			destroyHandle(messenger);
+		}
+	}
+
+	auto stats() -> Stats
+	{
+		return Stats {
+			.objectsCreated = g_counters.objectsCreated.load(std::memory_order_relaxed),
+			.objectsDestroyed = g_counters.objectsDestroyed.load(std::memory_order_relaxed),
+			.memoryAllocations = g_counters.memoryAllocations.load(std::memory_order_relaxed),
+			.bytesAllocated = g_counters.bytesAllocated.load(std::memory_order_relaxed),
+			.queueSubmits = g_counters.queueSubmits.load(std::memory_order_relaxed),
+			.commandBuffersSubmitted = g_counters.commandBuffersSubmitted.load(std::memory_order_relaxed),
+			.commandsSubmitted = g_counters.commandsSubmitted.load(std::memory_order_relaxed),
+			.drawsSubmitted = g_counters.drawsSubmitted.load(std::memory_order_relaxed),
+			.descriptorWrites = g_counters.descriptorWrites.load(std::memory_order_relaxed),
+			.mappedRangeFlushes = g_counters.mappedRangeFlushes.load(std::memory_order_relaxed)
+		};
+	}
+}
+
+using namespace mxc::nulldrv;
+
+extern "C"
+{
+// -- instance and physical device ---------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceVersion(uint32_t* pApiVersion)
+{
+	*pApiVersion = VK_API_VERSION_1_2;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(char const* pLayerName, uint32_t* pPropertyCount, VkExtensionProperties* pProperties)
+{
+	if (pLayerName) // no layers
+	{
+		return VK_ERROR_LAYER_NOT_PRESENT;
+	}
+	return enumerate(g_instanceExtensions, static_cast<uint32_t>(std::size(g_instanceExtensions)), pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceLayerProperties(uint32_t* pPropertyCount, VkLayerProperties*)
+{
+	*pPropertyCount = 0;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(VkInstanceCreateInfo const*, VkAllocationCallbacks const*, VkInstance* pInstance)
+{
+	count(g_counters.objectsCreated);
+	*pInstance = reinterpret_cast<VkInstance>(&g_instance);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance, VkAllocationCallbacks const*)
+{
+	destroyHandle(instance);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(VkInstance, char const* pName)
+{
+	if (strcmp(pName, "vkCreateDebugUtilsMessengerEXT") == 0)
+	{
+		return reinterpret_cast<PFN_vkVoidFunction>(&createDebugUtilsMessenger);
+	}
+	if (strcmp(pName, "vkDestroyDebugUtilsMessengerEXT") == 0)
+	{
+		return reinterpret_cast<PFN_vkVoidFunction>(&destroyDebugUtilsMessenger);
+	}
+	return nullptr;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(VkInstance, uint32_t* pPhysicalDeviceCount, VkPhysicalDevice* pPhysicalDevices)
+{
+	VkPhysicalDevice const physicalDevice = reinterpret_cast<VkPhysicalDevice>(&g_physicalDevice);
+	return enumerate(&physicalDevice, 1u, pPhysicalDeviceCount, pPhysicalDevices);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* pProperties)
+{
+	*pProperties = VkPhysicalDeviceProperties{};
+	pProperties->apiVersion = VK_API_VERSION_1_2;
+	pProperties->driverVersion = 1;
+	pProperties->vendorID = 0x10000; // first id of the Khronos vendor id range, not a PCI vendor
+	pProperties->deviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+	strncpy(pProperties->deviceName, "mxc null driver", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+
+	VkPhysicalDeviceLimits& limits = pProperties->limits;
+	limits.maxImageDimension2D = 16384;
+	limits.maxUniformBufferRange = 65536;
+	limits.maxStorageBufferRange = 1u << 30;
+	limits.maxPushConstantsSize = 128;
+	limits.maxMemoryAllocationCount = 4096;
+	limits.maxSamplerAllocationCount = 4000;
+	limits.bufferImageGranularity = 1;
+	limits.maxBoundDescriptorSets = 8;
+	limits.maxDescriptorSetUniformBuffersDynamic = 8;
+	limits.maxViewports = 1;
+	limits.minMemoryMapAlignment = 64;
+	limits.minTexelBufferOffsetAlignment = 64;
+	limits.minUniformBufferOffsetAlignment = BUFFER_ALIGNMENT;
+	limits.minStorageBufferOffsetAlignment = 64;
+	limits.timestampComputeAndGraphics = VK_TRUE;
+	limits.timestampPeriod = 1.f;
+	limits.optimalBufferCopyOffsetAlignment = 1;
+	limits.optimalBufferCopyRowPitchAlignment = 1;
+	limits.nonCoherentAtomSize = 64;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2* pProperties)
+{
+	vkGetPhysicalDeviceProperties(physicalDevice, &pProperties->properties);
+	for (auto* base = static_cast<VkBaseOutStructure*>(pProperties->pNext); base; base = base->pNext)
+	{
+		if (base->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES)
+		{
+			auto* const idProperties = reinterpret_cast<VkPhysicalDeviceIDProperties*>(base);
+			memset(idProperties->deviceUUID, 0x4e, VK_UUID_SIZE);
+			memset(idProperties->driverUUID, 0x4e, VK_UUID_SIZE);
+			memset(idProperties->deviceLUID, 0, VK_LUID_SIZE);
+			idProperties->deviceNodeMask = 0;
+			idProperties->deviceLUIDValid = VK_FALSE;
+		}
+	}
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+	VkQueueFamilyProperties const family {
+		.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT,
+		.queueCount = 1,
+		.timestampValidBits = 64,
+		.minImageTransferGranularity = {.width = 1, .height = 1, .depth = 1}
+	};
+	enumerate(&family, 1u, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+}
+
+// 0: device local, 1: host visible cached, 2: device local and host visible, like resizable BAR
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+	*pMemoryProperties = VkPhysicalDeviceMemoryProperties{};
+	pMemoryProperties->memoryTypeCount = 3;
+	pMemoryProperties->memoryTypes[0] = VkMemoryType{.propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .heapIndex = 0};
+	pMemoryProperties->memoryTypes[1] = VkMemoryType{
+		.propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+		.heapIndex = 1
+	};
+	pMemoryProperties->memoryTypes[2] = VkMemoryType{
+		.propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		.heapIndex = 0
+	};
+	pMemoryProperties->memoryHeapCount = 2;
+	pMemoryProperties->memoryHeaps[0] = VkMemoryHeap{.size = HEAP_SIZE, .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT};
+	pMemoryProperties->memoryHeaps[1] = VkMemoryHeap{.size = HEAP_SIZE, .flags = 0};
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(VkPhysicalDevice, char const* pLayerName, uint32_t* pPropertyCount, VkExtensionProperties* pProperties)
+{
+	if (pLayerName)
+	{
+		return VK_ERROR_LAYER_NOT_PRESENT;
+	}
+	return enumerate(g_deviceExtensions, static_cast<uint32_t>(std::size(g_deviceExtensions)), pPropertyCount, pProperties);
+}
+
+// -- surface and swapchain, not supported: the null device presents nothing -------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevice, uint32_t, VkSurfaceKHR, VkBool32* pSupported)
+{
+	*pSupported = VK_FALSE;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice, VkSurfaceKHR, VkSurfaceCapabilitiesKHR*)
+{
+	return surfaceLost();
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* pSurfaceFormatCount, VkSurfaceFormatKHR*)
+{
+	*pSurfaceFormatCount = 0;
+	return surfaceLost();
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* pPresentModeCount, VkPresentModeKHR*)
+{
+	*pPresentModeCount = 0;
+	return surfaceLost();
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySurfaceKHR(VkInstance, VkSurfaceKHR surface, VkAllocationCallbacks const*)
+{
+	destroyHandle(surface);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(VkDevice, VkSwapchainCreateInfoKHR const*, VkAllocationCallbacks const*, VkSwapchainKHR*)
+{
+	return surfaceLost();
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(VkDevice, VkSwapchainKHR swapchain, VkAllocationCallbacks const*)
+{
+	destroyHandle(swapchain);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetSwapchainImagesKHR(VkDevice, VkSwapchainKHR, uint32_t* pSwapchainImageCount, VkImage*)
+{
+	*pSwapchainImageCount = 0;
+	return surfaceLost();
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(VkDevice, VkSwapchainKHR, uint64_t, VkSemaphore, VkFence, uint32_t*)
+{
+	return surfaceLost();
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue, VkPresentInfoKHR const*)
+{
+	return surfaceLost();
+}
+
+// -- device and queue ------------------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice, VkDeviceCreateInfo const*, VkAllocationCallbacks const*, VkDevice* pDevice)
+{
+	count(g_counters.objectsCreated);
+	*pDevice = reinterpret_cast<VkDevice>(&g_device);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, VkAllocationCallbacks const*)
+{
+	destroyHandle(device);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(VkDevice, uint32_t, uint32_t, VkQueue* pQueue)
+{
+	*pQueue = reinterpret_cast<VkQueue>(&g_queue);
+}
+
+// every submission has already completed
+VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice)
+{
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue)
+{
+	return VK_SUCCESS;
+}
+
+// completes the submissions right away: timeline semaphores are set to their signal values, the fence is signaled
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue, uint32_t submitCount, VkSubmitInfo const* pSubmits, VkFence fence)
+{
+	count(g_counters.queueSubmits);
+	std::unique_lock lock(g_syncMutex);
+	for (uint32_t i = 0; i < submitCount; ++i)
+	{
+		VkSubmitInfo const& submit = pSubmits[i];
+		uint64_t commands = 0;
+		uint64_t draws = 0;
+		for (uint32_t j = 0; j < submit.commandBufferCount; ++j)
+		{
+			CommandBuffer const* const cmd = fromHandle<CommandBuffer>(submit.pCommandBuffers[j]);
+			commands += cmd->commandCount;
+			draws += cmd->drawCount;
+		}
+		count(g_counters.commandBuffersSubmitted, submit.commandBufferCount);
+		count(g_counters.commandsSubmitted, commands);
+		count(g_counters.drawsSubmitted, draws);
+
+		auto const* const timelineInfo = findInChain<VkTimelineSemaphoreSubmitInfo>(submit.pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO);
+		for (uint32_t j = 0; j < submit.signalSemaphoreCount; ++j)
+		{
+			Semaphore* const semaphore = fromHandle<Semaphore>(submit.pSignalSemaphores[j]);
+			if (semaphore->timeline && timelineInfo && j < timelineInfo->signalSemaphoreValueCount)
+			{
+				semaphore->value = timelineInfo->pSignalSemaphoreValues[j];
+			}
+		}
+	}
+	if (fence)
+	{
+		fromHandle<Fence>(fence)->signaled = true;
+	}
+	lock.unlock();
+	g_syncCondition.notify_all();
+	return VK_SUCCESS;
+}
+
+// -- memory ----------------------------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice, VkMemoryAllocateInfo const* pAllocateInfo, VkAllocationCallbacks const*, VkDeviceMemory* pMemory)
+{
+	if (pAllocateInfo->memoryTypeIndex > 2)
+	{
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+	DeviceMemory memory {.data = nullptr, .size = pAllocateInfo->allocationSize};
+	if (pAllocateInfo->memoryTypeIndex != 0) // host visible
+	{
+		memory.data = std::malloc(static_cast<size_t>(pAllocateInfo->allocationSize));
+		if (!memory.data)
+		{
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	VkResult const result = createObject(memory, pMemory);
+	if (result != VK_SUCCESS)
+	{
+		std::free(memory.data);
+		return result;
+	}
+	count(g_counters.memoryAllocations);
+	count(g_counters.bytesAllocated, pAllocateInfo->allocationSize);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice, VkDeviceMemory memory, VkAllocationCallbacks const*)
+{
+	if (memory)
+	{
+		std::free(fromHandle<DeviceMemory>(memory)->data);
+	}
+	destroyObject<DeviceMemory>(memory);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize, VkMemoryMapFlags, void** ppData)
+{
+	DeviceMemory const* const deviceMemory = fromHandle<DeviceMemory>(memory);
+	if (!deviceMemory->data)
+	{
+		return VK_ERROR_MEMORY_MAP_FAILED;
+	}
+	*ppData = static_cast<char*>(deviceMemory->data) + offset;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice, VkDeviceMemory)
+{
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkFlushMappedMemoryRanges(VkDevice, uint32_t memoryRangeCount, VkMappedMemoryRange const*)
+{
+	count(g_counters.mappedRangeFlushes, memoryRangeCount);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkInvalidateMappedMemoryRanges(VkDevice, uint32_t memoryRangeCount, VkMappedMemoryRange const*)
+{
+	count(g_counters.mappedRangeFlushes, memoryRangeCount);
+	return VK_SUCCESS;
+}
+
+// -- buffers and images ----------------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice, VkBufferCreateInfo const* pCreateInfo, VkAllocationCallbacks const*, VkBuffer* pBuffer)
+{
+	return createObject(Buffer{.size = pCreateInfo->size}, pBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice, VkBuffer buffer, VkAllocationCallbacks const*)
+{
+	destroyObject<Buffer>(buffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements(VkDevice, VkBuffer buffer, VkMemoryRequirements* pMemoryRequirements)
+{
+	VkDeviceSize const size = fromHandle<Buffer>(buffer)->size;
+	*pMemoryRequirements = VkMemoryRequirements {
+		.size = (size + BUFFER_ALIGNMENT - 1) & ~(BUFFER_ALIGNMENT - 1),
+		.alignment = BUFFER_ALIGNMENT,
+		.memoryTypeBits = MEMORY_TYPE_BITS
+	};
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory(VkDevice, VkBuffer, VkDeviceMemory, VkDeviceSize)
+{
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice, VkImageCreateInfo const* pCreateInfo, VkAllocationCallbacks const*, VkImage* pImage)
+{
+	VkExtent3D const& extent = pCreateInfo->extent;
+	VkDeviceSize const size = MAX_TEXEL_SIZE * extent.width * extent.height * extent.depth * pCreateInfo->arrayLayers;
+	return createObject(Image{.size = size}, pImage);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyImage(VkDevice, VkImage image, VkAllocationCallbacks const*)
+{
+	destroyObject<Image>(image);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements(VkDevice, VkImage image, VkMemoryRequirements* pMemoryRequirements)
+{
+	VkDeviceSize const size = fromHandle<Image>(image)->size;
+	*pMemoryRequirements = VkMemoryRequirements {
+		.size = (size + IMAGE_ALIGNMENT - 1) & ~(IMAGE_ALIGNMENT - 1),
+		.alignment = IMAGE_ALIGNMENT,
+		.memoryTypeBits = MEMORY_TYPE_BITS
+	};
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice, VkImage, VkDeviceMemory, VkDeviceSize)
+{
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(VkDevice, VkImageViewCreateInfo const*, VkAllocationCallbacks const*, VkImageView* pView)
+{
+	return createHandle(pView);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyImageView(VkDevice, VkImageView imageView, VkAllocationCallbacks const*)
+{
+	destroyHandle(imageView);
+}
+
+// -- synchronization -------------------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(VkDevice, VkSemaphoreCreateInfo const* pCreateInfo, VkAllocationCallbacks const*, VkSemaphore* pSemaphore)
+{
+	auto const* const typeInfo = findInChain<VkSemaphoreTypeCreateInfo>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO);
+	bool const timeline = typeInfo && typeInfo->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE;
+	return createObject(Semaphore{.timeline = timeline, .value = timeline ? typeInfo->initialValue : 0}, pSemaphore);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySemaphore(VkDevice, VkSemaphore semaphore, VkAllocationCallbacks const*)
+{
+	destroyObject<Semaphore>(semaphore);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetSemaphoreCounterValue(VkDevice, VkSemaphore semaphore, uint64_t* pValue)
+{
+	std::lock_guard lock(g_syncMutex);
+	*pValue = fromHandle<Semaphore>(semaphore)->value;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitSemaphores(VkDevice, VkSemaphoreWaitInfo const* pWaitInfo, uint64_t timeout)
+{
+	bool const waitAny = pWaitInfo->flags & VK_SEMAPHORE_WAIT_ANY_BIT;
+	std::unique_lock lock(g_syncMutex);
+	return waitUntil(lock, timeout, [pWaitInfo, waitAny]() -> bool {
+		for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; ++i)
+		{
+			bool const reached = fromHandle<Semaphore>(pWaitInfo->pSemaphores[i])->value >= pWaitInfo->pValues[i];
+			if (reached == waitAny)
+			{
+				return waitAny;
+			}
+		}
+		return !waitAny;
+	});
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateFence(VkDevice, VkFenceCreateInfo const* pCreateInfo, VkAllocationCallbacks const*, VkFence* pFence)
+{
+	return createObject(Fence{.signaled = (pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0}, pFence);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice, VkFence fence, VkAllocationCallbacks const*)
+{
+	destroyObject<Fence>(fence);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice, VkFence fence)
+{
+	std::lock_guard lock(g_syncMutex);
+	return fromHandle<Fence>(fence)->signaled ? VK_SUCCESS : VK_NOT_READY;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice, uint32_t fenceCount, VkFence const* pFences)
+{
+	std::lock_guard lock(g_syncMutex);
+	for (uint32_t i = 0; i < fenceCount; ++i)
+	{
+		fromHandle<Fence>(pFences[i])->signaled = false;
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(VkDevice, uint32_t fenceCount, VkFence const* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+	std::unique_lock lock(g_syncMutex);
+	return waitUntil(lock, timeout, [fenceCount, pFences, waitAll]() -> bool {
+		for (uint32_t i = 0; i < fenceCount; ++i)
+		{
+			bool const signaled = fromHandle<Fence>(pFences[i])->signaled;
+			if (signaled != static_cast<bool>(waitAll))
+			{
+				return signaled;
+			}
+		}
+		return waitAll;
+	});
+}
+
+// -- pipelines and render passes -------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice, VkRenderPassCreateInfo const*, VkAllocationCallbacks const*, VkRenderPass* pRenderPass)
+{
+	return createHandle(pRenderPass);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyRenderPass(VkDevice, VkRenderPass renderPass, VkAllocationCallbacks const*)
+{
+	destroyHandle(renderPass);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateFramebuffer(VkDevice, VkFramebufferCreateInfo const*, VkAllocationCallbacks const*, VkFramebuffer* pFramebuffer)
+{
+	return createHandle(pFramebuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyFramebuffer(VkDevice, VkFramebuffer framebuffer, VkAllocationCallbacks const*)
+{
+	destroyHandle(framebuffer);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(VkDevice, VkShaderModuleCreateInfo const*, VkAllocationCallbacks const*, VkShaderModule* pShaderModule)
+{
+	return createHandle(pShaderModule);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyShaderModule(VkDevice, VkShaderModule shaderModule, VkAllocationCallbacks const*)
+{
+	destroyHandle(shaderModule);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice, VkPipelineLayoutCreateInfo const*, VkAllocationCallbacks const*, VkPipelineLayout* pPipelineLayout)
+{
+	return createHandle(pPipelineLayout);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineLayout(VkDevice, VkPipelineLayout pipelineLayout, VkAllocationCallbacks const*)
+{
+	destroyHandle(pipelineLayout);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(VkDevice, VkPipelineCache, uint32_t createInfoCount, VkGraphicsPipelineCreateInfo const*,
+														  VkAllocationCallbacks const*, VkPipeline* pPipelines)
+{
+	for (uint32_t i = 0; i < createInfoCount; ++i)
+	{
+		createHandle(&pPipelines[i]);
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipeline(VkDevice, VkPipeline pipeline, VkAllocationCallbacks const*)
+{
+	destroyHandle(pipeline);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineCache(VkDevice, VkPipelineCacheCreateInfo const*, VkAllocationCallbacks const*, VkPipelineCache* pPipelineCache)
+{
+	return createHandle(pPipelineCache);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineCache(VkDevice, VkPipelineCache pipelineCache, VkAllocationCallbacks const*)
+{
+	destroyHandle(pipelineCache);
+}
+
+// nothing is ever compiled, so there is nothing to cache
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPipelineCacheData(VkDevice, VkPipelineCache, size_t* pDataSize, void*)
+{
+	*pDataSize = 0;
+	return VK_SUCCESS;
+}
+
+// -- descriptors -----------------------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorSetLayout(VkDevice, VkDescriptorSetLayoutCreateInfo const*, VkAllocationCallbacks const*, VkDescriptorSetLayout* pSetLayout)
+{
+	return createHandle(pSetLayout);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout descriptorSetLayout, VkAllocationCallbacks const*)
+{
+	destroyHandle(descriptorSetLayout);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorPool(VkDevice, VkDescriptorPoolCreateInfo const*, VkAllocationCallbacks const*, VkDescriptorPool* pDescriptorPool)
+{
+	return createHandle(pDescriptorPool);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorPool(VkDevice, VkDescriptorPool descriptorPool, VkAllocationCallbacks const*)
+{
+	destroyHandle(descriptorPool);
+}
+
+// pool capacities are not tracked, allocations never fail
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice, VkDescriptorSetAllocateInfo const* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; ++i)
+	{
+		createHandle(&pDescriptorSets[i]);
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkFreeDescriptorSets(VkDevice, VkDescriptorPool, uint32_t descriptorSetCount, VkDescriptorSet const* pDescriptorSets)
+{
+	for (uint32_t i = 0; i < descriptorSetCount; ++i)
+	{
+		destroyHandle(pDescriptorSets[i]);
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice, uint32_t descriptorWriteCount, VkWriteDescriptorSet const* pDescriptorWrites,
+												  uint32_t descriptorCopyCount, VkCopyDescriptorSet const* pDescriptorCopies)
+{
+	uint64_t descriptors = 0;
+	for (uint32_t i = 0; i < descriptorWriteCount; ++i)
+	{
+		descriptors += pDescriptorWrites[i].descriptorCount;
+	}
+	for (uint32_t i = 0; i < descriptorCopyCount; ++i)
+	{
+		descriptors += pDescriptorCopies[i].descriptorCount;
+	}
+	count(g_counters.descriptorWrites, descriptors);
+}
+
+// -- queries, timestamps always read 0 -------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateQueryPool(VkDevice, VkQueryPoolCreateInfo const*, VkAllocationCallbacks const*, VkQueryPool* pQueryPool)
+{
+	return createHandle(pQueryPool);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyQueryPool(VkDevice, VkQueryPool queryPool, VkAllocationCallbacks const*)
+{
+	destroyHandle(queryPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice, VkQueryPool, uint32_t, uint32_t queryCount, size_t, void* pData, VkDeviceSize stride,
+													 VkQueryResultFlags flags)
+{
+	size_t const valueSize = (flags & VK_QUERY_RESULT_64_BIT) ? sizeof(uint64_t) : sizeof(uint32_t);
+	size_t const valueCount = (flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) ? 2 : 1;
+	for (uint32_t i = 0; i < queryCount; ++i)
+	{
+		char* const result = static_cast<char*>(pData) + i * stride;
+		memset(result, 0, valueSize * valueCount);
+		if (valueCount == 2) // available
+		{
+			result[valueSize] = 1;
+		}
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkResetQueryPool(VkDevice, VkQueryPool, uint32_t, uint32_t)
+{
+}
+
+// -- command pools and buffers ---------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(VkDevice, VkCommandPoolCreateInfo const*, VkAllocationCallbacks const*, VkCommandPool* pCommandPool)
+{
+	return createObject(CommandPool{}, pCommandPool);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(VkDevice, VkCommandPool commandPool, VkAllocationCallbacks const*)
+{
+	if (!commandPool)
+	{
+		return;
+	}
+	for (CommandBuffer* cmd : fromHandle<CommandPool>(commandPool)->commandBuffers)
+	{
+		count(g_counters.objectsDestroyed);
+		delete cmd;
+	}
+	destroyObject<CommandPool>(commandPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(VkDevice, VkCommandPool commandPool, VkCommandPoolResetFlags)
+{
+	for (CommandBuffer* cmd : fromHandle<CommandPool>(commandPool)->commandBuffers)
+	{
+		*cmd = CommandBuffer{.commandCount = 0, .drawCount = 0};
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(VkDevice, VkCommandBufferAllocateInfo const* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	CommandPool* const pool = fromHandle<CommandPool>(pAllocateInfo->commandPool);
+	for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+	{
+		CommandBuffer* const cmd = new (std::nothrow) CommandBuffer{.commandCount = 0, .drawCount = 0};
+		if (!cmd)
+		{
+			vkFreeCommandBuffers(reinterpret_cast<VkDevice>(&g_device), pAllocateInfo->commandPool, i, pCommandBuffers);
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		pool->commandBuffers.push_back(cmd);
+		count(g_counters.objectsCreated);
+		pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(cmd);
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(VkDevice, VkCommandPool commandPool, uint32_t commandBufferCount, VkCommandBuffer const* pCommandBuffers)
+{
+	std::vector<CommandBuffer*>& commandBuffers = fromHandle<CommandPool>(commandPool)->commandBuffers;
+	for (uint32_t i = 0; i < commandBufferCount; ++i)
+	{
+		auto const it = std::find(commandBuffers.begin(), commandBuffers.end(), fromHandle<CommandBuffer>(pCommandBuffers[i]));
+		if (it != commandBuffers.end())
+		{
+			count(g_counters.objectsDestroyed);
+			delete *it;
+			commandBuffers.erase(it);
+		}
+	}
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferBeginInfo const*)
+{
+	*fromHandle<CommandBuffer>(commandBuffer) = CommandBuffer{.commandCount = 0, .drawCount = 0};
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffer)
+{
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags)
+{
+	*fromHandle<CommandBuffer>(commandBuffer) = CommandBuffer{.commandCount = 0, .drawCount = 0};
+	return VK_SUCCESS;
+}
+
+// -- commands, only counted ------------------------------------------------------------------------------------------------------------------
+
+VKAPI_ATTR void VKAPI_CALL vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool, uint32_t, uint32_t)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits, VkQueryPool, uint32_t)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, VkRenderPassBeginInfo const*, VkSubpassContents)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint, VkPipeline)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t, uint32_t, VkBuffer const*, VkDeviceSize const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer, VkDeviceSize, VkIndexType)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t, uint32_t, VkViewport const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t, uint32_t, VkRect2D const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint, VkPipelineLayout, uint32_t, uint32_t, VkDescriptorSet const*,
+												   uint32_t, uint32_t const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t, uint32_t, uint32_t, uint32_t)
+{
+	recordDraw(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t, uint32_t, uint32_t, int32_t, uint32_t)
+{
+	recordDraw(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout, VkShaderStageFlags, uint32_t, uint32_t, void const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer, VkBuffer, uint32_t, VkBufferCopy const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer, VkImage, VkImageLayout, uint32_t, VkBufferImageCopy const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage, VkImageLayout, VkBuffer, uint32_t, VkBufferImageCopy const*)
+{
+	recordCommand(commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags, VkPipelineStageFlags, VkDependencyFlags, uint32_t,
+												VkMemoryBarrier const*, uint32_t, VkBufferMemoryBarrier const*, uint32_t, VkImageMemoryBarrier const*)
+{
+	recordCommand(commandBuffer);
+}
+
+// secondaries are recorded before the primary executing them, so their counts are final here
+VKAPI_ATTR void VKAPI_CALL vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, VkCommandBuffer const* pCommandBuffers)
+{
+	CommandBuffer* const primary = fromHandle<CommandBuffer>(commandBuffer);
+	++primary->commandCount;
+	for (uint32_t i = 0; i < commandBufferCount; ++i)
+	{
+		CommandBuffer const* const secondary = fromHandle<CommandBuffer>(pCommandBuffers[i]);
+		primary->commandCount += secondary->commandCount;
+		primary->drawCount += secondary->drawCount;
+	}
+}
+}
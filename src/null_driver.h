@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Null Vulkan driver, linked in place of the Vulkan loader when the CMake option MXC_NULL_DRIVER is ON. It defines every Vulkan entry
+// point the renderer calls: objects are bare handles, command buffers only count what is recorded into them, and submissions complete
+// immediately (timeline semaphores jump to their signal values, fences are signaled), so that the CPU side of the renderer can be measured
+// without a GPU or an ICD, deterministically. Host visible memory is backed by real memory, as the renderer writes into it.
+// The device reports a single queue family with graphics, compute, transfer and 64 bit timestamps, which always read 0, and no surface
+// support, so only headless rendering works.
+namespace mxc::nulldrv
+{
+	// totals since startup. Commands are counted when the command buffer holding them is submitted, secondaries included
+	struct Stats
+	{
+		uint64_t objectsCreated; // every handle returned by a vkCreate*, vkAllocate*
+		uint64_t objectsDestroyed;
+		uint64_t memoryAllocations;
+		uint64_t bytesAllocated;
+		uint64_t queueSubmits;
+		uint64_t commandBuffersSubmitted;
+		uint64_t commandsSubmitted; // vkCmd* calls
+		uint64_t drawsSubmitted;
+		uint64_t descriptorWrites; // descriptors written or copied by vkUpdateDescriptorSets
+		uint64_t mappedRangeFlushes; // flushed and invalidated ranges
+	};
+
+	auto stats() -> Stats;
+}
@@ -0,0 +1,142 @@
+#include "pipeline_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <system_error>
+
+namespace mxc
+{
+	auto PipelineCache::init(VkPhysicalDevice phyDevice, VkDevice device, std::filesystem::path const& directory,
+							 VkAllocationCallbacks const* allocationCallbacks) & -> status_t
+	{
+		assert(m_cache == VK_NULL_HANDLE && "pipeline cache initialized twice");
+		m_device = device;
+		m_allocationCallbacks = allocationCallbacks;
+
+		// -- key: vendor, device and driver UUID (vulkan 1.1 core) ---------------------------------------------------------------------------------
+		VkPhysicalDeviceIDProperties idProperties {};
+		idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+		VkPhysicalDeviceProperties2 phyDeviceProperties {};
+		phyDeviceProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		phyDeviceProperties.pNext = &idProperties;
+		vkGetPhysicalDeviceProperties2(phyDevice, &phyDeviceProperties);
+		m_vendorID = phyDeviceProperties.properties.vendorID;
+		m_deviceID = phyDeviceProperties.properties.deviceID;
+		memcpy(m_pipelineCacheUUID, phyDeviceProperties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+		char fileName[128];
+		int written = snprintf(fileName, sizeof(fileName), "pipeline_cache_%08x_%08x_", m_vendorID, m_deviceID);
+		for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+		{
+			written += snprintf(fileName + written, sizeof(fileName) - written, "%02x", idProperties.driverUUID[i]);
+		}
+		snprintf(fileName + written, sizeof(fileName) - written, ".bin");
+
+		std::error_code errorCode;
+		std::filesystem::create_directories(directory, errorCode); // if it fails, we'll just fail to save
+		m_path = directory / fileName;
+
+		// -- load the previous data, if any and if it is for this device and driver ----------------------------------------------------------------
+		std::vector<char> initialData;
+		if (std::ifstream file{m_path, std::ios::binary | std::ios::ate}; file)
+		{
+			std::streamsize const size = file.tellg();
+			if (size > 0)
+			{
+				initialData.resize(static_cast<size_t>(size));
+				file.seekg(0);
+				if (!file.read(initialData.data(), size) || !isValid(initialData.data(), initialData.size()))
+				{
+					fprintf(stderr, "discarding stale or corrupted pipeline cache %s\n", m_path.string().c_str());
+					initialData.clear();
+				}
+			}
+		}
+
+		VkPipelineCacheCreateInfo const cacheCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0, // externally synchronized flag would let the driver skip locking, but pipelines could be created from jobs
+			.initialDataSize = initialData.size(),
+			.pInitialData = initialData.empty() ? nullptr : initialData.data()
+		};
+		if (vkCreatePipelineCache(m_device, &cacheCreateInfo, m_allocationCallbacks, &m_cache) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create pipeline cache!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		printf("pipeline cache %s loaded with %zu bytes\n", m_path.string().c_str(), initialData.size());
+		return APP_SUCCESS;
+	}
+
+	auto PipelineCache::destroy() & -> void
+	{
+		if (m_cache == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		save();
+		vkDestroyPipelineCache(m_device, m_cache, m_allocationCallbacks);
+		m_cache = VK_NULL_HANDLE;
+	}
+
+	auto PipelineCache::save() const & -> status_t
+	{
+		size_t size = 0;
+		if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0)
+		{
+			return APP_GENERIC_ERR;
+		}
+		std::vector<char> data(size);
+		if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to get pipeline cache data!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// write everything in a temporary file, and only then replace the old one. Rename is atomic on the same file system
+		std::filesystem::path tmpPath = m_path;
+		tmpPath += ".tmp";
+		bool written;
+		{
+			std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+			written = file && file.write(data.data(), static_cast<std::streamsize>(size)) && file.flush();
+		} // closed before it is removed or renamed, which some platforms don't allow on open files
+		std::error_code errorCode;
+		if (!written)
+		{
+			fprintf(stderr, "failed to write pipeline cache %s\n", tmpPath.string().c_str());
+			std::filesystem::remove(tmpPath, errorCode); // a partial file, if it was created at all
+			return APP_GENERIC_ERR;
+		}
+		std::filesystem::rename(tmpPath, m_path, errorCode);
+		if (errorCode)
+		{
+			fprintf(stderr, "failed to replace pipeline cache %s: %s\n", m_path.string().c_str(), errorCode.message().c_str());
+			std::filesystem::remove(tmpPath, errorCode);
+			return APP_GENERIC_ERR;
+		}
+
+		printf("pipeline cache %s saved with %zu bytes\n", m_path.string().c_str(), size);
+		return APP_SUCCESS;
+	}
+
+	auto PipelineCache::isValid(void const* data, size_t size) const & -> bool
+	{
+		// drivers should reject incompatible data on their own, but some crash instead, so check the header before handing it over
+		VkPipelineCacheHeaderVersionOne header;
+		if (size < sizeof(header))
+		{
+			return false;
+		}
+		memcpy(&header, data, sizeof(header));
+		return header.headerSize >= sizeof(header) && header.headerSize <= size
+			&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+			&& header.vendorID == m_vendorID
+			&& header.deviceID == m_deviceID
+			&& memcmp(header.pipelineCacheUUID, m_pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+}
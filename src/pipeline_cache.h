@@ -0,0 +1,49 @@
+#pragma once
+
+#include "status.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cassert>
+#include <filesystem>
+
+// VkPipelineCache persisted on disk between runs, so that pipelines compiled once are not compiled again at the next startup (or resize).
+// The file name is keyed by vendor ID, device ID and driver UUID, so different GPUs and driver versions don't overwrite each other's data,
+// and its contents are validated against the VkPipelineCacheHeaderVersionOne before being handed to the driver. A missing or stale file
+// simply results in an empty cache.
+// On destroy the cache data is written to a temporary file which is then renamed over the old one, so a crash while saving never leaves
+// a truncated cache behind.
+namespace mxc
+{
+	class PipelineCache
+	{
+	public: // constructors
+		PipelineCache() = default;
+		PipelineCache(PipelineCache const&) = delete;
+		auto operator=(PipelineCache const&) -> PipelineCache& = delete;
+		~PipelineCache() { assert(m_cache == VK_NULL_HANDLE && "destroy() must be called before the VkDevice is destroyed"); }
+
+	public: // public functions
+		// directory is where cache files are stored, created if needed
+		auto init(VkPhysicalDevice phyDevice, VkDevice device, std::filesystem::path const& directory,
+				  VkAllocationCallbacks const* allocationCallbacks = nullptr) & -> status_t;
+		// saves the cache to disk and destroys it
+		auto destroy() & -> void;
+		auto save() const & -> status_t;
+
+		auto handle() const & -> VkPipelineCache { return m_cache; }
+
+	private: // functions
+		auto isValid(void const* data, size_t size) const & -> bool;
+
+	private: // data
+		VkDevice m_device = VK_NULL_HANDLE;
+		VkAllocationCallbacks const* m_allocationCallbacks = nullptr;
+		VkPipelineCache m_cache = VK_NULL_HANDLE;
+		std::filesystem::path m_path;
+		uint32_t m_vendorID = 0;
+		uint32_t m_deviceID = 0;
+		uint8_t m_pipelineCacheUUID[VK_UUID_SIZE] = {};
+	};
+}
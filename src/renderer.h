@@ -0,0 +1,2896 @@
+#pragma once
+
+// Vulkan renderer, header only as it is templated on the allocator of its containers, so that other executables (eg. the benchmark)
+// can drive it too
+#ifndef GLFW_INCLUDE_VULKAN
+#define GLFW_INCLUDE_VULKAN
+#endif
+#include <GLFW/glfw3.h>
+#include <Eigen/Dense>
+
+#include "status.h"
+#include "geometry.h"
+#include "device_allocator.h"
+#include "uniform_ring.h"
+#include "upload_manager.h"
+#include "job_system.h"
+#include "pipeline_cache.h"
+#include "frame_readback.h"
+#include "gpu_profiler.h"
+#include "linear_arena.h"
+#include "trace.h"
+#include "meshlet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib> // TODO check for possible removal
+#include <cstdio> // TODO check its usage for possible removal in non debug builds
+#include <cstring>
+#include <cassert>
+
+#include <filesystem> // path
+#include <fstream> // ifstream
+#include <string_view> // unused yet
+#include <vector>
+#include <span> // unused yet
+#include <algorithm> // copy, unstable_sort, transform, unique
+#include <type_traits> // is_standard_layout
+
+// TODO setup one descriptor uniform buffer per image or add synchronization to uniform buffer to make it so that uniform data can be updated dynamically
+// TODO setup every step in a single function. e.g. group all buffer creations, currently scattered throughout initialization functions (Renderer class)
+//	and put them in a single function, which can be parametrized
+// TODO IMPORTANT BUG: when opened from executable the game doesn't lauch. Thats because the build doesn't contain the compiled shaders. 
+//	Either change current directory or at build copy shader folders (only .spv files)
+// TODO change naming convention from snake_case to camelCase for vars and PascalCase for types
+// TODO remove all std:: usage (except for platform abstraction and type support facilities). example: remove std::vector
+// TODO setup macro for compiler specific restrict keyword. Eg. __restrict__ for g++/clang, __restrict for MSVC, and forceinline, attribute(force_inline) for g++/clang, and __force_inline__ for MSVC
+// TODO add constexpr where fit
+// TODO setup documentation before source grows too much
+// TODO modify app class so that it can support having multiple layers
+// TODO once you write a user-defined constructor, syntesized move constructor and move assignment operators are disabled by default. Write them
+// TODO -fno-exceptions
+
+namespace mxc
+{
+	// TODO change return conventions into more meaningful and specific error carrying type to convey a more 
+	// 		specific status report
+	/*** WARNING: most of the functions will return APP_TRUE if successful, and APP_FALSE if unsuccessful ***/
+	struct VulkanPipelineConfig 
+	{
+		VkPipelineVertexInputStateCreateInfo vertexInputStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.vertexBindingDescriptionCount = 0,
+			.pVertexBindingDescriptions = nullptr,
+			.vertexAttributeDescriptionCount = 0,
+			.pVertexAttributeDescriptions = nullptr
+		};
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			.primitiveRestartEnable = VK_FALSE
+		};
+
+		VkPipelineTessellationStateCreateInfo tessellationStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.patchControlPoints = 0
+		};
+
+		VkPipelineViewportStateCreateInfo viewportStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.pNext = nullptr, 
+			.flags = 0,
+			.viewportCount = 0,
+			.pViewports = nullptr,
+			.scissorCount = 0,
+			.pScissors = nullptr 
+		};
+
+		VkPipelineRasterizationStateCreateInfo rasterizationStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.depthClampEnable = VK_FALSE,
+			.rasterizerDiscardEnable = VK_FALSE,
+			.polygonMode = VK_POLYGON_MODE_FILL,
+			.cullMode = VK_CULL_MODE_BACK_BIT,
+			.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+			.depthBiasEnable = VK_FALSE,
+			.depthBiasConstantFactor = 0.f,
+			.depthBiasClamp = 0.f,
+			.depthBiasSlopeFactor = 0.f,
+			.lineWidth = 1.f,
+		};
+
+		VkPipelineMultisampleStateCreateInfo multisampleStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+			.sampleShadingEnable = VK_FALSE,
+			.minSampleShading = 0.f,
+			.pSampleMask = nullptr,
+			.alphaToCoverageEnable = VK_FALSE,
+			.alphaToOneEnable = VK_FALSE
+		};
+
+		//VkStencilOpState constexpr stencilOpState {
+		//		.failOp = VK_STENCIL_OP_KEEP, // what to do if stencil test fails
+		//		.passOp = VK_STENCIL_OP_KEEP, // what to do if stencil test is successful
+		//		.depthFailOp = VK_STENCIL_OP_KEEP, // passes stencil but fails depth test
+		//		.compareOp = VK_COMPARE_OP_ALWAYS, // specifies stencil test operation. same type as depth comparison, but with another meaning
+		//		.compareMask = 0, // selects the bits of the unsigned integer values participating in the stencil test
+		//		.writeMask = 0, // selects the bits of the unsigned integer values updated by the stencil test in the stencil framebuffer attachment
+		//		.reference = 0 // integer stencil reference value used in some of the compare ops
+		//}
+		VkPipelineDepthStencilStateCreateInfo depthStencilStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.depthTestEnable = VK_FALSE,
+			.depthWriteEnable = VK_FALSE,
+			.depthCompareOp = VK_COMPARE_OP_LESS,
+			.depthBoundsTestEnable = VK_FALSE,
+			.stencilTestEnable = VK_FALSE,
+			.front = {VK_STENCIL_OP_KEEP,VK_STENCIL_OP_KEEP,VK_STENCIL_OP_KEEP,VK_COMPARE_OP_ALWAYS,0,0,0},
+			.back = {VK_STENCIL_OP_KEEP,VK_STENCIL_OP_KEEP,VK_STENCIL_OP_KEEP,VK_COMPARE_OP_ALWAYS,0,0,0},
+			.minDepthBounds = 0.f,
+			.maxDepthBounds = 0.f
+		};
+
+		VkPipelineColorBlendStateCreateInfo colorBlendStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.logicOpEnable = VK_FALSE,
+			.logicOp = VkLogicOp{},
+			.attachmentCount = 1u,
+			.pAttachments = nullptr,
+			.blendConstants = {}
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamicStateCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.dynamicStateCount = 0,
+			.pDynamicStates = nullptr
+		};
+	};
+
+	template <template<class> class AllocTemplate = std::allocator>
+	class Renderer
+	{
+	public: // type shortcuts
+		template <typename T>
+		using VectorCustom = std::vector<T, AllocTemplate<T>>;
+		template <typename T>
+		using VectorTransient = std::vector<T, ArenaAllocator<T>>; // function local temporaries, from the arena of the current scope
+
+	public: // constructors
+		Renderer();
+		Renderer(Renderer const&) = delete;
+		auto operator=(Renderer const&) -> Renderer = delete;
+		// TODO define move semantics
+		~Renderer();
+		
+	public: // public functions, initialization procedures
+		// TODO refactor so that you take a raw array. it is too restrictive to constraint api caller to use a specific class data structure
+		auto init(std::span<char const*> desiredInstanceExtensions, 
+				  std::span<char const*> desiredDeviceExtensions, 
+				  GLFWwindow* window, uint32_t width, uint32_t height,
+				  VertexStream const& vertexInput, IndexStream const& indexInput,
+				  Eigen::Transform<float,3,Eigen::Affine> const& affineTransform,
+				  JobSystem* jobSystem) & -> status_t;  // TODO vert and indices are Temp, need to refactor in their own class. Uniform data == affine transform is temporary
+		// TODO init arguments refactored in a customizeable struct, create swapchain only if requested, and create a window class
+		// a null window means headless: no surface nor swapchain, frames are rendered into offscreen images, left in TRANSFER_SRC_OPTIMAL layout
+		auto draw() & -> status_t;
+		auto resize(uint32_t width, uint32_t height) & -> status_t; // TODO recreate swapchain only if swapchain has been requested
+		auto updateUniformBuffer(uint32_t framebufferIdx) -> status_t;
+		// recorded command buffers are reused until something they reference changes. Setup functions call this already, callers
+		// changing the scene from outside (eg. geometry, draw parameters) must call it too
+		auto markCommandBuffersDirty() & -> void;
+		auto commandBufferRecordCount() const & -> uint64_t { return m_cmdBufRecordCount; }
+		auto setDrawItems(std::span<DrawItem const> drawItems) & -> void; // ranges of the index buffer drawn each frame. Drops the LODs and meshlets
+		// LODs of the draw items, one chain each, as built by buildLods. Each recording draws every DrawItem at the coarsest of its LODs whose
+		// error covers at most maxErrorPixels on screen, with the transform and extent of that moment
+		auto setLods(std::span<LodChain const> lodChains, std::span<MeshLod const> lods, float maxErrorPixels = 1.f) & -> status_t;
+		// meshlets of the draw items, one range each, as built by buildMeshlets. Each recording culls those of the DrawItems drawn at full detail
+		// against the frustum and their backfacing cones, and draws each run of visible meshlets with one call
+		auto setMeshlets(std::span<MeshletRange const> meshletRanges, std::span<Meshlet const> meshlets, std::span<MeshletBounds4 const> meshletBounds) & -> status_t;
+		// object to clip transform of the geometry (eg. the world matrix of a scene node), applied from the next frame. Command buffers are
+		// recorded again only if LODs or meshlets are selected with it
+		auto setTransform(Eigen::Transform<float,3,Eigen::Affine> const& affineTransform) & -> void;
+		auto recordedIndexCount() const & -> uint64_t { return m_recordedIndexCount; } // drawn by the last recorded command buffer, after LOD selection and culling
+		// how many frames the CPU can record and submit before waiting for the GPU. Lower means less latency, higher means less stalls
+		auto setFramesInFlight(uint32_t framesInFlight) & -> status_t;
+		// host memory of every vulkan object created from then on, so only before init. Null, the default, leaves it to the implementation
+		auto setAllocationCallbacks(VkAllocationCallbacks const* allocationCallbacks) & -> status_t;
+		auto allocationCallbacks() const & -> VkAllocationCallbacks const* { return m_allocationCallbacks; }
+		auto framesInFlight() const & -> uint32_t { return m_framesInFlight; }
+		// frames are numbered from 1 in submission order, frame n being submitted by the n-th successful draw
+		auto submittedFrameCount() const & -> uint64_t { return m_submittedFrameCount; }
+		auto waitFrameTimeline(uint64_t value) & -> status_t; // blocks until the GPU completed frame number value. Callable from any thread
+		auto isHeadless() const & -> bool { return m_headless; }
+		// from now on every frame is copied out and handed to callback (on a job system worker) a few frames later, without stalling rendering.
+		// Frames are skipped when all slotCount slots are busy
+		auto enableReadback(ReadbackCallback callback, void* userData, uint32_t slotCount = 3) & -> status_t;
+		auto jobSystem() const & -> JobSystem* { return m_jobSystem; } // so that work on renderer data (culling, asset decoding) can be scheduled alongside it
+		auto gpuProfiler() const & -> GpuProfiler const& { return m_gpuProfiler; }
+
+	public: // public function, utilities
+		auto progress_incomplete() const & -> status_t; // TODO: const correct and ref correct members
+
+	private: // setup vulkan objects functions, called by init
+		auto setupInstance(std::span<char const*> const& desiredExtensions) & -> status_t;
+		auto setupSurfaceKHR(GLFWwindow* window) & -> status_t; // TODO refactor
+		auto setupPhyDevice(std::span<char const*> const& desiredDeviceExtensions) -> status_t;
+		auto setupDeviceAndQueues(std::span<char const*> const& deviceExtensions) & -> status_t;
+		auto setupSwapchain(uint32_t width, uint32_t height) & -> status_t;
+		auto setupOffscreenTargets(uint32_t width, uint32_t height) & -> status_t; // headless replacement for the swapchain images
+		auto destroyOffscreenTargets() & -> void;
+		auto selectSurfaceFormat(VkPhysicalDevice phyDevice, VkSurfaceFormatKHR* outSurfaceFormat) const & -> bool; // preferred format among those supported by m_surface
+		auto setupCommandBuffers() & -> status_t;
+		auto setupImageCommandBuffers() & -> status_t; // primary and secondaries of each swapchain image, from the pools already created
+		auto destroyImageCommandBuffers() & -> void;
+		auto resizeImageState() & -> status_t; // rebuilds everything sized on the swapchain images after their count changed
+		auto setupDepthImage() & -> status_t;
+		auto setupDepthDeviceMemory() & -> status_t;
+		auto setupRenderPass() & -> status_t;
+		auto setupFramebuffers() & -> status_t;
+		auto setupGraphicsPipeline() & -> status_t;
+		auto recordCommands(uint32_t framebufferIdx) & -> status_t;
+		auto recordSecondary(uint32_t framebufferIdx, uint32_t threadIdx, std::span<DrawItem const> drawItems) & -> status_t;
+		auto recordDraws(VkCommandBuffer cmdBuf, uint32_t framebufferIdx, std::span<DrawItem const> drawItems) & -> void; // state binding and draws, shared by primary and secondaries
+		// draw items [first, last) at their LOD, or as their visible meshlets. Threads can select disjoint ranges
+		auto selectDraws(uint32_t first, uint32_t last) & -> std::span<DrawItem const>;
+		auto updateDrawSlots() & -> void; // sizes m_selectedDrawItems for the current LODs and meshlets
+		auto setupSynchronizationObjects() & -> status_t;
+		auto setupImageSemaphores() & -> status_t; // render finished semaphores and timeline values, one for each swapchain image
+		auto destroyImageSemaphores() & -> void;
+		auto setupVertexInput(VertexStream const& vertexInput, IndexStream const& indexInput) & -> status_t;
+		auto setupDescriptorSets(Eigen::Transform<float,3,Eigen::Affine> const& affineTransform) & -> status_t;
+		auto setupUniformRing(Eigen::Transform<float,3,Eigen::Affine> const& affineTransform) & -> status_t; // a region for each swapchain image, bound to the descriptor set
+
+		// frequently called
+		// auto createBuffer(/**/) & -> status_t;
+		// auto createImage(/**/) & -> status_t;
+		auto printVkResultValue(VkResult res) const & -> void;
+
+	private: // data members, dispatchable and non dispatchable vulkan objects handles
+		// vulkan initialization members
+		VkAllocationCallbacks const* m_allocationCallbacks; // not owned, passed to every create and destroy
+		#define MXC_RENDERER_TRANSIENT_ARENA_SIZE (256u << 10)
+		LinearArena m_transientArena; // temporaries of the setup functions and of each frame, given back when their scope ends
+		VkInstance m_instance;
+		VkPhysicalDevice m_phyDevice;
+		VkDevice m_device;
+		DeviceAllocator<AllocTemplate> m_deviceAllocator; // every VkDeviceMemory comes from here
+
+		// children of VkDevice
+		struct queues_t
+		{
+			// NOTE: graphics queue and presentation queue could be the same
+			int32_t graphics;
+			int32_t presentation;
+		};
+		#define MXC_RENDERER_QUEUES_COUNT sizeof(queues_t)/sizeof(int32_t)
+		#define MXC_RENDERER_GRAPHICS_QUEUES_COUNT 1
+		union // anonymous unions cannot possess anonymous structs. anonymous unions do NOT define a type, but a variable
+		{
+			int32_t m_queueIdxArr[MXC_RENDERER_QUEUES_COUNT]; 
+			queues_t m_queueIdx;
+		};
+		VkQueue m_queues[MXC_RENDERER_QUEUES_COUNT];
+
+		VkCommandPool m_graphicsCmdPool;	//cmdPools can also be trimmed or reset
+		VectorCustom<VkCommandBuffer> m_graphicsCmdBufs; // these two are created/allocated for the m_queueIdx.graphics queue
+		VectorCustom<uint8_t> m_graphicsCmdBufsDirty; // one for each command buffer, set when it has to be re-recorded before its next submission
+		uint64_t m_cmdBufRecordCount; // how many times a command buffer was actually recorded
+		uint64_t m_frameCount;
+		// secondary command buffers, for each swapchain image and for each recording chunk, laid out as [image][chunk], each allocated from its own pool.
+		// chunks are recorded as jobs, and a job runs on a single thread, so pools are never shared between threads
+		#define MXC_RENDERER_SECONDARY_RECORDING_THRESHOLD 256 // below this number of draws they are recorded inline in the primary
+		#define MXC_RENDERER_MAX_RECORD_THREADS 8
+		JobSystem* m_jobSystem; // not owned
+		uint32_t m_recordThreadCount;
+		VectorCustom<VkCommandPool> m_secondaryCmdPools;
+		VectorCustom<VkCommandBuffer> m_secondaryCmdBufs;
+
+		VkRenderPass m_renderPass;
+		// color output attachment and depth output attachment
+		#define MXC_RENDERER_ATTACHMENT_COUNT 2
+		VkImage m_depthImage;
+		VkImageView m_depthImageView;
+		DeviceAllocation m_depthImageMemory;
+
+		// cmdbuf count = framebuffer count = swapchain images count = semaphores count = fences count
+		VectorCustom<VkFramebuffer> m_framebuffers; // triple buffering
+			
+		#define MXC_RENDERER_SHADERS_COUNT 2
+		VkPipeline m_graphicsPipeline;
+		VkPipelineLayout m_graphicsPipelineLayout;
+		PipelineCache m_pipelineCache; // shared by every pipeline creation, persisted across runs
+
+		// gpu timings. Slots [0, MXC_RENDERER_PROFILER_IMAGE_SLOTS) belong to the graphics command buffers, one for each image, then upload batches
+		#define MXC_RENDERER_PROFILER_IMAGE_SLOTS 8
+		GpuProfiler m_gpuProfiler;
+
+		// -- frame pacing. Frame n (1 based) signals value n on the timeline semaphore when the GPU is done with it, so the CPU can run at most
+		//    m_framesInFlight frames ahead, regardless of how many images the swapchain has
+		#define MXC_RENDERER_DEFAULT_FRAMES_IN_FLIGHT 2
+		uint32_t m_framesInFlight;
+		uint64_t m_submittedFrameCount; // timeline value signaled by the last submitted frame
+		VkSemaphore m_frameTimeline;
+		VectorCustom<uint64_t> m_imageTimelineValue; // for each swapchain image, timeline value of the last frame which rendered to it
+		VectorCustom<VkSemaphore> m_semaphoreImageAvailable; // one for each frame in flight
+		VectorCustom<VkSemaphore> m_semaphoreRenderFinished; // one for each swapchain image, as it is reusable only once the image is acquired again
+
+		// headless mode, offscreen color images stand in for the swapchain ones (same vectors, so that framebuffers and recording don't care)
+		#define MXC_RENDERER_HEADLESS_IMAGE_COUNT 2
+		bool m_headless;
+		VectorCustom<DeviceAllocation> m_offscreenImageMemory;
+		FrameReadback<AllocTemplate> m_frameReadback; // initialized only if requested
+
+		// presentation WSI extension
+		VkSurfaceKHR m_surface;
+		VkSurfaceFormatKHR m_surfaceFormatUsed;
+		VkPresentModeKHR m_presentModeUsed;
+		VkSurfaceCapabilitiesKHR m_surfaceCapabilities; // TODO remember to check these in the creation of swapchain, pipeline, ...
+		VkSwapchainKHR m_swapchain;
+		VectorCustom<VkImage> m_swapchainImages;
+		VectorCustom<VkImageView> m_swapchainImageViews;
+		VkExtent2D m_surfaceExtent;
+
+		// other vulkan related
+		VkFormat m_depthImageFormat;
+
+		// input vertex data
+		UploadManager<AllocTemplate> m_uploadManager; // staging memory and transfers
+		VkBuffer m_vertexBuffer;
+		VkBuffer m_indexBuffer;
+		VertexFormat m_vertexFormat; // layout of the vertex buffer, the pipeline's vertex input follows it
+		VkIndexType m_indexType;
+		VectorCustom<DrawItem> m_drawItems;
+		VectorCustom<LodChain> m_lodChains; // one for each DrawItem, or none
+		VectorCustom<MeshLod> m_lods;
+		VectorCustom<MeshletRange> m_meshletRanges; // one for each DrawItem, or none
+		VectorCustom<Meshlet> m_meshlets;
+		VectorCustom<MeshletBounds4> m_meshletBounds;
+		VectorCustom<uint8_t> m_meshletVisible; // of the last recording, one for each meshlet
+		// m_drawItems at their LOD or as their visible meshlets, as last recorded: DrawItem i has the slots [m_drawSlotOffsets[i], m_drawSlotOffsets[i + 1]),
+		// one for each meshlet, or one. Sized by updateDrawSlots, so recording doesn't allocate
+		VectorCustom<DrawItem> m_selectedDrawItems;
+		VectorCustom<uint32_t> m_drawSlotOffsets;
+		float m_lodMaxErrorPixels;
+		uint64_t m_recordedIndexCount;
+		DeviceAllocation m_vertexBufferMemory; // sub-allocations of the device allocator blocks
+		DeviceAllocation m_indexBufferMemory;
+
+		// descriptor sets
+		VectorCustom<VkDescriptorSetLayout> m_descriptorSetLayouts;
+		VkDescriptorPool m_descriptorPool;
+		VectorCustom<VkDescriptorSet> m_descriptorSets;
+		#define MXC_RENDERER_UNIFORM_REGION_SIZE 65536 // bytes of uniform data each frame can push
+		UniformRing<AllocTemplate> m_uniformRing; // one region for each command buffer, so that we can update uniform data without synchronization
+		VectorCustom<uint32_t> m_transformDynamicOffsets; // one for each command buffer
+		VkDeviceSize m_uniformBufferSize;
+		Eigen::Transform<float,3,Eigen::Affine> m_transform; // TODO refactor
+		Eigen::Transform<float,3,Eigen::Affine> m_objectTransform; // m_transform without the dequantization, LOD errors and bounds are in mesh space
+		Eigen::Transform<float,3,Eigen::Affine> m_dequantization; // of the vertex buffer
+
+#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug
+		VkDebugUtilsMessengerEXT m_dbgMessenger;
+		#define MXC_RENDERER_INSERT_MESSENGER MESSENGER_CREATED
+#else
+		#define MXC_RENDERER_INSERT_MESSENGER 0
+#endif // ifndef NDEBUG
+
+		// renderer state machine to TODO refactor. type is below
+		uint32_t m_progressStatus;
+
+	private: // data members, utilities
+		enum m_Progress_t : uint32_t
+		{
+			INITIALIZED = 0x80000000,
+			INSTANCE_CREATED = 0x40000000,
+#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug
+			MESSENGER_CREATED = 0x20000000,
+#endif // ifndef NDEBUG
+			PHY_DEVICE_GOT = 0x10000000,
+			DEVICE_CREATED = 0x08000000,
+			SURFACE_CREATED = 0x0400000,
+			SWAPCHAIN_CREATED = 0x02000000,
+			SWAPCHAIN_IMAGE_VIEWS_CREATED = 0x01000000,
+			COMMAND_BUFFER_ALLOCATED = 0x00800000,
+			RENDERPASS_CREATED = 0x00200000,
+			DEPTH_IMAGE_CREATED = 0x00100000,
+			DEPTH_MEMORY_ALLOCATED = 0x00002000,
+			FRAMEBUFFERS_CREATED = 0x00080000,
+			GRAPHICS_PIPELINE_LAYOUT_CREATED = 0x00040000,
+			GRAPHICS_PIPELINE_CREATED = 0x00020000,
+			SYNCHRONIZATION_OBJECTS_CREATED = 0x00010000,
+			VERTEX_INPUT_BOUND = 0x00008000,
+			DESCRIPTOR_SETS_SETUP = 0x00004000
+		};
+	
+	private: // functions, utilities
+
+		#ifndef NDEBUG
+		auto dbgPrintInstanceExtensionsAndLayers(std::span<const char*> const& instanceExtensions, std::span<char const*> const& layers) -> void;
+		#endif
+	};
+
+	static constexpr VkSurfaceCapabilitiesKHR defaultSurfaceCapabilities{};
+
+	template <template<class> class AllocTemplate> Renderer<AllocTemplate>::Renderer() 
+			: m_allocationCallbacks(nullptr), m_transientArena(), m_instance(VK_NULL_HANDLE), m_phyDevice(VK_NULL_HANDLE), m_device(VK_NULL_HANDLE)
+			, m_queueIdxArr{-1}, m_queues{VK_NULL_HANDLE} // TODO Don't forget to update m_queueIdxArr when adding queue types
+			, m_graphicsCmdPool(VK_NULL_HANDLE), m_graphicsCmdBufs(VectorCustom<VkCommandBuffer>(0)), m_graphicsCmdBufsDirty(VectorCustom<uint8_t>(0)), m_cmdBufRecordCount(0), m_frameCount(0), m_jobSystem(nullptr), m_recordThreadCount(1), m_secondaryCmdPools(VectorCustom<VkCommandPool>(0)), m_secondaryCmdBufs(VectorCustom<VkCommandBuffer>(0)), m_renderPass(VK_NULL_HANDLE)
+			, m_depthImage(VK_NULL_HANDLE), m_depthImageView(VK_NULL_HANDLE), m_depthImageMemory()
+			, m_framebuffers(VectorCustom<VkFramebuffer>()), m_graphicsPipeline(VK_NULL_HANDLE), m_graphicsPipelineLayout(VK_NULL_HANDLE)
+			, m_framesInFlight(MXC_RENDERER_DEFAULT_FRAMES_IN_FLIGHT), m_submittedFrameCount(0), m_frameTimeline(VK_NULL_HANDLE), m_imageTimelineValue(VectorCustom<uint64_t>(0)), m_semaphoreImageAvailable(VectorCustom<VkSemaphore>()), m_semaphoreRenderFinished(VectorCustom<VkSemaphore>())
+			, m_headless(false), m_offscreenImageMemory(VectorCustom<DeviceAllocation>(0))
+			, m_surface(VK_NULL_HANDLE), m_surfaceFormatUsed({.format=VK_FORMAT_UNDEFINED,.colorSpace=VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}), m_presentModeUsed(VK_PRESENT_MODE_FIFO_KHR), m_surfaceCapabilities(defaultSurfaceCapabilities)
+			, m_swapchain(VK_NULL_HANDLE), m_swapchainImages(VectorCustom<VkImage>()), m_swapchainImageViews(VectorCustom<VkImageView>())
+			, m_surfaceExtent(VkExtent2D{0,0}), m_depthImageFormat(VK_FORMAT_D32_SFLOAT), m_uploadManager(), m_vertexBuffer(VK_NULL_HANDLE), m_indexBuffer(VK_NULL_HANDLE), m_vertexFormat(VERTEX_FORMAT_FLOAT32), m_indexType(VK_INDEX_TYPE_UINT32), m_drawItems(VectorCustom<DrawItem>(0)), m_lodChains(VectorCustom<LodChain>(0)), m_lods(VectorCustom<MeshLod>(0)), m_meshletRanges(VectorCustom<MeshletRange>(0)), m_meshlets(VectorCustom<Meshlet>(0)), m_meshletBounds(VectorCustom<MeshletBounds4>(0)), m_meshletVisible(VectorCustom<uint8_t>(0)), m_selectedDrawItems(VectorCustom<DrawItem>(0)), m_drawSlotOffsets(VectorCustom<uint32_t>(0)), m_lodMaxErrorPixels(1.f), m_recordedIndexCount(0), m_vertexBufferMemory(), m_indexBufferMemory()
+			, m_descriptorSetLayouts(VectorCustom<VkDescriptorSetLayout>()), m_descriptorPool(VK_NULL_HANDLE), m_descriptorSets(VectorCustom<VkDescriptorSet>(0))
+			, m_uniformRing(), m_transformDynamicOffsets(VectorCustom<uint32_t>(0)), m_uniformBufferSize(0), m_transform(Eigen::Transform<float,3,Eigen::Affine>::Identity()), m_objectTransform(Eigen::Transform<float,3,Eigen::Affine>::Identity()), m_dequantization(Eigen::Transform<float,3,Eigen::Affine>::Identity())
+#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug
+			, m_dbgMessenger(VK_NULL_HANDLE)
+#endif
+			, m_progressStatus(0u)
+	{
+	}				
+template <template<class> class AllocTemplate> 
+	auto Renderer<AllocTemplate>::init(std::span<char const*> desiredInstanceExtensions, 
+									   std::span<char const*> desiredDeviceExtensions,
+									   GLFWwindow* window, uint32_t width, uint32_t height,
+									   VertexStream const& vertexInput, IndexStream const& indexInput,
+									   Eigen::Transform<float,3,Eigen::Affine> const& affineTransform,
+									   JobSystem* jobSystem) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		if (m_transientArena.init(MXC_RENDERER_TRANSIENT_ARENA_SIZE) != APP_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+		LinearArena::Scope const initScope(&m_transientArena); // what the setup functions allocate is all given back on return
+
+		m_dequantization = vertexInput.dequantization();
+		m_transform = affineTransform * m_dequantization; // quantized positions are mapped back to the mesh bounds here
+		m_objectTransform = affineTransform;
+		m_jobSystem = jobSystem;
+		m_headless = window == nullptr;
+		if (setupInstance(desiredInstanceExtensions)
+			|| (!m_headless && setupSurfaceKHR(window)) // TODO work in progress, refactor to another class, like "rendererWindowAdaptor" to make renderer and window loosely coupled
+			|| setupPhyDevice(desiredDeviceExtensions)
+			|| setupDeviceAndQueues(desiredDeviceExtensions)
+			|| (m_headless ? setupOffscreenTargets(width, height) : setupSwapchain(width, height))
+			|| setupCommandBuffers()
+			|| setupDepthImage()
+			|| setupDepthDeviceMemory()
+			|| setupVertexInput(vertexInput, indexInput)
+			|| setupDescriptorSets(m_transform)
+			|| setupRenderPass()
+			|| setupFramebuffers()
+			|| setupGraphicsPipeline()
+			|| setupSynchronizationObjects())
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= INITIALIZED;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> 
+	Renderer<AllocTemplate>::~Renderer()
+	{
+		MXC_TRACE_SCOPE("~Renderer");
+		printf("time to destroy renderer!\n");
+		// wait until the device is idle to clean resources so we don't break anything with VkFences
+		if (m_progressStatus & DEVICE_CREATED)
+		{	
+			vkDeviceWaitIdle(m_device);
+		}
+
+		// destroy descriptor set, descriptor set layout and free its memory
+		for (uint32_t i = 0; i < m_descriptorSetLayouts.size(); ++i)
+			vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayouts[0], m_allocationCallbacks);
+
+		vkFreeDescriptorSets(m_device, m_descriptorPool, m_descriptorSets.size(), m_descriptorSets.data());
+		vkDestroyDescriptorPool(m_device, m_descriptorPool, m_allocationCallbacks);
+
+		m_uniformRing.destroy();
+		m_frameReadback.destroy(); // delivers the last frames
+
+		// destroy vertex and index buffers, and the staging memory used to fill them
+		m_uploadManager.destroy();
+		m_gpuProfiler.printStats();
+		m_gpuProfiler.destroy();
+		vkDestroyBuffer(m_device, m_vertexBuffer, m_allocationCallbacks);
+		vkDestroyBuffer(m_device, m_indexBuffer, m_allocationCallbacks);
+		m_deviceAllocator.free(m_vertexBufferMemory);
+		m_deviceAllocator.free(m_indexBufferMemory);
+
+		// Then we can clean everything up. Note that we do not check for successful initialization. That's because
+		// the vkDestroy and vkDeallocate functions can be called when the handle to be destroyed/freed is VK_NULL_HANDLE 
+		for (VkSemaphore semaphore : m_semaphoreImageAvailable)
+		{
+			vkDestroySemaphore(m_device, semaphore, m_allocationCallbacks);
+		}
+		destroyImageSemaphores();
+		vkDestroySemaphore(m_device, m_frameTimeline, m_allocationCallbacks);
+
+		vkDestroyPipeline(m_device, m_graphicsPipeline, m_allocationCallbacks);
+		vkDestroyPipelineLayout(m_device, m_graphicsPipelineLayout, m_allocationCallbacks);
+
+		// each array is walked on its own size, as init could have failed before filling it
+		for (uint32_t i = 0; i < m_framebuffers.size(); ++i)
+		{
+			vkDestroyFramebuffer(m_device, m_framebuffers[i], m_allocationCallbacks);
+		}
+		
+		// destroy depth buffer
+		vkDestroyImageView(m_device, m_depthImageView, m_allocationCallbacks);
+		vkDestroyImage(m_device, m_depthImage, m_allocationCallbacks);
+		m_deviceAllocator.free(m_depthImageMemory);
+	
+		vkDestroyRenderPass(m_device, m_renderPass, m_allocationCallbacks);
+	
+		destroyImageCommandBuffers();
+		vkDestroyCommandPool(m_device, m_graphicsCmdPool, m_allocationCallbacks);
+
+		for (uint32_t i = 0u; i < m_swapchainImageViews.size(); ++i)
+		{
+			vkDestroyImageView(m_device, m_swapchainImageViews[i], m_allocationCallbacks);
+		}
+		destroyOffscreenTargets(); // does nothing if not headless
+
+		vkDestroySwapchainKHR(m_device, m_swapchain, m_allocationCallbacks);
+		vkDestroySurfaceKHR(m_instance, m_surface, m_allocationCallbacks);
+
+		// all its child objects need to be destroyed before doing this, VkDeviceMemory blocks included
+		printf("command buffers recorded %lu times in %lu frames\n", static_cast<unsigned long>(m_cmdBufRecordCount), static_cast<unsigned long>(m_frameCount));
+		m_pipelineCache.destroy(); // written back to disk
+		m_transientArena.printStats();
+		m_deviceAllocator.printStats();
+		m_deviceAllocator.destroy();
+		vkDestroyDevice(m_device, m_allocationCallbacks);
+
+#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug
+		auto const vkDestroyDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+			vkGetInstanceProcAddr(m_instance, "vkDestroyDebugUtilsMessengerEXT")
+		);
+		if (vkDestroyDebugUtilsMessengerEXT)
+		{
+			vkDestroyDebugUtilsMessengerEXT(m_instance, m_dbgMessenger, m_allocationCallbacks);
+		}
+#endif
+
+		vkDestroyInstance(m_instance, m_allocationCallbacks);
+		printf("destroyed renderer!\n");
+	}
+	
+	//
+#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug TODO
+	// by default, Vulkan's validation layers print all their output to the STDOUT. we can decide to handle the report of validation layers
+	// ourselves by defining a function callback with format predefined by the specification, ONLY AFTER enabling the extension "VK_EXT_debug_utils"
+	// such string constant can be also written by typing the macro VK_EXT_DEBUG_UTILS_EXTENSION_NAME
+	/** types with the following signature: VkDebugUtils*EXT
+	 * VkDebugUtilsMessageSeverityFlagBitsEXT = number which is one of the following ( VK_DEBUG_UTILS_MESSAGE_SEVERITY_<content>_BIT_EXT )
+	 * 		VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT -> diagnostic message
+	 * 		<= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT -> report message, eg creation of a VkInstance
+	 * 		<= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT -> warning message
+	 * 		<= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT -> the one you don't want to see
+	 * 		their ordering can be used to filter messages "not important enough"
+	 * 	VkDebugUtilsMessageTypeFlagsEXT = again a bit field with names VK_DEBUG_UTILS_MESSAGE_TYPE_*_BIT_EXT
+	 * 		VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT -> the message reports the happening of an event unrelated with the specification(ie errors) or performance(suboptimal usage of vulkan)
+	 * 		VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT -> message reports violation of specification
+	 * 		VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT -> message reports suboptimal usage of vulkan
+	 * 	VkDebugUtilsMessengerCallbackDataEXT is a struct containing the message itself + some info about it
+	 * 		pMessage -> pointer to a nul-terminated string
+	 * 		pObjects -> array of vulkan objects handles related to the message
+	 * 		objectCount
+	 * 	pUserData -> pointer specified during the setup of the callback containing custom data
+	 *
+	 * 	the return bool of the callback reports whether the Vulkan call which triggered it should be aborted or not. This is normally used to 
+	 * 	test the validation itself, and should always return VK_FALSE otherwise
+	 */
+	VKAPI_ATTR
+	inline auto VKAPI_CALL debugCallback(
+		[[maybe_unused]] VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
+		[[maybe_unused]] VkDebugUtilsMessageTypeFlagsEXT message_type,
+		VkDebugUtilsMessengerCallbackDataEXT const* pcallback_data,
+		[[maybe_unused]] void* puser_data
+	) -> VkBool32
+	{
+		// TODO maybe it's better to put it in a file?
+		fprintf(stderr, "%s\n", pcallback_data->pMessage);
+		return VK_FALSE;
+
+	}
+	template <template<class> class AllocTemplate> 
+	auto Renderer<AllocTemplate>::dbgPrintInstanceExtensionsAndLayers(std::span<char const*> const& instanceExtensions, std::span<char const*> const& layers) -> void
+	{
+		FILE* const file = fopen("./ext_and_layers_names.txt", "w");
+		if (file)
+		{
+			fprintf(file, "extensions:\n");
+			for (uint32_t i = 0u; i < instanceExtensions.size(); ++i)
+			{
+				fprintf(file, "%s\n", instanceExtensions[i]);
+			}
+			fprintf(file, "validation layers:\n");
+			for (uint32_t i = 0u; i < layers.size(); ++i)
+			{
+				fprintf(file, "%s\n", layers[i]);
+			}
+			fclose(file);
+			printf("instance extensions and layers debug file created!\n");
+		}
+		else
+		{
+			printf("no debug file could be created!");
+		}
+	}
+#endif // ifndef NDEBUG
+
+	template <template<class> class AllocTemplate> 
+	auto Renderer<AllocTemplate>::setupInstance(std::span<char const*> const& desiredInstanceExtensions) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+     	// -- Check for vulkan 1.2 support ------------------------------------------------------------------
+		uint32_t supported_vk_api_version;
+		vkEnumerateInstanceVersion(&supported_vk_api_version);	
+       	if (supported_vk_api_version < VK_MAKE_API_VERSION(/*variant*/0,/*major*/1,/*minor*/2,/*patch*/0))
+		{
+			// TODO substitute with a primitive logging with pretty printing, enabled only in Debug
+       		fprintf(stderr, "system does not support vulkan 1.2 or higher!");
+			return APP_LACK_OF_VULKAN_1_2_SUPPORT_ERR;
+    	}
+
+		// -- Check for desired instance extensions support ---------------------------------------------------
+		uint32_t extensionPropertyCnt;
+		vkEnumerateInstanceExtensionProperties(/*layer*/nullptr, &extensionPropertyCnt, nullptr);
+		VectorTransient<VkExtensionProperties> extensionProperties(extensionPropertyCnt);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionPropertyCnt, extensionProperties.data());
+
+		for (uint32_t i = 0; i < desiredInstanceExtensions.size(); ++i)
+		{
+			uint32_t j = 0;
+			for (; j < extensionPropertyCnt; ++j)
+			{
+				if (strcmp(desiredInstanceExtensions[i], extensionProperties[j].extensionName) == 0)
+				{
+					break;
+				}
+			}
+			if (j == desiredInstanceExtensions.size())
+			{
+				fprintf(stderr, "couldn't find extension %s\n", extensionProperties[i].extensionName);
+				return APP_GENERIC_ERR;
+			}
+		}
+
+		// -- setup validation layers and messenger ---------------------------------------------------------------------------------------------------------
+		VectorTransient<char const*> desiredValidationLayers {
+			"VK_LAYER_KHRONOS_validation"
+		};
+		uint32_t enabledLayerCnt = 0u;
+		VkDebugUtilsMessengerCreateInfoEXT const* dbgMsgerPtr = nullptr;
+
+		#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug
+
+		// create info for the debug messenger, passed first as extension to the instance create info and then used to create msger
+		VkDebugUtilsMessengerCreateInfoEXT const dbgMsgerCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
+			.pNext = nullptr,
+			.flags = 0,
+			.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT
+							 | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT
+							 | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT
+							 | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,	// select which msg severities you want the messenger to report
+			.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT
+						 | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+						 | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,		// select which msg types you want the messenger to report
+			.pfnUserCallback = debugCallback,									// select which function to use as callback
+			.pUserData = nullptr												// selects user data to pass as 4th param to the callback. OPTIONAL
+		};
+		dbgMsgerPtr = &dbgMsgerCreateInfo;
+	
+		// check desired validation layers for support
+		uint32_t layerPropertyCnt;
+		vkEnumerateInstanceLayerProperties(&layerPropertyCnt, nullptr);
+		VectorTransient<VkLayerProperties> layerProperties(layerPropertyCnt);
+		vkEnumerateInstanceLayerProperties(&layerPropertyCnt, layerProperties.data());
+
+		for (uint32_t i = 0u; i < desiredValidationLayers.size(); ++i)
+		{
+			for (uint32_t j = 0u; j < layerPropertyCnt; ++j)
+			{
+				if (0 == strncmp(layerProperties[j].layerName, desiredValidationLayers[i], VK_MAX_EXTENSION_NAME_SIZE))
+				{
+					++enabledLayerCnt;
+					break;
+				}
+			}
+		}
+		if (enabledLayerCnt == 0u)
+		{
+			fprintf(stderr, "no layers were available!\n");
+		}
+
+		#endif // ifndef NDEBUG
+	
+		// -- create the vulkan instance --------------------------------------------------------------------------------------------------
+		VkApplicationInfo const applicationInfo = {
+			.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+			.pNext = nullptr,
+			.pApplicationName = "my first vulkan app",
+			.applicationVersion = 1u,
+			.pEngineName = "my first vulkan app",
+			.engineVersion = 1u,
+			.apiVersion = VK_MAKE_API_VERSION(/*variant*/0,/*major*/1,/*minor*/2,/*patch*/0) // the only useful thing here
+		};
+
+		VkInstanceCreateInfo const instanceCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+			.pNext = dbgMsgerPtr,
+			.flags = 0, // Bitmask on some options that define the BEHAVIOUR OF THE INSTANCE
+			.pApplicationInfo = &applicationInfo,
+			.enabledLayerCount = enabledLayerCnt, // enabling ALL layers for now TODO
+			.ppEnabledLayerNames = desiredValidationLayers.data(),
+			.enabledExtensionCount = static_cast<uint32_t>(desiredInstanceExtensions.size()),
+			.ppEnabledExtensionNames = desiredInstanceExtensions.data()
+		};
+
+		VkResult result = vkCreateInstance(&instanceCreateInfo, m_allocationCallbacks, &m_instance);
+		if (result != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create an instance!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= INSTANCE_CREATED;
+		printf("instance created!\n");
+
+		// -- create debug messenger --------------------------------------------------------------------------------------
+#ifndef NDEBUG // CMAKE_BUILD_TYPE=Debug
+		// since this is an extension function, it is not automatically loaded and we need to call vkGetInstanceProcAddr(insance, funcname) ourselves
+		auto const vkCreateDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(vkGetInstanceProcAddr(m_instance, "vkCreateDebugUtilsMessengerEXT"));
+		if (!vkCreateDebugUtilsMessengerEXT)
+		{
+			return VK_ERROR_EXTENSION_NOT_PRESENT;
+		}
+
+		result = vkCreateDebugUtilsMessengerEXT(m_instance, &dbgMsgerCreateInfo, m_allocationCallbacks, &m_dbgMessenger);
+		if (result != VK_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= MESSENGER_CREATED;
+		dbgPrintInstanceExtensionsAndLayers(desiredInstanceExtensions, desiredValidationLayers);
+#endif // ifndef NDEBUG	
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> 
+	auto Renderer<AllocTemplate>::setupPhyDevice(std::span<char const*> const& desiredDeviceExtensions) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & INSTANCE_CREATED);
+		assert((m_headless || (m_progressStatus & SURFACE_CREATED)) && "a surface is required, unless headless");
+
+		// variable used in all enumerate functions present here
+		uint32_t enumerateCounter;
+
+		// -- retrieve list of vulkan capable physical devices ----------------------------------------------------------------
+		vkEnumeratePhysicalDevices(m_instance, &enumerateCounter, nullptr);
+		VectorTransient<VkPhysicalDevice> phyDevices(enumerateCounter);
+		vkEnumeratePhysicalDevices(m_instance, &enumerateCounter, phyDevices.data());
+
+		// then you can query the properties of the physical device with vkGetPhysicalDeviceProperties and choose the one
+		// that suits your needs. I understand none of that, therefore I'm going to choose the first available GPU
+		// you have no idea how many more get properties functions there are.
+		// we will also query the available queue families. for now we need a graphics queue and a presentation enabled queue (WSI)
+		for (uint32_t i = 0u; i < phyDevices.size(); ++i)
+		{
+			// -- query physical device properties. Most relevant: limits and sparse properties TODO -------------------------------------------------------------------
+			VkPhysicalDeviceProperties phyDeviceProperties;
+			vkGetPhysicalDeviceProperties(phyDevices[i], &phyDeviceProperties);
+			if (phyDeviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+			{
+				printf("this is not a dedicated GPU!\n");
+			}
+
+			// -- query features TODO ---------------------------------------------------------------------------------------------
+
+			// -- query available queue families with their associated indices. First query how many there are to allocate a buffer ---------------
+			{
+				vkGetPhysicalDeviceQueueFamilyProperties(phyDevices[i], &enumerateCounter, nullptr);
+				if (enumerateCounter == 0u)
+				{
+					continue;
+				}
+
+				VectorTransient<VkQueueFamilyProperties> queueFamilyProperties(enumerateCounter);
+				vkGetPhysicalDeviceQueueFamilyProperties(phyDevices[i], &enumerateCounter, queueFamilyProperties.data());
+				for (uint32_t j = 0u; j < queueFamilyProperties.size(); ++j) // TODO refactor this to be more flexible
+				{
+					if ((m_queueIdx.graphics == -1) 
+						&& (0 != (queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)))
+					{
+						m_queueIdx.graphics = j;
+					}
+					
+					// query for the given index presentation support for the given queue family. Headless doesn't present, so it uses the graphics one
+					if (m_headless && m_queueIdx.graphics != -1)
+					{
+						m_queueIdx.presentation = m_queueIdx.graphics;
+						break;
+					}
+					if (m_queueIdx.presentation == -1 && !m_headless)
+					{
+						VkBool32 presentationSupported;
+						vkGetPhysicalDeviceSurfaceSupportKHR(phyDevices[i], /*queue family idx*/j, m_surface, &presentationSupported);
+						if (presentationSupported)
+						{
+							m_queueIdx.presentation = j;
+							break; // TODO move this break when adding more queue types
+						}
+					}
+				}
+
+				// now check if all necessary queues are present, if not continue with next device 
+				if (bool allQueuesPresent = m_queueIdx.graphics != -1 && m_queueIdx.presentation != -1; 
+					!allQueuesPresent)
+				{
+					continue;
+				}
+			} // vector killed
+
+			// -- get and store the surface capabilities, an intersection between the display capabilities
+			//    and the physical device capabilities regarding presentation. Needed to create a swapchain ----------------------------------------------
+			// vkGetPhysicalDeviceSurfaceCapabilitiesKHR(phyDevices[i], m_surface, &m_surfaceCapabilities); moved to swapchain creation
+			
+			// -- now check for surface format support, we want R8G8B8A8 format, with sRGB nonlinear colorspace. ------------------------------------------
+			// PS=there are more advanced query function to check for more specific features, 
+			// such as specifics about compression support
+			if (m_headless)
+			{
+				m_surfaceFormatUsed = {.format = VK_FORMAT_R8G8B8A8_UNORM, .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}; // mandatory as color attachment
+			}
+			else if (!selectSurfaceFormat(phyDevices[i], &m_surfaceFormatUsed))
+			{
+				continue;
+			}
+
+			// -- choose appropriate presentation mode for the swapchain ----------------------------------------------------------------------------
+			// We want as present mode, ie how images in the swapchain are managed during image
+			// swap, mailbox presentation mode, which means that 1) swapchain will keep the most 
+			// recent image and throw away the older ones 2) images are swapped during the vertical 
+			// blank interval only
+			if (!m_headless)
+			{
+				vkGetPhysicalDeviceSurfacePresentModesKHR(phyDevices[i], m_surface, &enumerateCounter, nullptr);
+				if (enumerateCounter == 0)
+				{
+					continue;
+				}
+	
+				VectorTransient<VkPresentModeKHR> surfacePresentModes(enumerateCounter);
+				vkGetPhysicalDeviceSurfacePresentModesKHR(phyDevices[i], m_surface, &enumerateCounter, surfacePresentModes.data());
+				for (uint32_t i = 0u; i < surfacePresentModes.size(); ++i)
+				{
+					if (surfacePresentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+					{
+						m_presentModeUsed = VK_PRESENT_MODE_MAILBOX_KHR;
+						break;
+					}
+				}
+				// if loop finishes and m_presentModeUsed is not set, its default value 
+				// (set by the renderer class constructor) is VK_PRESENT_MODE_FIFO_KHR
+			}
+			// -- check requested device extension support -------------------------------------------------------------------------------------------------------
+			{
+
+				printf("about to check device extension support on the physical device\n");
+				// then check against actual support of needed extensions for the device
+				vkEnumerateDeviceExtensionProperties(phyDevices[i], nullptr, &enumerateCounter, nullptr);
+				VectorTransient<VkExtensionProperties> supportedDeviceExtensions(enumerateCounter);
+				vkEnumerateDeviceExtensionProperties(phyDevices[i], nullptr, &enumerateCounter, supportedDeviceExtensions.data());
+
+				for (uint32_t i = 0u; i < desiredDeviceExtensions.size(); ++i)
+				{
+					uint32_t j = 0u;
+					for (; j < supportedDeviceExtensions.size(); ++j)
+					{
+						printf("\tchecking for desired device extension %u, on device extension %u\n", i, j);
+						if (0 == strncmp(supportedDeviceExtensions[j].extensionName, desiredDeviceExtensions[i], VK_MAX_EXTENSION_NAME_SIZE))
+						{
+							break;
+						}
+					}
+					if (j == supportedDeviceExtensions.size())
+					{
+						fprintf(stderr, "couldn't find device extension %s\n", desiredDeviceExtensions[i]);
+						return APP_GENERIC_ERR;
+					}
+				}
+			}
+
+			m_phyDevice = phyDevices[i];
+			m_progressStatus |= PHY_DEVICE_GOT;
+			printf("got physical device!\n");
+			break;
+		}
+
+		return APP_SUCCESS;
+	}
+	
+	template <template<class> class AllocTemplate> 
+	auto Renderer<AllocTemplate>::setupDeviceAndQueues(std::span<char const*> const& deviceExtensions) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & PHY_DEVICE_GOT);
+		// we can also map a device to multiple physical devices, a "device group", 
+		// physical devices that can access each other's memory. I'don't care
+		
+		// TODO it can be refactored in a struct of arrays to be more readable
+		// allocate necessary memory
+		// -- for each queue family (of which we'll save 1 unique queue each), store index, priority and device queue create info -----------------------------------
+
+		// "QUEUES" need to be setup BEFORE setting up the device, as queues are "CREATED ALONGSIDE THE DEVICE"
+		// for each DISTICT queue we need to create its associated VkDeviceQueueCreateInfo, 
+		// "BUT", a queue having presentation feature can be the same queue
+		// we will be using for graphics operation. Therefore we need to create a set of queue indices
+		// "IMPORTANT NOTE" TODO we might need again this set of queue indices. If that is the case, move this code
+		// TODO it can be optimized, i.e. unique indices can be built up during the creation of queueIdxArr back in setupPhysicalDevice
+		VectorTransient<uint32_t> queueUniqueIndices(std::begin(m_queueIdxArr), std::end(m_queueIdxArr));
+		std::sort(queueUniqueIndices.begin(), queueUniqueIndices.end());
+		queueUniqueIndices.erase(std::unique(queueUniqueIndices.begin(), queueUniqueIndices.end()), queueUniqueIndices.end());
+		// each queue must have a "priority", between 0.0 and 1.0. the higher the priority the more
+		// important the queue is, and such information MIGHT be used by the implementation to eg.
+		// schedule the queues, give processing time to them. Vulkan makes NO GUARANTEES
+		VectorTransient<float> queuePriorities(queueUniqueIndices.size(), 1.f);
+		
+		// -- create a VkDeviceQueueCreateInfo for each unique queue --------------------------------------------------------------------------------
+		VectorTransient<VkDeviceQueueCreateInfo> deviceQueueCreateInfos(queueUniqueIndices.size(), {
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.pNext = nullptr, // TODO ?
+			.flags = 0, // it has just the value VK_DEVICE_QUEUE_CREATE_PROTECTED_BIT, idk what is it, type is an enum called VkDeviceQueueCreateFlags
+			.queueFamilyIndex = 0,
+			.queueCount = 1, // every queue family supports at least 1 queue. For more than one, you check the Physical device queue family properties TODO
+			.pQueuePriorities = nullptr
+		});
+	
+		for (uint32_t i = 0u; i < deviceQueueCreateInfos.size(); ++i)
+		{
+			deviceQueueCreateInfos[i].queueFamilyIndex = queueUniqueIndices[i];
+			deviceQueueCreateInfos[i].pQueuePriorities = queuePriorities.data(); 
+		}
+
+		// TODO this is to refactor and move to physical device selection code. Do it by passing supported extensions to the init function and then pass them here
+		// -- Create device ------------------------------------------------------------------------------------------------------------------
+		// timeline semaphores are core in vulkan 1.2, but still a feature to enable. Frame pacing depends on them
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+			.pNext = nullptr,
+			.timelineSemaphore = VK_TRUE
+		};
+		VkDeviceCreateInfo const deviceCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+			.pNext = &timelineSemaphoreFeatures, // TODO explore extensions in future
+			.flags = 0,
+			.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCreateInfos.size()),
+			.pQueueCreateInfos = deviceQueueCreateInfos.data(), 
+			.enabledLayerCount = 0, // DEPRECATED
+			.ppEnabledLayerNames = nullptr, // DEPRECATED
+			.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+			.ppEnabledExtensionNames = deviceExtensions.data(),
+			.pEnabledFeatures = nullptr // feature specification is OPTIONAL, VkPhysicalDeviceFeatures* TODO add---------------------------------------------------------- init params
+		}; 
+
+		if (vkCreateDevice(m_phyDevice, &deviceCreateInfo, m_allocationCallbacks, &m_device) != VK_SUCCESS)
+		{
+			return APP_DEVICE_CREATION_ERR;
+		}
+
+		// TODO VK_EXT_device_memory_report, in 4.2 in vkspec
+		
+		// if anything goes wrong with the device when executing a command, it can become "lost", to query with "VK_ERROR_DEVICE_LOST", which 
+		// is a return value of some operations using the device. When a device is lost, "its child objects (anything created/allocated whose
+		// creation function has as first param the device), are not destroyed"
+		
+		m_progressStatus |= DEVICE_CREATED;
+		printf("created device!\n");
+
+		// -- store queue handles --------------------------------------------------------------------------------------------------------------
+		for (uint32_t i = 0u; i < MXC_RENDERER_QUEUES_COUNT; ++i)
+		{
+			vkGetDeviceQueue(m_device, m_queueIdx.graphics, /*queue index within the family*/0u, &m_queues[i]); // TODO change when supporting more than 1 queue within a queue family
+		}
+
+		// -- device memory sub-allocator, from now on no one calls vkAllocateMemory directly -------------------------------------------------
+		if (m_deviceAllocator.init(m_phyDevice, m_device, DeviceAllocator<AllocTemplate>::DEFAULT_BLOCK_SIZE, m_allocationCallbacks) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to initialize device memory allocator!\n");
+			return APP_DEVICE_CREATION_ERR;
+		}
+
+		// -- gpu profiler, whose slots are not tied to the swapchain so that it can be created before it --------------------------------------------
+		if (m_gpuProfiler.init(m_phyDevice, m_device, static_cast<uint32_t>(m_queueIdx.graphics),
+							   MXC_RENDERER_PROFILER_IMAGE_SLOTS + UploadManager<AllocTemplate>::BATCH_COUNT, m_allocationCallbacks) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to initialize gpu profiler!\n");
+			return APP_DEVICE_CREATION_ERR;
+		}
+
+		// -- upload manager, owning the staging memory. Uploads go through the graphics queue --------------------------------------------------
+		if (m_uploadManager.init(m_device, &m_deviceAllocator, m_queues[0], static_cast<uint32_t>(m_queueIdx.graphics)) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to initialize upload manager!\n");
+			return APP_DEVICE_CREATION_ERR;
+		}
+		m_uploadManager.setProfiler(&m_gpuProfiler, /*firstSlot*/MXC_RENDERER_PROFILER_IMAGE_SLOTS);
+
+		// -- pipeline cache, loaded from the working directory like shaders ---------------------------------------------------------------------
+		if (m_pipelineCache.init(m_phyDevice, m_device, "pipeline_cache", m_allocationCallbacks) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to initialize pipeline cache!\n");
+			return APP_DEVICE_CREATION_ERR;
+		}
+
+		return APP_SUCCESS;
+	}
+
+	// TODO refactor
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupSurfaceKHR(GLFWwindow* window) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		// setup surface
+		if (VK_SUCCESS != glfwCreateWindowSurface(m_instance, window, m_allocationCallbacks, &m_surface))
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= SURFACE_CREATED;
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::selectSurfaceFormat(VkPhysicalDevice phyDevice, VkSurfaceFormatKHR* outSurfaceFormat) const & -> bool
+	{
+		uint32_t enumerateCounter;
+		vkGetPhysicalDeviceSurfaceFormatsKHR(phyDevice, m_surface, &enumerateCounter, nullptr);
+		if (enumerateCounter == 0)
+		{
+			return false;
+		}
+
+		VectorTransient<VkSurfaceFormatKHR> surfaceFormats(enumerateCounter);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(phyDevice, m_surface, &enumerateCounter, surfaceFormats.data());
+
+		uint32_t i = 0u;
+		for (; i < surfaceFormats.size(); ++i)
+		{
+			// NOTE: format undefined, returned by vkGetPhysicalDeviceSurfaceFormatsKHR means all formats are supported under the associated color space
+			if (surfaceFormats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+				&& (surfaceFormats[i].format == VK_FORMAT_UNDEFINED || surfaceFormats[i].format == VK_FORMAT_R8G8B8A8_UNORM || surfaceFormats[i].format == VK_FORMAT_B8G8R8A8_UNORM))
+			{
+				*outSurfaceFormat = surfaceFormats[i];
+				return true;
+			}
+		}
+
+		// forceful approach
+		// return false;
+
+		// sane approach
+		*outSurfaceFormat = surfaceFormats[0];
+		return true;
+	}
+
+	// TODO for now will use composite alpha opaque
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupSwapchain(uint32_t width, uint32_t height) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		// -- get and store the surface capabilities, an intersection between the display capabilities
+		//    and the physical device capabilities regarding presentation. Needed to create a swapchain ----------------------------------------------
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_phyDevice, m_surface, &m_surfaceCapabilities);
+			
+		// -- create swapchain ----------------------------------------------------------------------------------------------------------------
+		// TODO remove hardcoded window width and height when implementing dynamic viewport
+		// m_surfaceCapabilities.currentExtent, needed for swapchain creation, can contain either 
+		// the current width and height of the surface or the special value {0xfffffffff,0xffffffff), indicating
+		// that I can choose image size, which in such case will be the window size
+		m_surfaceExtent = {
+			.width = m_surfaceCapabilities.currentExtent.width != 0xffffffff ? m_surfaceCapabilities.currentExtent.width : width,
+			.height= m_surfaceCapabilities.currentExtent.height != 0xffffffff ? m_surfaceCapabilities.currentExtent.height : height
+		};
+
+		// if the graphics and presentation queue (TODO might change as these change) belong to the 
+		// same queue family, or not. the swapchain needs to know about how many and which queue families it will
+		// deal with. TODO to refactor out when structure of family queue indices will change. in particular, if and when we decide to use more than one queue per family this has to change
+		uint32_t const queueFamilyCnt = 1u + (m_queueIdx.graphics == m_queueIdx.presentation); 
+		uint32_t const queueFamilyIndices[2] = {static_cast<uint32_t>(m_queueIdx.graphics), static_cast<uint32_t>(m_queueIdx.presentation)};
+		
+		
+		// swapchain requires we specify if the image is going to be accessed by one queue at a time (sharing mode = exclusive) or by more than one (sharing mode = concurrent).
+		// this depends on whether or not the presentation queue and the graphics queue are one and the same.
+		VkSharingMode imageSharingMode = queueFamilyCnt == 1 ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT;
+
+		VkSwapchainCreateInfoKHR const swapchainCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+			.pNext = nullptr,
+			.flags = 0u, 
+			.surface = m_surface,
+			.minImageCount = m_surfaceCapabilities.minImageCount + 1, // increment by one to allow for TRIBLE BUFFERING
+			.imageFormat = m_surfaceFormatUsed.format,
+			.imageColorSpace = m_surfaceFormatUsed.colorSpace,
+			.imageExtent = m_surfaceExtent,
+			.imageArrayLayers = 1, // number of views in a multiview surface. >1 only for stereoscopic apps, like VR
+			.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT // bitfield expressing in how many ways an image will be used. Transfer source too, if possible, for readback
+				| (m_surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT),
+			.imageSharingMode = imageSharingMode, // either EXCLUSIVE or CONCURRENT, first means that an image will be exclusive to family queues, other concurrent, we have only one graphics family queue for now TODO
+			.queueFamilyIndexCount = queueFamilyCnt,
+			.pQueueFamilyIndices = queueFamilyIndices,
+			.preTransform = m_surfaceCapabilities.currentTransform, // transform applied before presentation to image. will use current transform given by surface, which means do nothing
+			.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR, // type VkCompositeAlphaFlagBitsKHR, indicates which alpha compositing mode to use after fragment shader
+			.presentMode = m_presentModeUsed,
+			.clipped = VK_FALSE, // specifies whether to not execute fragment shader on not visible pixels due to other windows on top of the app or window partially out of display bounds (if set to VK_TRUE). NOTE TODO DO NOT SET IT TO TRUE IF YOU WILL FURTHER PROCESS THE CONTENT OF THE FRAMEBUFFER
+			.oldSwapchain = m_swapchain // special Vulkan object handle value specifying an invalid object
+		};
+
+		VkSwapchainKHR swapchain;
+		VkResult res = vkCreateSwapchainKHR(m_device, &swapchainCreateInfo, m_allocationCallbacks, &swapchain);
+		if (res != VK_SUCCESS)
+		{
+			return APP_SWAPCHAIN_CREATION_ERR;
+		}
+
+		vkDestroySwapchainKHR(m_device, m_swapchain, m_allocationCallbacks); 
+		m_swapchain = swapchain; 
+		m_progressStatus |= SWAPCHAIN_CREATED; 
+		printf("swapchain created!\n"); 
+
+		// -- get images from swapchain and create associated image views --------------------------------------------------------------------
+		{
+			uint32_t swapchainImagesCnt; 
+			vkGetSwapchainImagesKHR(m_device, m_swapchain, &swapchainImagesCnt, nullptr); 
+			assert(swapchainImagesCnt); 
+			m_swapchainImages.resize(swapchainImagesCnt); 
+			vkGetSwapchainImagesKHR(m_device, m_swapchain, &swapchainImagesCnt, m_swapchainImages.data()); 
+		}
+
+		// TODO refactor image view creation
+		m_swapchainImageViews.resize(m_swapchainImages.size()); 
+		for (uint32_t i = 0u; i < m_swapchainImageViews.size(); ++i)
+		{
+			VkImageViewCreateInfo const image_view_create_info = {
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.pNext = nullptr, // TODO what
+				.flags = 0,
+				.image = m_swapchainImages[i],
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,  // dimensionality and number of image
+				.format = m_surfaceFormatUsed.format,
+				.components = VkComponentMapping{
+					.r = VK_COMPONENT_SWIZZLE_IDENTITY, // type VkComponentSwizzle, you can remap a color channel into another or force one value
+					.g = VK_COMPONENT_SWIZZLE_IDENTITY,
+					.b = VK_COMPONENT_SWIZZLE_IDENTITY,
+					.a = VK_COMPONENT_SWIZZLE_IDENTITY
+				},
+				.subresourceRange = { // VkImageSubresourceRange selects mip levels and array elements to use
+					// which aspects of the image (color, depth, stencil, ...) are included in view
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT | VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT,
+					.baseMipLevel = 0u,
+					.levelCount = 1, // in the image created by swapchain there is 1 mipmap level
+					.baseArrayLayer = 0u, // think of photoshop layers?
+					.layerCount = 1u // in the swapchain image there are as many array layers as specified in the swapchain create info
+				}
+			};
+
+			res = vkCreateImageView(m_device, &image_view_create_info, m_allocationCallbacks, &m_swapchainImageViews[i]);
+			if (res != VK_SUCCESS)
+			{
+				return APP_GENERIC_ERR;
+			}
+		}
+		
+		m_progressStatus |= SWAPCHAIN_IMAGE_VIEWS_CREATED;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupOffscreenTargets(uint32_t width, uint32_t height) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert((m_progressStatus & DEVICE_CREATED) && m_headless);
+		m_surfaceExtent = {.width = width, .height = height};
+
+		// -- device local color images, rendered to like swapchain images and then copied out (TRANSFER_SRC) ----------------------------------------
+		uint32_t const graphicsIdx = static_cast<uint32_t>(m_queueIdx.graphics);
+		VkImageCreateInfo const colorImgCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = m_surfaceFormatUsed.format,
+			.extent = VkExtent3D{.width = width, .height = height, .depth = 1},
+			.mipLevels = 1,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 1,
+			.pQueueFamilyIndices = &graphicsIdx,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		};
+
+		m_swapchainImages.assign(MXC_RENDERER_HEADLESS_IMAGE_COUNT, VK_NULL_HANDLE);
+		m_swapchainImageViews.assign(MXC_RENDERER_HEADLESS_IMAGE_COUNT, VK_NULL_HANDLE);
+		m_offscreenImageMemory.assign(MXC_RENDERER_HEADLESS_IMAGE_COUNT, DeviceAllocation{});
+		for (uint32_t i = 0u; i < MXC_RENDERER_HEADLESS_IMAGE_COUNT; ++i)
+		{
+			if (vkCreateImage(m_device, &colorImgCreateInfo, m_allocationCallbacks, &m_swapchainImages[i]) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create offscreen color image!\n");
+				return APP_GENERIC_ERR;
+			}
+			if (m_deviceAllocator.allocateForImage(m_swapchainImages[i], VK_IMAGE_TILING_OPTIMAL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, /*preferred*/0, &m_offscreenImageMemory[i]) != APP_SUCCESS)
+			{
+				fprintf(stderr, "could not allocate device memory for offscreen color image!\n");
+				return APP_VK_ALLOCATION_ERR;
+			}
+
+			VkImageViewCreateInfo const imageViewCreateInfo {
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.image = m_swapchainImages[i],
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,
+				.format = m_surfaceFormatUsed.format,
+				.components = VkComponentMapping{
+					.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+					.g = VK_COMPONENT_SWIZZLE_IDENTITY,
+					.b = VK_COMPONENT_SWIZZLE_IDENTITY,
+					.a = VK_COMPONENT_SWIZZLE_IDENTITY
+				},
+				.subresourceRange = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.baseMipLevel = 0u,
+					.levelCount = 1,
+					.baseArrayLayer = 0u,
+					.layerCount = 1u
+				}
+			};
+			if (vkCreateImageView(m_device, &imageViewCreateInfo, m_allocationCallbacks, &m_swapchainImageViews[i]) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create offscreen color image view!\n");
+				return APP_GENERIC_ERR;
+			}
+		}
+
+		m_progressStatus |= SWAPCHAIN_IMAGE_VIEWS_CREATED;
+		printf("created %u offscreen color images %ux%u\n", MXC_RENDERER_HEADLESS_IMAGE_COUNT, width, height);
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::destroyOffscreenTargets() & -> void
+	{
+		// views are destroyed together with the swapchain ones
+		for (uint32_t i = 0u; i < m_offscreenImageMemory.size(); ++i)
+		{
+			vkDestroyImage(m_device, m_swapchainImages[i], m_allocationCallbacks);
+			m_deviceAllocator.free(m_offscreenImageMemory[i]);
+		}
+		m_offscreenImageMemory.clear();
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupCommandBuffers() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & DEVICE_CREATED && "command pools are child objects of devices, hence we need a device\n");
+
+		// -- create command buffer pool -------------------------------------------------------------------------------------------
+		VkCommandPoolCreateInfo const cmdPoolCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+				   | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, // VkCommandPoolCreateFlags, there are 3: 1)transient(for driver optimizations) i.e. short lived(for driver optimizations)  2)resettable 3)protected(uses protected memory, https://registry.khronos.org/vulkan/specs/1.2-extensions/html/chap11.html#memory-protected-memory)
+			.queueFamilyIndex = static_cast<uint32_t>(m_queueIdx.graphics), // if DEVICE_CREATED was set, then this is safe
+		};
+
+		VkResult res = vkCreateCommandPool(m_device, &cmdPoolCreateInfo, m_allocationCallbacks, &m_graphicsCmdPool);
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create a command pool for the graphics queue!\n");
+			return APP_MEMORY_ERR;
+		}
+	
+		// the secondaries need a pool each, as they are used by different threads. These and the buffers are per image, so they are recreated
+		// if the swapchain comes back with a different image count
+		if (setupImageCommandBuffers() != APP_SUCCESS)
+		{
+			return APP_VK_ALLOCATION_ERR;
+		}
+
+		m_progressStatus |= COMMAND_BUFFER_ALLOCATED;
+		printf("created command pool and allocated a resettable and transient command pool\n");
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupImageCommandBuffers() & -> status_t
+	{
+		assert(m_graphicsCmdBufs.empty() && m_secondaryCmdPools.empty() && "image command buffers allocated twice");
+
+		// -- allocate command buffers. There will be 1 command buffer for each framebuffer --------------------------------------------------------
+		VkCommandBufferAllocateInfo const graphicsCmdBufAllocInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.commandPool = m_graphicsCmdPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, // VkCommandBufferLevel, can either be PRIMARY=surface level commands, executed by queues or SECONDARY = can be called by primary/secondary command buffers, a bit like functions
+			.commandBufferCount = static_cast<uint32_t>(m_swapchainImages.size()) // cmdbuf count = framebuffer count = swapchain images count = semaphores count
+		};
+
+		m_graphicsCmdBufs.resize(m_swapchainImages.size());
+
+		VkResult res = vkAllocateCommandBuffers(m_device, &graphicsCmdBufAllocInfo, m_graphicsCmdBufs.data());
+		if (res != VK_SUCCESS)
+		{
+			m_graphicsCmdBufs.clear(); // nothing to free
+			fprintf(stderr, "failed to allocate a command buffer to the graphics command pool!\n");
+			return APP_VK_ALLOCATION_ERR;
+		}
+
+		// -- per image, per thread command pools, each with its secondary command buffer -------------------------------------------------------
+		// a pool can only be used by one thread at a time, so each recording job gets its own, and one set per image lets us reset the pools
+		// of an image while the others are in flight
+		uint32_t const jobThreadCount = m_jobSystem ? m_jobSystem->threadCount() : 1u;
+		m_recordThreadCount = std::clamp(jobThreadCount, 1u, static_cast<uint32_t>(MXC_RENDERER_MAX_RECORD_THREADS));
+		m_secondaryCmdPools.resize(m_swapchainImages.size() * m_recordThreadCount, VK_NULL_HANDLE);
+		m_secondaryCmdBufs.resize(m_secondaryCmdPools.size(), VK_NULL_HANDLE);
+		VkCommandPoolCreateInfo const secondaryCmdPoolCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0, // reset as a whole with vkResetCommandPool, cheaper than resetting each buffer
+			.queueFamilyIndex = static_cast<uint32_t>(m_queueIdx.graphics)
+		};
+		for (uint32_t i = 0; i < m_secondaryCmdPools.size(); ++i)
+		{
+			res = vkCreateCommandPool(m_device, &secondaryCmdPoolCreateInfo, m_allocationCallbacks, &m_secondaryCmdPools[i]);
+			if (res != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create a secondary command pool!\n");
+				return APP_MEMORY_ERR;
+			}
+
+			VkCommandBufferAllocateInfo const secondaryCmdBufAllocInfo {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.pNext = nullptr,
+				.commandPool = m_secondaryCmdPools[i],
+				.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+				.commandBufferCount = 1
+			};
+			res = vkAllocateCommandBuffers(m_device, &secondaryCmdBufAllocInfo, &m_secondaryCmdBufs[i]);
+			if (res != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to allocate a secondary command buffer!\n");
+				return APP_VK_ALLOCATION_ERR;
+			}
+		}
+
+		markCommandBuffersDirty();
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::destroyImageCommandBuffers() & -> void
+	{
+		// the primaries as many as were allocated, zero is not a valid count
+		if (!m_graphicsCmdBufs.empty())
+		{
+			vkFreeCommandBuffers(m_device, m_graphicsCmdPool, static_cast<uint32_t>(m_graphicsCmdBufs.size()), m_graphicsCmdBufs.data());
+		}
+		for (uint32_t i = 0; i < m_secondaryCmdPools.size(); ++i)
+		{
+			vkDestroyCommandPool(m_device, m_secondaryCmdPools[i], m_allocationCallbacks); // frees its command buffers
+		}
+		m_graphicsCmdBufs.clear();
+		m_graphicsCmdBufsDirty.clear();
+		m_secondaryCmdPools.clear();
+		m_secondaryCmdBufs.clear();
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupDepthImage() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & DEVICE_CREATED);
+
+		uint32_t graphicsIdxsUnsigned[MXC_RENDERER_GRAPHICS_QUEUES_COUNT] = {static_cast<uint32_t>(m_queueIdx.graphics)}; // TODO change, not futureproof
+
+		// create depth image
+		VkImageCreateInfo const depthImgCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,// specifies additional properties of the image. BE AWARE THAT MANY THINGS, such as 2darray, cubemap, sparce memory, multisampling, ... require a flag
+			.imageType = VK_IMAGE_TYPE_2D,// number of dimensions
+			.format = m_depthImageFormat,
+			.extent = VkExtent3D{ // same as the color attachments, set by setupSwapchain or setupOffscreenTargets
+					.width = m_surfaceExtent.width,
+					.height = m_surfaceExtent.height,
+					.depth = 1
+			},
+			.mipLevels = 1, // numbers of levels of detail 
+			.arrayLayers = 1, // numbers of layers in the image (Photoshop sense)
+			.samples = VK_SAMPLE_COUNT_1_BIT,//VkSampleCountFlagBits
+			.tiling = VK_IMAGE_TILING_OPTIMAL, // how image is laid out in memory, between optimal, linear, drm(requires extension, linux only)
+			.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE, // either exclusive or concurrent
+			.queueFamilyIndexCount = MXC_RENDERER_GRAPHICS_QUEUES_COUNT,
+			.pQueueFamilyIndices = graphicsIdxsUnsigned, // assuming device and queues have been setup
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED // the only valid ones are UNDEFINED and PREINITIALIZED. The render pass transitions it
+		};
+
+		VkResult res = vkCreateImage(m_device, &depthImgCreateInfo, m_allocationCallbacks, &m_depthImage);
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create depth image!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// create depth image view
+		// they are non dispatchable handles NOT accessed by shaders but represent a range in an image with associated metadata
+		// special values useful for creation = VK_REMAINING_ARRAY_LAYERS, VK_REMAINING_MIP_LEVELS
+		VkImageViewCreateInfo const depthImgViewCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,// there is one to specify that view will be read during fragment density stage? and one for reading the view in CPU at the end of the command buffer execution
+			.image = m_depthImage,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,// dimentionality and type of view, must be "less then or equal" to image
+			.format = m_depthImageFormat,
+			.components = VkComponentMapping{// VkComponentMapping, all swizzle identities
+				.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+				.g = VK_COMPONENT_SWIZZLE_IDENTITY,
+				.b = VK_COMPONENT_SWIZZLE_IDENTITY,
+				.a = VK_COMPONENT_SWIZZLE_IDENTITY
+			},
+			.subresourceRange = VkImageSubresourceRange{// specifies subrange accessible from view
+				.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+				.baseMipLevel = 0,
+				.levelCount = VK_REMAINING_MIP_LEVELS,
+				.baseArrayLayer = 0,
+				.layerCount = VK_REMAINING_ARRAY_LAYERS
+			}
+		};
+
+		res = vkCreateImageView(m_device, &depthImgViewCreateInfo, m_allocationCallbacks, &m_depthImageView);
+		if (res != VK_SUCCESS)
+		{
+			vkDestroyImage(m_device, m_depthImage, m_allocationCallbacks);
+			fprintf(stderr, "failed to create depth image view!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= DEPTH_IMAGE_CREATED;
+		return APP_SUCCESS;
+	}
+
+	// TODO dependant on supported exts
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::printVkResultValue(VkResult res) const & -> void
+	{
+		switch (res)
+		{
+		    case VK_SUCCESS: fprintf(stderr, "VK_SUCCESS\n"); break;
+		    case VK_NOT_READY: fprintf(stderr, "VK_NOT_READY\n"); break;
+		    case VK_TIMEOUT: fprintf(stderr, "VK_TIMEOUT\n"); break;
+		    case VK_EVENT_SET: fprintf(stderr, "VK_EVENT_SET\n"); break;
+		    case VK_EVENT_RESET: fprintf(stderr, "VK_EVENT_RESET\n"); break;
+		    case VK_INCOMPLETE: fprintf(stderr, "VK_INCOMPLETE\n"); break;
+		    case VK_ERROR_OUT_OF_HOST_MEMORY: fprintf(stderr, "VK_ERROR_OUT_OF_HOST_MEMORY\n"); break;
+		    case VK_ERROR_OUT_OF_DEVICE_MEMORY: fprintf(stderr, "VK_ERROR_OUT_OF_DEVICE_MEMORY\n"); break;
+		    case VK_ERROR_INITIALIZATION_FAILED: fprintf(stderr, "VK_ERROR_INITIALIZATION_FAILED\n"); break;
+		    case VK_ERROR_DEVICE_LOST: fprintf(stderr, "VK_ERROR_DEVICE_LOST\n"); break;
+		    case VK_ERROR_MEMORY_MAP_FAILED: fprintf(stderr, "VK_ERROR_MEMORY_MAP_FAILED\n"); break;
+		    case VK_ERROR_LAYER_NOT_PRESENT: fprintf(stderr, "VK_ERROR_LAYER_NOT_PRESENT\n"); break;
+		    case VK_ERROR_EXTENSION_NOT_PRESENT: fprintf(stderr, "VK_ERROR_EXTENSION_NOT_PRESENT\n"); break;
+		    case VK_ERROR_FEATURE_NOT_PRESENT: fprintf(stderr, "VK_ERROR_FEATURE_NOT_PRESENT\n"); break;
+		    case VK_ERROR_INCOMPATIBLE_DRIVER: fprintf(stderr, "VK_ERROR_INCOMPATIBLE_DRIVER\n"); break;
+		    case VK_ERROR_TOO_MANY_OBJECTS: fprintf(stderr, "VK_ERROR_TOO_MANY_OBJECTS\n"); break;
+		    case VK_ERROR_FORMAT_NOT_SUPPORTED: fprintf(stderr, "VK_ERROR_FORMAT_NOT_SUPPORTED\n"); break;
+		    case VK_ERROR_FRAGMENTED_POOL: fprintf(stderr, "VK_ERROR_FRAGMENTED_POOL\n"); break;
+		    case VK_ERROR_UNKNOWN: fprintf(stderr, "VK_ERROR_UNKNOWN\n"); break;
+			// provided by VK_VERSION_1_1
+		    case VK_ERROR_OUT_OF_POOL_MEMORY: fprintf(stderr, "VK_ERROR_OUT_OF_POOL_MEMORY\n"); break;
+			// provided by VK_VERSION_1_1
+		    case VK_ERROR_INVALID_EXTERNAL_HANDLE: fprintf(stderr, "VK_ERROR_INVALID_EXTERNAL_HANDLE\n"); break;
+			// provided by VK_VERSION_1_2
+		    case VK_ERROR_FRAGMENTATION: fprintf(stderr, "VK_ERROR_FRAGMENTATION\n"); break;
+			// provided by VK_VERSION_1_2
+		    case VK_ERROR_INVALID_OPAQUE_CAPTURE_ADDRESS: fprintf(stderr, "VK_ERROR_INVALID_OPAQUE_CAPTURE_ADDRESS\n"); break;
+			// provided by VK_VERSION_1_3
+		    case VK_PIPELINE_COMPILE_REQUIRED: fprintf(stderr, "VK_PIPELINE_COMPILE_REQUIRED\n"); break;
+			// provided by VK_KHR_surface
+		    case VK_ERROR_SURFACE_LOST_KHR: fprintf(stderr, "VK_ERROR_SURFACE_LOST_KHR\n"); break;
+			// provided by VK_KHR_surface
+		    case VK_ERROR_NATIVE_WINDOW_IN_USE_KHR: fprintf(stderr, "VK_ERROR_NATIVE_WINDOW_IN_USE_KHR\n"); break;
+			// provided by VK_KHR_swapchain
+		    case VK_SUBOPTIMAL_KHR: fprintf(stderr, "VK_SUBOPTIMAL_KHR\n"); break;
+			// provided by VK_KHR_swapchain
+		    case VK_ERROR_OUT_OF_DATE_KHR: fprintf(stderr, "VK_ERROR_OUT_OF_DATE_KHR\n"); break;
+			// provided by VK_KHR_display_swapchain
+		    case VK_ERROR_INCOMPATIBLE_DISPLAY_KHR: fprintf(stderr, "VK_ERROR_INCOMPATIBLE_DISPLAY_KHR\n"); break;
+			// provided by VK_EXT_debug_report
+		    case VK_ERROR_VALIDATION_FAILED_EXT: fprintf(stderr, "VK_ERROR_VALIDATION_FAILED_EXT\n"); break;
+			// provided by VK_NV_glsl_shader
+		    case VK_ERROR_INVALID_SHADER_NV: fprintf(stderr, "VK_ERROR_INVALID_SHADER_NV\n"); break;
+			// provided by VK_EXT_image_drm_format_modifier
+		    case VK_ERROR_INVALID_DRM_FORMAT_MODIFIER_PLANE_LAYOUT_EXT: fprintf(stderr, "VK_ERROR_INVALID_DRM_FORMAT_MODIFIER_PLANE_LAYOUT_EXT\n"); break;
+			// provided by VK_KHR_global_priority
+		    case VK_ERROR_NOT_PERMITTED_KHR: fprintf(stderr, "VK_ERROR_NOT_PERMITTED_KHR\n"); break;
+			// provided by VK_EXT_full_screen_exclusive
+		    case VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT: fprintf(stderr, "VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT\n"); break;
+			// provided by VK_KHR_deferred_host_operations
+			case VK_THREAD_IDLE_KHR: fprintf(stderr, "VK_THREAD_IDLE_KHR\n"); break;
+			// provided by VK_KHR_deferred_host_operations
+			case VK_THREAD_DONE_KHR: fprintf(stderr, "VK_THREAD_DONE_KHR\n"); break;
+			// provided by VK_KHR_deferred_host_operations
+			case VK_OPERATION_DEFERRED_KHR: fprintf(stderr, "VK_OPERATION_DEFERRED_KHR\n"); break;
+			// provided by VK_KHR_deferred_host_operations
+			case VK_OPERATION_NOT_DEFERRED_KHR: fprintf(stderr, "VK_OPERATION_NOT_DEFERRED_KHR\n"); break;
+			// provided by VK_EXT_image_compression_control
+		    case VK_ERROR_COMPRESSION_EXHAUSTED_EXT: fprintf(stderr, "VK_ERROR_COMPRESSION_EXHAUSTED_EXT\n"); break;
+			case VK_RESULT_MAX_ENUM: break;
+		}
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupDepthDeviceMemory() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert((m_progressStatus & (DEVICE_CREATED | DEPTH_IMAGE_CREATED)) && "VkDevice required to allocate VkDeviceMemory!\n");
+
+		// allocate and bind memory for the depth image. It lives in a block of the device allocator, next to other optimal tiling images
+		if (m_deviceAllocator.allocateForImage(m_depthImage, VK_IMAGE_TILING_OPTIMAL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, /*preferred*/0, &m_depthImageMemory) != APP_SUCCESS)
+		{
+			fprintf(stderr, "could not allocate device memory for depth image!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= DEPTH_MEMORY_ALLOCATED;
+		printf("allocated device memory for depth buffer!\n");
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupRenderPass() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		// -- create output attachment and references ------------------------------------------------------------------------------------
+		// render pass output attachment descriptions array (for the render pass, we will also need attachment references for the subpasses, which are handles decorated with some data to this array) VkAttachmentDescription const outAttachmentDescriptions[MXC_RENDERER_ATTACHMENT_COUNT] {
+		VkAttachmentDescription const outAttachmentDescriptions[] {
+			// color attachment
+			{
+				.flags = 0,// only flag is VK_ATTACHMENT_DESCRIPTION_MAY_ALIAS_BIT, which specifies that all attachments use the same device memory. I am not dealing with memory now
+				.format = m_surfaceFormatUsed.format,
+				.samples = VK_SAMPLE_COUNT_1_BIT, // VkSampleCountFlagBits, we are not using multisampling
+				.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, // how color and depth of the attachment will be modified at the beginning of the first subpass. Clear color specified when recording commands
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE, // how color and depth components of the attachments will be treated at the end of the last subpass. We want to store them to present them
+				.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE, // how stencil components of the attachments will be treated at the beginning of the first subpass. I am not using a stencil buffer now TODO
+				.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				// CANNOT BE UNDEFINED IF LOADOP IS LOAD
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,//(VkImageLayout) layout of the attachment image subresource EXPECTED when the render pass instance begins(the first subpass). RENDER PASS IS A BLUEPRINT FOR A RENDERING PROCESS, CALLED RENDER PASS INSTANCE
+				.finalLayout = m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR// layout of the attachment image subresource will be TRANSITIONED TO when the render pass instance ends(the last subpass). Headless images are meant to be copied out
+			},
+			// depth attachment
+			{
+				.flags = 0,
+			    // VK_FORMAT_D32_SFLOAT: 32-bit float for depth
+			    // VK_FORMAT_D32_SFLOAT_S8_UINT: 32-bit signed float for depth and 8 bit stencil component
+			    // VK_FORMAT_D24_UNORM_S8_UINT: 24-bit float for depth and 8 bit stencil component
+				.format = m_depthImageFormat, // no need to check for support of such a format, as the 3 of them are MANDATORY BY THE VULKAN SPECIFICATION. see setupPhysical device and TODO refactor
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, //(VkAttachmentLoadOp)
+				.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+				.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+			}
+		};
+
+		// output attachment references
+		VkAttachmentReference const outAttachmentRefs[MXC_RENDERER_ATTACHMENT_COUNT] {
+			// color attachment ref
+			{
+				.attachment = 0, // index of the attachment used as stored in the array of attachment descriptions
+				.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL// VkImageLayout, specifies the layout of the attachment used during the subpass
+			},
+			// depth attachment ref
+			{
+				.attachment = 1,
+				.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+			}
+		}; 
+
+		// subpasses creation
+		VkSubpassDescription const subpassDescriptions[] {
+			{
+				.flags = 0,// specifies usage of subpass, if it matches one of the flags. They all require extensions
+				.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,// pipeline type supported by the subpass (you could use same subpass descriptions to create multiple pipelines)
+				.inputAttachmentCount = 0, // TODO need descriptor sets. They match the input of the vertex shader written with layout(binding = n, location = 0) in ...
+				.pInputAttachments = nullptr, // type VkAttachmentReference*
+				.colorAttachmentCount = 1, // same count as resolve attachment count
+				.pColorAttachments = outAttachmentRefs, // these are outputs of the fragment shader, the layout(location = 0) out ... 
+				.pResolveAttachments = nullptr, // resolve attachments are attachments specifying in a multisampling scenario multiple samples per pixels are converted to one sample per pixel, requires VK_SUBPASS_DESCRIPTION_SHADER_RESOLVE_BIT_QCOM
+				.pDepthStencilAttachment = nullptr, //&outAttachmentRefs[1], // ALWAYS ONE IN EACH SUBPASS
+				.preserveAttachmentCount = 0, // preserve attachments are all the attachments of the render pass not used in this subpass
+				.pPreserveAttachments = nullptr
+			}
+		};
+
+		// -- subpass dependencies creation ---------------------------------------------------------------------------------------
+		// last subpass dependency, since it's from initial to final layout, it's implicit but we specify it anyway. the first is needed
+		// subpasses may execute out of order among each other, and this is a problem since the image during rendering will be manipulated in different intermediate gpu-specific formats depending on which stage of the
+		// render pass an image currently is. Therefore we require that between an image forma transition to the other the n-th subpass has finished executing in all invocations before starting with the other.
+		VkSubpassDependency subpassDependencies[] {
+			// color attachment, from VK_IMAGE_LAYOUT_UNDEFINED (coming from the swapchain) to VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL (going to the first subpass)
+			{
+				.srcSubpass = VK_SUBPASS_EXTERNAL, // it means outside of our subpasses
+				.dstSubpass = 0, // this is the index of the subpass
+				.srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // last stage that has to happen STRICTLY before the layout transition happens. bottom of pipe means the last stage of the pipeline. it means the end of the subpass external stuff
+				.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // stage that can start only AFTER the transition has been completed
+				.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT, // memory operation within the source stage that has to be completed before the layout transition can begin. we first need to read the color data coming from the swapchain, then we can convert it. this is equivalent of bitwise or'ing every read access flag
+				.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+							   //| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, // conversion has to happen before we attempt to read/write to the color output attachment
+				.dependencyFlags = 0
+				// each access mask can occur in sone particular stages (table on vkspec). So access mask can be thought of as "substages", consisting of types of memory accesses
+			},
+			// color attachment, from VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL (1st subpass) to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR (SUBPASS_EXTERNAL)
+			{
+				.srcSubpass = 0,
+				.dstSubpass = VK_SUBPASS_EXTERNAL,
+				.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // first we need to finish to output to the color attachment in the framebuffer
+				.dstStageMask = m_headless ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+							   //| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, 
+				.dstAccessMask = m_headless ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_MEMORY_READ_BIT,
+				.dependencyFlags = 0
+			},
+			// depth attachment
+			{
+				.srcSubpass = VK_SUBPASS_EXTERNAL,
+				.dstSubpass = 0,
+				.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+				.dependencyFlags = 0
+			}
+		};
+
+		// -- render pass creation --------------------------------------------------------------------------------------------------------------
+		VkRenderPassCreateInfo const renderPassCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,// there is only one flag(type VkRenderPassCreateFlagBits), which enables the use of render pass transforms, ie transforms applied to all primitives in each subpass. VK_RENDER_PASS_CREATE_TRANSFORM_BIT_QCOM
+			.attachmentCount = MXC_RENDERER_ATTACHMENT_COUNT,
+			.pAttachments = outAttachmentDescriptions,
+			.subpassCount = 1, // TODO for now we do not use subpasses
+			.pSubpasses = subpassDescriptions,
+			.dependencyCount = sizeof(subpassDependencies)/sizeof(VkSubpassDependency), // TODO 
+			.pDependencies = subpassDependencies//TODO
+		};
+		
+		printf("we created %lu subpass dependencies!\n", sizeof(subpassDependencies)/sizeof(VkSubpassDependency));
+
+		VkResult const res = vkCreateRenderPass(m_device, &renderPassCreateInfo, m_allocationCallbacks, &m_renderPass);
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create renderpass!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		printf("created renderpass!\n");
+		m_progressStatus |= RENDERPASS_CREATED;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupFramebuffers() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & RENDERPASS_CREATED);
+
+		// -- create Framebuffers -----------------------------------------------------------------------------------------------
+		m_framebuffers.resize(m_swapchainImages.size());
+
+		// The reason you need multiple presentable images is because one (or more) of them is in the process of being presented. 
+		// During that time (which could take a while), you still want the GPU to be doing stuff. Since it can’t “do stuff” to the image that’s 
+		// being presented, it would have to “do stuff” to some other image. But you’re not presenting your depth buffer, are you? 
+		// None of the above applies.the contents of the depth buffer are its own. Its contents are generated by on-GPU processes: the renderpass 
+		// load/clear operation, subpasses that use it as a depth attachment, etc. Once you’re finished generating an image with the depth buffer, 
+		// you don’t need it anymore. So that buffer can be immediately reused by another rendering process. the only potential synchronization issue 
+		// is that you have to prevent the next frame’s rendering commands from starting until the current frame’s commands have finished with the 
+		// depth buffer. And since you usually have plenty of other reasons for imposing synchronization between frames, 
+		// that synchronization should be sufficient.
+		VkImageView usedAttachments[MXC_RENDERER_ATTACHMENT_COUNT] { m_swapchainImageViews[0], m_depthImageView}; // we have 2 attachments per swapchain image, 1st is color, 2nd depth. Depth doesn't change
+
+		VkFramebufferCreateInfo framebufferCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			.pNext = nullptr, // TODO look into that
+			.flags = 0, // there is, as of now, 1 flag only, to create an "imageless" framebuffer
+			.renderPass = m_renderPass,
+			.attachmentCount = MXC_RENDERER_ATTACHMENT_COUNT,
+			.pAttachments = usedAttachments, // as it's a pointer, all I have to do to create 3 different framebuffers is to change the color output attachment in the loop
+			.width = m_surfaceExtent.width,
+			.height = m_surfaceExtent.height,
+			.layers = 1 // TODO remove hardcoded number
+		};
+
+		VkResult res;
+		for (uint32_t i = 0; i < m_framebuffers.size(); ++i)
+		{
+			res = vkCreateFramebuffer(m_device, &framebufferCreateInfo, m_allocationCallbacks, &m_framebuffers[i]);
+			if (res != VK_SUCCESS)
+			{
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					vkDestroyFramebuffer(m_device, m_framebuffers[j], m_allocationCallbacks);
+				}
+
+				fprintf(stderr, "failed to create framebuffers!\n");
+				return APP_GENERIC_ERR;
+			}
+
+			if (i + 1 < m_framebuffers.size()) // the view past the last one doesn't exist, reading it is already out of bounds
+			{
+				usedAttachments[0] = m_swapchainImageViews[i+1];
+			}
+		}
+
+		printf("%lu framebuffers created!\n", m_framebuffers.size());
+		markCommandBuffersDirty(); // recorded command buffers reference the old ones
+		m_progressStatus |= FRAMEBUFFERS_CREATED;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupVertexInput(VertexStream const& vertexInput, IndexStream const& indexInput) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & DEVICE_CREATED);
+		
+		// -- create index, vertex buffers ------------------------------------------------------------------------------------------
+		VkBufferCreateInfo const bufferCreateInfo[] {
+			{ // vertex buffer
+				.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.size = static_cast<VkDeviceSize>(vertexInput.data.size()),
+				.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+				.queueFamilyIndexCount = 1,
+				.pQueueFamilyIndices = nullptr// queueFamilyIndices WRONG! even though we have more than one queue, presentation is not involved
+			},
+			{ // index buffer
+				.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.size = static_cast<VkDeviceSize>(indexInput.data.size()),
+				.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+				.queueFamilyIndexCount = 1,
+				.pQueueFamilyIndices = nullptr
+			}
+		};
+		if (vkCreateBuffer(m_device, &bufferCreateInfo[0], m_allocationCallbacks, &m_vertexBuffer) != VK_SUCCESS
+			|| vkCreateBuffer(m_device, &bufferCreateInfo[1], m_allocationCallbacks, &m_indexBuffer) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create vertex or index buffer!\n");
+			m_progressStatus &= ~VERTEX_INPUT_BOUND;
+			return APP_GENERIC_ERR;
+		}
+		
+		// -- allocate and bind memory for the buffers -----------------------------------------------------------------------------
+		// vertex and index buffers are placed by the device allocator in a device local block
+		if (m_deviceAllocator.allocateForBuffer(m_vertexBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, /*preferred*/0, &m_vertexBufferMemory) != APP_SUCCESS
+			|| m_deviceAllocator.allocateForBuffer(m_indexBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, /*preferred*/0, &m_indexBufferMemory) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to allocate device memory for vertex or index buffer!\n");
+			m_progressStatus &= ~VERTEX_INPUT_BOUND;
+			return APP_GENERIC_ERR;
+		}
+
+		// -- upload the data through the upload manager ---------------------------------------------------------------------------
+		// both copies go in the same batch, and nobody waits for it. The batch ends with a barrier towards vertex input, and since every
+		// draw is submitted later on the same queue, it will see the data
+		if (m_uploadManager.uploadBuffer(m_vertexBuffer, /*dstOffset*/0, vertexInput.data.data(), bufferCreateInfo[0].size,
+										 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) != APP_SUCCESS
+			|| m_uploadManager.uploadBuffer(m_indexBuffer, /*dstOffset*/0, indexInput.data.data(), bufferCreateInfo[1].size,
+											VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to upload vertex input!\n");
+			m_progressStatus &= ~VERTEX_INPUT_BOUND;
+			return APP_GENERIC_ERR;
+		}
+		if (m_uploadManager.submit() == UploadManager<AllocTemplate>::INVALID_TICKET)
+		{
+			fprintf(stderr, "failed to upload vertex input!\n");
+			m_progressStatus &= ~VERTEX_INPUT_BOUND;
+			return APP_GENERIC_ERR;
+		}
+		m_vertexFormat = vertexInput.format;
+		m_indexType = indexInput.indexType();
+
+		// by default everything is drawn in one go
+		m_drawItems.assign(1, DrawItem{.indexCount = indexInput.count, .firstIndex = 0, .vertexOffset = 0});
+		
+		printf("vertex input set up!\n");
+		markCommandBuffersDirty();
+		m_progressStatus |= VERTEX_INPUT_BOUND;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupDescriptorSets(Eigen::Transform<float,3,Eigen::Affine> const& affineTransform) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & DEVICE_CREATED);
+		assert(sizeof(affineTransform.matrix()) == 16 * sizeof(float));
+
+		// a single descriptor set pointing to the uniform ring. Each frame selects its slice through a dynamic offset
+		m_descriptorSets.resize(1);
+
+		// -- create the descriptor set layout -------------------------------------------------------------------------------------------
+		m_descriptorSetLayouts.resize(1); // TODO hardcoded
+		VkDescriptorSetLayoutBinding const descriptorSetLayoutBindings[] {
+			{
+				.binding = 0, // binding number in shader ([[vk::binding(0)]]) 
+				.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // same as uniform buffer for the shader
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+				.pImmutableSamplers = nullptr // only for descriptors of the sampler type
+			}
+		};
+
+		VkDescriptorSetLayoutCreateInfo const descriptorSetLayoutCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.bindingCount = 1,
+			.pBindings = descriptorSetLayoutBindings
+		};
+		VkResult res = vkCreateDescriptorSetLayout(m_device, &descriptorSetLayoutCreateInfo, m_allocationCallbacks, &m_descriptorSetLayouts[0]); // fails only if out of memory
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to Create a descriptor set layout!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// -- create descriptor pool ---------------------------------------------------------------------------------------------------
+		VkDescriptorPoolSize const descriptorPoolSizes[] {
+			{
+				.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+				.descriptorCount = 1
+			}
+		};
+
+		VkDescriptorPoolCreateInfo const descriptorPoolCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.maxSets = static_cast<uint32_t>(m_descriptorSets.size()), // TODO extract all hard coded numbers from this function, specifies how many descriptor sets can be allocated in here
+			.poolSizeCount = 1, // the pool sizes specify the size of the pool by describing a "nominal layout", i.e. max workload layout (?)
+			.pPoolSizes = descriptorPoolSizes
+		};
+		
+		res = vkCreateDescriptorPool(m_device, &descriptorPoolCreateInfo, m_allocationCallbacks, &m_descriptorPool);
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create a descriptor pool!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// -- allocate descriptor set from descriptor pool --------------------------------------------------------------------------------
+		VectorTransient<VkDescriptorSetLayout> setLayouts(m_descriptorSets.size(), m_descriptorSetLayouts[0]);
+		
+		VkDescriptorSetAllocateInfo const descriptorSetAllocateInfo {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.descriptorPool = m_descriptorPool,
+			.descriptorSetCount = static_cast<uint32_t>(m_descriptorSets.size()),
+			.pSetLayouts = setLayouts.data() // there is a 1:1 relationship between layouts and sets, even if duplicates
+		};
+		res = vkAllocateDescriptorSets(m_device, &descriptorSetAllocateInfo, m_descriptorSets.data());
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to allocate a descriptor sets!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// -- create the uniform ring which physically holds the transform data, and point the descriptor set to it ---------------------------------
+		if (setupUniformRing(affineTransform) != APP_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		m_progressStatus |= DESCRIPTOR_SETS_SETUP;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupUniformRing(Eigen::Transform<float,3,Eigen::Affine> const& affineTransform) & -> status_t
+	{
+		m_transformDynamicOffsets.assign(m_swapchainImages.size(), 0);
+
+		// one region for each swapchain image, as there are as many frames in flight. The ring is mapped once and stays so until destruction
+		m_uniformBufferSize = sizeof(affineTransform.matrix());
+		if (m_uniformRing.init(m_phyDevice, m_device, &m_deviceAllocator, MXC_RENDERER_UNIFORM_REGION_SIZE, static_cast<uint32_t>(m_swapchainImages.size())) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to create the uniform ring!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// write the initial transform in every region, so that any frame can be recorded before its first update
+		for (uint32_t i = 0; i < m_swapchainImages.size(); ++i)
+		{
+			m_uniformRing.beginRegion(i);
+			if (m_uniformRing.push(affineTransform.data(), m_uniformBufferSize, &m_transformDynamicOffsets[i]) != APP_SUCCESS)
+			{
+				return APP_GENERIC_ERR;
+			}
+		}
+		m_uniformRing.flush();
+
+		// -- update descriptor set with the ring buffer ------------------------------------------------------------------------------------------------
+		// with a dynamic uniform buffer, offset is the base to which dynamic offsets are added, and range is the size of one slice
+		VkDescriptorBufferInfo const descriptorBufferInfo {
+			.buffer = m_uniformRing.buffer(),
+			.offset = 0,
+			.range = m_uniformBufferSize
+		};
+		
+		// structure describing the write operation we need to perform on a descriptor set
+		VkWriteDescriptorSet const descriptorWrite {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.pNext = nullptr,
+			.dstSet = m_descriptorSets[0], // destination descriptor set to update
+			.dstBinding = 0, // the binding within the descriptor set to update
+			.dstArrayElement = 0, // the first element within the binding to update. It is the number of elements in pBufferInfo (unless type is INLINE_UNIFORM_BLOCK, in which case it is the size in bytes of the block)
+			.descriptorCount = 1, // the number of descriptors in the binding from the set first array element
+			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+			.pImageInfo = nullptr, // relevant only if data comes from an image
+			.pBufferInfo = &descriptorBufferInfo,
+			.pTexelBufferView = nullptr // relevant only if data comes from a texel buffer
+		};
+		
+		// function used both to copy data from another descriptor OR to write a descriptor with fresh data either from a buffer, or from an image, or from a texel buffer
+		vkUpdateDescriptorSets(m_device, /*descriptorWriteCount*/1, &descriptorWrite, /*descriptorCopyCount*/0, /*pDescriptorCopies*/nullptr);
+
+		markCommandBuffersDirty(); // the dynamic offsets could have changed
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::updateUniformBuffer(uint32_t framebufferIdx) -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		// the region of this frame is free, as its fence has been waited on. Restarting it from the beginning gives back the same offsets
+		// every frame, so the dynamic offsets recorded in the command buffer stay valid
+		m_uniformRing.beginRegion(framebufferIdx);
+		if (m_uniformRing.push(m_transform.data(), m_uniformBufferSize, &m_transformDynamicOffsets[framebufferIdx]) != APP_SUCCESS
+			|| m_uniformRing.flush() != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to update uniform data!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupGraphicsPipeline() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(m_progressStatus & (FRAMEBUFFERS_CREATED | RENDERPASS_CREATED | VERTEX_INPUT_BOUND | DESCRIPTOR_SETS_SETUP) && "graphics pipeline creation requires a renderpass and framebuffers!\n");
+
+		// creation of all information about pipeline steps: layout, and then in order of execution
+		// -- pipeline layout TODO update when adding descriptor sets --------------------------------------------------------------------------------------------------------------
+		VkPipelineLayoutCreateInfo const graphicsPipelineLayoutCI {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0, // there is only 1 and requires an extension
+			.setLayoutCount = static_cast<uint32_t>(m_descriptorSetLayouts.size()), // TODO change, number of descriptor sets to include in the pipeline layout
+			.pSetLayouts = m_descriptorSetLayouts.data(), // TODO change, pointer to array of VkDescriptorSetLayout objects
+			.pushConstantRangeCount = 0, // TODO change, number to push constant ranges (range = a part of push constant)
+			.pPushConstantRanges = nullptr // TODO change
+		};
+
+		VkResult res = vkCreatePipelineLayout(m_device, &graphicsPipelineLayoutCI, m_allocationCallbacks, &m_graphicsPipelineLayout);
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create graphics pipeline layout!\n");
+			return APP_GENERIC_ERR;
+		}
+		printf("created graphics pipeline layout\n");
+		m_progressStatus |= GRAPHICS_PIPELINE_LAYOUT_CREATED;
+
+		// -- VkPipelineShaderStageCreateInfo describes the shaders to use in the graphics pipeline TODO number of stages hardcoded ----------------------------------------------------------------------------------------------
+		// ---- creation of the shader modules
+		// ------ evaluate file sizes
+		namespace fs = std::filesystem;
+		fs::path const relativeShaderPaths[MXC_RENDERER_SHADERS_COUNT] {"shaders/triangle.vert.spv","shaders/triangle.frag.spv"};// TODO hardcode of shaders numbers
+		fs::path const shaderPaths[MXC_RENDERER_SHADERS_COUNT] = {fs::current_path() / relativeShaderPaths[0], fs::current_path() / relativeShaderPaths[1]}; 
+		std::error_code ecs[MXC_RENDERER_SHADERS_COUNT];
+		size_t const shaderSizes[MXC_RENDERER_SHADERS_COUNT] {fs::file_size(shaderPaths[0], ecs[0]), fs::file_size(shaderPaths[1], ecs[1])}; // TODO check the error code, whose codes themselves are platform specific
+		
+		// ------ allocate char buffers to store shader binary data
+		VectorTransient<char> shadersBuf[2];
+		shadersBuf[0].resize(shaderSizes[0]);
+		shadersBuf[1].resize(shaderSizes[1]);
+		printf("current path is %s\nshader path of vertex shader: %s\nshader path of fragment shader: %s\n", fs::current_path().c_str(), shaderPaths[0].c_str(), shaderPaths[1].c_str());
+		std::ifstream shaderStreams[MXC_RENDERER_SHADERS_COUNT] {std::ifstream(shaderPaths[0]), std::ifstream(shaderPaths[1])};
+		if (!shaderStreams[0].is_open() || !shaderStreams[0].is_open())
+		{
+			fprintf(stderr, "failed to open shader files whyyyyyyyyyyyyyyyyyyyyyyyy\n");
+			return APP_GENERIC_ERR;
+		}
+		shaderStreams[0].read(shadersBuf[0].data(), shaderSizes[0]);
+		shaderStreams[1].read(shadersBuf[1].data(), shaderSizes[1]);
+
+		printf("vector sizes are %lu and %lu\n", shadersBuf[0].size(), shadersBuf[1].size());
+		assert(shadersBuf[0].size() != 0 && shadersBuf[1].size() != 0);
+
+		VkShaderModuleCreateInfo const shaderModuleCreateInfos[MXC_RENDERER_SHADERS_COUNT] {
+			{ // Vertex Shader Module Create Info
+				.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.codeSize = shaderSizes[0],
+				.pCode = reinterpret_cast<uint32_t*>(shadersBuf[0].data())
+			},
+			{ // Fragment Shader Module Create Info
+				.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.codeSize = shaderSizes[1],
+				.pCode = reinterpret_cast<uint32_t*>(shadersBuf[1].data())
+			}
+		};
+
+		VkShaderModule shaders[MXC_RENDERER_SHADERS_COUNT] = {VK_NULL_HANDLE};
+		if ( vkCreateShaderModule(m_device, &shaderModuleCreateInfos[0],m_allocationCallbacks, &shaders[0]) != VK_SUCCESS 
+			|| vkCreateShaderModule(m_device, &shaderModuleCreateInfos[1], m_allocationCallbacks, &shaders[1]) != VK_SUCCESS)
+		{
+			vkDestroyPipelineLayout(m_device, m_graphicsPipelineLayout, m_allocationCallbacks);
+			return APP_GENERIC_ERR;
+		}
+
+		// ---- creation of the information structure
+		VkPipelineShaderStageCreateInfo const graphicsPipelineShaderStageCIs[MXC_RENDERER_SHADERS_COUNT] {
+			VkPipelineShaderStageCreateInfo{ // VERTEX SHADER
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.pNext = nullptr, // TODO
+				.flags = 0, // all of the flags regard SUBGROUPS, a group of tasks running in parallel in a compute unit (warp or wavefront). Too advanced TODO future
+				.stage = VK_SHADER_STAGE_VERTEX_BIT,
+				.module = shaders[0],
+				.pName = "main",
+				.pSpecializationInfo = nullptr// sepcialization constants are a mechanism to specify in a SPIR-V module constant values at pipeline creation time, which can be modified while executing the application TODO later
+			},
+			VkPipelineShaderStageCreateInfo{ // FRAGMENT SHADER
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+				.module = shaders[1],
+				.pName = "main",
+				.pSpecializationInfo = nullptr
+			}
+		};
+
+		// -- rest of the pipeline create info -------------------------------------------------------------------------------------------------------------------------------------------------------------
+		// derived from the layout of the vertex buffer uploaded by setupVertexInput
+		VertexInputDescription const vertexInputDescription = mxc::vertexInputDescription(m_vertexFormat);
+
+		VkPipelineColorBlendAttachmentState const colorBlendAttachmentStates[] {
+			{
+				.blendEnable = VK_TRUE,
+				.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+				.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+				.colorBlendOp = VK_BLEND_OP_ADD,
+				.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+				.alphaBlendOp = VK_BLEND_OP_ADD,
+				.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT // specifies which components of the color has to be written alfter blending
+			}
+		};
+
+		VkDynamicState const dynamicStates[2] {
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		}; // TODO refactor to make it configurable
+
+		VulkanPipelineConfig graphicsPipelineConfig;
+		graphicsPipelineConfig.rasterizationStateCI.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		graphicsPipelineConfig.colorBlendStateCI.pAttachments = colorBlendAttachmentStates;
+		graphicsPipelineConfig.dynamicStateCI.dynamicStateCount = 2; // TODO make it configurable
+		graphicsPipelineConfig.dynamicStateCI.pDynamicStates = dynamicStates;
+
+		graphicsPipelineConfig.vertexInputStateCI.vertexBindingDescriptionCount = 1;
+		graphicsPipelineConfig.vertexInputStateCI.pVertexBindingDescriptions = &vertexInputDescription.binding;
+		graphicsPipelineConfig.vertexInputStateCI.vertexAttributeDescriptionCount = vertexInputDescription.attributeCount;
+		graphicsPipelineConfig.vertexInputStateCI.pVertexAttributeDescriptions = vertexInputDescription.attributes.data();
+
+		// -- finally assemble the graphics pipeline ------------------------------------------------------------------------------------------------
+		VkGraphicsPipelineCreateInfo const graphicsPipelineCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = nullptr, // TODO you have no idea how many extension structures and flags there are
+			.flags = 0,
+			.stageCount = 2, // TODO change that
+			.pStages = graphicsPipelineShaderStageCIs,
+			.pVertexInputState = &graphicsPipelineConfig.vertexInputStateCI,
+			.pInputAssemblyState = &graphicsPipelineConfig.inputAssemblyStateCI,
+			.pTessellationState = &graphicsPipelineConfig.tessellationStateCI,
+			.pViewportState = &graphicsPipelineConfig.viewportStateCI,
+			.pRasterizationState = &graphicsPipelineConfig.rasterizationStateCI,
+			.pMultisampleState = &graphicsPipelineConfig.multisampleStateCI,
+			.pDepthStencilState = &graphicsPipelineConfig.depthStencilStateCI,
+			.pColorBlendState = &graphicsPipelineConfig.colorBlendStateCI,
+			.pDynamicState = &graphicsPipelineConfig.dynamicStateCI,
+			.layout = m_graphicsPipelineLayout,
+			.renderPass = m_renderPass,
+			.subpass = 0, // subpass index in the renderpass. A pipeline will execute 1 subpass only.
+			.basePipelineHandle = VK_NULL_HANDLE, // recycle old pipeline, requires PIPELINE_DERIVATIVES flag. TODO set this up
+			.basePipelineIndex = 0 // doesn't count if basePipelineHandle is VK_NULL_HANDLE
+		};
+
+		res = vkCreateGraphicsPipelines(
+			m_device,
+			m_pipelineCache.handle(), // warm after the first run, so this is mostly a lookup
+			1, // createInfoCount
+			&graphicsPipelineCreateInfo,
+			m_allocationCallbacks,
+			&m_graphicsPipeline
+		); // TODO do not hardcode pipeline number
+
+		// -- cleanup ----------------------------------------------------------------------------------------------
+		shaderStreams[0].close();
+		shaderStreams[1].close();
+		for (uint32_t i = 0u; i < MXC_RENDERER_SHADERS_COUNT; ++i)
+			vkDestroyShaderModule(m_device, shaders[i], m_allocationCallbacks);
+		
+		markCommandBuffersDirty(); // recorded command buffers reference the old ones
+		m_progressStatus |= GRAPHICS_PIPELINE_CREATED;
+		printf("pipeline created!\n");
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupSynchronizationObjects() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert((m_progressStatus & DEVICE_CREATED) && "device is required to create synchronization primitives!\n");
+
+		// -- frame timeline, counting frames completed by the GPU. Replaces a fence for each frame ------------------------------------------------
+		VkSemaphoreTypeCreateInfo const timelineTypeCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.pNext = nullptr, // export semaphore?
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE, // binary=signaled or unsignaled or timeline=counting semaphore
+			.initialValue = m_submittedFrameCount // everything submitted so far is done
+		};
+		VkSemaphoreCreateInfo const timelineCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = static_cast<const void*>(&timelineTypeCreateInfo),
+			.flags = 0 // none for now
+		};
+		if (vkCreateSemaphore(m_device, &timelineCreateInfo, m_allocationCallbacks, &m_frameTimeline) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create frame timeline semaphore!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// -- binary semaphores, still required by the WSI. Render finished ones are per image, acquire ones per frame in flight ------------------
+		if (setupImageSemaphores() != APP_SUCCESS || setFramesInFlight(m_framesInFlight) != APP_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		printf("created frame timeline and semaphores(can acquire image from swapchain and render finished) created\n");
+		m_progressStatus |= SYNCHRONIZATION_OBJECTS_CREATED;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setAllocationCallbacks(VkAllocationCallbacks const* allocationCallbacks) & -> status_t
+	{
+		// objects must be destroyed with callbacks compatible with the ones they were created with
+		if (m_progressStatus & INSTANCE_CREATED)
+		{
+			fprintf(stderr, "allocation callbacks can only be set before the renderer is initialized\n");
+			return APP_GENERIC_ERR;
+		}
+		m_allocationCallbacks = allocationCallbacks;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setupImageSemaphores() & -> status_t
+	{
+		assert(m_semaphoreRenderFinished.empty() && "image semaphores created twice");
+		VkSemaphoreCreateInfo const semaphoreCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = nullptr, // binary by default
+			.flags = 0 // none for now
+		};
+		m_semaphoreRenderFinished.resize(m_swapchainImages.size(), VK_NULL_HANDLE);
+		for (uint32_t i = 0u; i < m_semaphoreRenderFinished.size(); ++i)
+		{
+			if (vkCreateSemaphore(m_device, &semaphoreCreateInfo, m_allocationCallbacks, &m_semaphoreRenderFinished[i]) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create synchronization primitives!\n");
+				return APP_GENERIC_ERR; // what was created is destroyed by the destructor
+			}
+		}
+		// no frame rendered to any image yet, or the device is idle, so waiting on any of them returns at once
+		m_imageTimelineValue.assign(m_swapchainImages.size(), 0);
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::destroyImageSemaphores() & -> void
+	{
+		for (VkSemaphore semaphore : m_semaphoreRenderFinished)
+		{
+			vkDestroySemaphore(m_device, semaphore, m_allocationCallbacks);
+		}
+		m_semaphoreRenderFinished.clear();
+		m_imageTimelineValue.clear();
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::setFramesInFlight(uint32_t framesInFlight) & -> status_t
+	{
+		assert(framesInFlight != 0 && "at least one frame has to be in flight");
+		if (m_frameTimeline == VK_NULL_HANDLE)
+		{
+			m_framesInFlight = framesInFlight; // applied by setupSynchronizationObjects
+			return APP_SUCCESS;
+		}
+
+		// acquire semaphores can be destroyed only when no pending operation uses them
+		waitFrameTimeline(m_submittedFrameCount);
+		for (VkSemaphore semaphore : m_semaphoreImageAvailable)
+		{
+			vkDestroySemaphore(m_device, semaphore, m_allocationCallbacks);
+		}
+
+		m_framesInFlight = framesInFlight;
+		m_semaphoreImageAvailable.assign(m_framesInFlight, VK_NULL_HANDLE);
+		VkSemaphoreCreateInfo const semaphoreCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0
+		};
+		for (uint32_t i = 0u; i < m_framesInFlight; ++i)
+		{
+			if (vkCreateSemaphore(m_device, &semaphoreCreateInfo, m_allocationCallbacks, &m_semaphoreImageAvailable[i]) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create image available semaphores!\n");
+				return APP_GENERIC_ERR;
+			}
+		}
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::waitFrameTimeline(uint64_t value) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		VkSemaphoreWaitInfo const waitInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.pNext = nullptr,
+			.flags = 0, // wait all, irrelevant with a single semaphore
+			.semaphoreCount = 1,
+			.pSemaphores = &m_frameTimeline,
+			.pValues = &value
+		};
+		// returns immediately if the value was already reached, as it happens with 0
+		return vkWaitSemaphores(m_device, &waitInfo, /*timeout*/0xffffffffffffffff) == VK_SUCCESS ? APP_SUCCESS : APP_GENERIC_ERR;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::recordDraws(VkCommandBuffer cmdBuf, uint32_t framebufferIdx, std::span<DrawItem const> drawItems) & -> void
+	{
+		// bind graphics pipeline to render pass
+		vkCmdBindPipeline(cmdBuf, /*VkPipelineBindPoint*/VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline); // bind point = type of pipeline to bind
+
+		// bind vertex and index buffers
+		VkBuffer const vertexBuffers[] {m_vertexBuffer};
+		VkDeviceSize const offsets[] {0}; // offset from beginning to buffer, from which vulkan will bind
+		vkCmdBindVertexBuffers(cmdBuf, 0/*first binding*/, 1/*binding count*/, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(cmdBuf, m_indexBuffer, /*offset*/0, m_indexType);
+
+		// TODO we didn't specify viewport and scissor to be dynamic for now, so no need to vkCmdSet them, but I'll come back
+		VkViewport const viewport {
+			.x = 0.f,// x,y define the upper-left corner of the viewport in screen coordinates. x,y must be >= viewportBoundsRange[0], x+width,y+height <= viewportBoundsRange[1]. they are VkPhysicalDeviceLimits
+			.y = 0.f,
+			.width = static_cast<float>(m_surfaceExtent.width), // width, height are the viewport's width and height. MUST BE LESS THAN the maximum specified in the device limits(in the device properties) // TODO setup checks TODO TODO important
+			.height = static_cast<float>(m_surfaceExtent.height),
+			.minDepth = 0.f, // viewport's width and height. min can be bigger than max (what even is the result then?), for values out of the range [0.f,1.f], you need extension depth_range_unrestricted
+			.maxDepth = 1.f
+		};
+
+		VkRect2D const scissor {
+			.offset = {0, 0}, // VkOffset type, has 2 SIGNED integers
+			.extent = m_surfaceExtent // VkExtent type, has 2 UNSIGNED integers
+		};
+		vkCmdSetViewport(cmdBuf, 0/*1st viewport*/, 1/*viewport count*/, &viewport);
+		vkCmdSetScissor(cmdBuf, 0/*1st scissor*/, 1/*scissor count*/, &scissor);
+
+		// bind descriptor sets
+		vkCmdBindDescriptorSets(
+			cmdBuf, 
+			VK_PIPELINE_BIND_POINT_GRAPHICS, // pipeline bind point. tells vulkan the type of the pipeline that will use the descriptor set
+			m_graphicsPipelineLayout, 
+			0, // first set number. You can bind descriptor sets to arbitrary numbers
+			1, // set count
+			&m_descriptorSets[0], 
+			1, // dynamicOffsetcount and dynamicOffsets pointer. If any of the sets being bound has at least 1 descriptor of type UNIFORM_DYNAMIC, then offsetCount = number of such descriptors being bound, and each of the offsets will be used to access buffer 
+			&m_transformDynamicOffsets[framebufferIdx]);
+	
+		// draw commands
+		// vkCmdDraw(cmdBuf, /*vertexCount*/3, /*instance count*/1, /*firstVertexID*/0, /*firstInstanceID*/0); // vertex count == how many times to call the vertex shader != how many vertices we have stored in a buffer, instance count == number of times to draw the same primitives
+		for (DrawItem const& drawItem : drawItems)
+		{
+			vkCmdDrawIndexed(cmdBuf, drawItem.indexCount, /*instanceCount*/1, drawItem.firstIndex, drawItem.vertexOffset, /*firstInstance*/0);
+		}
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::recordSecondary(uint32_t framebufferIdx, uint32_t threadIdx, std::span<DrawItem const> drawItems) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		NoHeapScope const noHeap; // on a worker thread, which has no arena
+		// pools are per image and per thread, so no other thread touches this one, and only command buffers of this image, which is not in flight, are reset
+		uint32_t const poolIdx = framebufferIdx * m_recordThreadCount + threadIdx;
+		if (vkResetCommandPool(m_device, m_secondaryCmdPools[poolIdx], /*flags*/0) != VK_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		// secondary command buffers executed inside a render pass inherit it, and must declare it (the framebuffer is optional, but helps some drivers)
+		VkCommandBufferInheritanceInfo const inheritanceInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.pNext = nullptr,
+			.renderPass = m_renderPass,
+			.subpass = 0,
+			.framebuffer = m_framebuffers[framebufferIdx],
+			.occlusionQueryEnable = VK_FALSE,
+			.queryFlags = 0,
+			.pipelineStatistics = 0
+		};
+		VkCommandBufferBeginInfo const cmdBufBeginInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr,
+			.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, // the whole secondary command buffer is inside a render pass
+			.pInheritanceInfo = &inheritanceInfo
+		};
+
+		VkCommandBuffer const cmdBuf = m_secondaryCmdBufs[poolIdx];
+		vkBeginCommandBuffer(cmdBuf, &cmdBufBeginInfo);
+		recordDraws(cmdBuf, framebufferIdx, drawItems);
+		return vkEndCommandBuffer(cmdBuf) == VK_SUCCESS ? APP_SUCCESS : APP_GENERIC_ERR;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::recordCommands(uint32_t framebufferIdx) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		assert(framebufferIdx < m_swapchainImages.size() && "framebuffer index out of bounds");
+		assert((m_progressStatus & (GRAPHICS_PIPELINE_CREATED | COMMAND_BUFFER_ALLOCATED)) && "command buffer recording requires a pipeline and a command buffer!\n");
+
+		// few draws are recorded inline, as spreading them on threads would cost more than recording them. Otherwise the draws are split in
+		// m_recordThreadCount contiguous chunks, each recorded in a secondary command buffer by its thread, which selects their LODs and culls
+		// their meshlets too
+		bool const useSecondaries = m_recordThreadCount > 1 && m_drawItems.size() >= MXC_RENDERER_SECONDARY_RECORDING_THRESHOLD;
+		uint64_t recordedIndexCount = 0;
+		auto const countIndices = [](std::span<DrawItem const> drawItems) {
+			uint64_t count = 0;
+			for (DrawItem const& drawItem : drawItems)
+			{
+				count += drawItem.indexCount;
+			}
+			return count;
+		};
+		if (useSecondaries)
+		{
+			uint32_t const drawCount = static_cast<uint32_t>(m_drawItems.size());
+			VectorTransient<uint64_t> indexCounts(m_recordThreadCount, 0);
+			auto const recordChunk = [this, framebufferIdx, drawCount, &indexCounts, &countIndices](uint32_t threadIdx) -> status_t {
+				uint32_t const first = static_cast<uint32_t>(uint64_t{drawCount} * threadIdx / m_recordThreadCount);
+				uint32_t const last = static_cast<uint32_t>(uint64_t{drawCount} * (threadIdx + 1) / m_recordThreadCount);
+				std::span<DrawItem const> const drawItems = selectDraws(first, last);
+				indexCounts[threadIdx] = countIndices(drawItems);
+				return recordSecondary(framebufferIdx, threadIdx, drawItems);
+			};
+
+			// one job per chunk. This thread records a chunk too, and then helps with the others until all are done
+			VectorTransient<status_t> results(m_recordThreadCount, APP_SUCCESS);
+			m_jobSystem->parallel_for(m_recordThreadCount, /*grainSize*/1, [&results, &recordChunk](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					results[i] = recordChunk(i);
+				}
+			});
+			if (std::any_of(results.begin(), results.end(), [](status_t status) { return status != APP_SUCCESS; }))
+			{
+				fprintf(stderr, "failed to record secondary command buffers!\n");
+				return APP_GENERIC_ERR;
+			}
+			for (uint64_t count : indexCounts)
+			{
+				recordedIndexCount += count;
+			}
+		}
+
+		// should be called begin RECORDING, we are not executing any command here
+		VkCommandBufferBeginInfo const cmdBufBeginInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr, // can be pointer to vkgroupcommandbufferbegininfo if you setup a device group
+			.flags = 0,// recorded once and submitted many times. we have 3: one time submit = buffer will be reset after first use, render pass continue = for secondary cmd bufs only, specifies that this 2ndary cmd buf is entirely in renderpass, simultaneous use = allows to resubmit buffer to a queue while it is in the pending state, aka not finished
+			.pInheritanceInfo = nullptr // used if this is a secondary buffer, defines the state that the secondary buffer will inherit from primary command buffer (render pass, subpass, framebuffer, and pipeline statistics)
+		};
+		VkClearValue const clearValues[] {
+			// color attachment
+			{.color = VkClearColorValue{0.3f, 0.3f, 0.3f, 1.f}},
+			// depth attachment
+			{.depthStencil = VkClearDepthStencilValue{.depth = 0.f, .stencil = 0u}} // stencil value ignored
+		};
+		VkRenderPassBeginInfo const renderPassBeginInfo {
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			.pNext = nullptr, // can be stuff for device groups
+			.renderPass = m_renderPass,
+			.framebuffer = m_framebuffers[framebufferIdx],
+			.renderArea = VkRect2D{VkOffset2D{0,0}, m_surfaceExtent},
+			.clearValueCount = 2u, // array of clear colors, used if in the subpass the loadOp and/or stencilLoadOp was specified as VK_ATTACHMENT_LOAD_OP_CLEAR, there is one clear color for each attachment, AND THE ARRAY IS INDEXED BY THE ATTACHMENT NUMBER, so there can be holes
+			.pClearValues = clearValues // using clear values for color attachment and depth attachment, to clear buffer values in the command buffer use vkCmdFillBuffer
+		};
+
+		VkCommandBuffer const cmdBuf = m_graphicsCmdBufs[framebufferIdx];
+		vkBeginCommandBuffer(cmdBuf, &cmdBufBeginInfo);
+		m_gpuProfiler.beginFrame(cmdBuf, framebufferIdx); // images past MXC_RENDERER_PROFILER_IMAGE_SLOTS are simply not profiled
+		{
+			// timestamps can't be written in a subpass whose contents are secondary command buffers, so the scope wraps the whole render pass
+			GpuProfiler::Scope const renderPassScope(&m_gpuProfiler, cmdBuf, framebufferIdx, "render pass");
+			// inline = no secondary buffers are executed in each subpass, while secondary means that subpass is recorded in a secondary command buffer
+			vkCmdBeginRenderPass(cmdBuf, &renderPassBeginInfo, useSecondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+			if (useSecondaries)
+			{
+				vkCmdExecuteCommands(cmdBuf, m_recordThreadCount, &m_secondaryCmdBufs[framebufferIdx * m_recordThreadCount]);
+			}
+			else
+			{
+				std::span<DrawItem const> const drawItems = selectDraws(0, static_cast<uint32_t>(m_drawItems.size()));
+				recordedIndexCount = countIndices(drawItems);
+				recordDraws(cmdBuf, framebufferIdx, drawItems);
+			}
+			vkCmdEndRenderPass(cmdBuf);
+		}
+		VkResult const res = vkEndCommandBuffer(cmdBuf);
+		if (res != VK_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		m_recordedIndexCount = recordedIndexCount;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate> auto Renderer<AllocTemplate>::draw() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		LinearArena::Scope const frameScope(&m_transientArena); // per frame temporaries, reset in O(1) on return
+		VkResult res;
+
+		// recycle the staging memory of the uploads which are done, never blocks
+		m_uploadManager.poll();
+
+		// hand over captured frames the GPU is done with, never blocks
+		if (m_frameReadback.isInitialized())
+		{
+			uint64_t completedFrame = 0;
+			vkGetSemaphoreCounterValue(m_device, m_frameTimeline, &completedFrame);
+			m_frameReadback.poll(completedFrame);
+		}
+
+		// wait for frame (this - m_framesInFlight) to finish, as otherwise we would continue to submit command buffers indefinitely without knowing if the GPU is keeping up.
+		// Its acquire semaphore slot is then free again
+		uint64_t const frameValue = m_submittedFrameCount + 1;
+		uint32_t const frameSlot = static_cast<uint32_t>(frameValue % m_framesInFlight);
+		if (frameValue > m_framesInFlight && waitFrameTimeline(frameValue - m_framesInFlight) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed waiting on the frame timeline!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// then acquire next available image from the swapchain. To be safe that it is not being presented, we will wait on semaphoreImageAvailable.
+		// Headless, offscreen images are just used round robin, over the per image state, which resize keeps at the image count
+		assert(m_imageTimelineValue.size() == m_swapchainImages.size() && m_semaphoreRenderFinished.size() == m_swapchainImages.size()
+			&& m_graphicsCmdBufs.size() == m_swapchainImages.size() && "per image state out of sync with the swapchain");
+		uint32_t imageIdx = static_cast<uint32_t>(frameValue % m_imageTimelineValue.size());
+		res = m_headless ? VK_SUCCESS : vkAcquireNextImageKHR(m_device, m_swapchain, /*timeout in ns*/0xffffffffffffffff, m_semaphoreImageAvailable[frameSlot], /*fenceToSignal*/VK_NULL_HANDLE, &imageIdx);
+		// if the window is resized while the device is not idle, we need to catch here that the surface is not anymore compatible with our swapchain, and recreate it, together with framebuffers, images and pipeline
+		if (res == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			fprintf(stderr, "Houston, we have a problem\n");
+			return APP_REQUIRES_RESIZE_ERR;
+		}
+
+		// command buffer, framebuffer and uniform region are per image, and images can be acquired out of order, so the image could still be used
+		// by a frame other than the one we just waited for
+		if (waitFrameTimeline(m_imageTimelineValue[imageIdx]) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed waiting on the frame timeline!\n");
+			return APP_GENERIC_ERR;
+		}
+		m_imageTimelineValue[imageIdx] = frameValue;
+		m_gpuProfiler.collect(imageIdx); // timestamps of the previous frame on this image, which just completed
+		
+		// TODO move updateUniformBuffer to be handled by events
+		if (updateUniformBuffer(imageIdx) != APP_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		// the command buffer of this image is re-recorded only if something it references changed since its last recording
+		if (m_graphicsCmdBufsDirty[imageIdx])
+		{
+			NoHeapScope const noHeap; // recording allocates only from the frame arena, asserted in debug builds
+			if (vkResetCommandBuffer(m_graphicsCmdBufs[imageIdx], /*reset flags*/0) != VK_SUCCESS // only reset flag for now is "release all resources"
+				|| recordCommands(imageIdx) != APP_SUCCESS)
+			{
+				fprintf(stderr, "couldn't record command buffer!\n");
+				return APP_GENERIC_ERR;
+			}
+			m_graphicsCmdBufsDirty[imageIdx] = false;
+			++m_cmdBufRecordCount;
+		}
+
+		// the copy for the readback, if any, is executed right after the frame, in the same submission
+		VkCommandBuffer cmdBufs[] { m_graphicsCmdBufs[imageIdx], VK_NULL_HANDLE };
+		uint32_t cmdBufCount = 1;
+		if (m_frameReadback.isInitialized())
+		{
+			VkImageLayout const colorLayout = m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // render pass finalLayout
+			cmdBufs[1] = m_frameReadback.record(m_swapchainImages[imageIdx], colorLayout, m_surfaceExtent, m_surfaceFormatUsed.format, frameValue);
+			cmdBufCount += cmdBufs[1] != VK_NULL_HANDLE;
+		}
+
+		VkPipelineStageFlags const pipelineSemaphoreStageFlags[] {
+			// VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT  -- we are not waiting till all execution of all stages before fragment shader are executed, BUT we are waiting only on the availability of the image to present to
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+		};
+		// the render finished semaphore is waited on to present the image to the screen, the timeline tells the CPU this frame is done.
+		// Headless there's nothing to acquire nor present, so only the timeline is used
+		VkSemaphore const signalSemaphores[] { m_frameTimeline, m_semaphoreRenderFinished[imageIdx] };
+		uint64_t const signalValues[] { frameValue, 0 }; // values of binary semaphores are ignored
+		uint32_t const binarySemaphoreCount = m_headless ? 0u : 1u;
+		uint64_t const waitValue = 0;
+		VkTimelineSemaphoreSubmitInfo const timelineSubmitInfo {
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.pNext = nullptr,
+			.waitSemaphoreValueCount = binarySemaphoreCount,
+			.pWaitSemaphoreValues = &waitValue,
+			.signalSemaphoreValueCount = 1 + binarySemaphoreCount,
+			.pSignalSemaphoreValues = signalValues
+		};
+		VkSubmitInfo const submitInfo {
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = &timelineSubmitInfo, // there is stuff for timeline semaphores, protected submit
+			.waitSemaphoreCount = binarySemaphoreCount,
+			.pWaitSemaphores = &m_semaphoreImageAvailable[frameSlot],
+			.pWaitDstStageMask = pipelineSemaphoreStageFlags, // where in the pipeline the semaphore has to be waited on
+			.commandBufferCount = cmdBufCount,
+			.pCommandBuffers = cmdBufs,
+			.signalSemaphoreCount = 1 + binarySemaphoreCount,
+			.pSignalSemaphores = signalSemaphores
+		};
+
+		res = vkQueueSubmit(m_queues[0], /*submitCount*/1, &submitInfo, /*fenceToSignal*/VK_NULL_HANDLE);
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed submitting draw operation!\n");
+			printVkResultValue(res);
+			return APP_GENERIC_ERR;
+		}
+		m_submittedFrameCount = frameValue;
+		m_gpuProfiler.markSubmitted(imageIdx);
+
+		if (m_headless)
+		{
+			++m_frameCount;
+			return APP_SUCCESS;
+		}
+
+		// once drawing is completed, we can present the image
+		VkPresentInfoKHR const presentInfo {
+			.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+			.pNext = nullptr,
+			.waitSemaphoreCount = 1,
+			.pWaitSemaphores = &m_semaphoreRenderFinished[imageIdx],
+			.swapchainCount = 1,
+			.pSwapchains = &m_swapchain,
+			.pImageIndices = &imageIdx,
+			.pResults = nullptr // pointer to an array containing swapchainCount results, indicating outcome of each presentation operation
+		};
+		
+		res = vkQueuePresentKHR(m_queues[0], &presentInfo);
+		if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) // TODO lacks if window was resized
+		{
+			fprintf(stderr, "Houston, we have a problem\n");
+			return APP_REQUIRES_RESIZE_ERR;
+		}
+		if (res != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to present image!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		++m_frameCount;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::setDrawItems(std::span<DrawItem const> drawItems) & -> void
+	{
+		m_drawItems.assign(drawItems.begin(), drawItems.end());
+		m_lodChains.clear(); // they belong to the previous draw items
+		m_lods.clear();
+		m_meshletRanges.clear();
+		m_meshlets.clear();
+		m_meshletBounds.clear();
+		updateDrawSlots();
+		markCommandBuffersDirty();
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::setLods(std::span<LodChain const> lodChains, std::span<MeshLod const> lods, float maxErrorPixels) & -> status_t
+	{
+		if (!lodChains.empty() && lodChains.size() != m_drawItems.size())
+		{
+			fprintf(stderr, "%lu LOD chains for %lu draw items!\n", static_cast<unsigned long>(lodChains.size()), static_cast<unsigned long>(m_drawItems.size()));
+			return APP_GENERIC_ERR;
+		}
+		m_lodChains.assign(lodChains.begin(), lodChains.end());
+		m_lods.assign(lods.begin(), lods.end());
+		m_lodMaxErrorPixels = maxErrorPixels;
+		updateDrawSlots();
+		markCommandBuffersDirty();
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::setMeshlets(std::span<MeshletRange const> meshletRanges, std::span<Meshlet const> meshlets, std::span<MeshletBounds4 const> meshletBounds) & -> status_t
+	{
+		if ((!meshletRanges.empty() && meshletRanges.size() != m_drawItems.size()) || meshletBounds.size() != (meshlets.size() + 3) / 4)
+		{
+			fprintf(stderr, "%lu meshlet ranges for %lu draw items!\n", static_cast<unsigned long>(meshletRanges.size()), static_cast<unsigned long>(m_drawItems.size()));
+			return APP_GENERIC_ERR;
+		}
+		for (MeshletRange const& range : meshletRanges)
+		{
+			if (range.firstMeshlet > meshlets.size() || range.meshletCount > meshlets.size() - range.firstMeshlet)
+			{
+				fprintf(stderr, "meshlet range outside of the meshlets!\n");
+				return APP_GENERIC_ERR;
+			}
+		}
+		m_meshletRanges.assign(meshletRanges.begin(), meshletRanges.end());
+		m_meshlets.assign(meshlets.begin(), meshlets.end());
+		m_meshletBounds.assign(meshletBounds.begin(), meshletBounds.end());
+		m_meshletVisible.resize(meshlets.size());
+		updateDrawSlots();
+		markCommandBuffersDirty();
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::setTransform(Eigen::Transform<float,3,Eigen::Affine> const& affineTransform) & -> void
+	{
+		m_transform = affineTransform * m_dequantization; // pushed to the uniform ring every frame
+		m_objectTransform = affineTransform;
+		if (!m_lodChains.empty() || !m_meshletRanges.empty())
+		{
+			markCommandBuffersDirty();
+		}
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::updateDrawSlots() & -> void
+	{
+		m_drawSlotOffsets.resize(m_drawItems.size() + 1);
+		m_drawSlotOffsets[0] = 0;
+		for (uint32_t i = 0; i < m_drawItems.size(); ++i)
+		{
+			m_drawSlotOffsets[i + 1] = m_drawSlotOffsets[i] + (m_meshletRanges.empty() ? 1 : std::max(m_meshletRanges[i].meshletCount, 1u));
+		}
+		m_selectedDrawItems.resize(m_drawSlotOffsets.back());
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::selectDraws(uint32_t first, uint32_t last) & -> std::span<DrawItem const>
+	{
+		if (m_lodChains.empty() && m_meshletRanges.empty())
+		{
+			return std::span<DrawItem const>(m_drawItems.data() + first, last - first);
+		}
+		Eigen::Matrix4f const objectToClip = m_objectTransform.matrix();
+		LodProjection const projection = lodProjection(objectToClip, static_cast<float>(m_surfaceExtent.width), static_cast<float>(m_surfaceExtent.height));
+		std::span<MeshLod const> const lods(m_lods.data(), m_lods.size());
+		MeshletCuller const culler = meshletCuller(objectToClip);
+		std::span<MeshletBounds4 const> const meshletBounds(m_meshletBounds.data(), m_meshletBounds.size());
+
+		// compacted from the first slot of the range, each DrawItem has enough of them for all of its meshlets
+		uint32_t const firstSlot = m_drawSlotOffsets[first];
+		uint32_t slot = firstSlot;
+		for (uint32_t i = first; i < last; ++i)
+		{
+			DrawItem const& drawItem = m_drawItems[i];
+			DrawItem const selected = m_lodChains.empty() ? drawItem : selectLod(drawItem, m_lodChains[i], lods, projection, m_lodMaxErrorPixels);
+			MeshletRange const range = m_meshletRanges.empty() ? MeshletRange{.firstMeshlet = 0, .meshletCount = 0} : m_meshletRanges[i];
+			if (range.meshletCount == 0 || selected.firstIndex != drawItem.firstIndex) // meshlets are of the full detail level only
+			{
+				m_selectedDrawItems[slot++] = selected;
+				continue;
+			}
+
+			cullMeshlets(meshletBounds, range.firstMeshlet, range.firstMeshlet + range.meshletCount, culler, m_meshletVisible.data());
+			uint32_t const itemSlot = slot;
+			for (uint32_t m = range.firstMeshlet; m < range.firstMeshlet + range.meshletCount; ++m)
+			{
+				if (!m_meshletVisible[m])
+				{
+					continue;
+				}
+				Meshlet const& meshlet = m_meshlets[m];
+				DrawItem* const previous = slot > itemSlot ? &m_selectedDrawItems[slot - 1] : nullptr;
+				if (previous && previous->firstIndex + previous->indexCount == meshlet.firstIndex)
+				{
+					previous->indexCount += meshlet.indexCount;
+				}
+				else
+				{
+					m_selectedDrawItems[slot++] = DrawItem{.indexCount = meshlet.indexCount, .firstIndex = meshlet.firstIndex, .vertexOffset = drawItem.vertexOffset};
+				}
+			}
+		}
+		return std::span<DrawItem const>(m_selectedDrawItems.data() + firstSlot, slot - firstSlot);
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::enableReadback(ReadbackCallback callback, void* userData, uint32_t slotCount) & -> status_t
+	{
+		assert((m_progressStatus & INITIALIZED) && "readback requires an initialized renderer");
+		if (m_frameReadback.isInitialized())
+		{
+			return APP_SUCCESS;
+		}
+
+		// the copy assumes 4 bytes per pixel, and swapchain images have to be usable as transfer source
+		VkFormat const format = m_surfaceFormatUsed.format;
+		if (format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_R8G8B8A8_SRGB && format != VK_FORMAT_B8G8R8A8_UNORM && format != VK_FORMAT_B8G8R8A8_SRGB)
+		{
+			fprintf(stderr, "readback not supported for color format %d!\n", static_cast<int32_t>(format));
+			return APP_GENERIC_ERR;
+		}
+		if (!m_headless && !(m_surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+		{
+			fprintf(stderr, "swapchain images cannot be copied from, readback not supported!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		return m_frameReadback.init(m_device, &m_deviceAllocator, static_cast<uint32_t>(m_queueIdx.graphics), m_jobSystem, slotCount, callback, userData);
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::markCommandBuffersDirty() & -> void
+	{
+		m_graphicsCmdBufsDirty.assign(m_graphicsCmdBufs.size(), true);
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::resize(uint32_t width, uint32_t height) & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		LinearArena::Scope const resizeScope(&m_transientArena);
+		vkDeviceWaitIdle(m_device);
+
+		// only extent dependent objects are recreated. Viewport and scissor are dynamic state, so the pipeline survives, unless the surface
+		// format changed (eg. window moved to a monitor with a different format), as the render pass and with it the pipeline depend on it
+		VkSurfaceFormatKHR surfaceFormat = m_surfaceFormatUsed;
+		if (!m_headless)
+		{
+			selectSurfaceFormat(m_phyDevice, &surfaceFormat);
+		}
+		bool const formatChanged = surfaceFormat.format != m_surfaceFormatUsed.format || surfaceFormat.colorSpace != m_surfaceFormatUsed.colorSpace;
+		if (formatChanged)
+		{
+			printf("surface format changed, recreating render pass and pipeline\n");
+			m_surfaceFormatUsed = surfaceFormat;
+			vkDestroyPipeline(m_device, m_graphicsPipeline, m_allocationCallbacks);
+			vkDestroyPipelineLayout(m_device, m_graphicsPipelineLayout, m_allocationCallbacks);
+			vkDestroyRenderPass(m_device, m_renderPass, m_allocationCallbacks);
+		}
+
+		for (uint32_t i = 0; i < m_framebuffers.size(); ++i)
+		{
+			vkDestroyFramebuffer(m_device, m_framebuffers[i], m_allocationCallbacks);
+		}
+		
+		// destroy depth buffer
+		vkDestroyImageView(m_device, m_depthImageView, m_allocationCallbacks);
+		vkDestroyImage(m_device, m_depthImage, m_allocationCallbacks);
+		m_deviceAllocator.free(m_depthImageMemory); // the block stays around, so the new depth image will likely land in the same place
+
+		// command buffers are kept, and re-recorded at their next use as the framebuffers and the pipeline change. Unless the new swapchain
+		// has a different image count, in which case everything per image is rebuilt
+		for (uint32_t i = 0u; i < m_swapchainImageViews.size(); ++i)
+		{
+			vkDestroyImageView(m_device, m_swapchainImageViews[i], m_allocationCallbacks);
+		}
+		destroyOffscreenTargets();
+		size_t const oldImageCount = m_swapchainImages.size();
+
+		if ((m_headless ? setupOffscreenTargets(width, height) : setupSwapchain(width, height))
+			|| (m_swapchainImages.size() != oldImageCount && resizeImageState())
+			|| (formatChanged && setupRenderPass())
+			|| setupDepthImage()
+			|| setupDepthDeviceMemory()
+			|| setupFramebuffers()
+			|| (formatChanged && setupGraphicsPipeline()))
+		{
+			fprintf(stderr, "failed to recreate swapchain dependent objects!\n");
+			return APP_SWAPCHAIN_CREATION_ERR;
+		}
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::resizeImageState() & -> status_t
+	{
+		MXC_TRACE_FUNCTION();
+		printf("swapchain image count changed to %u, recreating per image state\n", static_cast<uint32_t>(m_swapchainImages.size()));
+		// the device is idle, so no region of the ring, command buffer or semaphore is in use
+		destroyImageCommandBuffers();
+		m_uniformRing.destroy();
+		destroyImageSemaphores();
+		if (setupImageCommandBuffers() != APP_SUCCESS || setupUniformRing(m_transform) != APP_SUCCESS || setupImageSemaphores() != APP_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto Renderer<AllocTemplate>::progress_incomplete() const & -> status_t 
+	{
+		// headless has neither surface nor swapchain
+		status_t const notRequired = m_headless ? (SURFACE_CREATED | SWAPCHAIN_CREATED) : 0u;
+		status_t const status = m_progressStatus ^ (~notRequired & (
+			DESCRIPTOR_SETS_SETUP |
+			VERTEX_INPUT_BOUND |
+			SYNCHRONIZATION_OBJECTS_CREATED |
+			GRAPHICS_PIPELINE_CREATED | 
+			GRAPHICS_PIPELINE_LAYOUT_CREATED |
+			FRAMEBUFFERS_CREATED |
+			DEPTH_MEMORY_ALLOCATED |
+			DEPTH_IMAGE_CREATED |
+			RENDERPASS_CREATED |
+			COMMAND_BUFFER_ALLOCATED |
+			SWAPCHAIN_IMAGE_VIEWS_CREATED |
+			SWAPCHAIN_CREATED |
+			MXC_RENDERER_INSERT_MESSENGER |
+			INITIALIZED |
+			INSTANCE_CREATED |
+			SURFACE_CREATED |
+			PHY_DEVICE_GOT |
+			DEVICE_CREATED 
+		));
+		printf("renderer status is %x\n", static_cast<uint32_t>(status));
+		return status;
+	}
+}
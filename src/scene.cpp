@@ -0,0 +1,316 @@
+#include "scene.h"
+
+#include "job_system.h"
+#include "trace.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MXC_SCENE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm> // fill, max
+#include <bit> // countr_zero
+#include <cassert>
+
+namespace mxc
+{
+	auto Scene::toRows(Eigen::Transform<float,3,Eigen::Affine> const& transform) -> AffineRows
+	{
+		AffineRows rows;
+		for (int32_t r = 0; r < 3; ++r)
+		{
+			for (int32_t c = 0; c < 4; ++c)
+			{
+				rows.m[r][c] = transform.matrix()(r, c);
+			}
+		}
+		return rows;
+	}
+
+	auto Scene::toTransform(AffineRows const& rows) -> Eigen::Transform<float,3,Eigen::Affine>
+	{
+		Eigen::Transform<float,3,Eigen::Affine> transform = Eigen::Transform<float,3,Eigen::Affine>::Identity();
+		for (int32_t r = 0; r < 3; ++r)
+		{
+			for (int32_t c = 0; c < 4; ++c)
+			{
+				transform.matrix()(r, c) = rows.m[r][c];
+			}
+		}
+		return transform;
+	}
+
+	auto Scene::reserve(uint32_t nodeCount) & -> void
+	{
+		m_locals.reserve(nodeCount);
+		m_worlds.reserve(nodeCount);
+		m_parents.reserve(nodeCount);
+		m_subtreeSizes.reserve(nodeCount);
+		m_dirty.reserve((nodeCount + 63) / 64);
+		m_nodeOfSlot.reserve(nodeCount);
+		m_slotOfNode.reserve(nodeCount);
+	}
+
+	auto Scene::addNode(uint32_t parent, Eigen::Transform<float,3,Eigen::Affine> const& local) & -> uint32_t
+	{
+		assert((parent == SCENE_NO_PARENT || parent < nodeCount()) && "the parent of a node must be added before it");
+		uint32_t const node = nodeCount();
+		uint32_t const slot = node; // at the end, until the order is restored
+		uint32_t const parentSlot = parent == SCENE_NO_PARENT ? SCENE_NO_PARENT : m_slotOfNode[parent];
+		m_locals.push_back(toRows(local));
+		m_worlds.push_back(m_locals.back());
+		m_parents.push_back(parentSlot);
+		m_subtreeSizes.push_back(1);
+		m_nodeOfSlot.push_back(node);
+		m_slotOfNode.push_back(slot);
+		if (slot / 64 >= m_dirty.size())
+		{
+			m_dirty.push_back(0);
+		}
+		m_dirty[slot / 64] |= uint64_t{1} << (slot % 64);
+
+		// a root, or a child right after its parent's subtree, keeps the depth first order, as when a hierarchy is added depth first
+		if (m_orderDirty || parentSlot == SCENE_NO_PARENT)
+		{
+			return node;
+		}
+		if (parentSlot + m_subtreeSizes[parentSlot] != slot)
+		{
+			m_orderDirty = true;
+			return node;
+		}
+		for (uint32_t ancestor = parentSlot; ancestor != SCENE_NO_PARENT; ancestor = m_parents[ancestor])
+		{
+			++m_subtreeSizes[ancestor];
+		}
+		return node;
+	}
+
+	auto Scene::setLocal(uint32_t node, Eigen::Transform<float,3,Eigen::Affine> const& local) & -> void
+	{
+		uint32_t const slot = m_slotOfNode[node];
+		m_locals[slot] = toRows(local);
+		m_dirty[slot / 64] |= uint64_t{1} << (slot % 64);
+	}
+
+	auto Scene::local(uint32_t node) const & -> Eigen::Transform<float,3,Eigen::Affine>
+	{
+		return toTransform(m_locals[m_slotOfNode[node]]);
+	}
+
+	auto Scene::world(uint32_t node) const & -> Eigen::Transform<float,3,Eigen::Affine>
+	{
+		return toTransform(m_worlds[m_slotOfNode[node]]);
+	}
+
+	auto Scene::restoreHierarchyOrder() & -> void
+	{
+		MXC_TRACE_FUNCTION();
+		uint32_t const count = nodeCount();
+		// children of each slot, in slot order, CSR. Parents always have a lower slot than their children before the restore too, as
+		// nodes are appended after their parent
+		std::vector<uint32_t> childOffsets(count + 1, 0);
+		for (uint32_t slot = 0; slot < count; ++slot)
+		{
+			if (m_parents[slot] != SCENE_NO_PARENT)
+			{
+				++childOffsets[m_parents[slot] + 1];
+			}
+		}
+		for (uint32_t slot = 0; slot < count; ++slot)
+		{
+			childOffsets[slot + 1] += childOffsets[slot];
+		}
+		std::vector<uint32_t> children(childOffsets[count]);
+		std::vector<uint32_t> written(childOffsets.begin(), childOffsets.end() - 1);
+		for (uint32_t slot = 0; slot < count; ++slot)
+		{
+			if (m_parents[slot] != SCENE_NO_PARENT)
+			{
+				children[written[m_parents[slot]]++] = slot;
+			}
+		}
+
+		// depth first, roots and siblings in their current order
+		std::vector<uint32_t> order; // old slot of each new slot
+		order.reserve(count);
+		std::vector<uint32_t> stack;
+		for (uint32_t root = 0; root < count; ++root)
+		{
+			if (m_parents[root] != SCENE_NO_PARENT)
+			{
+				continue;
+			}
+			stack.push_back(root);
+			while (!stack.empty())
+			{
+				uint32_t const slot = stack.back();
+				stack.pop_back();
+				order.push_back(slot);
+				for (uint32_t i = childOffsets[slot + 1]; i > childOffsets[slot]; --i)
+				{
+					stack.push_back(children[i - 1]);
+				}
+			}
+		}
+		assert(order.size() == count);
+
+		std::vector<uint32_t> newSlots(count);
+		for (uint32_t slot = 0; slot < count; ++slot)
+		{
+			newSlots[order[slot]] = slot;
+		}
+		std::vector<AffineRows> locals(count);
+		std::vector<AffineRows> worlds(count);
+		std::vector<uint32_t> parents(count);
+		std::vector<uint64_t> dirty(m_dirty.size(), 0);
+		std::vector<uint32_t> nodeOfSlot(count);
+		for (uint32_t slot = 0; slot < count; ++slot)
+		{
+			uint32_t const old = order[slot];
+			locals[slot] = m_locals[old];
+			worlds[slot] = m_worlds[old];
+			parents[slot] = m_parents[old] == SCENE_NO_PARENT ? SCENE_NO_PARENT : newSlots[m_parents[old]];
+			dirty[slot / 64] |= ((m_dirty[old / 64] >> (old % 64)) & 1) << (slot % 64);
+			nodeOfSlot[slot] = m_nodeOfSlot[old];
+			m_slotOfNode[m_nodeOfSlot[old]] = slot;
+		}
+		m_locals = std::move(locals);
+		m_worlds = std::move(worlds);
+		m_parents = std::move(parents);
+		m_dirty = std::move(dirty);
+		m_nodeOfSlot = std::move(nodeOfSlot);
+
+		// children after their parent, so sizes accumulate backwards
+		std::fill(m_subtreeSizes.begin(), m_subtreeSizes.end(), 1u);
+		for (uint32_t slot = count; slot-- > 0;)
+		{
+			if (m_parents[slot] != SCENE_NO_PARENT)
+			{
+				m_subtreeSizes[m_parents[slot]] += m_subtreeSizes[slot];
+			}
+		}
+		m_orderDirty = false;
+	}
+
+	auto Scene::nextDirty(uint32_t slot) const & -> uint32_t
+	{
+		uint32_t const count = nodeCount();
+		if (slot >= count)
+		{
+			return count;
+		}
+		size_t word = slot / 64;
+		uint64_t bits = m_dirty[word] & (~uint64_t{0} << (slot % 64));
+		while (bits == 0)
+		{
+			if (++word == m_dirty.size())
+			{
+				return count;
+			}
+			bits = m_dirty[word];
+		}
+		return std::min(count, static_cast<uint32_t>(word * 64 + std::countr_zero(bits)));
+	}
+
+	auto Scene::updateRange(uint32_t first, uint32_t last) & -> void
+	{
+		for (uint32_t slot = first; slot < last; ++slot)
+		{
+			uint32_t const parent = m_parents[slot];
+			AffineRows const& local = m_locals[slot];
+			AffineRows& world = m_worlds[slot];
+			if (parent == SCENE_NO_PARENT)
+			{
+				world = local;
+				continue;
+			}
+			// row r of parent * local: the parent's row r weighs the local rows, plus its translation, as the local's last row is (0 0 0 1)
+			AffineRows const& parentWorld = m_worlds[parent];
+#ifdef MXC_SCENE_SSE2
+			__m128 const l0 = _mm_load_ps(local.m[0]);
+			__m128 const l1 = _mm_load_ps(local.m[1]);
+			__m128 const l2 = _mm_load_ps(local.m[2]);
+			__m128 const translationMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			for (uint32_t r = 0; r < 3; ++r)
+			{
+				__m128 const p = _mm_load_ps(parentWorld.m[r]);
+				__m128 row = _mm_and_ps(p, translationMask);
+				row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)), l0));
+				row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), l1));
+				row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), l2));
+				_mm_store_ps(world.m[r], row);
+			}
+#else
+			for (uint32_t r = 0; r < 3; ++r)
+			{
+				float const* const p = parentWorld.m[r];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					world.m[r][c] = p[0] * local.m[0][c] + p[1] * local.m[1][c] + p[2] * local.m[2][c] + (c == 3 ? p[3] : 0.f);
+				}
+			}
+#endif
+		}
+	}
+
+	auto Scene::updateWorld(JobSystem* jobSystem, SceneUpdateStats* outStats) & -> void
+	{
+		MXC_TRACE_FUNCTION();
+		if (m_orderDirty)
+		{
+			restoreHierarchyOrder();
+		}
+
+		// a dirty node takes its whole subtree along, so the scan jumps over it. Subtrees too large for one job are split: their upper
+		// nodes are updated here, the smaller subtrees below go to the jobs
+		uint32_t const count = nodeCount();
+		SceneUpdateStats stats {.dirtySubtreeCount = 0, .updatedNodeCount = 0, .jobCount = 0};
+		m_tasks.clear();
+		for (uint32_t slot = nextDirty(0); slot < count; slot = nextDirty(slot))
+		{
+			uint32_t const end = slot + m_subtreeSizes[slot];
+			++stats.dirtySubtreeCount;
+			stats.updatedNodeCount += m_subtreeSizes[slot];
+			if (!jobSystem)
+			{
+				updateRange(slot, end);
+				slot = end;
+				continue;
+			}
+			while (slot < end)
+			{
+				if (m_subtreeSizes[slot] <= SCENE_TASK_NODES)
+				{
+					m_tasks.push_back(slot);
+					slot += m_subtreeSizes[slot];
+				}
+				else
+				{
+					updateRange(slot, slot + 1); // its children follow
+					++slot;
+				}
+			}
+		}
+
+		if (!m_tasks.empty())
+		{
+			// many small subtrees (eg. animated leaves) are batched, about SCENE_TASK_NODES nodes for each job
+			uint32_t const taskCount = static_cast<uint32_t>(m_tasks.size());
+			uint32_t const grainSize = std::max(1u, static_cast<uint32_t>(uint64_t{SCENE_TASK_NODES} * taskCount / std::max(stats.updatedNodeCount, 1u)));
+			stats.jobCount = (taskCount + grainSize - 1) / grainSize;
+			jobSystem->parallel_for(taskCount, grainSize, [this](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					updateRange(m_tasks[i], m_tasks[i] + m_subtreeSizes[m_tasks[i]]);
+				}
+			});
+		}
+		std::fill(m_dirty.begin(), m_dirty.end(), uint64_t{0});
+
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <vector>
+
+// Scene graph of transforms. Every field of the nodes has its own array (local and world matrices, parent, subtree size, dirty bits),
+// indexed by slot, and the slots are kept in depth first order: parents come before their children and every subtree is a contiguous
+// range, so world matrices are propagated with forward linear scans, no pointer chasing. Matrices are affine, stored as their 3 rows of
+// 4 floats, 16 byte aligned, and multiplied 4 lanes at a time with SSE2 (scalar otherwise).
+// setLocal only sets a dirty bit. updateWorld finds the dirty subtrees scanning the bits 64 at a time, recomputes just those, and splits
+// them among the job system: ancestors of more than SCENE_TASK_NODES nodes are updated first on the calling thread, then the subtrees
+// below them, independent of each other, in parallel.
+// Node ids are stable, slots are not: adding a child anywhere but at the end of its parent's subtree restores the order at the next update
+namespace mxc
+{
+	class JobSystem;
+
+	inline constexpr uint32_t SCENE_NO_PARENT = UINT32_MAX;
+	inline constexpr uint32_t SCENE_TASK_NODES = 1024; // about the nodes each job updates
+
+	struct SceneUpdateStats
+	{
+		uint32_t dirtySubtreeCount;
+		uint32_t updatedNodeCount;
+		uint32_t jobCount; // 0 if everything ran on the calling thread
+	};
+
+	class Scene
+	{
+	public:
+		auto reserve(uint32_t nodeCount) & -> void;
+		// parent is a node id, or SCENE_NO_PARENT for a root. Returns the id of the new node, numbered from 0 in order of addition
+		auto addNode(uint32_t parent, Eigen::Transform<float,3,Eigen::Affine> const& local) & -> uint32_t;
+		auto setLocal(uint32_t node, Eigen::Transform<float,3,Eigen::Affine> const& local) & -> void; // the world matrices of its subtree update next time
+		auto local(uint32_t node) const & -> Eigen::Transform<float,3,Eigen::Affine>;
+		auto world(uint32_t node) const & -> Eigen::Transform<float,3,Eigen::Affine>; // as of the last updateWorld
+		auto nodeCount() const & -> uint32_t { return static_cast<uint32_t>(m_slotOfNode.size()); }
+		// world = parent world * local for every node below a dirty one. jobSystem can be null, otherwise the calling thread must be allowed
+		// to submit jobs to it
+		auto updateWorld(JobSystem* jobSystem, SceneUpdateStats* outStats = nullptr) & -> void;
+
+	private:
+		struct alignas(16) AffineRows
+		{
+			float m[3][4];
+		};
+
+		static auto toRows(Eigen::Transform<float,3,Eigen::Affine> const& transform) -> AffineRows;
+		static auto toTransform(AffineRows const& rows) -> Eigen::Transform<float,3,Eigen::Affine>;
+		auto restoreHierarchyOrder() & -> void;
+		auto nextDirty(uint32_t slot) const & -> uint32_t; // first dirty slot from slot on, nodeCount if none
+		auto updateRange(uint32_t first, uint32_t last) & -> void; // slots in order, parents of the first outside of the range must be up to date
+
+	private:
+		// by slot
+		std::vector<AffineRows> m_locals;
+		std::vector<AffineRows> m_worlds;
+		std::vector<uint32_t> m_parents; // slot of the parent, or SCENE_NO_PARENT
+		std::vector<uint32_t> m_subtreeSizes; // the node included
+		std::vector<uint64_t> m_dirty; // bit per slot, the local matrix changed since the last update
+		std::vector<uint32_t> m_nodeOfSlot;
+		// by node id
+		std::vector<uint32_t> m_slotOfNode;
+		bool m_orderDirty = false; // slots aren't in depth first order, and subtree sizes are stale
+		std::vector<uint32_t> m_tasks; // scratch of updateWorld, first slot of each subtree handed to a job
+	};
+}
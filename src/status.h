@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mxc
+{
+	using status_t = uint32_t;
+	#define APP_SUCCESS 0
+	#define APP_GENERIC_ERR 1
+	#define APP_MEMORY_ERR 2
+	#define APP_LACK_OF_VULKAN_1_2_SUPPORT_ERR 3
+	#define APP_INIT_FAILURE 4
+	#define APP_QUEUE_ERR 5
+	#define APP_DEVICE_CREATION_ERR 6
+	#define APP_SWAPCHAIN_CREATION_ERR 7
+	#define APP_VK_ALLOCATION_ERR 8
+	#define APP_REQUIRES_RESIZE_ERR 9
+	//... more errors
+}
@@ -0,0 +1,163 @@
+#include "trace.h"
+
+#include <algorithm> // min
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <new>
+
+namespace mxc::trace
+{
+	namespace
+	{
+		struct Event
+		{
+			char const* name;
+			uint64_t beginNs;
+			uint64_t endNs;
+		};
+
+		struct ThreadBuffer
+		{
+			Event events[EVENTS_PER_THREAD];
+			std::atomic<uint32_t> count; // events [0, count) are complete and never written again
+			std::atomic<uint32_t> dropped; // written by the owner thread only, atomic so that dumps can read it
+		};
+
+		// buffers are never freed, a dump can be requested until the very end of the process
+		std::atomic<ThreadBuffer*> g_buffers[MAX_THREADS];
+		std::atomic<uint32_t> g_bufferCount{0};
+		std::atomic<bool> g_dumpRequested{false};
+		std::chrono::steady_clock::time_point const g_epoch = std::chrono::steady_clock::now();
+
+		thread_local ThreadBuffer* t_buffer = nullptr;
+		thread_local bool t_registrationFailed = false;
+
+		auto threadBuffer() -> ThreadBuffer*
+		{
+			if (t_buffer || t_registrationFailed)
+			{
+				return t_buffer;
+			}
+			uint32_t const idx = g_bufferCount.fetch_add(1, std::memory_order_relaxed);
+			ThreadBuffer* buffer = idx < MAX_THREADS ? new (std::nothrow) ThreadBuffer : nullptr;
+			if (!buffer)
+			{
+				t_registrationFailed = true;
+				return nullptr;
+			}
+			buffer->count.store(0, std::memory_order_relaxed);
+			buffer->dropped.store(0, std::memory_order_relaxed);
+			g_buffers[idx].store(buffer, std::memory_order_release);
+			t_buffer = buffer;
+			return t_buffer;
+		}
+
+		auto writeEscaped(FILE* file, char const* str) -> void
+		{
+			for (; *str; ++str)
+			{
+				if (*str == '"' || *str == '\\')
+				{
+					fputc('\\', file);
+				}
+				fputc(*str, file);
+			}
+		}
+
+		auto onDumpSignal(int) -> void
+		{
+			g_dumpRequested.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	auto now() -> uint64_t
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count());
+	}
+
+	auto record(char const* name, uint64_t beginNs, uint64_t endNs) -> void
+	{
+		ThreadBuffer* buffer = threadBuffer();
+		if (!buffer)
+		{
+			return;
+		}
+		// only this thread writes count, so a relaxed load is enough. The release store publishes the event to dumps
+		uint32_t const count = buffer->count.load(std::memory_order_relaxed);
+		if (count == EVENTS_PER_THREAD)
+		{
+			buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+		buffer->events[count] = Event{.name = name, .beginNs = beginNs, .endNs = endNs};
+		buffer->count.store(count + 1, std::memory_order_release);
+	}
+
+	auto dump(char const* path) -> bool
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+		{
+			fprintf(stderr, "failed to open trace file %s!\n", path);
+			return false;
+		}
+
+		// ts and dur are in microseconds. Thread ids are registration order, the main thread usually being 0
+		uint64_t eventCount = 0;
+		uint64_t droppedCount = 0;
+		fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+		uint32_t const bufferCount = std::min(g_bufferCount.load(std::memory_order_relaxed), MAX_THREADS);
+		char const* separator = "";
+		for (uint32_t tid = 0; tid < bufferCount; ++tid)
+		{
+			ThreadBuffer const* buffer = g_buffers[tid].load(std::memory_order_acquire);
+			if (!buffer) // registering right now, or failed to
+			{
+				continue;
+			}
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", separator, tid, tid);
+			separator = ",\n";
+
+			uint32_t const count = buffer->count.load(std::memory_order_acquire);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Event const& event = buffer->events[i];
+				fputs(",\n{\"name\":\"", file);
+				writeEscaped(file, event.name);
+				fprintf(file, "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", tid,
+						static_cast<double>(event.beginNs) * 1e-3, static_cast<double>(event.endNs - event.beginNs) * 1e-3);
+			}
+			eventCount += count;
+			droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+		}
+		fputs("\n]}\n", file);
+
+		bool const ok = ferror(file) == 0;
+		fclose(file);
+		if (!ok)
+		{
+			fprintf(stderr, "failed to write trace file %s!\n", path);
+			return false;
+		}
+		printf("trace with %lu events from %u threads written to %s, %lu events dropped\n", static_cast<unsigned long>(eventCount), bufferCount, path,
+			   static_cast<unsigned long>(droppedCount));
+		return true;
+	}
+
+	auto installDumpSignal() -> void
+	{
+#ifdef SIGUSR1 // POSIX only
+		std::signal(SIGUSR1, onDumpSignal);
+#endif
+	}
+
+	auto dumpIfRequested(char const* path) -> void
+	{
+		if (g_dumpRequested.exchange(false, std::memory_order_relaxed))
+		{
+			dump(path);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// CPU tracing of hot paths and startup stages, exported as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev).
+// Each thread appends complete events (name, begin, end) to its own fixed buffer, registered once on the first event, so recording is
+// two clock reads and a release store, without locks nor atomics read-modify-write. When a buffer is full further events of that thread
+// are dropped and counted. A dump reads every buffer up to its published count, so it can run while the other threads keep tracing.
+// Scopes are compiled out unless MXC_TRACE_ENABLED is defined (CMake option MXC_TRACING)
+namespace mxc::trace
+{
+	inline constexpr uint32_t EVENTS_PER_THREAD = 1u << 15;
+	inline constexpr uint32_t MAX_THREADS = 64;
+
+	auto now() -> uint64_t; // ns, steady clock
+	// name must be a string literal, or anyway outlive the trace
+	auto record(char const* name, uint64_t beginNs, uint64_t endNs) -> void;
+
+	auto dump(char const* path) -> bool;
+	// SIGUSR1, where available, requests a dump, which is written by the next dumpIfRequested (a signal handler can't do file IO safely)
+	auto installDumpSignal() -> void;
+	auto dumpIfRequested(char const* path) -> void;
+
+	class Scope
+	{
+	public:
+		explicit Scope(char const* name) : m_name(name), m_beginNs(now()) {}
+		Scope(Scope const&) = delete;
+		auto operator=(Scope const&) -> Scope& = delete;
+		~Scope() { record(m_name, m_beginNs, now()); }
+
+	private:
+		char const* m_name;
+		uint64_t m_beginNs;
+	};
+}
+
+#define MXC_TRACE_CONCAT_IMPL(a, b) a##b
+#define MXC_TRACE_CONCAT(a, b) MXC_TRACE_CONCAT_IMPL(a, b)
+#ifdef MXC_TRACE_ENABLED
+	#define MXC_TRACE_SCOPE(name) mxc::trace::Scope const MXC_TRACE_CONCAT(mxcTraceScope, __LINE__)(name)
+#else
+	#define MXC_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+#define MXC_TRACE_FUNCTION() MXC_TRACE_SCOPE(__func__)
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "status.h"
+#include "device_allocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+// Ring of uniform data, backed by a single VkBuffer living in persistently mapped host visible memory. The buffer is split in
+// regionCount regions of equal size, one for each frame which can be in flight, and each region is sub-allocated linearly every frame.
+// Slices are aligned to VkPhysicalDeviceLimits::minUniformBufferOffsetAlignment and are meant to be bound through a descriptor of type
+// VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, passing the offset returned by push as dynamic offset to vkCmdBindDescriptorSets.
+// Since a region restarts from its beginning at each beginRegion, pushing the same sequence of blocks yields the same offsets, so
+// recorded command buffers stay valid across frames as long as the sequence doesn't change.
+// NOTE: the caller must ensure the GPU is done with a region (eg. by waiting its frame fence) before calling beginRegion on it
+namespace mxc
+{
+	template <template<class> class AllocTemplate>
+	class UniformRing
+	{
+	public: // constructors
+		UniformRing() = default;
+		UniformRing(UniformRing const&) = delete;
+		auto operator=(UniformRing const&) -> UniformRing& = delete;
+		~UniformRing() { assert(m_buffer == VK_NULL_HANDLE && "destroy() must be called before the VkDevice is destroyed"); }
+
+	public: // public functions
+		auto init(VkPhysicalDevice phyDevice, VkDevice device, DeviceAllocator<AllocTemplate>* deviceAllocator, VkDeviceSize regionSize, uint32_t regionCount) & -> status_t;
+		auto destroy() & -> void;
+
+		// starts sub-allocating from the beginning of region regionIdx, and flushes what was written in the previous one
+		auto beginRegion(uint32_t regionIdx) & -> void;
+		// reserves an aligned slice in the current region. Returns a pointer to write to, or nullptr if the region is full
+		auto allocate(VkDeviceSize size, uint32_t* outDynamicOffset) & -> void*;
+		// allocate + memcpy
+		auto push(void const* data, VkDeviceSize size, uint32_t* outDynamicOffset) & -> status_t;
+		// makes writes in the current region visible to the device. Does nothing for host coherent memory
+		auto flush() & -> status_t;
+
+		auto buffer() const & -> VkBuffer { return m_buffer; }
+		auto alignment() const & -> VkDeviceSize { return m_alignment; }
+		auto regionSize() const & -> VkDeviceSize { return m_regionSize; }
+
+	private: // data
+		VkDevice m_device = VK_NULL_HANDLE;
+		DeviceAllocator<AllocTemplate>* m_deviceAllocator = nullptr;
+		VkBuffer m_buffer = VK_NULL_HANDLE;
+		DeviceAllocation m_memory{};
+		VkDeviceSize m_alignment = 1;
+		VkDeviceSize m_regionSize = 0;
+		uint32_t m_regionCount = 0;
+		uint32_t m_regionIdx = 0;
+		VkDeviceSize m_head = 0; // relative to the current region
+		VkDeviceSize m_flushedHead = 0;
+	};
+
+	template <template<class> class AllocTemplate>
+	auto UniformRing<AllocTemplate>::init(VkPhysicalDevice phyDevice, VkDevice device, DeviceAllocator<AllocTemplate>* deviceAllocator, VkDeviceSize regionSize, uint32_t regionCount) & -> status_t
+	{
+		assert(m_buffer == VK_NULL_HANDLE && "uniform ring initialized twice");
+		assert(regionCount != 0);
+		m_device = device;
+		m_deviceAllocator = deviceAllocator;
+
+		VkPhysicalDeviceProperties phyDeviceProperties;
+		vkGetPhysicalDeviceProperties(phyDevice, &phyDeviceProperties);
+		m_alignment = std::max<VkDeviceSize>(phyDeviceProperties.limits.minUniformBufferOffsetAlignment, 1);
+
+		// regions have to start at an aligned offset too
+		m_regionSize = (regionSize + m_alignment - 1) & ~(m_alignment - 1);
+		m_regionCount = regionCount;
+		m_regionIdx = 0;
+		m_head = m_flushedHead = 0;
+
+		VkBufferCreateInfo const bufferCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.size = m_regionSize * m_regionCount,
+			.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices = nullptr
+		};
+		if (vkCreateBuffer(m_device, &bufferCreateInfo, m_deviceAllocator->allocationCallbacks(), &m_buffer) != VK_SUCCESS)
+		{
+			m_buffer = VK_NULL_HANDLE;
+			fprintf(stderr, "failed to create uniform ring buffer!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		// mapped by the device allocator for the lifetime of its block
+		if (m_deviceAllocator->allocateForBuffer(m_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_memory) != APP_SUCCESS)
+		{
+			// destroy() takes a buffer for one with memory
+			vkDestroyBuffer(m_device, m_buffer, m_deviceAllocator->allocationCallbacks());
+			m_buffer = VK_NULL_HANDLE;
+			fprintf(stderr, "failed to allocate memory for uniform ring buffer!\n");
+			return APP_VK_ALLOCATION_ERR;
+		}
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UniformRing<AllocTemplate>::destroy() & -> void
+	{
+		if (m_buffer == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		vkDestroyBuffer(m_device, m_buffer, m_deviceAllocator->allocationCallbacks());
+		m_deviceAllocator->free(m_memory);
+		m_buffer = VK_NULL_HANDLE;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UniformRing<AllocTemplate>::beginRegion(uint32_t regionIdx) & -> void
+	{
+		assert(regionIdx < m_regionCount && "uniform ring region index out of bounds");
+		flush();
+		m_regionIdx = regionIdx;
+		m_head = m_flushedHead = 0;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UniformRing<AllocTemplate>::allocate(VkDeviceSize size, uint32_t* outDynamicOffset) & -> void*
+	{
+		VkDeviceSize const offset = (m_head + m_alignment - 1) & ~(m_alignment - 1);
+		if (offset + size > m_regionSize)
+		{
+			fprintf(stderr, "uniform ring region %u is full! (%lu bytes)\n", m_regionIdx, static_cast<unsigned long>(m_regionSize));
+			return nullptr;
+		}
+		m_head = offset + size;
+
+		VkDeviceSize const bufferOffset = m_regionIdx * m_regionSize + offset;
+		*outDynamicOffset = static_cast<uint32_t>(bufferOffset);
+		return static_cast<unsigned char*>(m_memory.mappedPtr) + bufferOffset;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UniformRing<AllocTemplate>::push(void const* data, VkDeviceSize size, uint32_t* outDynamicOffset) & -> status_t
+	{
+		void* ptr = allocate(size, outDynamicOffset);
+		if (!ptr)
+		{
+			return APP_MEMORY_ERR;
+		}
+		memcpy(ptr, data, size);
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UniformRing<AllocTemplate>::flush() & -> status_t
+	{
+		if (m_head == m_flushedHead || m_memory.memory == VK_NULL_HANDLE)
+		{
+			return APP_SUCCESS;
+		}
+		VkDeviceSize const regionOffset = m_regionIdx * m_regionSize;
+		status_t const status = m_deviceAllocator->flush(m_memory, regionOffset + m_flushedHead, m_head - m_flushedHead);
+		m_flushedHead = m_head;
+		return status;
+	}
+}
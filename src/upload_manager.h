@@ -0,0 +1,517 @@
+#pragma once
+
+#include "status.h"
+#include "device_allocator.h"
+#include "gpu_profiler.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <algorithm> // min, max
+
+// Asynchronous uploads of buffer and image data to device local memory.
+// Data is copied in a persistently mapped staging ring, and the copies are recorded in a batch, a command buffer from a transient
+// pool, which is submitted with a fence when submit() is called (or when the ring or the batch runs out of space). Nothing waits
+// for the device on submission: ordering with later work on the same queue is guaranteed by a memory barrier at the end of each
+// batch, from the transfer writes to the accesses declared by the uploads (eg. vertex attribute read), so a draw submitted after the
+// batch sees the data. Staging space of a batch is recycled once its fence is signaled, which is checked (without blocking) by poll().
+// The CPU blocks only when the ring is exhausted, waiting for the oldest batch in flight.
+// Each submitted batch is identified by a monotonically increasing ticket, which can be used to ask for completion.
+// NOTE: not thread safe
+namespace mxc
+{
+	template <template<class> class AllocTemplate>
+	class UploadManager
+	{
+	public: // constants
+		static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 16ull << 20; // 16 MiB
+		static constexpr uint64_t INVALID_TICKET = UINT64_MAX; // returned by submit when the batch couldn't be submitted
+		static constexpr uint32_t BATCH_COUNT = 8; // max batches in flight + 1 recording
+		static constexpr VkDeviceSize STAGING_ALIGNMENT = 16; // satisfies any texel size and optimalBufferCopyOffsetAlignment in practice
+
+	public: // constructors
+		UploadManager() = default;
+		UploadManager(UploadManager const&) = delete;
+		auto operator=(UploadManager const&) -> UploadManager& = delete;
+		~UploadManager() { assert(m_stagingBuffer == VK_NULL_HANDLE && "destroy() must be called before the VkDevice is destroyed"); }
+
+	public: // public functions
+		auto init(VkDevice device, DeviceAllocator<AllocTemplate>* deviceAllocator, VkQueue queue, uint32_t queueFamilyIdx, VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE) & -> status_t;
+		auto destroy() & -> void; // waits for all batches in flight
+
+		// dstStageMask and dstAccessMask describe how the buffer is going to be consumed, eg. VERTEX_INPUT and VERTEX_ATTRIBUTE_READ
+		// buffers bigger than the staging ring are split in more copies
+		auto uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, void const* data, VkDeviceSize size,
+						  VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) & -> status_t;
+		// copies one tightly packed subresource region. The image is transitioned from UNDEFINED, so its previous content is discarded,
+		// to TRANSFER_DST_OPTIMAL and then to finalLayout
+		auto uploadImage(VkImage dstImage, VkBufferImageCopy const& region, void const* data, VkDeviceSize size, VkImageLayout finalLayout,
+						 VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) & -> status_t;
+
+		// submits the batch being recorded, if any. Returns the ticket of the last submitted batch, or INVALID_TICKET if the submission
+		// failed, in which case the batch and its uploads are dropped
+		auto submit() & -> uint64_t;
+		// retires completed batches without blocking, recycling their staging space. To be called regularly, eg. once per frame
+		auto poll() & -> void;
+		auto isComplete(uint64_t ticket) const & -> bool { return ticket <= m_retiredTicket; }
+		auto wait(uint64_t ticket) & -> status_t;
+		auto waitIdle() & -> status_t;
+
+		// each batch is timed in the "upload" scope of its slot, [firstSlot, firstSlot + BATCH_COUNT)
+		auto setProfiler(GpuProfiler* profiler, uint32_t firstSlot) & -> void { m_profiler = profiler; m_firstProfilerSlot = firstSlot; }
+
+		auto bytesUploaded() const & -> uint64_t { return m_bytesUploaded; }
+		auto batchesSubmitted() const & -> uint64_t { return m_submittedTicket; }
+
+	private: // types
+		struct Batch
+		{
+			VkCommandBuffer cmdBuf;
+			VkFence fence;
+			uint64_t ticket;
+			VkDeviceSize stagingEnd; // ring head after the last reservation of this batch
+			VkPipelineStageFlags dstStageMask;
+			VkAccessFlags dstAccessMask;
+			uint32_t profilerScope;
+		};
+
+	private: // functions
+		auto reserve(VkDeviceSize size, VkDeviceSize* outOffset) & -> status_t; // blocks if the ring is full
+		auto tryReserve(VkDeviceSize size, VkDeviceSize* outOffset) & -> bool;
+		auto beginBatch() & -> status_t;
+		auto retireOldest(bool block) & -> bool;
+
+	private: // data
+		VkDevice m_device = VK_NULL_HANDLE;
+		DeviceAllocator<AllocTemplate>* m_deviceAllocator = nullptr;
+		VkQueue m_queue = VK_NULL_HANDLE;
+		VkCommandPool m_cmdPool = VK_NULL_HANDLE;
+
+		VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+		DeviceAllocation m_stagingMemory{};
+		VkDeviceSize m_stagingSize = 0;
+		VkDeviceSize m_head = 0; // next free byte
+		VkDeviceSize m_tail = 0; // first byte still in use by a batch
+
+		Batch m_batches[BATCH_COUNT]{};
+		uint32_t m_oldestBatch = 0; // batches in flight are [m_oldestBatch, m_oldestBatch + m_inFlightCount), the next one is the recording one
+		uint32_t m_inFlightCount = 0;
+		bool m_recording = false;
+
+		uint64_t m_submittedTicket = 0;
+		uint64_t m_retiredTicket = 0;
+		uint64_t m_bytesUploaded = 0;
+
+		GpuProfiler* m_profiler = nullptr;
+		uint32_t m_firstProfilerSlot = 0;
+	};
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::init(VkDevice device, DeviceAllocator<AllocTemplate>* deviceAllocator, VkQueue queue, uint32_t queueFamilyIdx, VkDeviceSize stagingSize) & -> status_t
+	{
+		assert(m_stagingBuffer == VK_NULL_HANDLE && "upload manager initialized twice");
+		m_device = device;
+		m_deviceAllocator = deviceAllocator;
+		m_queue = queue;
+		m_stagingSize = stagingSize;
+		m_head = m_tail = 0;
+
+		// -- staging ring, host visible and persistently mapped ---------------------------------------------------------------------------
+		VkBufferCreateInfo const bufferCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.size = m_stagingSize,
+			.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices = nullptr
+		};
+		if (vkCreateBuffer(m_device, &bufferCreateInfo, m_deviceAllocator->allocationCallbacks(), &m_stagingBuffer) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create staging buffer!\n");
+			return APP_GENERIC_ERR;
+		}
+		if (m_deviceAllocator->allocateForBuffer(m_stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_stagingMemory) != APP_SUCCESS)
+		{
+			fprintf(stderr, "failed to allocate memory for staging buffer!\n");
+			return APP_VK_ALLOCATION_ERR;
+		}
+
+		// -- command pool for short lived command buffers, each resettable on its own -----------------------------------------------------
+		VkCommandPoolCreateInfo const cmdPoolCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+			.queueFamilyIndex = queueFamilyIdx
+		};
+		if (vkCreateCommandPool(m_device, &cmdPoolCreateInfo, m_deviceAllocator->allocationCallbacks(), &m_cmdPool) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to create upload command pool!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		VkCommandBuffer cmdBufs[BATCH_COUNT];
+		VkCommandBufferAllocateInfo const cmdBufAllocateInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.commandPool = m_cmdPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = BATCH_COUNT
+		};
+		if (vkAllocateCommandBuffers(m_device, &cmdBufAllocateInfo, cmdBufs) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to allocate upload command buffers!\n");
+			return APP_GENERIC_ERR;
+		}
+
+		VkFenceCreateInfo const fenceCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0
+		};
+		for (uint32_t i = 0; i < BATCH_COUNT; ++i)
+		{
+			m_batches[i] = Batch{.cmdBuf = cmdBufs[i], .fence = VK_NULL_HANDLE, .ticket = 0, .stagingEnd = 0, .dstStageMask = 0, .dstAccessMask = 0, .profilerScope = GpuProfiler::INVALID_SCOPE};
+			if (vkCreateFence(m_device, &fenceCreateInfo, m_deviceAllocator->allocationCallbacks(), &m_batches[i].fence) != VK_SUCCESS)
+			{
+				fprintf(stderr, "failed to create upload fence!\n");
+				return APP_GENERIC_ERR;
+			}
+		}
+
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::destroy() & -> void
+	{
+		if (m_device == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		if (m_recording || m_inFlightCount != 0)
+		{
+			submit(); // a batch failing to submit is dropped, those already in flight must still be waited for
+			wait(m_submittedTicket);
+		}
+
+		for (uint32_t i = 0; i < BATCH_COUNT; ++i)
+		{
+			vkDestroyFence(m_device, m_batches[i].fence, m_deviceAllocator->allocationCallbacks());
+		}
+		vkDestroyCommandPool(m_device, m_cmdPool, m_deviceAllocator->allocationCallbacks()); // frees its command buffers
+		vkDestroyBuffer(m_device, m_stagingBuffer, m_deviceAllocator->allocationCallbacks());
+		m_deviceAllocator->free(m_stagingMemory);
+
+		printf("upload manager: %lu bytes uploaded in %lu batches\n", static_cast<unsigned long>(m_bytesUploaded), static_cast<unsigned long>(m_submittedTicket));
+		m_stagingBuffer = VK_NULL_HANDLE;
+		m_cmdPool = VK_NULL_HANDLE;
+		m_device = VK_NULL_HANDLE;
+	}
+
+	// -- staging ring ---------------------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::tryReserve(VkDeviceSize size, VkDeviceSize* outOffset) & -> bool
+	{
+		// used space is [m_tail, m_head), possibly wrapping around. When nothing is in use start over from 0, so big requests have the most room
+		bool const empty = m_inFlightCount == 0 && !m_recording;
+		if (empty)
+		{
+			m_head = m_tail = 0;
+		}
+
+		VkDeviceSize offset = (m_head + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+		if (empty || m_head > m_tail)
+		{
+			// free space is [m_head, end) and [0, m_tail)
+			if (offset + size > m_stagingSize)
+			{
+				if (size > m_tail)
+				{
+					return false;
+				}
+				offset = 0;
+			}
+		}
+		else if (offset + size > m_tail) // free space is [m_head, m_tail), and m_head == m_tail means full
+		{
+			return false;
+		}
+
+		m_head = offset + size;
+		*outOffset = offset;
+		return true;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::reserve(VkDeviceSize size, VkDeviceSize* outOffset) & -> status_t
+	{
+		assert(size <= m_stagingSize);
+		poll();
+		while (!tryReserve(size, outOffset))
+		{
+			// out of staging space: push out what we have, then wait for the oldest batch in flight to give some back
+			if (submit() == INVALID_TICKET || !retireOldest(/*block*/true))
+			{
+				fprintf(stderr, "upload manager: couldn't reserve %lu bytes of staging memory!\n", static_cast<unsigned long>(size));
+				return APP_MEMORY_ERR;
+			}
+		}
+		return APP_SUCCESS;
+	}
+
+	// -- batches ----------------------------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::beginBatch() & -> status_t
+	{
+		if (m_recording)
+		{
+			return APP_SUCCESS;
+		}
+		// the slot after the in flight ones must be free
+		if (m_inFlightCount == BATCH_COUNT - 1 && !retireOldest(/*block*/true))
+		{
+			return APP_GENERIC_ERR;
+		}
+
+		Batch& batch = m_batches[(m_oldestBatch + m_inFlightCount) % BATCH_COUNT];
+		batch.stagingEnd = m_head;
+		batch.dstStageMask = 0;
+		batch.dstAccessMask = 0;
+		vkResetCommandBuffer(batch.cmdBuf, /*flags*/0);
+
+		VkCommandBufferBeginInfo const beginInfo {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			.pInheritanceInfo = nullptr
+		};
+		if (vkBeginCommandBuffer(batch.cmdBuf, &beginInfo) != VK_SUCCESS)
+		{
+			fprintf(stderr, "failed to begin recording of upload batch!\n");
+			return APP_GENERIC_ERR;
+		}
+		if (m_profiler)
+		{
+			uint32_t const slot = m_firstProfilerSlot + (m_oldestBatch + m_inFlightCount) % BATCH_COUNT;
+			m_profiler->beginFrame(batch.cmdBuf, slot);
+			batch.profilerScope = m_profiler->beginScope(batch.cmdBuf, slot, "upload");
+		}
+		m_recording = true;
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::submit() & -> uint64_t
+	{
+		if (!m_recording)
+		{
+			return m_submittedTicket;
+		}
+
+		Batch& batch = m_batches[(m_oldestBatch + m_inFlightCount) % BATCH_COUNT];
+
+		// a single global barrier makes all the transfer writes of the batch available and visible to the consumers declared by the uploads.
+		// Image layout transitions already carry their own
+		if (batch.dstAccessMask != 0)
+		{
+			VkMemoryBarrier const memoryBarrier {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.pNext = nullptr,
+				.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+				.dstAccessMask = batch.dstAccessMask
+			};
+			vkCmdPipelineBarrier(batch.cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, batch.dstStageMask, /*dependencyFlags*/0,
+								 /*memoryBarrierCount*/1, &memoryBarrier, /*bufferMemoryBarrierCount*/0, nullptr, /*imageMemoryBarrierCount*/0, nullptr);
+		}
+		uint32_t const profilerSlot = m_firstProfilerSlot + (m_oldestBatch + m_inFlightCount) % BATCH_COUNT;
+		if (m_profiler)
+		{
+			m_profiler->endScope(batch.cmdBuf, profilerSlot, batch.profilerScope);
+		}
+		vkEndCommandBuffer(batch.cmdBuf);
+
+		// staging writes must be visible to the device before the copies are executed
+		m_deviceAllocator->flush(m_stagingMemory);
+
+		VkSubmitInfo const submitInfo {
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = nullptr,
+			.waitSemaphoreCount = 0,
+			.pWaitSemaphores = nullptr,
+			.pWaitDstStageMask = nullptr,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &batch.cmdBuf,
+			.signalSemaphoreCount = 0,
+			.pSignalSemaphores = nullptr
+		};
+		vkResetFences(m_device, /*fenceCount*/1, &batch.fence);
+		m_recording = false;
+		if (vkQueueSubmit(m_queue, /*submitCount*/1, &submitInfo, batch.fence) != VK_SUCCESS)
+		{
+			// the fence will never be signaled, so the batch must not be waited for: it goes back to free, and its staging space with it
+			fprintf(stderr, "failed to submit upload batch!\n");
+			m_head = m_inFlightCount == 0 ? m_tail : m_batches[(m_oldestBatch + m_inFlightCount - 1) % BATCH_COUNT].stagingEnd;
+			return INVALID_TICKET;
+		}
+		if (m_profiler)
+		{
+			m_profiler->markSubmitted(profilerSlot);
+		}
+
+		batch.stagingEnd = m_head;
+		batch.ticket = ++m_submittedTicket;
+		++m_inFlightCount;
+		return batch.ticket;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::retireOldest(bool block) & -> bool
+	{
+		if (m_inFlightCount == 0)
+		{
+			return false;
+		}
+
+		Batch& batch = m_batches[m_oldestBatch];
+		VkResult const res = block ? vkWaitForFences(m_device, /*fenceCount*/1, &batch.fence, /*waitAll*/VK_TRUE, /*timeout*/UINT64_MAX)
+								   : vkGetFenceStatus(m_device, batch.fence);
+		if (res != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		if (m_profiler)
+		{
+			m_profiler->collect(m_firstProfilerSlot + m_oldestBatch); // fence signaled, so this doesn't block
+		}
+		m_tail = batch.stagingEnd;
+		m_retiredTicket = batch.ticket;
+		m_oldestBatch = (m_oldestBatch + 1) % BATCH_COUNT;
+		--m_inFlightCount;
+		return true;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::poll() & -> void
+	{
+		while (retireOldest(/*block*/false))
+		{
+		}
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::wait(uint64_t ticket) & -> status_t
+	{
+		assert(ticket <= m_submittedTicket && "waiting on a batch never submitted");
+		while (m_retiredTicket < ticket)
+		{
+			if (!retireOldest(/*block*/true))
+			{
+				return APP_GENERIC_ERR;
+			}
+		}
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::waitIdle() & -> status_t
+	{
+		uint64_t const ticket = submit();
+		return ticket == INVALID_TICKET ? APP_GENERIC_ERR : wait(ticket);
+	}
+
+	// -- uploads ---------------------------------------------------------------------------------------------------------------------------------------
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, void const* data, VkDeviceSize size,
+													VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) & -> status_t
+	{
+		// chunks of at most half the ring, so that a chunk can always fit once the other half retires
+		VkDeviceSize const maxChunk = m_stagingSize / 2;
+		for (VkDeviceSize done = 0; done < size;)
+		{
+			VkDeviceSize const chunk = std::min(size - done, maxChunk);
+			VkDeviceSize stagingOffset;
+			if (reserve(chunk, &stagingOffset) != APP_SUCCESS || beginBatch() != APP_SUCCESS)
+			{
+				return APP_GENERIC_ERR;
+			}
+			memcpy(static_cast<unsigned char*>(m_stagingMemory.mappedPtr) + stagingOffset, static_cast<unsigned char const*>(data) + done, chunk);
+
+			Batch& batch = m_batches[(m_oldestBatch + m_inFlightCount) % BATCH_COUNT];
+			VkBufferCopy const region {
+				.srcOffset = stagingOffset,
+				.dstOffset = dstOffset + done,
+				.size = chunk
+			};
+			vkCmdCopyBuffer(batch.cmdBuf, m_stagingBuffer, dstBuffer, /*regionCount*/1, &region);
+			batch.dstStageMask |= dstStageMask;
+			batch.dstAccessMask |= dstAccessMask;
+			batch.stagingEnd = m_head;
+
+			done += chunk;
+			m_bytesUploaded += chunk;
+		}
+		return APP_SUCCESS;
+	}
+
+	template <template<class> class AllocTemplate>
+	auto UploadManager<AllocTemplate>::uploadImage(VkImage dstImage, VkBufferImageCopy const& region, void const* data, VkDeviceSize size, VkImageLayout finalLayout,
+												   VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) & -> status_t
+	{
+		if (size > m_stagingSize / 2)
+		{
+			fprintf(stderr, "upload manager: image region of %lu bytes doesn't fit the staging ring!\n", static_cast<unsigned long>(size));
+			return APP_MEMORY_ERR;
+		}
+
+		VkDeviceSize stagingOffset;
+		if (reserve(size, &stagingOffset) != APP_SUCCESS || beginBatch() != APP_SUCCESS)
+		{
+			return APP_GENERIC_ERR;
+		}
+		memcpy(static_cast<unsigned char*>(m_stagingMemory.mappedPtr) + stagingOffset, data, size);
+
+		Batch& batch = m_batches[(m_oldestBatch + m_inFlightCount) % BATCH_COUNT];
+		VkImageSubresourceRange const subresourceRange {
+			.aspectMask = region.imageSubresource.aspectMask,
+			.baseMipLevel = region.imageSubresource.mipLevel,
+			.levelCount = 1,
+			.baseArrayLayer = region.imageSubresource.baseArrayLayer,
+			.layerCount = region.imageSubresource.layerCount
+		};
+		VkImageMemoryBarrier imageBarrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = dstImage,
+			.subresourceRange = subresourceRange
+		};
+		vkCmdPipelineBarrier(batch.cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, /*dependencyFlags*/0,
+							 0, nullptr, 0, nullptr, /*imageMemoryBarrierCount*/1, &imageBarrier);
+
+		VkBufferImageCopy stagedRegion = region;
+		stagedRegion.bufferOffset = stagingOffset;
+		vkCmdCopyBufferToImage(batch.cmdBuf, m_stagingBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, /*regionCount*/1, &stagedRegion);
+
+		imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageBarrier.dstAccessMask = dstAccessMask;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageBarrier.newLayout = finalLayout;
+		vkCmdPipelineBarrier(batch.cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, /*dependencyFlags*/0,
+							 0, nullptr, 0, nullptr, /*imageMemoryBarrierCount*/1, &imageBarrier);
+		batch.stagingEnd = m_head;
+
+		m_bytesUploaded += size;
+		return APP_SUCCESS;
+	}
+}
@@ -0,0 +1,196 @@
+#include "vertex_format.h"
+
+#include <algorithm> // min, max
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MXC_VERTEX_FORMAT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace mxc
+{
+	namespace
+	{
+		char const* const VERTEX_FORMAT_NAMES[VERTEX_FORMAT_COUNT] {"float32", "half", "snorm16"};
+
+		auto at(void* base, size_t stride, size_t i) -> unsigned char* { return static_cast<unsigned char*>(base) + i * stride; }
+		auto at(float const* base, size_t stride, size_t i) -> float const*
+		{
+			return reinterpret_cast<float const*>(reinterpret_cast<unsigned char const*>(base) + i * stride);
+		}
+
+		// -- scalar --------------------------------------------------------------------------------------------------------------------
+		auto snorm16FromUnit(float x) -> int16_t
+		{
+			return static_cast<int16_t>(std::lrint(std::clamp(x, -1.f, 1.f) * 32767.f));
+		}
+
+#ifndef MXC_VERTEX_FORMAT_SSE2 // the SSE2 encoders have their own
+		// x in [-1,1]: rebias the exponent by multiplying by 2^-112, then the half is the float's top bits, rounded half up. Values under
+		// the half normal range become float denormals, whose top bits are the half denormal
+		auto halfFromUnit(float x) -> uint16_t
+		{
+			x = std::clamp(x, -1.f, 1.f);
+			uint32_t bits;
+			memcpy(&bits, &x, sizeof(bits));
+			uint32_t const sign = bits & 0x80000000u;
+			bits = (bits ^ sign) & ~0xfffu;
+			float rebiased;
+			memcpy(&rebiased, &bits, sizeof(bits));
+			rebiased *= 0x1p-112f;
+			memcpy(&bits, &rebiased, sizeof(bits));
+			return static_cast<uint16_t>(((bits + 0x1000u) >> 13) | (sign >> 16));
+		}
+
+		auto unorm8FromUnit(float x) -> uint8_t
+		{
+			return static_cast<uint8_t>(std::lrint(std::clamp(x, 0.f, 1.f) * 255.f));
+		}
+#endif
+
+		// normal, assumed unit, to the octahedron on [-1,1]^2
+		auto octahedral(float const* n, float* outXY) -> void
+		{
+			float const l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+			float const x = l1 > 0.f ? n[0] / l1 : 0.f;
+			float const y = l1 > 0.f ? n[1] / l1 : 0.f;
+			bool const lowerHemisphere = l1 > 0.f && n[2] < 0.f;
+			outXY[0] = lowerHemisphere ? (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f) : x;
+			outXY[1] = lowerHemisphere ? (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f) : y;
+		}
+
+#ifdef MXC_VERTEX_FORMAT_SSE2
+		// -- SSE2 ----------------------------------------------------------------------------------------------------------------------
+		// 3 floats in the first lanes, 0 in the last. Doesn't read past the third, which may be the end of the stream
+		auto load3(float const* p) -> __m128
+		{
+			double xy; // the stream is only 4 byte aligned, so no _mm_load_sd
+			memcpy(&xy, p, sizeof(xy));
+			return _mm_movelh_ps(_mm_castpd_ps(_mm_set_sd(xy)), _mm_load_ss(p + 2));
+		}
+
+		auto clampUnit(__m128 v, __m128 low) -> __m128
+		{
+			return _mm_min_ps(_mm_max_ps(v, low), _mm_set1_ps(1.f));
+		}
+
+		// 4 int32 holding 16 bit patterns to 4 int16, low 64 bits of the result. packs saturates as signed, so sign extend first
+		auto pack16(__m128i v) -> __m128i
+		{
+			v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+			return _mm_packs_epi32(v, v);
+		}
+
+		// same as halfFromUnit, on 4 lanes
+		auto halfFromUnit4(__m128 x) -> __m128i
+		{
+			x = clampUnit(x, _mm_set1_ps(-1.f));
+			__m128 const sign = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int32_t>(0x80000000u))));
+			__m128 const truncated = _mm_and_ps(_mm_xor_ps(x, sign), _mm_castsi128_ps(_mm_set1_epi32(~0xfff)));
+			__m128i const rebiased = _mm_castps_si128(_mm_mul_ps(truncated, _mm_set1_ps(0x1p-112f)));
+			__m128i const magnitude = _mm_srli_epi32(_mm_add_epi32(rebiased, _mm_set1_epi32(0x1000)), 13);
+			return _mm_or_si128(magnitude, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+		}
+#endif
+	}
+
+	auto vertexFormatName(VertexFormat format) -> char const*
+	{
+		return format < VERTEX_FORMAT_COUNT ? VERTEX_FORMAT_NAMES[format] : "unknown";
+	}
+
+	auto parseVertexFormat(char const* name, VertexFormat* outFormat) -> status_t
+	{
+		for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; ++i)
+		{
+			if (strcmp(name, VERTEX_FORMAT_NAMES[i]) == 0)
+			{
+				*outFormat = static_cast<VertexFormat>(i);
+				return APP_SUCCESS;
+			}
+		}
+		return APP_GENERIC_ERR;
+	}
+
+	// -- encoders ----------------------------------------------------------------------------------------------------------------------
+	auto encodePositionsHalf(float const* in, size_t inStride, size_t count, float const offset[3], float const invScale[3], void* out, size_t outStride) -> void
+	{
+#ifdef MXC_VERTEX_FORMAT_SSE2
+		__m128 const offset4 = load3(offset);
+		__m128 const invScale4 = load3(invScale); // w ends up 0
+		for (size_t i = 0; i < count; ++i)
+		{
+			__m128 const unit = _mm_mul_ps(_mm_sub_ps(load3(at(in, inStride, i)), offset4), invScale4);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(at(out, outStride, i)), pack16(halfFromUnit4(unit)));
+		}
+#else
+		for (size_t i = 0; i < count; ++i)
+		{
+			float const* p = at(in, inStride, i);
+			uint16_t const half[4] {halfFromUnit((p[0] - offset[0]) * invScale[0]), halfFromUnit((p[1] - offset[1]) * invScale[1]),
+									halfFromUnit((p[2] - offset[2]) * invScale[2]), 0};
+			memcpy(at(out, outStride, i), half, sizeof(half));
+		}
+#endif
+	}
+
+	auto encodePositionsSnorm16(float const* in, size_t inStride, size_t count, float const offset[3], float const invScale[3], void* out, size_t outStride) -> void
+	{
+#ifdef MXC_VERTEX_FORMAT_SSE2
+		__m128 const offset4 = load3(offset);
+		__m128 const invScale4 = _mm_mul_ps(load3(invScale), _mm_set1_ps(32767.f));
+		__m128 const low = _mm_set1_ps(-32767.f);
+		__m128 const high = _mm_set1_ps(32767.f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			__m128 const scaled = _mm_mul_ps(_mm_sub_ps(load3(at(in, inStride, i)), offset4), invScale4);
+			__m128i const rounded = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(scaled, low), high)); // to nearest
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(at(out, outStride, i)), _mm_packs_epi32(rounded, rounded));
+		}
+#else
+		for (size_t i = 0; i < count; ++i)
+		{
+			float const* p = at(in, inStride, i);
+			int16_t const snorm[4] {snorm16FromUnit((p[0] - offset[0]) * invScale[0]), snorm16FromUnit((p[1] - offset[1]) * invScale[1]),
+									snorm16FromUnit((p[2] - offset[2]) * invScale[2]), 0};
+			memcpy(at(out, outStride, i), snorm, sizeof(snorm));
+		}
+#endif
+	}
+
+	auto encodeColorsUnorm8(float const* in, size_t inStride, size_t count, void* out, size_t outStride) -> void
+	{
+#ifdef MXC_VERTEX_FORMAT_SSE2
+		__m128 const alpha = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+		for (size_t i = 0; i < count; ++i)
+		{
+			__m128 const rgba = _mm_or_ps(_mm_andnot_ps(alpha, load3(at(in, inStride, i))), _mm_and_ps(alpha, _mm_set1_ps(1.f)));
+			__m128i const rounded = _mm_cvtps_epi32(_mm_mul_ps(clampUnit(rgba, _mm_setzero_ps()), _mm_set1_ps(255.f)));
+			__m128i const words = _mm_packs_epi32(rounded, rounded);
+			int32_t const packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+			memcpy(at(out, outStride, i), &packed, sizeof(packed));
+		}
+#else
+		for (size_t i = 0; i < count; ++i)
+		{
+			float const* c = at(in, inStride, i);
+			uint8_t const rgba[4] {unorm8FromUnit(c[0]), unorm8FromUnit(c[1]), unorm8FromUnit(c[2]), 255};
+			memcpy(at(out, outStride, i), rgba, sizeof(rgba));
+		}
+#endif
+	}
+
+	auto encodeOctahedral(float const* in, size_t inStride, size_t count, void* out, size_t outStride) -> void
+	{
+		// the fold has a data dependent branch per vertex, it stays scalar
+		for (size_t i = 0; i < count; ++i)
+		{
+			float xy[2];
+			octahedral(at(in, inStride, i), xy);
+			int16_t const snorm[2] {snorm16FromUnit(xy[0]), snorm16FromUnit(xy[1])};
+			memcpy(at(out, outStride, i), snorm, sizeof(snorm));
+		}
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "status.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Vertex buffer layouts described at compile time: a VertexLayout lists its attributes in shader location order, and the stride, offsets,
+// binding and attribute descriptions the pipeline needs are all derived from it, so they can't drift from the data.
+// Attributes are stored in formats the vertex fetch converts to float by itself, so shaders read float3/float4 whatever the layout:
+// - positions as float, or half / snorm16 after being mapped into [-1,1] by the encoder. The renderer folds the inverse mapping (a scale
+//   and an offset, VertexStream::positionOffset/positionScale) into the transform, so quantization costs nothing in the shader
+// - colors as float, or RGBA8 unorm
+// - normals octahedral encoded in 2 snorm16, decoded in the shader as shown at encodeOctahedral. Vertex has no normal yet, so none of
+//   the layouts below uses them
+// 3 component 16 bit formats are not widely supported for vertex buffers, so positions take 4, the last one being 0.
+// The renderer picks the layout at runtime, from a VertexFormat, which each layout instantiates once in vertexInputDescription
+namespace mxc
+{
+	// -- attributes --------------------------------------------------------------------------------------------------------------------
+	struct PositionFloat3 { static constexpr VkFormat format = VK_FORMAT_R32G32B32_SFLOAT; static constexpr uint32_t size = 12; };
+	struct PositionHalf4 { static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT; static constexpr uint32_t size = 8; };
+	struct PositionSnorm16x4 { static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SNORM; static constexpr uint32_t size = 8; };
+	struct ColorFloat3 { static constexpr VkFormat format = VK_FORMAT_R32G32B32_SFLOAT; static constexpr uint32_t size = 12; };
+	struct ColorUnorm8x4 { static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM; static constexpr uint32_t size = 4; };
+	struct NormalOctSnorm16x2 { static constexpr VkFormat format = VK_FORMAT_R16G16_SNORM; static constexpr uint32_t size = 4; };
+
+	inline constexpr uint32_t MAX_VERTEX_ATTRIBUTES = 8;
+
+	// everything the pipeline needs to know about one vertex buffer layout
+	struct VertexInputDescription
+	{
+		VkVertexInputBindingDescription binding;
+		std::array<VkVertexInputAttributeDescription, MAX_VERTEX_ATTRIBUTES> attributes;
+		uint32_t attributeCount;
+	};
+
+	// -- layouts -----------------------------------------------------------------------------------------------------------------------
+	// interleaved, one binding, attribute i at location i
+	template <typename... Attributes> struct VertexLayout
+	{
+		static constexpr uint32_t attributeCount = sizeof...(Attributes);
+		static constexpr uint32_t stride = (Attributes::size + ...);
+		static constexpr std::array<uint32_t, attributeCount> sizes {Attributes::size...};
+		static constexpr std::array<VkFormat, attributeCount> formats {Attributes::format...};
+
+		template <uint32_t location> static constexpr auto offset() -> uint32_t
+		{
+			uint32_t result = 0;
+			for (uint32_t i = 0; i < location; ++i)
+			{
+				result += sizes[i];
+			}
+			return result;
+		}
+
+		static constexpr auto describe(uint32_t binding) -> VertexInputDescription
+		{
+			VertexInputDescription description {
+				.binding = VkVertexInputBindingDescription{.binding = binding, .stride = stride, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
+				.attributes = {},
+				.attributeCount = attributeCount
+			};
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < attributeCount; ++i)
+			{
+				description.attributes[i] = VkVertexInputAttributeDescription{.location = i, .binding = binding, .format = formats[i], .offset = offset};
+				offset += sizes[i];
+			}
+			return description;
+		}
+
+		// vertex fetch wants every attribute aligned to its component size, 4 bytes is enough for all of the above
+		static_assert(attributeCount <= MAX_VERTEX_ATTRIBUTES && ((Attributes::size % 4 == 0) && ...));
+	};
+
+	using VertexLayoutFloat32 = VertexLayout<PositionFloat3, ColorFloat3>; // same as Vertex, what importers produce
+	using VertexLayoutHalf = VertexLayout<PositionHalf4, ColorUnorm8x4>;
+	using VertexLayoutSnorm16 = VertexLayout<PositionSnorm16x4, ColorUnorm8x4>;
+
+	// stored in .mxm files, so values never change
+	enum VertexFormat : uint32_t
+	{
+		VERTEX_FORMAT_FLOAT32 = 0,
+		VERTEX_FORMAT_HALF = 1,
+		VERTEX_FORMAT_SNORM16 = 2,
+		VERTEX_FORMAT_COUNT
+	};
+
+	constexpr auto vertexInputDescription(VertexFormat format, uint32_t binding = 0) -> VertexInputDescription
+	{
+		switch (format)
+		{
+			case VERTEX_FORMAT_HALF: return VertexLayoutHalf::describe(binding);
+			case VERTEX_FORMAT_SNORM16: return VertexLayoutSnorm16::describe(binding);
+			default: return VertexLayoutFloat32::describe(binding);
+		}
+	}
+	constexpr auto vertexStride(VertexFormat format) -> uint32_t { return vertexInputDescription(format).binding.stride; }
+	auto vertexFormatName(VertexFormat format) -> char const*;
+	auto parseVertexFormat(char const* name, VertexFormat* outFormat) -> status_t; // "float32", "half", "snorm16"
+
+	// -- encoders ----------------------------------------------------------------------------------------------------------------------
+	// SSE2 when the target has it (except the octahedral fold), scalar otherwise. Each converts count elements, reading 3 floats each from
+	// a stream with inStride bytes between elements, and writing out with outStride. Positions are first mapped to [-1,1] as
+	// (p - offset) * invScale. Out of range values are clamped
+	auto encodePositionsHalf(float const* in, size_t inStride, size_t count, float const offset[3], float const invScale[3], void* out, size_t outStride) -> void;
+	auto encodePositionsSnorm16(float const* in, size_t inStride, size_t count, float const offset[3], float const invScale[3], void* out, size_t outStride) -> void;
+	auto encodeColorsUnorm8(float const* in, size_t inStride, size_t count, void* out, size_t outStride) -> void; // alpha is 1
+	// unit normals to the octahedron unfolded on [-1,1]^2. Shader side:
+	//   float3 n = float3(e.x, e.y, 1 - abs(e.x) - abs(e.y)); float t = saturate(-n.z); n.xy += (n.xy >= 0 ? -t : t); normalize(n)
+	auto encodeOctahedral(float const* in, size_t inStride, size_t count, void* out, size_t outStride) -> void;
+}
@@ -0,0 +1,188 @@
+#include "vulkan_host_allocator.h"
+
+#include "host_allocator.h"
+
+#include <algorithm> // max, min
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace mxc
+{
+	namespace
+	{
+		// right before the returned pointer. The block starts headerSpace(alignment) bytes before it
+		struct BlockHeader
+		{
+			size_t size;
+			size_t alignment;
+			uint32_t scope;
+		};
+
+		char const* const SCOPE_NAMES[VulkanHostAllocator::SCOPE_COUNT] {"vk command", "vk object", "vk cache", "vk device", "vk instance"};
+
+		auto scopeIndex(VkSystemAllocationScope scope) -> uint32_t
+		{
+			uint32_t const idx = static_cast<uint32_t>(scope);
+			return idx < VulkanHostAllocator::SCOPE_COUNT ? idx : static_cast<uint32_t>(VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+		}
+
+		auto blockAlignment(size_t alignment) -> size_t
+		{
+			return std::max(alignment, alignof(std::max_align_t));
+		}
+
+		// keeps the returned pointer aligned as requested
+		auto headerSpace(size_t alignment) -> size_t
+		{
+			size_t const align = blockAlignment(alignment);
+			return (sizeof(BlockHeader) + align - 1) & ~(align - 1);
+		}
+
+		auto headerOf(void* memory) -> BlockHeader*
+		{
+			return reinterpret_cast<BlockHeader*>(memory) - 1;
+		}
+
+		auto raisePeak(std::atomic<uint64_t>& peak, uint64_t value) -> void
+		{
+			uint64_t current = peak.load(std::memory_order_relaxed);
+			while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+	VulkanHostAllocator::VulkanHostAllocator()
+		: m_callbacks{
+			.pUserData = this,
+			.pfnAllocation = allocation,
+			.pfnReallocation = reallocation,
+			.pfnFree = free,
+			.pfnInternalAllocation = internalAllocation,
+			.pfnInternalFree = internalFree
+		}
+	{
+	}
+
+	auto VulkanHostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope) & -> void*
+	{
+		uint32_t const scopeIdx = scopeIndex(scope);
+		size_t const header = headerSpace(alignment);
+		void* block = nullptr;
+		{
+			hostalloc::TagScope const tag(SCOPE_NAMES[scopeIdx]);
+			block = hostalloc::allocate(header + size, blockAlignment(alignment));
+		}
+		if (!block)
+		{
+			return nullptr; // the implementation turns it into VK_ERROR_OUT_OF_HOST_MEMORY
+		}
+		void* const memory = static_cast<char*>(block) + header;
+		*headerOf(memory) = BlockHeader{.size = size, .alignment = alignment, .scope = scopeIdx};
+
+		ScopeCounters& counters = m_scopes[scopeIdx];
+		counters.allocationCount.fetch_add(1, std::memory_order_relaxed);
+		raisePeak(counters.bytesPeak, counters.bytesLive.fetch_add(size, std::memory_order_relaxed) + size);
+		return memory;
+	}
+
+	auto VulkanHostAllocator::deallocate(void* memory) & -> void
+	{
+		if (!memory)
+		{
+			return;
+		}
+		BlockHeader const header = *headerOf(memory);
+		ScopeCounters& counters = m_scopes[header.scope];
+		counters.freeCount.fetch_add(1, std::memory_order_relaxed);
+		counters.bytesLive.fetch_sub(header.size, std::memory_order_relaxed);
+		size_t const space = headerSpace(header.alignment);
+		hostalloc::deallocate(static_cast<char*>(memory) - space, space + header.size, blockAlignment(header.alignment));
+	}
+
+	VKAPI_ATTR auto VKAPI_CALL VulkanHostAllocator::allocation(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope) -> void*
+	{
+		return static_cast<VulkanHostAllocator*>(userData)->allocate(size, alignment, scope);
+	}
+
+	// the spec requires the original alignment, and a null original or a zero size to act as allocation and free
+	VKAPI_ATTR auto VKAPI_CALL VulkanHostAllocator::reallocation(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) -> void*
+	{
+		auto* const self = static_cast<VulkanHostAllocator*>(userData);
+		if (!original)
+		{
+			return self->allocate(size, alignment, scope);
+		}
+		if (size == 0)
+		{
+			self->deallocate(original);
+			return nullptr;
+		}
+		void* const memory = self->allocate(size, alignment, scope);
+		if (!memory)
+		{
+			return nullptr; // the original stays valid
+		}
+		self->m_scopes[scopeIndex(scope)].reallocationCount.fetch_add(1, std::memory_order_relaxed);
+		memcpy(memory, original, std::min(size, headerOf(original)->size));
+		self->deallocate(original);
+		return memory;
+	}
+
+	VKAPI_ATTR auto VKAPI_CALL VulkanHostAllocator::free(void* userData, void* memory) -> void
+	{
+		static_cast<VulkanHostAllocator*>(userData)->deallocate(memory);
+	}
+
+	VKAPI_ATTR auto VKAPI_CALL VulkanHostAllocator::internalAllocation(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope) -> void
+	{
+		ScopeCounters& counters = static_cast<VulkanHostAllocator*>(userData)->m_scopes[scopeIndex(scope)];
+		counters.internalAllocationCount.fetch_add(1, std::memory_order_relaxed);
+		raisePeak(counters.internalBytesPeak, counters.internalBytesLive.fetch_add(size, std::memory_order_relaxed) + size);
+	}
+
+	VKAPI_ATTR auto VKAPI_CALL VulkanHostAllocator::internalFree(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope) -> void
+	{
+		static_cast<VulkanHostAllocator*>(userData)->m_scopes[scopeIndex(scope)].internalBytesLive.fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	auto VulkanHostAllocator::stats() const & -> Stats
+	{
+		Stats stats{};
+		for (uint32_t i = 0; i < SCOPE_COUNT; ++i)
+		{
+			ScopeCounters const& counters = m_scopes[i];
+			stats.scopes[i] = ScopeStats{
+				.allocationCount = counters.allocationCount.load(std::memory_order_relaxed),
+				.reallocationCount = counters.reallocationCount.load(std::memory_order_relaxed),
+				.freeCount = counters.freeCount.load(std::memory_order_relaxed),
+				.bytesLive = counters.bytesLive.load(std::memory_order_relaxed),
+				.bytesPeak = counters.bytesPeak.load(std::memory_order_relaxed),
+				.internalAllocationCount = counters.internalAllocationCount.load(std::memory_order_relaxed),
+				.internalBytesLive = counters.internalBytesLive.load(std::memory_order_relaxed),
+				.internalBytesPeak = counters.internalBytesPeak.load(std::memory_order_relaxed)
+			};
+		}
+		return stats;
+	}
+
+	auto VulkanHostAllocator::printStats() const & -> void
+	{
+		Stats const s = stats();
+		printf("vulkan host allocation stats:\n");
+		for (uint32_t i = 0; i < SCOPE_COUNT; ++i)
+		{
+			ScopeStats const& scope = s.scopes[i];
+			if (scope.allocationCount == 0 && scope.internalAllocationCount == 0)
+			{
+				continue;
+			}
+			printf("\t%-12s %lu allocations (%lu reallocations), %lu frees, live %lu bytes, peak %lu bytes; internal: %lu allocations, live %lu bytes, peak %lu bytes\n",
+				   SCOPE_NAMES[i], static_cast<unsigned long>(scope.allocationCount), static_cast<unsigned long>(scope.reallocationCount),
+				   static_cast<unsigned long>(scope.freeCount), static_cast<unsigned long>(scope.bytesLive), static_cast<unsigned long>(scope.bytesPeak),
+				   static_cast<unsigned long>(scope.internalAllocationCount), static_cast<unsigned long>(scope.internalBytesLive),
+				   static_cast<unsigned long>(scope.internalBytesPeak));
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+
+// Host memory of the Vulkan implementation (loader, layers, driver), as VkAllocationCallbacks. Every block comes from hostalloc, tagged
+// with its allocation scope: command and object scope blocks, the many small and short lived ones made while creating pipelines,
+// swapchains and the like, are recycled through its per-thread size class caches. Each block carries a small header with size, alignment
+// and scope, since the free callback gets none of them. Allocations the driver makes on its own (executable memory) are only reported,
+// through the internal notifications, and are tracked separately.
+// The callbacks can be called from any thread. The allocator must outlive every object created with its callbacks
+namespace mxc
+{
+	class VulkanHostAllocator
+	{
+	public:
+		static inline constexpr uint32_t SCOPE_COUNT = 5; // VK_SYSTEM_ALLOCATION_SCOPE_COMMAND .. INSTANCE
+
+		struct ScopeStats
+		{
+			uint64_t allocationCount;
+			uint64_t reallocationCount;
+			uint64_t freeCount;
+			uint64_t bytesLive;
+			uint64_t bytesPeak;
+			uint64_t internalAllocationCount; // notified, not allocated by us
+			uint64_t internalBytesLive;
+			uint64_t internalBytesPeak;
+		};
+
+		struct Stats
+		{
+			ScopeStats scopes[SCOPE_COUNT]; // indexed by VkSystemAllocationScope
+		};
+
+	public:
+		VulkanHostAllocator();
+		VulkanHostAllocator(VulkanHostAllocator const&) = delete; // the callbacks point to this
+		auto operator=(VulkanHostAllocator const&) -> VulkanHostAllocator& = delete;
+
+		auto callbacks() const & -> VkAllocationCallbacks const* { return &m_callbacks; }
+		auto stats() const & -> Stats;
+		auto printStats() const & -> void;
+
+	private:
+		struct ScopeCounters
+		{
+			std::atomic<uint64_t> allocationCount{0};
+			std::atomic<uint64_t> reallocationCount{0};
+			std::atomic<uint64_t> freeCount{0};
+			std::atomic<uint64_t> bytesLive{0};
+			std::atomic<uint64_t> bytesPeak{0};
+			std::atomic<uint64_t> internalAllocationCount{0};
+			std::atomic<uint64_t> internalBytesLive{0};
+			std::atomic<uint64_t> internalBytesPeak{0};
+		};
+
+		static VKAPI_ATTR auto VKAPI_CALL allocation(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope) -> void*;
+		static VKAPI_ATTR auto VKAPI_CALL reallocation(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) -> void*;
+		static VKAPI_ATTR auto VKAPI_CALL free(void* userData, void* memory) -> void;
+		static VKAPI_ATTR auto VKAPI_CALL internalAllocation(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) -> void;
+		static VKAPI_ATTR auto VKAPI_CALL internalFree(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) -> void;
+
+		auto allocate(size_t size, size_t alignment, VkSystemAllocationScope scope) & -> void*;
+		auto deallocate(void* memory) & -> void;
+
+		VkAllocationCallbacks m_callbacks;
+		ScopeCounters m_scopes[SCOPE_COUNT];
+	};
+}
@@ -0,0 +1,58 @@
+#include "mesh_import.h"
+#include "mesh_file.h"
+#include "mesh_optimize.h"
+#include "mesh_lod.h"
+#include "meshlet.h"
+#include "job_system.h"
+#include "trace.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Offline converter to .mxm: imports any format importMesh reads, in parallel, optimizes it for the vertex cache and overdraw (16 bit
+// indices where they fit), builds its LODs and meshlets, encodes the vertices (snorm16 positions and RGBA8 colors
+// unless told otherwise, half the size of float ones) and writes everything in the layout the renderer uploads, so that the application
+// and the benchmark load it with a memory mapping instead of parsing text.
+// usage: VulkanLearningMeshConvert [--vertex-format float32|half|snorm16] INPUT OUTPUT.mxm
+auto main(int32_t argc, char* argv[]) -> int32_t
+{
+	mxc::VertexFormat vertexFormat = mxc::VERTEX_FORMAT_SNORM16;
+	int32_t argIdx = 1;
+	if (argc > 2 && strcmp(argv[1], "--vertex-format") == 0)
+	{
+		argIdx = mxc::parseVertexFormat(argv[2], &vertexFormat) == APP_SUCCESS ? 3 : argc;
+	}
+	if (argc - argIdx != 2 || !mxc::isMeshFilePath(argv[argIdx + 1]))
+	{
+		fprintf(stderr, "usage: %s [--vertex-format float32|half|snorm16] INPUT(.obj, .gltf, .glb) OUTPUT.mxm\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	char const* const inPath = argv[argIdx];
+	char const* const outPath = argv[argIdx + 1];
+
+	mxc::JobSystem jobSystem;
+	if (jobSystem.init() != APP_SUCCESS)
+	{
+		fprintf(stderr, "failed to start the job system!\n");
+		return EXIT_FAILURE;
+	}
+	mxc::MeshData mesh;
+	if (mxc::importMesh(inPath, &jobSystem, &mesh) != APP_SUCCESS)
+	{
+		fprintf(stderr, "failed to import %s!\n", inPath);
+		return EXIT_FAILURE;
+	}
+
+	uint64_t const beginNs = mxc::trace::now();
+	size_t const floatBytes = mesh.vertices.size() * sizeof(mxc::Vertex);
+	if (mxc::optimizeMesh(&mesh, &jobSystem) != APP_SUCCESS || mxc::buildLods(&mesh, &jobSystem) != APP_SUCCESS
+		|| mxc::buildMeshlets(&mesh, &jobSystem) != APP_SUCCESS || mxc::encodeVertices(&mesh, vertexFormat, &jobSystem) != APP_SUCCESS || mxc::writeMeshFile(outPath, mesh.view()) != APP_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	printf("wrote %s in %.1f ms, %s vertices in %lu bytes instead of %lu\n", outPath, static_cast<double>(mxc::trace::now() - beginNs) * 1e-6,
+		   mxc::vertexFormatName(vertexFormat), static_cast<unsigned long>(mesh.view().vertices.data.size()), static_cast<unsigned long>(floatBytes));
+	return EXIT_SUCCESS;
+}